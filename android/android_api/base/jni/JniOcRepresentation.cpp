@@ -63,7 +63,7 @@ JNIEXPORT jobject JNICALL Java_org_iotivity_base_OcRepresentation_getValues
         return nullptr;
     }
 
-    for (std::map<std::string, AttributeValue>::const_iterator it = values.begin(); it != values.end(); it++)
+    for (auto it = values.begin(); it != values.end(); it++)
     {
         jobject key = static_cast<jobject>(env->NewStringUTF(it->first.c_str()));
         jobject val = boost::apply_visitor(JObjectConverter(env), it->second);
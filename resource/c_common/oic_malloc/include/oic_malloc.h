@@ -35,6 +35,8 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -48,6 +50,67 @@ extern "C"
 // Typedefs
 //-----------------------------------------------------------------------------
 
+/**
+ * Modules whose allocations are accounted separately when the stack is built with
+ * ENABLE_MALLOC_STATS. A translation unit's allocations carry the tag OIC_MALLOC_TAG,
+ * which the build defines per library; OIC_MEM_TAG_OTHER when it is not defined.
+ */
+typedef enum
+{
+    OIC_MEM_TAG_OTHER = 0,
+    OIC_MEM_TAG_CONNECTIVITY,
+    OIC_MEM_TAG_STACK,
+    OIC_MEM_TAG_SECURITY,
+    OIC_MEM_TAG_PAYLOAD,
+    OIC_MEM_TAG_COUNT
+} OICMemTag;
+
+/**
+ * Allocation counters of one module, see OICGetMemStats.
+ */
+typedef struct
+{
+    uint64_t allocations;   /**< Blocks allocated. */
+    uint64_t frees;         /**< Blocks freed. */
+    int64_t liveBytes;      /**< Bytes allocated and not freed yet. */
+    int64_t peakBytes;      /**< Highest liveBytes so far. */
+} OICMemTagStats;
+
+/**
+ * Allocation counters of all modules, indexed by OICMemTag.
+ */
+typedef struct
+{
+    OICMemTagStats tags[OIC_MEM_TAG_COUNT];
+} OICMemStats;
+
+/**
+ * Called with a snapshot of the allocation counters, see OICSetMemStatsHook.
+ */
+typedef void (*OICMemStatsHook)(const OICMemStats *stats, void *context);
+
+/**
+ * A pool of memory blocks of one size. Blocks given back to the pool are kept
+ * for the next allocation instead of going back to the heap.
+ *
+ * Pool blocks are ordinary OICMalloc blocks, so a block may be released with
+ * OICFree instead, and any OICMalloc block of at least the pool's block size
+ * may be given to the pool.
+ */
+typedef struct OICPool OICPool;
+
+/**
+ * Counters of a pool, see OICPoolGetStats.
+ */
+typedef struct
+{
+    size_t blockSize;       /**< Size of the blocks of the pool. */
+    size_t freeBlocks;      /**< Blocks kept for the next allocations. */
+    uint64_t allocations;   /**< Blocks handed out. */
+    uint64_t reused;        /**< Blocks handed out that were kept by the pool. */
+    uint64_t releases;      /**< Blocks given back to the pool. */
+} OICPoolStats;
+
 //-----------------------------------------------------------------------------
 // Function prototypes
 //-----------------------------------------------------------------------------
@@ -111,6 +174,117 @@ void *OICCalloc(size_t num, size_t size);
  */
 void OICFree(void *ptr);
 
+/**
+ * Like OICMalloc, OICCalloc and OICRealloc, accounting the block to the given module.
+ * With ENABLE_MALLOC_STATS, OICMalloc, OICCalloc and OICRealloc call these with
+ * OIC_MALLOC_TAG. A reallocated block keeps its tag.
+ */
+void *OICMallocTagged(size_t size, OICMemTag tag);
+void *OICCallocTagged(size_t num, size_t size, OICMemTag tag);
+void *OICReallocTagged(void *ptr, size_t size, OICMemTag tag);
+
+/**
+ * Gets a snapshot of the allocation counters of every module. Counters are updated
+ * without locking, so a snapshot taken while other threads allocate may be a few
+ * allocations behind.
+ *
+ * @param stats - Filled with the counters
+ *
+ * @return
+ *     true on success
+ *     false if the stack is built without ENABLE_MALLOC_STATS
+ */
+bool OICGetMemStats(OICMemStats *stats);
+
+/**
+ * Sets a hook called with a snapshot of the allocation counters every intervalMs
+ * milliseconds. The hook runs on whichever thread allocates once the interval has
+ * passed, so it should be short. Calls never overlap, and the allocations of the
+ * hook itself do not call it again. It may call OICGetMemStats and
+ * OICSetMemStatsHook; a hook just removed may still be running on another thread.
+ *
+ * @param hook - The hook, or a null pointer to remove it
+ * @param context - Passed to the hook
+ * @param intervalMs - Milliseconds between two calls
+ *
+ * @return
+ *     true on success
+ *     false if the stack is built without ENABLE_MALLOC_STATS
+ */
+bool OICSetMemStatsHook(OICMemStatsHook hook, void *context, uint32_t intervalMs);
+
+/**
+ * Creates a pool of blocks of blockSize bytes. The pool is thread safe.
+ *
+ * @param blockSize - Size of the blocks in bytes, where blockSize > 0
+ * @param maxFreeBlocks - How many released blocks the pool keeps; blocks released
+ *                        beyond that go back to the heap.
+ *
+ * @return
+ *     on success, the pool
+ *     on failure, a null pointer is returned
+ */
+OICPool *OICPoolCreate(size_t blockSize, size_t maxFreeBlocks);
+
+/**
+ * Like OICPoolCreate, accounting the blocks of the pool to the given module.
+ */
+OICPool *OICPoolCreateTagged(size_t blockSize, size_t maxFreeBlocks, OICMemTag tag);
+
+/**
+ * Destroys a pool and frees the blocks it keeps. Blocks still in use are ordinary
+ * OICMalloc blocks and are released with OICFree.
+ *
+ * @param pool - The pool. If pool is a null pointer, the function does nothing.
+ */
+void OICPoolDestroy(OICPool *pool);
+
+/**
+ * Allocates a block from a pool, reusing a released block if there is one.
+ *
+ * @param pool - The pool
+ *
+ * @return
+ *     on success, a pointer to a block of the pool's block size
+ *     on failure, a null pointer is returned
+ */
+void *OICPoolAlloc(OICPool *pool);
+
+/**
+ * Like OICPoolAlloc, with the block zeroed.
+ */
+void *OICPoolCalloc(OICPool *pool);
+
+/**
+ * Gives a block back to a pool.
+ *
+ * @param pool - The pool
+ * @param ptr - A block of the pool, or any block allocated by OICMalloc with at
+ *              least the pool's block size. If ptr is a null pointer, the function
+ *              does nothing.
+ */
+void OICPoolFree(OICPool *pool, void *ptr);
+
+/**
+ * Gets the counters of a pool.
+ *
+ * @param pool - The pool
+ * @param stats - Filled with the counters
+ */
+void OICPoolGetStats(OICPool *pool, OICPoolStats *stats);
+
+#ifdef ENABLE_MALLOC_STATS
+#ifndef OIC_MALLOC_TAG
+#define OIC_MALLOC_TAG OIC_MEM_TAG_OTHER
+#endif
+
+#define OICMalloc(size) OICMallocTagged((size), OIC_MALLOC_TAG)
+#define OICCalloc(num, size) OICCallocTagged((num), (size), OIC_MALLOC_TAG)
+#define OICRealloc(ptr, size) OICReallocTagged((ptr), (size), OIC_MALLOC_TAG)
+#define OICPoolCreate(blockSize, maxFreeBlocks) \
+    OICPoolCreateTagged((blockSize), (maxFreeBlocks), OIC_MALLOC_TAG)
+#endif // ENABLE_MALLOC_STATS
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -22,8 +22,29 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <stdlib.h>
+#include <string.h>
 #include "oic_malloc.h"
 
+#if defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#ifdef ENABLE_MALLOC_STATS
+#include "oic_time.h"
+
+#if !defined(__GNUC__)
+#error "ENABLE_MALLOC_STATS needs the GCC atomic builtins"
+#endif
+
+// The header turns these into their tagged versions; this file defines both.
+#undef OICMalloc
+#undef OICCalloc
+#undef OICRealloc
+#undef OICPoolCreate
+#endif
+
 // Enable extra debug logging for malloc.  Comment out to disable
 #ifdef ENABLE_MALLOC_DEBUG
 #include "logger.h"
@@ -34,14 +55,109 @@
 // Typedefs
 //-----------------------------------------------------------------------------
 
+// Free blocks are chained through their first bytes.
+typedef struct OICPoolBlock
+{
+    struct OICPoolBlock *next;
+} OICPoolBlock;
+
+struct OICPool
+{
+    OICPoolBlock *freeList;
+    size_t maxFreeBlocks;
+    OICMemTag tag;
+    OICPoolStats stats;
+#if defined(HAVE_PTHREAD_H)
+    pthread_mutex_t lock;
+#elif defined(_WIN32)
+    CRITICAL_SECTION lock;
+#endif
+};
+
+#ifdef ENABLE_MALLOC_STATS
+// Precedes every block to remember what to account when it is freed. The union
+// keeps the block as aligned as malloc's.
+typedef union
+{
+    struct
+    {
+        size_t size;
+        OICMemTag tag;
+    } info;
+    long double align;
+} OICMemHeader;
+
+// Counts of a thread. Only that thread writes them, so counting needs no lock;
+// a snapshot sums the counters of all threads.
+typedef struct OICMemThreadCounters
+{
+    struct OICMemThreadCounters *next;
+    bool inUse;
+    uint64_t allocations[OIC_MEM_TAG_COUNT];
+    uint64_t frees[OIC_MEM_TAG_COUNT];
+} OICMemThreadCounters;
+#endif
+
 //-----------------------------------------------------------------------------
 // Private variables
 //-----------------------------------------------------------------------------
+#ifdef ENABLE_MALLOC_STATS
+// A peak needs the total, so live bytes are shared by all threads
+static int64_t g_liveBytes[OIC_MEM_TAG_COUNT];
+static int64_t g_peakBytes[OIC_MEM_TAG_COUNT];
+
+static OICMemStatsHook g_hook = NULL;
+static void *g_hookContext = NULL;
+static bool g_hookEnabled = false;
+static bool g_inHook = false;
+static uint32_t g_hookInterval = 0;
+static uint64_t g_nextHookTime = 0;
+
+#if defined(HAVE_PTHREAD_H)
+// Guards the list of counters and the hook, not the counting itself
+static pthread_mutex_t g_statsLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t g_countersKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_countersKey;
+static bool g_countersKeyCreated = false;
+
+// The counters of every thread that ever allocated; those of exited threads are
+// handed to new threads.
+static OICMemThreadCounters *g_threadCounters = NULL;
+#else
+// Without pthreads all allocations count in one place, updated atomically
+static OICMemThreadCounters g_counters;
+static OICMemThreadCounters *g_threadCounters = &g_counters;
+#endif
+#endif // ENABLE_MALLOC_STATS
 
 //-----------------------------------------------------------------------------
 // Macros
 //-----------------------------------------------------------------------------
 
+// Platforms without threads need no lock
+#if defined(HAVE_PTHREAD_H)
+#define POOL_LOCK(pool) pthread_mutex_lock(&(pool)->lock)
+#define POOL_UNLOCK(pool) pthread_mutex_unlock(&(pool)->lock)
+#elif defined(_WIN32)
+#define POOL_LOCK(pool) EnterCriticalSection(&(pool)->lock)
+#define POOL_UNLOCK(pool) LeaveCriticalSection(&(pool)->lock)
+#else
+#define POOL_LOCK(pool)
+#define POOL_UNLOCK(pool)
+#endif
+
+// How many allocations of a module a thread makes between looks at the clock for
+// the stats hook
+#define MEM_STATS_HOOK_CHECK_PERIOD 64
+
+#if defined(ENABLE_MALLOC_STATS) && defined(HAVE_PTHREAD_H)
+#define STATS_LOCK() pthread_mutex_lock(&g_statsLock)
+#define STATS_UNLOCK() pthread_mutex_unlock(&g_statsLock)
+#else
+#define STATS_LOCK()
+#define STATS_UNLOCK()
+#endif
+
 //-----------------------------------------------------------------------------
 // Internal API function
 //-----------------------------------------------------------------------------
@@ -49,6 +165,185 @@
 //-----------------------------------------------------------------------------
 // Private internal function prototypes
 //-----------------------------------------------------------------------------
+#ifdef ENABLE_MALLOC_STATS
+#if defined(HAVE_PTHREAD_H)
+static void OICMemReleaseCounters(void *counters)
+{
+    STATS_LOCK();
+    ((OICMemThreadCounters *)counters)->inUse = false;
+    STATS_UNLOCK();
+}
+
+static void OICMemCreateCountersKey(void)
+{
+    g_countersKeyCreated = (0 == pthread_key_create(&g_countersKey, OICMemReleaseCounters));
+}
+#endif
+
+static OICMemThreadCounters *OICMemGetThreadCounters(void)
+{
+#if defined(HAVE_PTHREAD_H)
+    pthread_once(&g_countersKeyOnce, OICMemCreateCountersKey);
+    if (!g_countersKeyCreated)
+    {
+        return NULL;
+    }
+
+    OICMemThreadCounters *counters = (OICMemThreadCounters *)pthread_getspecific(g_countersKey);
+    if (counters)
+    {
+        return counters;
+    }
+
+    STATS_LOCK();
+    for (counters = g_threadCounters; counters && counters->inUse; counters = counters->next)
+    {
+    }
+    if (!counters)
+    {
+        // Not OICCalloc: the counters are not accounted themselves
+        counters = (OICMemThreadCounters *)calloc(1, sizeof(OICMemThreadCounters));
+        if (counters)
+        {
+            counters->next = g_threadCounters;
+            g_threadCounters = counters;
+        }
+    }
+    if (counters)
+    {
+        counters->inUse = true;
+    }
+    STATS_UNLOCK();
+
+    if (counters)
+    {
+        pthread_setspecific(g_countersKey, counters);
+    }
+    return counters;
+#else
+    return &g_counters;
+#endif
+}
+
+static uint64_t OICMemCount(uint64_t *counter)
+{
+#if defined(HAVE_PTHREAD_H)
+    // The counter has a single writer, a store is enough for readers
+    uint64_t value = *counter + 1;
+    __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+    return value;
+#else
+    return __atomic_add_fetch(counter, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static void OICMemAddLiveBytes(OICMemTag tag, int64_t bytes)
+{
+    int64_t live = __atomic_add_fetch(&g_liveBytes[tag], bytes, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&g_peakBytes[tag], __ATOMIC_RELAXED);
+    while (live > peak &&
+           !__atomic_compare_exchange_n(&g_peakBytes[tag], &peak, live, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+// Must be called with the stats lock held
+static void OICMemSnapshot(OICMemStats *stats)
+{
+    memset(stats, 0, sizeof(OICMemStats));
+    for (OICMemThreadCounters *counters = g_threadCounters; counters; counters = counters->next)
+    {
+        for (int tag = 0; tag < OIC_MEM_TAG_COUNT; ++tag)
+        {
+            stats->tags[tag].allocations +=
+                __atomic_load_n(&counters->allocations[tag], __ATOMIC_RELAXED);
+            stats->tags[tag].frees += __atomic_load_n(&counters->frees[tag], __ATOMIC_RELAXED);
+        }
+    }
+    for (int tag = 0; tag < OIC_MEM_TAG_COUNT; ++tag)
+    {
+        stats->tags[tag].liveBytes = __atomic_load_n(&g_liveBytes[tag], __ATOMIC_RELAXED);
+        stats->tags[tag].peakBytes = __atomic_load_n(&g_peakBytes[tag], __ATOMIC_RELAXED);
+    }
+}
+
+static void OICMemCheckHook(void)
+{
+    if (!__atomic_load_n(&g_hookEnabled, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    // Whoever moves the deadline calls the hook
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    uint64_t next = __atomic_load_n(&g_nextHookTime, __ATOMIC_RELAXED);
+    uint64_t interval = __atomic_load_n(&g_hookInterval, __ATOMIC_RELAXED);
+    if (now < next ||
+        !__atomic_compare_exchange_n(&g_nextHookTime, &next, now + interval, false,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    // One call at a time, and none for what the hook allocates itself
+    OICMemStatsHook hook = NULL;
+    void *context = NULL;
+    OICMemStats stats;
+    STATS_LOCK();
+    if (g_hook && !g_inHook)
+    {
+        hook = g_hook;
+        context = g_hookContext;
+        OICMemSnapshot(&stats);
+        g_inHook = true;
+    }
+    STATS_UNLOCK();
+
+    // Run without the lock, so the hook may read the stats or set another hook
+    if (hook)
+    {
+        hook(&stats, context);
+        STATS_LOCK();
+        g_inHook = false;
+        STATS_UNLOCK();
+    }
+}
+
+static void *OICMemTrack(OICMemHeader *header, size_t size, OICMemTag tag)
+{
+    if (!header)
+    {
+        return NULL;
+    }
+
+    header->info.size = size;
+    header->info.tag = tag;
+    OICMemAddLiveBytes(tag, (int64_t)size);
+
+    OICMemThreadCounters *counters = OICMemGetThreadCounters();
+    if (counters &&
+        0 == OICMemCount(&counters->allocations[tag]) % MEM_STATS_HOOK_CHECK_PERIOD)
+    {
+        OICMemCheckHook();
+    }
+    return header + 1;
+}
+
+static void *OICMemUntrack(void *ptr)
+{
+    OICMemHeader *header = (OICMemHeader *)ptr - 1;
+    OICMemTag tag = header->info.tag;
+    OICMemAddLiveBytes(tag, -(int64_t)header->info.size);
+
+    OICMemThreadCounters *counters = OICMemGetThreadCounters();
+    if (counters)
+    {
+        OICMemCount(&counters->frees[tag]);
+    }
+    return header;
+}
+#endif // ENABLE_MALLOC_STATS
 
 //-----------------------------------------------------------------------------
 // Public APIs
@@ -58,66 +353,121 @@ static uint32_t count;
 #endif
 
 void *OICMalloc(size_t size)
+{
+    return OICMallocTagged(size, OIC_MEM_TAG_OTHER);
+}
+
+void *OICMallocTagged(size_t size, OICMemTag tag)
 {
     if (0 == size)
     {
         return NULL;
     }
 
-#ifdef ENABLE_MALLOC_DEBUG
+#ifdef ENABLE_MALLOC_STATS
+    if (size > SIZE_MAX - sizeof(OICMemHeader) || (unsigned)tag >= OIC_MEM_TAG_COUNT)
+    {
+        return NULL;
+    }
+    void *ptr = OICMemTrack((OICMemHeader *)malloc(sizeof(OICMemHeader) + size), size, tag);
+#else
+    (void)tag;
     void *ptr = malloc(size);
+#endif
+
+#ifdef ENABLE_MALLOC_DEBUG
     if (ptr)
     {
         count++;
     }
     OIC_LOG_V(INFO, TAG, "malloc: ptr=%p, size=%u, count=%u", ptr, size, count);
-    return ptr;
-#else
-    return malloc(size);
 #endif
+    return ptr;
 }
 
 void *OICCalloc(size_t num, size_t size)
+{
+    return OICCallocTagged(num, size, OIC_MEM_TAG_OTHER);
+}
+
+void *OICCallocTagged(size_t num, size_t size, OICMemTag tag)
 {
     if (0 == size || 0 == num)
     {
         return NULL;
     }
 
-#ifdef ENABLE_MALLOC_DEBUG
+#ifdef ENABLE_MALLOC_STATS
+    if (num > (SIZE_MAX - sizeof(OICMemHeader)) / size || (unsigned)tag >= OIC_MEM_TAG_COUNT)
+    {
+        return NULL;
+    }
+    void *ptr = OICMemTrack((OICMemHeader *)calloc(1, sizeof(OICMemHeader) + num * size),
+                            num * size, tag);
+#else
+    (void)tag;
     void *ptr = calloc(num, size);
+#endif
+
+#ifdef ENABLE_MALLOC_DEBUG
     if (ptr)
     {
         count++;
     }
     OIC_LOG_V(INFO, TAG, "calloc: ptr=%p, num=%u, size=%u, count=%u", ptr, num, size, count);
-    return ptr;
-#else
-    return calloc(num, size);
 #endif
+    return ptr;
 }
 
 void *OICRealloc(void* ptr, size_t size)
+{
+    return OICReallocTagged(ptr, size, OIC_MEM_TAG_OTHER);
+}
+
+void *OICReallocTagged(void* ptr, size_t size, OICMemTag tag)
 {
     // Override realloc() behavior for NULL pointer which normally would
     // work as per malloc(), however we suppress the behavior of possibly
     // returning a non-null unique pointer.
     if (ptr == NULL)
     {
-        return OICMalloc(size);
+        return OICMallocTagged(size, tag);
     }
 
     // Otherwise leave the behavior up to realloc() itself:
 
-#ifdef ENABLE_MALLOC_DEBUG
+#ifdef ENABLE_MALLOC_STATS
+    // The block keeps the tag it was allocated with
+    if (0 == size)
+    {
+        OICFree(ptr);
+        return NULL;
+    }
+    if (size > SIZE_MAX - sizeof(OICMemHeader))
+    {
+        return NULL;
+    }
+    OICMemHeader *header = (OICMemHeader *)ptr - 1;
+    size_t oldSize = header->info.size;
+    header = (OICMemHeader *)realloc(header, sizeof(OICMemHeader) + size);
+    if (!header)
+    {
+        return NULL;
+    }
+    header->info.size = size;
+    OICMemAddLiveBytes(header->info.tag, (int64_t)size - (int64_t)oldSize);
+    void* newptr = header + 1;
+#else
+    (void)tag;
     void* newptr = realloc(ptr, size);
+#endif
+
+#ifdef ENABLE_MALLOC_DEBUG
     OIC_LOG_V(INFO, TAG, "realloc: ptr=%p, newptr=%p, size=%u", ptr, newptr, size);
+#endif
     // Very important to return the correct pointer here, as it only *somtimes*
     // differs and thus can be hard to notice/test:
     return newptr;
-#else
-    return realloc(ptr, size);
-#endif
 }
 
 void OICFree(void *ptr)
@@ -132,5 +482,180 @@ void OICFree(void *ptr)
     OIC_LOG_V(INFO, TAG, "free: ptr=%p, count=%u", ptr, count);
 #endif
 
+#ifdef ENABLE_MALLOC_STATS
+    if (ptr)
+    {
+        ptr = OICMemUntrack(ptr);
+    }
+#endif
     free(ptr);
 }
+
+bool OICGetMemStats(OICMemStats *stats)
+{
+#ifdef ENABLE_MALLOC_STATS
+    if (!stats)
+    {
+        return false;
+    }
+
+    STATS_LOCK();
+    OICMemSnapshot(stats);
+    STATS_UNLOCK();
+    return true;
+#else
+    (void)stats;
+    return false;
+#endif
+}
+
+bool OICSetMemStatsHook(OICMemStatsHook hook, void *context, uint32_t intervalMs)
+{
+#ifdef ENABLE_MALLOC_STATS
+    STATS_LOCK();
+    g_hook = hook;
+    g_hookContext = context;
+    __atomic_store_n(&g_hookInterval, intervalMs, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_nextHookTime, OICGetCurrentTime(TIME_IN_MS) + intervalMs,
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&g_hookEnabled, NULL != hook, __ATOMIC_RELAXED);
+    STATS_UNLOCK();
+    return true;
+#else
+    (void)hook;
+    (void)context;
+    (void)intervalMs;
+    return false;
+#endif
+}
+
+OICPool *OICPoolCreate(size_t blockSize, size_t maxFreeBlocks)
+{
+    return OICPoolCreateTagged(blockSize, maxFreeBlocks, OIC_MEM_TAG_OTHER);
+}
+
+OICPool *OICPoolCreateTagged(size_t blockSize, size_t maxFreeBlocks, OICMemTag tag)
+{
+    if (0 == blockSize)
+    {
+        return NULL;
+    }
+
+    OICPool *pool = (OICPool *)OICCalloc(1, sizeof(OICPool));
+    if (!pool)
+    {
+        return NULL;
+    }
+
+#if defined(HAVE_PTHREAD_H)
+    if (0 != pthread_mutex_init(&pool->lock, NULL))
+    {
+        OICFree(pool);
+        return NULL;
+    }
+#elif defined(_WIN32)
+    InitializeCriticalSection(&pool->lock);
+#endif
+
+    // A free block must hold the link to the next one
+    pool->stats.blockSize = blockSize < sizeof(OICPoolBlock) ? sizeof(OICPoolBlock) : blockSize;
+    pool->maxFreeBlocks = maxFreeBlocks;
+    pool->tag = tag;
+    return pool;
+}
+
+void OICPoolDestroy(OICPool *pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    while (pool->freeList)
+    {
+        OICPoolBlock *block = pool->freeList;
+        pool->freeList = block->next;
+        OICFree(block);
+    }
+
+#if defined(HAVE_PTHREAD_H)
+    pthread_mutex_destroy(&pool->lock);
+#elif defined(_WIN32)
+    DeleteCriticalSection(&pool->lock);
+#endif
+    OICFree(pool);
+}
+
+void *OICPoolAlloc(OICPool *pool)
+{
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    POOL_LOCK(pool);
+    OICPoolBlock *block = pool->freeList;
+    if (block)
+    {
+        pool->freeList = block->next;
+        pool->stats.freeBlocks--;
+        pool->stats.reused++;
+    }
+    pool->stats.allocations++;
+    POOL_UNLOCK(pool);
+
+    if (!block)
+    {
+        block = (OICPoolBlock *)OICMallocTagged(pool->stats.blockSize, pool->tag);
+    }
+    return block;
+}
+
+void *OICPoolCalloc(OICPool *pool)
+{
+    void *ptr = OICPoolAlloc(pool);
+    if (ptr)
+    {
+        memset(ptr, 0, pool->stats.blockSize);
+    }
+    return ptr;
+}
+
+void OICPoolFree(OICPool *pool, void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    if (!pool)
+    {
+        OICFree(ptr);
+        return;
+    }
+
+    OICPoolBlock *block = (OICPoolBlock *)ptr;
+    POOL_LOCK(pool);
+    pool->stats.releases++;
+    if (pool->stats.freeBlocks < pool->maxFreeBlocks)
+    {
+        block->next = pool->freeList;
+        pool->freeList = block;
+        pool->stats.freeBlocks++;
+        block = NULL;
+    }
+    POOL_UNLOCK(pool);
+
+    OICFree(block);
+}
+
+void OICPoolGetStats(OICPool *pool, OICPoolStats *stats)
+{
+    if (!pool || !stats)
+    {
+        return;
+    }
+
+    POOL_LOCK(pool);
+    *stats = pool->stats;
+    POOL_UNLOCK(pool);
+}
@@ -38,6 +38,7 @@ extern "C" {
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdint.h>
 using namespace std;
@@ -138,3 +139,239 @@ TEST(OICCalloc, CallocFail4)
     EXPECT_TRUE(NULL == pBuffer);
     OICFree(pBuffer);
 }
+
+TEST(OICPool, CreateFail)
+{
+    // A pool of empty blocks makes no sense
+    EXPECT_TRUE(NULL == OICPoolCreate(0, 4));
+}
+
+TEST(OICPool, ReusesFreedBlocks)
+{
+    OICPool *pool = OICPoolCreate(24, 4);
+    ASSERT_TRUE(NULL != pool);
+
+    void *first = OICPoolAlloc(pool);
+    ASSERT_TRUE(NULL != first);
+    OICPoolFree(pool, first);
+    EXPECT_EQ(first, OICPoolAlloc(pool));
+
+    OICPoolStats stats;
+    OICPoolGetStats(pool, &stats);
+    EXPECT_EQ(24u, stats.blockSize);
+    EXPECT_EQ(0u, stats.freeBlocks);
+    EXPECT_EQ(2u, stats.allocations);
+    EXPECT_EQ(1u, stats.reused);
+    EXPECT_EQ(1u, stats.releases);
+
+    OICPoolFree(pool, first);
+    OICPoolDestroy(pool);
+}
+
+TEST(OICPool, CallocZeroesReusedBlocks)
+{
+    OICPool *pool = OICPoolCreate(16, 4);
+    ASSERT_TRUE(NULL != pool);
+
+    uint8_t *block = (uint8_t *)OICPoolAlloc(pool);
+    ASSERT_TRUE(NULL != block);
+    memset(block, 0xA5, 16);
+    OICPoolFree(pool, block);
+
+    block = (uint8_t *)OICPoolCalloc(pool);
+    ASSERT_TRUE(NULL != block);
+    for (int i = 0; i < 16; ++i)
+    {
+        EXPECT_EQ(0, block[i]);
+    }
+
+    OICPoolFree(pool, block);
+    OICPoolDestroy(pool);
+}
+
+TEST(OICPool, KeepsAtMostMaxFreeBlocks)
+{
+    OICPool *pool = OICPoolCreate(32, 2);
+    ASSERT_TRUE(NULL != pool);
+
+    void *blocks[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        blocks[i] = OICPoolAlloc(pool);
+        ASSERT_TRUE(NULL != blocks[i]);
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        OICPoolFree(pool, blocks[i]);
+    }
+
+    OICPoolStats stats;
+    OICPoolGetStats(pool, &stats);
+    EXPECT_EQ(2u, stats.freeBlocks);
+    EXPECT_EQ(4u, stats.releases);
+
+    OICPoolDestroy(pool);
+}
+
+TEST(OICPool, MixesWithOICMalloc)
+{
+    OICPool *pool = OICPoolCreate(sizeof(uint64_t), 4);
+    ASSERT_TRUE(NULL != pool);
+
+    // A pool block may go back to the heap, and a heap block to the pool
+    OICFree(OICPoolAlloc(pool));
+    OICPoolFree(pool, OICMalloc(sizeof(uint64_t)));
+
+    OICPoolStats stats;
+    OICPoolGetStats(pool, &stats);
+    EXPECT_EQ(1u, stats.freeBlocks);
+
+    OICPoolFree(NULL, OICMalloc(1));
+    OICPoolFree(pool, NULL);
+    OICPoolDestroy(pool);
+    OICPoolDestroy(NULL);
+}
+
+#ifdef ENABLE_MALLOC_STATS
+TEST(OICMemStats, CountsPerTag)
+{
+    OICMemStats before;
+    ASSERT_TRUE(OICGetMemStats(&before));
+
+    void *first = OICMallocTagged(100, OIC_MEM_TAG_PAYLOAD);
+    void *second = OICCallocTagged(2, 50, OIC_MEM_TAG_PAYLOAD);
+    ASSERT_TRUE(NULL != first);
+    ASSERT_TRUE(NULL != second);
+    first = OICRealloc(first, 300);
+    ASSERT_TRUE(NULL != first);
+
+    OICMemStats during;
+    ASSERT_TRUE(OICGetMemStats(&during));
+    const OICMemTagStats &payload = during.tags[OIC_MEM_TAG_PAYLOAD];
+    EXPECT_EQ(before.tags[OIC_MEM_TAG_PAYLOAD].allocations + 2, payload.allocations);
+    EXPECT_EQ(before.tags[OIC_MEM_TAG_PAYLOAD].liveBytes + 400, payload.liveBytes);
+    EXPECT_LE(payload.liveBytes, payload.peakBytes);
+    EXPECT_EQ(before.tags[OIC_MEM_TAG_SECURITY].allocations,
+              during.tags[OIC_MEM_TAG_SECURITY].allocations);
+
+    OICFree(first);
+    OICFree(second);
+
+    OICMemStats after;
+    ASSERT_TRUE(OICGetMemStats(&after));
+    EXPECT_EQ(before.tags[OIC_MEM_TAG_PAYLOAD].frees + 2, after.tags[OIC_MEM_TAG_PAYLOAD].frees);
+    EXPECT_EQ(before.tags[OIC_MEM_TAG_PAYLOAD].liveBytes, after.tags[OIC_MEM_TAG_PAYLOAD].liveBytes);
+    EXPECT_EQ(payload.peakBytes, after.tags[OIC_MEM_TAG_PAYLOAD].peakBytes);
+}
+
+TEST(OICMemStats, PoolKeepsItsTag)
+{
+    OICMemStats before;
+    ASSERT_TRUE(OICGetMemStats(&before));
+
+    OICPool *pool = OICPoolCreateTagged(64, 4, OIC_MEM_TAG_CONNECTIVITY);
+    ASSERT_TRUE(NULL != pool);
+    OICPoolFree(pool, OICPoolAlloc(pool));
+
+    // The pool still holds the block
+    OICMemStats during;
+    ASSERT_TRUE(OICGetMemStats(&during));
+    EXPECT_EQ(before.tags[OIC_MEM_TAG_CONNECTIVITY].liveBytes + 64,
+              during.tags[OIC_MEM_TAG_CONNECTIVITY].liveBytes);
+
+    OICPoolDestroy(pool);
+
+    OICMemStats after;
+    ASSERT_TRUE(OICGetMemStats(&after));
+    EXPECT_EQ(before.tags[OIC_MEM_TAG_CONNECTIVITY].liveBytes,
+              after.tags[OIC_MEM_TAG_CONNECTIVITY].liveBytes);
+}
+
+static void countHookCalls(const OICMemStats *stats, void *context)
+{
+    EXPECT_TRUE(NULL != stats);
+    ++*(int *)context;
+}
+
+TEST(OICMemStats, HookGetsSnapshots)
+{
+    int calls = 0;
+    ASSERT_TRUE(OICSetMemStatsHook(countHookCalls, &calls, 0));
+    for (int i = 0; i < 1000; ++i)
+    {
+        OICFree(OICMalloc(8));
+    }
+    ASSERT_TRUE(OICSetMemStatsHook(NULL, NULL, 0));
+    EXPECT_LT(0, calls);
+
+    int callsAfterRemoval = calls;
+    for (int i = 0; i < 1000; ++i)
+    {
+        OICFree(OICMalloc(8));
+    }
+    EXPECT_EQ(callsAfterRemoval, calls);
+}
+
+struct HookState
+{
+    int calls;
+    int depth;
+    int maxDepth;
+};
+
+static void readStatsInHook(const OICMemStats *stats, void *context)
+{
+    HookState *state = (HookState *)context;
+    state->maxDepth = std::max(state->maxDepth, ++state->depth);
+    ++state->calls;
+
+    OICMemStats current;
+    EXPECT_TRUE(OICGetMemStats(&current));
+    EXPECT_LE(stats->tags[OIC_MEM_TAG_OTHER].allocations,
+              current.tags[OIC_MEM_TAG_OTHER].allocations);
+    // Enough to reach the next check for the hook
+    for (int i = 0; i < 200; ++i)
+    {
+        OICFree(OICMalloc(8));
+    }
+    --state->depth;
+}
+
+TEST(OICMemStats, HookMayReadStatsAndAllocate)
+{
+    HookState state = { 0, 0, 0 };
+    ASSERT_TRUE(OICSetMemStatsHook(readStatsInHook, &state, 0));
+    for (int i = 0; i < 1000; ++i)
+    {
+        OICFree(OICMalloc(8));
+    }
+    ASSERT_TRUE(OICSetMemStatsHook(NULL, NULL, 0));
+
+    EXPECT_LT(0, state.calls);
+    EXPECT_EQ(1, state.maxDepth);
+}
+
+static void removeHookInHook(const OICMemStats *, void *context)
+{
+    ++*(int *)context;
+    EXPECT_TRUE(OICSetMemStatsHook(NULL, NULL, 0));
+}
+
+TEST(OICMemStats, HookMayRemoveItself)
+{
+    int calls = 0;
+    ASSERT_TRUE(OICSetMemStatsHook(removeHookInHook, &calls, 0));
+    for (int i = 0; i < 1000; ++i)
+    {
+        OICFree(OICMalloc(8));
+    }
+    EXPECT_EQ(1, calls);
+}
+#else
+TEST(OICMemStats, NotBuiltIn)
+{
+    OICMemStats stats;
+    EXPECT_FALSE(OICGetMemStats(&stats));
+    EXPECT_FALSE(OICSetMemStatsHook(NULL, NULL, 0));
+}
+#endif
@@ -623,6 +623,17 @@ typedef void (*CAErrorCallback)(const CAEndpoint_t *object,
  */
 typedef void (*CANetworkMonitorCallback)(const CAEndpoint_t *info, CANetworkStatus_t status);
 
+/**
+ * Callback function type writing the payload of a message straight into its PDU.
+ * @param[in]       context     Context given along with the callback.
+ * @param[out]      buffer      Payload area of the PDU.
+ * @param[in,out]   size        Room in the buffer. Set to the size of the payload written,
+ *                              or to the size needed if the payload does not fit.
+ * @return ::CA_STATUS_OK, ::CA_MEMORY_ALLOC_FAILED if the payload does not fit,
+ *         or other ERROR CODES.
+ */
+typedef CAResult_t (*CAPayloadWriter)(void *context, uint8_t *buffer, size_t *size);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
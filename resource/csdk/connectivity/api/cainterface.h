@@ -189,6 +189,24 @@ CAResult_t CASendRequest(const CAEndpoint_t *object, const CARequestInfo_t *requ
  */
 CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo);
 
+/**
+ * Send the response with a payload written straight into the PDU, after its header and
+ * options, instead of being copied from a payload buffer. The payload and payloadSize of
+ * responseInfo are ignored; payloadFormat is used.
+ * @param[in]   object           Endpoint where the payload need to be sent.
+ *                               This endpoint is delivered with Request or response callback.
+ * @param[in]   responseInfo     Information for the response.
+ * @param[in]   writer           Callback writing the payload, called before this returns.
+ * @param[in]   context          Context passed to the writer.
+ * @return ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ *         ::CA_NOT_SUPPORTED if the response can not be sent in a single PDU, i.e. the
+ *         payload does not fit, it belongs to a block-wise transfer, or it is a multicast or
+ *         CoAP over TCP message. It must be sent by ::CASendResponse then.
+ */
+CAResult_t CASendResponseWithPayloadWriter(const CAEndpoint_t *object,
+                                           const CAResponseInfo_t *responseInfo,
+                                           CAPayloadWriter writer, void *context);
+
 /**
  * Select network to use.
  * @param[in]   interestedNetwork    Connectivity Type enum.
@@ -34,6 +34,20 @@ extern "C"
 {
 #endif
 
+/**
+ * Creates the pools that recycle endpoints and request and response infos. Until
+ * they exist, and after CADestroyObjectPools, these objects come from the heap.
+ * Calling it again while the pools exist does nothing.
+ * @return  ::CA_STATUS_OK or ::CA_MEMORY_ALLOC_FAILED.
+ */
+CAResult_t CACreateObjectPools();
+
+/**
+ * Destroys the object pools. Objects still in use remain valid and are freed to
+ * the heap. No other thread may allocate or free these objects meanwhile.
+ */
+void CADestroyObjectPools();
+
 /**
  * Creates a new remote endpoint from the input endpoint.
  * @param[in]   endpoint           endpoint information where the data has to be sent.
@@ -72,6 +86,12 @@ CAResult_t CACloneInfo(const CAInfo_t *info, CAInfo_t *clone);
  */
 CARequestInfo_t *CACloneRequestInfo(const CARequestInfo_t *request);
 
+/**
+ * Allocate a zeroed CARequestInfo_t instance.
+ * @return  request info object, to be destroyed with CADestroyRequestInfoInternal.
+ */
+CARequestInfo_t *CACreateRequestInfoObject();
+
 /**
  * Destroy the request information.
  * @param[in]   request           request information that needs to be destroyed.
@@ -85,6 +105,12 @@ void CADestroyRequestInfoInternal(CARequestInfo_t *request);
  */
 CAResponseInfo_t *CACloneResponseInfo(const CAResponseInfo_t *response);
 
+/**
+ * Allocate a zeroed CAResponseInfo_t instance.
+ * @return  response info object, to be destroyed with CADestroyResponseInfoInternal.
+ */
+CAResponseInfo_t *CACreateResponseInfoObject();
+
 /**
  * Destroy the response information.
  * @param[in]   response           response information that needs to be destroyed.
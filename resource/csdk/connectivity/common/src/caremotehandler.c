@@ -27,6 +27,63 @@
 
 #define TAG "CA"
 
+/**
+ * How many freed objects of each kind are kept for reuse. Every message carries
+ * an endpoint and a request or response info, so this covers a burst of messages
+ * in flight between the adapters and the stack.
+ */
+#define CA_MAX_POOLED_OBJECTS 48
+
+// Objects are only pooled between CACreateObjectPools and CADestroyObjectPools;
+// a null pool allocates from and frees to the heap.
+static OICPool *g_endpointPool = NULL;
+static OICPool *g_requestInfoPool = NULL;
+static OICPool *g_responseInfoPool = NULL;
+
+static void *CAAllocObject(OICPool *pool, size_t size)
+{
+    return pool ? OICPoolCalloc(pool) : OICCalloc(1, size);
+}
+
+CAResult_t CACreateObjectPools()
+{
+    if (!g_endpointPool)
+    {
+        g_endpointPool = OICPoolCreate(sizeof(CAEndpoint_t), CA_MAX_POOLED_OBJECTS);
+    }
+    if (!g_requestInfoPool)
+    {
+        g_requestInfoPool = OICPoolCreate(sizeof(CARequestInfo_t), CA_MAX_POOLED_OBJECTS);
+    }
+    if (!g_responseInfoPool)
+    {
+        g_responseInfoPool = OICPoolCreate(sizeof(CAResponseInfo_t), CA_MAX_POOLED_OBJECTS);
+    }
+
+    if (!g_endpointPool || !g_requestInfoPool || !g_responseInfoPool)
+    {
+        OIC_LOG(ERROR, TAG, "object pool creation failed");
+        CADestroyObjectPools();
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    return CA_STATUS_OK;
+}
+
+void CADestroyObjectPools()
+{
+    OICPool *pool = g_endpointPool;
+    g_endpointPool = NULL;
+    OICPoolDestroy(pool);
+
+    pool = g_requestInfoPool;
+    g_requestInfoPool = NULL;
+    OICPoolDestroy(pool);
+
+    pool = g_responseInfoPool;
+    g_responseInfoPool = NULL;
+    OICPoolDestroy(pool);
+}
+
 CAEndpoint_t *CACloneEndpoint(const CAEndpoint_t *rep)
 {
     if (NULL == rep)
@@ -36,7 +93,7 @@ CAEndpoint_t *CACloneEndpoint(const CAEndpoint_t *rep)
     }
 
     // allocate the remote end point structure.
-    CAEndpoint_t *clone = (CAEndpoint_t *)OICMalloc(sizeof (CAEndpoint_t));
+    CAEndpoint_t *clone = (CAEndpoint_t *)CAAllocObject(g_endpointPool, sizeof (CAEndpoint_t));
     if (NULL == clone)
     {
         OIC_LOG(ERROR, TAG, "CACloneRemoteEndpoint Out of memory");
@@ -70,7 +127,7 @@ CARequestInfo_t *CACloneRequestInfo(const CARequestInfo_t *rep)
     }
 
     // allocate the request info structure.
-    CARequestInfo_t *clone = (CARequestInfo_t *) OICMalloc(sizeof(CARequestInfo_t));
+    CARequestInfo_t *clone = CACreateRequestInfoObject();
     if (!clone)
     {
         OIC_LOG(ERROR, TAG, "CACloneRequestInfo Out of memory");
@@ -127,7 +184,7 @@ CAResponseInfo_t *CACloneResponseInfo(const CAResponseInfo_t *rep)
     }
 
     // allocate the response info structure.
-    CAResponseInfo_t *clone = (CAResponseInfo_t *) OICCalloc(1, sizeof(CAResponseInfo_t));
+    CAResponseInfo_t *clone = CACreateResponseInfoObject();
     if (NULL == clone)
     {
         OIC_LOG(ERROR, TAG, "CACloneResponseInfo Out of memory");
@@ -152,7 +209,7 @@ CAEndpoint_t *CACreateEndpointObject(CATransportFlags_t flags,
                                      const char *address,
                                      uint16_t port)
 {
-    CAEndpoint_t *info = (CAEndpoint_t *)OICCalloc(1, sizeof(CAEndpoint_t));
+    CAEndpoint_t *info = (CAEndpoint_t *)CAAllocObject(g_endpointPool, sizeof(CAEndpoint_t));
     if (NULL == info)
     {
         OIC_LOG(ERROR, TAG, "Memory allocation failed !");
@@ -173,7 +230,17 @@ CAEndpoint_t *CACreateEndpointObject(CATransportFlags_t flags,
 
 void CAFreeEndpoint(CAEndpoint_t *rep)
 {
-    OICFree(rep);
+    OICPoolFree(g_endpointPool, rep);
+}
+
+CARequestInfo_t *CACreateRequestInfoObject()
+{
+    return (CARequestInfo_t *)CAAllocObject(g_requestInfoPool, sizeof(CARequestInfo_t));
+}
+
+CAResponseInfo_t *CACreateResponseInfoObject()
+{
+    return (CAResponseInfo_t *)CAAllocObject(g_responseInfoPool, sizeof(CAResponseInfo_t));
 }
 
 static void CADestroyInfoInternal(CAInfo_t *info)
@@ -207,7 +274,7 @@ void CADestroyRequestInfoInternal(CARequestInfo_t *rep)
     }
 
     CADestroyInfoInternal(&rep->info);
-    OICFree(rep);
+    OICPoolFree(g_requestInfoPool, rep);
 }
 
 void CADestroyResponseInfoInternal(CAResponseInfo_t *rep)
@@ -219,7 +286,7 @@ void CADestroyResponseInfoInternal(CAResponseInfo_t *rep)
     }
 
     CADestroyInfoInternal(&rep->info);
-    OICFree(rep);
+    OICPoolFree(g_responseInfoPool, rep);
 }
 
 void CADestroyErrorInfoInternal(CAErrorInfo_t *errorInfo)
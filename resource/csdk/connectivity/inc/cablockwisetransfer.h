@@ -36,6 +36,9 @@
 #include "caprotocolmessage.h"
 #include "camessagehandler.h"
 
+/** size of a block of the given szx, in bytes. **/
+#define BLOCK_SIZE(arg) (1 << ((arg) + 4))
+
 #ifdef __cplusplus
 extern "C"
 {
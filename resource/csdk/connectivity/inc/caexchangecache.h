@@ -0,0 +1,90 @@
+/******************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the cache of the exchanges of received confirmable requests.
+ * A retransmitted request is answered with the response that was sent for the
+ * original one, without passing it to the upper layer again.
+ */
+
+#ifndef CA_EXCHANGECACHE_H_
+#define CA_EXCHANGECACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cacommon.h"
+
+/** EXCHANGE_LIFETIME of CoAP, seconds. **/
+#define CA_EXCHANGE_LIFETIME_SEC            247
+
+/**
+ * seconds a request without response is kept. A duplicate arriving later is passed up
+ * again, as the first one apparently got lost on the way.
+ **/
+#define CA_EXCHANGE_PENDING_SEC             2
+
+/** maximum number of cached exchanges. the oldest one is dropped for a new one. **/
+#define CA_EXCHANGE_CACHE_SIZE              64
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Initializes the exchange cache.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAExchangeCacheInitialize();
+
+/**
+ * Check a received confirmable request against the cache. A new request is recorded.
+ * @param[in]   endpoint        endpoint the request came from.
+ * @param[in]   messageId       message id of the request.
+ * @param[out]  response        copy of the response sent for the original request,
+ *                              NULL if it is not sent yet. must be freed by the caller.
+ * @param[out]  size            size of the response.
+ * @return  true if the request is a duplicate and must not be passed up.
+ */
+bool CAExchangeCacheCheckRequest(const CAEndpoint_t *endpoint, uint16_t messageId,
+                                 void **response, uint32_t *size);
+
+/**
+ * Store a sent response pdu for a recorded request with the same message id.
+ * Other pdus are ignored.
+ * @param[in]   endpoint        endpoint the response is sent to.
+ * @param[in]   pdu             sent pdu binary data.
+ * @param[in]   size            sent pdu binary data size.
+ */
+void CAExchangeCacheStoreResponse(const CAEndpoint_t *endpoint, const void *pdu,
+                                  uint32_t size);
+
+/**
+ * Terminates the exchange cache and frees the cached responses.
+ */
+void CAExchangeCacheTerminate();
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* CA_EXCHANGECACHE_H_ */
@@ -53,6 +53,7 @@ typedef struct
     CAResponseInfo_t *responseInfo;
     CAErrorInfo_t *errorInfo;
     CADataType_t dataType;
+    coap_pdu_t *pdu;    /**< pdu generated by the sender; NULL to generate it from the info */
 } CAData_t;
 
 #ifdef __cplusplus
@@ -71,6 +72,20 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint,
                                const void *sendMsg,
                                CADataType_t dataType);
 
+/**
+ * Generates the PDU of a response with a payload written by the caller and detaches
+ * control from the caller for sending it.
+ * @param[in] endpoint      endpoint information where the data has to be sent.
+ * @param[in] responseInfo  response that needs to be sent; its payload is ignored.
+ * @param[in] writer        callback writing the payload into the PDU.
+ * @param[in] context       context passed to the writer.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ *          ::CA_NOT_SUPPORTED if the response needs more than a single PDU.
+ */
+CAResult_t CADetachSendResponseWithWriter(const CAEndpoint_t *endpoint,
+                                          const CAResponseInfo_t *responseInfo,
+                                          CAPayloadWriter writer, void *context);
+
 /**
  * Setting the request and response callbacks for network packets.
  * @param[in] ReqHandler      callback for receiving the requests.
@@ -92,6 +107,19 @@ CAResult_t CAInitializeMessageHandler();
  */
 void CATerminateMessageHandler();
 
+/**
+ * Allocate a zeroed CAData_t instance. While the message handler is initialized,
+ * freed instances are recycled.
+ * @return  data object, to be freed with ::CAFreeDataObject.
+ */
+CAData_t *CACreateDataObject();
+
+/**
+ * Free a CAData_t instance. The endpoint, infos and pdu it points to are not freed.
+ * @param[in] data    data object allocated by ::CACreateDataObject.
+ */
+void CAFreeDataObject(CAData_t *data);
+
 /**
  * Handler for receiving request and response callback in single thread model.
  */
@@ -110,6 +110,18 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
  */
 CAResult_t CAParseURI(const char *uriInfo, coap_list_t **options);
 
+/**
+ * Adds a payload written by a callback to the pdu, after its options.
+ * @param[in]   pdu                 pdu holding header and options.
+ * @param[in]   maxPayloadSize      largest payload allowed; 0 for the room left in the pdu.
+ * @param[in]   writer              callback writing the payload.
+ * @param[in]   context             context passed to the writer.
+ * @return  ::CA_STATUS_OK, ::CA_MEMORY_ALLOC_FAILED if the payload does not fit,
+ *          or other ERROR CODES returned by the writer.
+ */
+CAResult_t CAAddPayloadWithWriter(coap_pdu_t *pdu, size_t maxPayloadSize,
+                                  CAPayloadWriter writer, void *context);
+
 /**
  * Helper that uses libcoap to parse either the path or the parameters of a URI
  * and populate the supplied options list.
@@ -51,8 +51,6 @@
 #define BLOCK_M_BIT_IDX            3
 #define PORT_LENGTH                2
 
-#define BLOCK_SIZE(arg) (1 << ((arg) + 4))
-
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
@@ -721,7 +719,7 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
             }
             memcpy(responseData.token, pdu->hdr->coap_hdr_udp_t.token, responseData.tokenLength);
 
-            cloneData->responseInfo = (CAResponseInfo_t*) OICCalloc(1, sizeof(CAResponseInfo_t));
+            cloneData->responseInfo = CACreateResponseInfoObject();
             if (!cloneData->responseInfo)
             {
                 OIC_LOG(ERROR, TAG, "out of memory");
@@ -2015,7 +2013,7 @@ CAData_t* CACreateNewDataSet(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint
         }
         memcpy(responseData.token, pdu->hdr->coap_hdr_udp_t.token, responseData.tokenLength);
 
-        responseInfo = (CAResponseInfo_t*) OICCalloc(1, sizeof(CAResponseInfo_t));
+        responseInfo = CACreateResponseInfoObject();
         if (!responseInfo)
         {
             OIC_LOG(ERROR, TAG, "out of memory");
@@ -2035,7 +2033,7 @@ CAData_t* CACreateNewDataSet(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint
         }
         memcpy(requestData.token, pdu->hdr->coap_hdr_udp_t.token, requestData.tokenLength);
 
-        requestInfo = (CARequestInfo_t*) OICCalloc(1, sizeof(CARequestInfo_t));
+        requestInfo = CACreateRequestInfoObject();
         if (!requestInfo)
         {
             OIC_LOG(ERROR, TAG, "out of memory");
@@ -2063,7 +2061,7 @@ CAData_t* CACreateNewDataSet(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint
         CADestroyResponseInfoInternal(resInfo);
     }
 
-    CAData_t *data = (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+    CAData_t *data = CACreateDataObject();
     if (!data)
     {
         OIC_LOG(ERROR, TAG, "out of memory");
@@ -2084,13 +2082,14 @@ CAData_t *CACloneCAData(const CAData_t *data)
 {
     VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
 
-    CAData_t *clone = (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+    CAData_t *clone = CACreateDataObject();
     if (!clone)
     {
         OIC_LOG(ERROR, TAG, "out of memory");
         return NULL;
     }
     *clone = *data;
+    clone->pdu = NULL;
 
     if (data->requestInfo)
     {
@@ -2603,7 +2602,7 @@ void CADestroyDataSet(CAData_t* data)
     CAFreeEndpoint(data->remoteEndpoint);
     CADestroyRequestInfoInternal(data->requestInfo);
     CADestroyResponseInfoInternal(data->responseInfo);
-    OICFree(data);
+    CAFreeDataObject(data);
 }
 
 CABlockDataID_t* CACreateBlockDatablockId(const CAToken_t token, uint8_t tokenLength,
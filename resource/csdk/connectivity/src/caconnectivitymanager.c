@@ -342,6 +342,20 @@ CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *re
     }
 }
 
+CAResult_t CASendResponseWithPayloadWriter(const CAEndpoint_t *object,
+                                           const CAResponseInfo_t *responseInfo,
+                                           CAPayloadWriter writer, void *context)
+{
+    OIC_LOG(DEBUG, TAG, "CASendResponseWithPayloadWriter");
+
+    if (!g_isInitialized)
+    {
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CADetachSendResponseWithWriter(object, responseInfo, writer, context);
+}
+
 CAResult_t CASelectNetwork(CATransportAdapter_t interestedNetwork)
 {
     OIC_LOG_V(DEBUG, TAG, "Selected network : %d", interestedNetwork);
@@ -0,0 +1,272 @@
+/******************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <string.h>
+
+#include "caexchangecache.h"
+#include "caprotocolmessage.h"
+#include "camutex.h"
+#include "oic_malloc.h"
+#include "oic_time.h"
+#include "logger.h"
+
+#define TAG "OIC_CA_EXCHANGE"
+
+/** number of hash buckets, must be a power of two. **/
+#define CA_EXCHANGE_BUCKETS     (CA_EXCHANGE_CACHE_SIZE * 2)
+
+/** end of a bucket chain. **/
+#define CA_EXCHANGE_NONE        (-1)
+
+typedef struct
+{
+    CATransportAdapter_t adapter;       /**< adapter of the requester */
+    uint16_t port;                      /**< port of the requester */
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< address of the requester */
+    uint16_t messageId;                 /**< coap PDU message id of the request */
+    uint64_t expires;                   /**< expiry time. milliseconds */
+    void *pdu;                          /**< sent response, NULL until it is sent */
+    uint32_t size;                      /**< sent response size */
+    int16_t next;                       /**< next entry in the same bucket */
+} CAExchange_t;
+
+/**
+ * Entries form a ring in the order the requests came in; a new request replaces the oldest
+ * entry when the ring is full.
+ */
+static CAExchange_t g_exchanges[CA_EXCHANGE_CACHE_SIZE];
+static int16_t g_buckets[CA_EXCHANGE_BUCKETS];
+static uint16_t g_oldest = 0;
+static uint16_t g_count = 0;
+static ca_mutex g_exchangeMutex = NULL;
+
+static uint32_t CAHashExchange(const CAEndpoint_t *endpoint, uint16_t messageId)
+{
+    // FNV-1a over the address, port and message id
+    uint32_t hash = 2166136261u;
+    for (const char *c = endpoint->addr; *c; c++)
+    {
+        hash = (hash ^ (uint8_t) *c) * 16777619u;
+    }
+    hash = (hash ^ endpoint->port) * 16777619u;
+    hash = (hash ^ messageId) * 16777619u;
+    return hash & (CA_EXCHANGE_BUCKETS - 1);
+}
+
+static bool CAIsSameExchange(const CAExchange_t *exchange, const CAEndpoint_t *endpoint,
+                             uint16_t messageId)
+{
+    return exchange->messageId == messageId && exchange->port == endpoint->port
+           && exchange->adapter == endpoint->adapter
+           && strncmp(exchange->addr, endpoint->addr, sizeof(exchange->addr)) == 0;
+}
+
+static CAExchange_t *CAFindExchange(const CAEndpoint_t *endpoint, uint16_t messageId)
+{
+    int16_t index = g_buckets[CAHashExchange(endpoint, messageId)];
+    while (CA_EXCHANGE_NONE != index)
+    {
+        CAExchange_t *exchange = &g_exchanges[index];
+        if (CAIsSameExchange(exchange, endpoint, messageId))
+        {
+            return exchange;
+        }
+        index = exchange->next;
+    }
+    return NULL;
+}
+
+/**
+ * Remove the oldest entry of the ring.
+ */
+static void CARemoveOldestExchange()
+{
+    CAExchange_t *exchange = &g_exchanges[g_oldest];
+    CAEndpoint_t endpoint = { .adapter = exchange->adapter, .port = exchange->port };
+    memcpy(endpoint.addr, exchange->addr, sizeof(endpoint.addr));
+
+    int16_t *link = &g_buckets[CAHashExchange(&endpoint, exchange->messageId)];
+    while (CA_EXCHANGE_NONE != *link && *link != (int16_t) g_oldest)
+    {
+        link = &g_exchanges[*link].next;
+    }
+    if (CA_EXCHANGE_NONE != *link)
+    {
+        *link = exchange->next;
+    }
+
+    OICFree(exchange->pdu);
+    exchange->pdu = NULL;
+    g_oldest = (g_oldest + 1) % CA_EXCHANGE_CACHE_SIZE;
+    g_count--;
+}
+
+/**
+ * Drop the expired entries from the old end of the ring. Entries expire in about the
+ * order they came in, so the few that expire out of order are left to the ring.
+ */
+static void CARemoveExpiredExchanges(uint64_t now)
+{
+    while (g_count && g_exchanges[g_oldest].expires <= now)
+    {
+        CARemoveOldestExchange();
+    }
+}
+
+CAResult_t CAExchangeCacheInitialize()
+{
+    if (!g_exchangeMutex)
+    {
+        g_exchangeMutex = ca_mutex_new();
+        if (!g_exchangeMutex)
+        {
+            OIC_LOG(ERROR, TAG, "ca_mutex_new has failed");
+            return CA_STATUS_FAILED;
+        }
+    }
+
+    memset(g_exchanges, 0, sizeof(g_exchanges));
+    for (size_t i = 0; i < CA_EXCHANGE_BUCKETS; i++)
+    {
+        g_buckets[i] = CA_EXCHANGE_NONE;
+    }
+    g_oldest = 0;
+    g_count = 0;
+    return CA_STATUS_OK;
+}
+
+bool CAExchangeCacheCheckRequest(const CAEndpoint_t *endpoint, uint16_t messageId,
+                                 void **response, uint32_t *size)
+{
+    if (!endpoint || !response || !size || !g_exchangeMutex)
+    {
+        return false;
+    }
+
+    *response = NULL;
+    *size = 0;
+
+    bool duplicate = false;
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+
+    ca_mutex_lock(g_exchangeMutex);
+    CARemoveExpiredExchanges(now);
+
+    CAExchange_t *exchange = CAFindExchange(endpoint, messageId);
+    if (exchange && exchange->expires > now)
+    {
+        duplicate = true;
+        if (exchange->pdu)
+        {
+            *response = OICMalloc(exchange->size);
+            if (*response)
+            {
+                memcpy(*response, exchange->pdu, exchange->size);
+                *size = exchange->size;
+            }
+        }
+        OIC_LOG_V(DEBUG, TAG, "duplicate request, msgid=%d, %s", messageId,
+                  *response ? "resend response" : "still in progress");
+    }
+    else if (!exchange)
+    {
+        if (CA_EXCHANGE_CACHE_SIZE == g_count)
+        {
+            CARemoveOldestExchange();
+        }
+
+        uint16_t index = (g_oldest + g_count) % CA_EXCHANGE_CACHE_SIZE;
+        exchange = &g_exchanges[index];
+        exchange->adapter = endpoint->adapter;
+        exchange->port = endpoint->port;
+        memcpy(exchange->addr, endpoint->addr, sizeof(exchange->addr));
+        exchange->messageId = messageId;
+        exchange->expires = now + CA_EXCHANGE_PENDING_SEC * MS_PER_SEC;
+        exchange->pdu = NULL;
+        exchange->size = 0;
+
+        int16_t *bucket = &g_buckets[CAHashExchange(endpoint, messageId)];
+        exchange->next = *bucket;
+        *bucket = (int16_t) index;
+        g_count++;
+    }
+    else
+    {
+        // Expired but still in the ring; the request is handled as a new one.
+        OICFree(exchange->pdu);
+        exchange->pdu = NULL;
+        exchange->size = 0;
+        exchange->expires = now + CA_EXCHANGE_PENDING_SEC * MS_PER_SEC;
+    }
+
+    ca_mutex_unlock(g_exchangeMutex);
+    return duplicate;
+}
+
+void CAExchangeCacheStoreResponse(const CAEndpoint_t *endpoint, const void *pdu,
+                                  uint32_t size)
+{
+    if (!endpoint || !pdu || !g_exchangeMutex)
+    {
+        return;
+    }
+
+    CAMessageType_t type = CAGetMessageTypeFromPduBinaryData(pdu, size);
+    if (CA_MSG_ACKNOWLEDGE != type && CA_MSG_RESET != type)
+    {
+        return;
+    }
+    uint16_t messageId = CAGetMessageIdFromPduBinaryData(pdu, size);
+
+    ca_mutex_lock(g_exchangeMutex);
+
+    CAExchange_t *exchange = CAFindExchange(endpoint, messageId);
+    if (exchange && !exchange->pdu)
+    {
+        exchange->pdu = OICMalloc(size);
+        if (exchange->pdu)
+        {
+            memcpy(exchange->pdu, pdu, size);
+            exchange->size = size;
+            exchange->expires = OICGetCurrentTime(TIME_IN_MS)
+                                + CA_EXCHANGE_LIFETIME_SEC * MS_PER_SEC;
+        }
+    }
+
+    ca_mutex_unlock(g_exchangeMutex);
+}
+
+void CAExchangeCacheTerminate()
+{
+    if (!g_exchangeMutex)
+    {
+        return;
+    }
+
+    ca_mutex_lock(g_exchangeMutex);
+    while (g_count)
+    {
+        CARemoveOldestExchange();
+    }
+    ca_mutex_unlock(g_exchangeMutex);
+
+    ca_mutex_free(g_exchangeMutex);
+    g_exchangeMutex = NULL;
+}
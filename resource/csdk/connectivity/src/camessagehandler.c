@@ -44,6 +44,7 @@
 #include "uqueue.h"
 #include "cathreadpool.h" /* for thread pool */
 #include "caqueueingthread.h"
+#include "caexchangecache.h"
 
 #define SINGLE_HANDLE
 #define MAX_THREAD_POOL_SIZE    20
@@ -61,8 +62,13 @@ static CAQueueingThread_t g_receiveThread;
 
 #define TAG "OIC_CA_MSG_HANDLE"
 
+// freed messages kept for reuse, see CACreateDataObject
+#define CA_MAX_POOLED_DATA 48
+
 static CARetransmission_t g_retransmissionContext;
 
+static OICPool *g_dataPool = NULL;
+
 // handler field
 static CARequestCallback g_requestHandler = NULL;
 static CAResponseCallback g_responseHandler = NULL;
@@ -124,7 +130,7 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
 {
     OIC_LOG(DEBUG, TAG, "CAGenerateHandlerData IN");
     CAInfo_t *info = NULL;
-    CAData_t *cadata = (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+    CAData_t *cadata = CACreateDataObject();
     if (!cadata)
     {
         OIC_LOG(ERROR, TAG, "memory allocation failed");
@@ -142,7 +148,7 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
 
     if (CA_RESPONSE_DATA == dataType)
     {
-        CAResponseInfo_t* resInfo = (CAResponseInfo_t*)OICCalloc(1, sizeof(CAResponseInfo_t));
+        CAResponseInfo_t* resInfo = CACreateResponseInfoObject();
         if (!resInfo)
         {
             OIC_LOG(ERROR, TAG, "memory allocation failed");
@@ -167,7 +173,7 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
     }
     else if (CA_REQUEST_DATA == dataType)
     {
-        CARequestInfo_t* reqInfo = (CARequestInfo_t*)OICCalloc(1, sizeof(CARequestInfo_t));
+        CARequestInfo_t* reqInfo = CACreateRequestInfoObject();
         if (!reqInfo)
         {
             OIC_LOG(ERROR, TAG, "memory allocation failed");
@@ -233,7 +239,7 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
     return cadata;
 
 exit:
-    OICFree(cadata);
+    CAFreeDataObject(cadata);
     CAFreeEndpoint(ep);
     return NULL;
 }
@@ -250,7 +256,7 @@ static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uin
         return;
     }
 
-    CAResponseInfo_t* resInfo = (CAResponseInfo_t*)OICCalloc(1, sizeof(CAResponseInfo_t));
+    CAResponseInfo_t* resInfo = CACreateResponseInfoObject();
 
     if (!resInfo)
     {
@@ -273,7 +279,7 @@ static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uin
         return;
     }
 
-    CAData_t *cadata = (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+    CAData_t *cadata = CACreateDataObject();
     if (NULL == cadata)
     {
         OIC_LOG(ERROR, TAG, "memory allocation failed !");
@@ -341,7 +347,12 @@ static void CADestroyData(void *data, uint32_t size)
         CADestroyErrorInfoInternal(cadata->errorInfo);
     }
 
-    OICFree(cadata);
+    if (NULL != cadata->pdu)
+    {
+        coap_delete_pdu(cadata->pdu);
+    }
+
+    CAFreeDataObject(cadata);
     OIC_LOG(DEBUG, TAG, "CADestroyData OUT");
 }
 
@@ -464,6 +475,19 @@ exit:
     return res;
 }
 
+/*
+ * Delete a pdu generated for the data. A pdu generated by the sender is freed along
+ * with the data.
+ */
+static void CADeleteSentPDU(const CAData_t *data, coap_pdu_t *pdu, coap_list_t *options)
+{
+    coap_delete_list(options);
+    if (pdu != data->pdu)
+    {
+        coap_delete_pdu(pdu);
+    }
+}
+
 static CAResult_t CAProcessSendData(const CAData_t *data)
 {
     VERIFY_NON_NULL(data, TAG, "data");
@@ -490,7 +514,17 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
         bool skipRetransmission = false;
 #endif
 
-        if (NULL != data->requestInfo)
+        if (NULL != data->pdu && NULL != data->responseInfo)
+        {
+            OIC_LOG(DEBUG, TAG, "pdu is generated already..");
+
+            info = &data->responseInfo->info;
+#ifdef ROUTING_GATEWAY
+            skipRetransmission = data->responseInfo->info.skipRetransmission;
+#endif
+            pdu = data->pdu;
+        }
+        else if (NULL != data->requestInfo)
         {
             OIC_LOG(DEBUG, TAG, "requestInfo is available..");
 
@@ -522,7 +556,8 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
         if (NULL != pdu)
         {
 #ifdef WITH_BWT
-            if (CAIsSupportedBlockwiseTransfer(data->remoteEndpoint->adapter))
+            if (CAIsSupportedBlockwiseTransfer(data->remoteEndpoint->adapter)
+                && pdu != data->pdu)
             {
                 // Blockwise transfer
                 if (NULL != info)
@@ -534,8 +569,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                     {
                         OIC_LOG(INFO, TAG, "to write block option has failed");
                         CAErrorHandler(data->remoteEndpoint, pdu->hdr, pdu->length, res);
-                        coap_delete_list(options);
-                        coap_delete_pdu(pdu);
+                        CADeleteSentPDU(data, pdu, options);
                         return res;
                     }
                 }
@@ -548,11 +582,22 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
             {
                 OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
                 CAErrorHandler(data->remoteEndpoint, pdu->hdr, pdu->length, res);
-                coap_delete_list(options);
-                coap_delete_pdu(pdu);
+                CADeleteSentPDU(data, pdu, options);
                 return res;
             }
 
+#ifndef SINGLE_THREAD
+            // keep the reply to a CON request for its retransmissions
+            if (NULL != data->responseInfo
+#ifdef WITH_TCP
+                && !CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter)
+#endif
+               )
+            {
+                CAExchangeCacheStoreResponse(data->remoteEndpoint, pdu->hdr, pdu->length);
+            }
+#endif
+
 #ifdef WITH_TCP
             if (CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter))
             {
@@ -571,14 +616,12 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                 {
                     //when retransmission not supported this will return CA_NOT_SUPPORTED, ignore
                     OIC_LOG_V(INFO, TAG, "retransmission is not enabled due to error, res : %d", res);
-                    coap_delete_list(options);
-                    coap_delete_pdu(pdu);
+                    CADeleteSentPDU(data, pdu, options);
                     return res;
                 }
             }
 
-            coap_delete_list(options);
-            coap_delete_pdu(pdu);
+            CADeleteSentPDU(data, pdu, options);
         }
         else
         {
@@ -697,6 +740,51 @@ static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, ui
     return ret;
 }
 
+#ifndef SINGLE_THREAD
+/*
+ * A retransmitted CON request is answered with the reply to the original one, or dropped
+ * while the original is still being handled, so the upper layer sees it only once.
+ */
+static bool CAIsDuplicateRequest(const CAEndpoint_t *endpoint, const void *data,
+                                 uint32_t dataLen)
+{
+#ifdef WITH_TCP
+    if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
+    {
+        return false;
+    }
+#endif
+    if (CA_MSG_CONFIRM != CAGetMessageTypeFromPduBinaryData(data, dataLen))
+    {
+        return false;
+    }
+
+    void *response = NULL;
+    uint32_t responseLen = 0;
+    if (!CAExchangeCacheCheckRequest(endpoint, CAGetMessageIdFromPduBinaryData(data, dataLen),
+                                     &response, &responseLen))
+    {
+        return false;
+    }
+
+    if (response)
+    {
+        OIC_LOG(INFO, TAG, "Duplicate request, resend the response");
+        CAResult_t res = CASendUnicastData(endpoint, response, responseLen);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "resend failed:%d", res);
+        }
+        OICFree(response);
+    }
+    else
+    {
+        OIC_LOG(INFO, TAG, "Duplicate request still in progress, drop it");
+    }
+    return true;
+}
+#endif
+
 static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
                                      const void *data, uint32_t dataLen)
 {
@@ -720,6 +808,13 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     OIC_LOG_V(DEBUG, TAG, "code = %d", code);
     if (CA_GET == code || CA_POST == code || CA_PUT == code || CA_DELETE == code)
     {
+#ifndef SINGLE_THREAD
+        if (CAIsDuplicateRequest(&(sep->endpoint), data, dataLen))
+        {
+            coap_delete_pdu(pdu);
+            return;
+        }
+#endif
         cadata = CAGenerateHandlerData(&(sep->endpoint), &(sep->identity), pdu, CA_REQUEST_DATA);
         if (!cadata)
         {
@@ -853,7 +948,7 @@ static CAData_t* CAPrepareSendData(const CAEndpoint_t *endpoint, const void *sen
 {
     OIC_LOG(DEBUG, TAG, "CAPrepareSendData IN");
 
-    CAData_t *cadata = (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+    CAData_t *cadata = CACreateDataObject();
     if (!cadata)
     {
         OIC_LOG(ERROR, TAG, "memory allocation failed");
@@ -975,6 +1070,124 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     return CA_STATUS_OK;
 }
 
+CAResult_t CADetachSendResponseWithWriter(const CAEndpoint_t *endpoint,
+                                          const CAResponseInfo_t *responseInfo,
+                                          CAPayloadWriter writer, void *context)
+{
+    VERIFY_NON_NULL(endpoint, TAG, "endpoint");
+    VERIFY_NON_NULL(responseInfo, TAG, "responseInfo");
+    VERIFY_NON_NULL(writer, TAG, "writer");
+
+    // multicast, reset and stream messages are generated per adapter or sized to the payload.
+    if (responseInfo->isMulticast || CA_MSG_RESET == responseInfo->info.type)
+    {
+        return CA_NOT_SUPPORTED;
+    }
+#ifdef WITH_TCP
+    if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
+    {
+        return CA_NOT_SUPPORTED;
+    }
+#endif
+
+    if (false == CAIsSelectedNetworkAvailable())
+    {
+        return CA_STATUS_FAILED;
+    }
+
+    size_t maxPayloadSize = 0;
+#ifdef WITH_BWT
+    if (CAIsSupportedBlockwiseTransfer(endpoint->adapter))
+    {
+        // a response of a block-wise transfer in progress carries a block of its payload.
+        CABlockDataID_t *blockDataID = CACreateBlockDatablockId(responseInfo->info.token,
+                                                                responseInfo->info.tokenLength,
+                                                                endpoint->port);
+        if (!blockDataID)
+        {
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        bool inTransfer = (NULL != CAGetBlockDataFromBlockDataList(blockDataID));
+        CADestroyBlockID(blockDataID);
+        if (inTransfer)
+        {
+            return CA_NOT_SUPPORTED;
+        }
+
+        // a larger payload is sent block-wise.
+        maxPayloadSize = BLOCK_SIZE(CA_DEFAULT_BLOCK_SIZE);
+    }
+#endif // WITH_BWT
+
+    // the payload is written into the pdu rather than copied along with the info.
+    CAResponseInfo_t header = *responseInfo;
+    header.info.payload = NULL;
+    header.info.payloadSize = 0;
+
+    CAData_t *data = CAPrepareSendData(endpoint, &header, CA_RESPONSE_DATA);
+    if (!data)
+    {
+        OIC_LOG(ERROR, TAG, "CAPrepareSendData failed");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    CAInfo_t *info = &data->responseInfo->info;
+    coap_list_t *options = NULL;
+    coap_transport_type transport = coap_udp;
+    CAResult_t res = CA_SEND_FAILED;
+
+    coap_pdu_t *pdu = CAGeneratePDU(data->responseInfo->result, info, data->remoteEndpoint,
+                                    &options, &transport);
+    if (!pdu)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to generate unicast PDU");
+        goto exit;
+    }
+    data->pdu = pdu;
+
+#ifdef WITH_BWT
+    if (CAIsSupportedBlockwiseTransfer(endpoint->adapter))
+    {
+        // adds the options only, as there is no payload yet.
+        res = CAAddBlockOption(&data->pdu, info, data->remoteEndpoint, &options);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "to write block option has failed");
+            goto exit;
+        }
+    }
+#endif // WITH_BWT
+
+    res = CAAddPayloadWithWriter(data->pdu, maxPayloadSize, writer, context);
+    if (CA_MEMORY_ALLOC_FAILED == res)
+    {
+        OIC_LOG(DEBUG, TAG, "payload does not fit in the pdu");
+        res = CA_NOT_SUPPORTED;
+        goto exit;
+    }
+    else if (CA_STATUS_OK != res)
+    {
+        OIC_LOG_V(ERROR, TAG, "payload writer failed:%d", res);
+        goto exit;
+    }
+    coap_delete_list(options);
+    options = NULL;
+
+#ifdef SINGLE_THREAD
+    res = CAProcessSendData(data);
+    CADestroyData(data, sizeof(CAData_t));
+    return res;
+#else
+    CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
+    return CA_STATUS_OK;
+#endif // SINGLE_THREAD
+
+exit:
+    coap_delete_list(options);
+    CADestroyData(data, sizeof(CAData_t));
+    return res;
+}
+
 void CASetInterfaceCallbacks(CARequestCallback ReqHandler, CAResponseCallback RespHandler,
                              CAErrorCallback errorHandler)
 {
@@ -988,8 +1201,29 @@ void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler)
     g_nwMonitorHandler = nwMonitorHandler;
 }
 
+CAData_t *CACreateDataObject()
+{
+    return g_dataPool ? (CAData_t *) OICPoolCalloc(g_dataPool)
+                      : (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+}
+
+void CAFreeDataObject(CAData_t *data)
+{
+    OICPoolFree(g_dataPool, data);
+}
+
 CAResult_t CAInitializeMessageHandler()
 {
+    // recycle the objects of every message; without the pools they come from the heap
+    if (!g_dataPool)
+    {
+        g_dataPool = OICPoolCreate(sizeof(CAData_t), CA_MAX_POOLED_DATA);
+    }
+    if (!g_dataPool || CA_STATUS_OK != CACreateObjectPools())
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create object pools.");
+    }
+
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
     CASetErrorHandleCallback(CAErrorHandler);
 
@@ -1091,6 +1325,12 @@ CAResult_t CAInitializeMessageHandler()
         return res;
     }
 
+    // duplicate request detection; without it duplicates are just passed up
+    if (CA_STATUS_OK != CAExchangeCacheInitialize())
+    {
+        OIC_LOG(ERROR, TAG, "Failed to Initialize exchange cache.");
+    }
+
     // initialize interface adapters by controller
     CAInitializeAdapters(g_threadPoolHandle);
 #else
@@ -1168,6 +1408,8 @@ void CATerminateMessageHandler()
 
     // terminate interface adapters by controller
     CATerminateAdapters();
+
+    CAExchangeCacheTerminate();
 #else
     // terminate interface adapters by controller
     CATerminateAdapters();
@@ -1176,6 +1418,12 @@ void CATerminateMessageHandler()
     CARetransmissionStop(&g_retransmissionContext);
     CARetransmissionDestroy(&g_retransmissionContext);
 #endif // SINGLE_THREAD
+
+    // nothing is queued or in flight anymore
+    OICPool *pool = g_dataPool;
+    g_dataPool = NULL;
+    OICPoolDestroy(pool);
+    CADestroyObjectPools();
 }
 
 void CALogPDUInfo(coap_pdu_t *pdu, const CAEndpoint_t *endpoint)
@@ -1281,7 +1529,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
 {
     OIC_LOG(DEBUG, TAG, "CASendErrorInfo IN");
 #ifndef SINGLE_THREAD
-    CAData_t *cadata = (CAData_t *) OICCalloc(1, sizeof(CAData_t));
+    CAData_t *cadata = CACreateDataObject();
     if (!cadata)
     {
         OIC_LOG(ERROR, TAG, "cadata memory allocation failed");
@@ -1292,7 +1540,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     if (!ep)
     {
         OIC_LOG(ERROR, TAG, "endpoint clone failed");
-        OICFree(cadata);
+        CAFreeDataObject(cadata);
         return;
     }
 
@@ -1300,7 +1548,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     if (!errorInfo)
     {
         OIC_LOG(ERROR, TAG, "errorInfo memory allocation failed");
-        OICFree(cadata);
+        CAFreeDataObject(cadata);
         CAFreeEndpoint(ep);
         return;
     }
@@ -1309,7 +1557,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "info clone failed");
-        OICFree(cadata);
+        CAFreeDataObject(cadata);
         OICFree(errorInfo);
         CAFreeEndpoint(ep);
         return;
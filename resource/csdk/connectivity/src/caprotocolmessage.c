@@ -383,6 +383,50 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
     return pdu;
 }
 
+CAResult_t CAAddPayloadWithWriter(coap_pdu_t *pdu, size_t maxPayloadSize,
+                                  CAPayloadWriter writer, void *context)
+{
+    VERIFY_NON_NULL(pdu, TAG, "pdu");
+    VERIFY_NON_NULL(writer, TAG, "writer");
+
+    if (pdu->data)
+    {
+        OIC_LOG(ERROR, TAG, "pdu has a payload already");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    // the payload marker and the payload follow the options
+    if (pdu->length + PAYLOAD_MARKER >= pdu->max_size)
+    {
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    size_t room = pdu->max_size - pdu->length - PAYLOAD_MARKER;
+    if (maxPayloadSize && maxPayloadSize < room)
+    {
+        room = maxPayloadSize;
+    }
+
+    unsigned char *data = (unsigned char *) pdu->hdr + pdu->length + PAYLOAD_MARKER;
+    size_t size = room;
+    CAResult_t res = writer(context, data, &size);
+    if (CA_STATUS_OK != res)
+    {
+        return res;
+    }
+    if (size > room)
+    {
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    if (size > 0)
+    {
+        data[-PAYLOAD_MARKER] = COAP_PAYLOAD_START;
+        pdu->data = data;
+        pdu->length += size + PAYLOAD_MARKER;
+    }
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
 {
     VERIFY_NON_NULL(uriInfo, TAG, "uriInfo");
@@ -671,7 +715,7 @@ uint32_t CAGetOptionCount(coap_opt_iterator_t opt_iter)
             && COAP_OPTION_CONTENT_FORMAT != opt_iter.type
             && COAP_OPTION_ACCEPT != opt_iter.type
             && COAP_OPTION_URI_HOST != opt_iter.type && COAP_OPTION_URI_PORT != opt_iter.type
-            && COAP_OPTION_ETAG != opt_iter.type && COAP_OPTION_MAXAGE != opt_iter.type
+            && COAP_OPTION_MAXAGE != opt_iter.type
             && COAP_OPTION_PROXY_URI != opt_iter.type && COAP_OPTION_PROXY_SCHEME != opt_iter.type)
         {
             count++;
@@ -870,7 +914,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             }
             else if (COAP_OPTION_URI_PORT == opt_iter.type ||
                     COAP_OPTION_URI_HOST == opt_iter.type ||
-                    COAP_OPTION_ETAG == opt_iter.type ||
                     COAP_OPTION_MAXAGE == opt_iter.type ||
                     COAP_OPTION_PROXY_URI == opt_iter.type ||
                     COAP_OPTION_PROXY_SCHEME== opt_iter.type)
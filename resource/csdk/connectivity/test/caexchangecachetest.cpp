@@ -0,0 +1,93 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+#include "caexchangecache.h"
+#include "caprotocolmessage.h"
+#include "oic_malloc.h"
+
+#include <string.h>
+
+class CAExchangeCacheTests : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        CAExchangeCacheInitialize();
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.port = 5683;
+        strcpy(endpoint.addr, "192.168.0.10");
+    }
+
+    virtual void TearDown()
+    {
+        CAExchangeCacheTerminate();
+    }
+
+    CAEndpoint_t endpoint;
+};
+
+// piggybacked 2.05 Content ACK with message id 0x1234 and no token
+static const unsigned char ackPdu[] = { 0x60, 0x45, 0x12, 0x34 };
+
+TEST_F(CAExchangeCacheTests, DuplicateBeforeResponse)
+{
+    uint16_t id = CAGetMessageIdFromPduBinaryData(ackPdu, sizeof(ackPdu));
+    void *response = NULL;
+    uint32_t size = 0;
+
+    EXPECT_FALSE(CAExchangeCacheCheckRequest(&endpoint, id, &response, &size));
+    EXPECT_TRUE(CAExchangeCacheCheckRequest(&endpoint, id, &response, &size));
+    EXPECT_TRUE(NULL == response);
+}
+
+TEST_F(CAExchangeCacheTests, DuplicateGetsCachedResponse)
+{
+    uint16_t id = CAGetMessageIdFromPduBinaryData(ackPdu, sizeof(ackPdu));
+    void *response = NULL;
+    uint32_t size = 0;
+
+    EXPECT_FALSE(CAExchangeCacheCheckRequest(&endpoint, id, &response, &size));
+    CAExchangeCacheStoreResponse(&endpoint, ackPdu, sizeof(ackPdu));
+
+    EXPECT_TRUE(CAExchangeCacheCheckRequest(&endpoint, id, &response, &size));
+    ASSERT_TRUE(NULL != response);
+    EXPECT_EQ(sizeof(ackPdu), size);
+    EXPECT_EQ(0, memcmp(ackPdu, response, sizeof(ackPdu)));
+    OICFree(response);
+
+    // same message id from another endpoint is a new exchange
+    endpoint.port = 5684;
+    EXPECT_FALSE(CAExchangeCacheCheckRequest(&endpoint, id, &response, &size));
+}
+
+TEST_F(CAExchangeCacheTests, OldestExchangeIsReplaced)
+{
+    void *response = NULL;
+    uint32_t size = 0;
+
+    for (uint16_t id = 0; id <= CA_EXCHANGE_CACHE_SIZE; id++)
+    {
+        EXPECT_FALSE(CAExchangeCacheCheckRequest(&endpoint, id, &response, &size));
+    }
+    EXPECT_TRUE(CAExchangeCacheCheckRequest(&endpoint, CA_EXCHANGE_CACHE_SIZE,
+                                            &response, &size));
+    EXPECT_FALSE(CAExchangeCacheCheckRequest(&endpoint, 0, &response, &size));
+}
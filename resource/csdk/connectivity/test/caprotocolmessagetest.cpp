@@ -213,3 +213,60 @@ TEST(CAProtocolMessage, CAGetTokenFromPDU)
 
     EXPECT_EQ(CA_STATUS_OK, CAGetTokenFromPDU(pdu->hdr, &outData, &tempRep));
 }
+
+static CAResult_t writeTestPayload(void *context, uint8_t *buffer, size_t *size)
+{
+    const char *payload = (const char *) context;
+    size_t payloadSize = strlen(payload);
+    if (payloadSize > *size)
+    {
+        *size = payloadSize;
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    memcpy(buffer, payload, payloadSize);
+    *size = payloadSize;
+    return CA_STATUS_OK;
+}
+
+TEST(CAProtocolMessage, CAAddPayloadWithWriter)
+{
+    CAEndpoint_t tempRep;
+    memset(&tempRep, 0, sizeof(CAEndpoint_t));
+    tempRep.flags = CA_DEFAULT_FLAGS;
+    tempRep.adapter = CA_ADAPTER_IP;
+    tempRep.port = 5683;
+
+    coap_list_t *options = NULL;
+    coap_transport_type transport = coap_udp;
+
+    CAInfo_t inData;
+    memset(&inData, 0, sizeof(CAInfo_t));
+    inData.token = (char *) "token";
+    inData.tokenLength = strlen(inData.token);
+    inData.type = CA_MSG_NONCONFIRM;
+
+    coap_pdu_t *pdu = CAGeneratePDU(CA_CONTENT, &inData, &tempRep, &options, &transport);
+    ASSERT_TRUE(NULL != pdu);
+    size_t headerLength = pdu->length;
+
+    // Larger than the allowed payload size; the pdu is left as it is.
+    char payload[] = "payload";
+    EXPECT_EQ(CA_MEMORY_ALLOC_FAILED,
+              CAAddPayloadWithWriter(pdu, strlen(payload) - 1, writeTestPayload, payload));
+    EXPECT_TRUE(NULL == pdu->data);
+    EXPECT_EQ(headerLength, pdu->length);
+
+    EXPECT_EQ(CA_STATUS_OK, CAAddPayloadWithWriter(pdu, 0, writeTestPayload, payload));
+    ASSERT_TRUE(NULL != pdu->data);
+    EXPECT_EQ(headerLength + 1 + strlen(payload), pdu->length);
+    EXPECT_EQ(COAP_PAYLOAD_START, pdu->data[-1]);
+    EXPECT_EQ(0, memcmp(payload, pdu->data, strlen(payload)));
+
+    size_t dataLength = 0;
+    unsigned char *data = NULL;
+    EXPECT_EQ(1, coap_get_data(pdu, &dataLength, &data));
+    EXPECT_EQ(strlen(payload), dataLength);
+
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+}
@@ -0,0 +1,97 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the index from subject UUID and resource href to the ACEs of
+ * the ACL, used by the policy engine to check a request without walking the whole ACL.
+ */
+
+#ifndef IOTVT_SRM_ACLINDEX_H
+#define IOTVT_SRM_ACLINDEX_H
+
+#include "ocstack.h"
+#include "securevirtualresourcetypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Add an ACE to the index. ACEs must be indexed in the order they appear in the ACL,
+ * so an ACE appended to the ACL is indexed after all the ACEs before it.
+ *
+ * @param ace ACE appended to the ACL.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult IndexACE(const OicSecAce_t *ace);
+
+/**
+ * Remove an ACE from the index. Must be called before the ACE is freed and while
+ * it still holds its resource list.
+ *
+ * @param ace ACE removed from the ACL.
+ */
+void UnindexACE(const OicSecAce_t *ace);
+
+/**
+ * Remove one resource href of an ACE from the index, when the resource is removed
+ * from the ACE but the ACE stays in the ACL.
+ *
+ * @param ace ACE the resource is removed from.
+ * @param href href of the removed resource.
+ */
+void UnindexACEResource(const OicSecAce_t *ace, const char *href);
+
+/**
+ * Drop the index and index all the ACEs of an ACL in order.
+ *
+ * @param acl ACL to index, may be NULL.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult RebuildACLIndex(const OicSecAcl_t *acl);
+
+/**
+ * Find the first ACE, in ACL order, whose subject is @p subjectId and which lists
+ * @p resource or the wildcard resource.
+ *
+ * @param subjectId subject of the request.
+ * @param resource href of the requested resource.
+ * @param ace set to the matching ACE, NULL if none.
+ * @param subjectFound set to true if any ACE has @p subjectId as its subject.
+ *
+ * @return false if the index is incomplete and the ACL must be walked instead.
+ */
+bool FindIndexedACE(const OicUuid_t *subjectId, const char *resource,
+                    const OicSecAce_t **ace, bool *subjectFound);
+
+/**
+ * Free the index.
+ */
+void DeleteACLIndex();
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // IOTVT_SRM_ACLINDEX_H
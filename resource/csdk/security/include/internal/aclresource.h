@@ -51,6 +51,20 @@ OCStackResult DeInitACLResource();
  */
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr);
 
+/**
+ * This method is used by PolicyEngine to retrieve the ACE granting a Subject access to
+ * a resource. It looks the ACE up in the ACL index instead of walking the ACL.
+ *
+ * @param subjectId ID of the subject for which ACE is required.
+ * @param resource href of the resource being accessed.
+ * @param subjectFound set to true if the ACL has any ACE for subjectId.
+ *
+ * @return reference to the first @ref OicSecAce_t for subjectId listing resource or the
+ *         wildcard resource, else NULL.
+ */
+const OicSecAce_t* GetACEForResource(const OicUuid_t* subjectId, const char* resource,
+                                     bool* subjectFound);
+
 /**
  * This function converts ACL data into CBOR format.
  *
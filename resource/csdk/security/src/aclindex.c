@@ -0,0 +1,449 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <string.h>
+
+#include "utlist.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "logger.h"
+#include "srmresourcestrings.h"
+#include "aclindex.h"
+
+#define TAG "SRM-ACLINDEX"
+
+/** Number of subject hash buckets; must be a power of two.*/
+#define ACL_INDEX_SUBJECT_BUCKETS (32)
+
+/** Number of href hash buckets of each subject; must be a power of two.*/
+#define ACL_INDEX_HREF_BUCKETS (8)
+
+/** Initial number of ACEs a reference list has room for.*/
+#define ACL_INDEX_INITIAL_CAPACITY (4)
+
+/**
+ * An indexed ACE and its position in the ACL.
+ */
+typedef struct
+{
+    const OicSecAce_t *ace;
+
+    /** Increases along the ACL, so the first match is the one with the lowest order.*/
+    uint32_t order;
+} AclIndexRef;
+
+/**
+ * ACEs in ACL order.
+ */
+typedef struct
+{
+    AclIndexRef *refs;
+    size_t count;
+    size_t capacity;
+} AclIndexRefList;
+
+/**
+ * One exact resource href and the ACEs of a subject listing it.
+ */
+typedef struct AclIndexHref
+{
+    /** Next entry in the same bucket.*/
+    struct AclIndexHref *next;
+
+    /** Resource href, owned by the entry.*/
+    char *href;
+
+    AclIndexRefList aces;
+} AclIndexHref;
+
+/**
+ * One subject and its ACEs, by resource href.
+ */
+typedef struct AclIndexSubject
+{
+    /** Next entry in the same bucket.*/
+    struct AclIndexSubject *next;
+
+    OicUuid_t subjectId;
+
+    /** Number of ACEs with this subject, whatever resources they list.*/
+    size_t aceCount;
+
+    /** ACEs by exact resource href.*/
+    AclIndexHref *hrefs[ACL_INDEX_HREF_BUCKETS];
+
+    /** ACEs listing the wildcard resource.*/
+    AclIndexRefList wildcardHref;
+} AclIndexSubject;
+
+static AclIndexSubject *g_subjects[ACL_INDEX_SUBJECT_BUCKETS];
+
+/** ACEs for the wildcard subject, which every request falls back to.*/
+static AclIndexSubject g_wildcardSubject;
+
+/** Order given to the next indexed ACE.*/
+static uint32_t g_nextOrder = 0;
+
+/** Set when an allocation failed and the index misses an ACE.*/
+static bool g_incomplete = false;
+
+static uint32_t HashBytes(const uint8_t *bytes, size_t length)
+{
+    // djb2
+    uint32_t hash = 5381;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = ((hash << 5) + hash) + bytes[i];
+    }
+    return hash;
+}
+
+static bool IsWildcardSubjectId(const OicUuid_t *subjectId)
+{
+    return 0 == memcmp(subjectId, &WILDCARD_SUBJECT_ID, sizeof(OicUuid_t));
+}
+
+static bool IsWildcardHref(const char *href)
+{
+    return 0 == strcmp(href, WILDCARD_RESOURCE_URI);
+}
+
+static AclIndexSubject **FindSubjectLink(const OicUuid_t *subjectId)
+{
+    AclIndexSubject **link =
+        &g_subjects[HashBytes(subjectId->id, sizeof(subjectId->id)) & (ACL_INDEX_SUBJECT_BUCKETS - 1)];
+    while (*link && memcmp(&(*link)->subjectId, subjectId, sizeof(OicUuid_t)) != 0)
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static AclIndexHref **FindHrefLink(AclIndexSubject *subject, const char *href)
+{
+    AclIndexHref **link = &subject->hrefs[HashBytes((const uint8_t *)href, strlen(href))
+                                          & (ACL_INDEX_HREF_BUCKETS - 1)];
+    while (*link && strcmp((*link)->href, href) != 0)
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static AclIndexSubject *FindSubject(const OicUuid_t *subjectId)
+{
+    return IsWildcardSubjectId(subjectId) ? &g_wildcardSubject : *FindSubjectLink(subjectId);
+}
+
+static bool AddRef(AclIndexRefList *list, const OicSecAce_t *ace, uint32_t order)
+{
+    if (list->count == list->capacity)
+    {
+        size_t capacity = list->capacity ? list->capacity * 2 : ACL_INDEX_INITIAL_CAPACITY;
+        AclIndexRef *refs = (AclIndexRef *)OICRealloc(list->refs, capacity * sizeof(AclIndexRef));
+        if (!refs)
+        {
+            return false;
+        }
+        list->refs = refs;
+        list->capacity = capacity;
+    }
+
+    list->refs[list->count].ace = ace;
+    list->refs[list->count].order = order;
+    list->count++;
+    return true;
+}
+
+static void RemoveRefs(AclIndexRefList *list, const OicSecAce_t *ace)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < list->count; i++)
+    {
+        if (list->refs[i].ace != ace)
+        {
+            list->refs[kept++] = list->refs[i];
+        }
+    }
+    list->count = kept;
+}
+
+static void FreeHref(AclIndexHref *entry)
+{
+    OICFree(entry->href);
+    OICFree(entry->aces.refs);
+    OICFree(entry);
+}
+
+static void ClearSubject(AclIndexSubject *subject)
+{
+    for (size_t i = 0; i < ACL_INDEX_HREF_BUCKETS; i++)
+    {
+        AclIndexHref *entry = subject->hrefs[i];
+        while (entry)
+        {
+            AclIndexHref *next = entry->next;
+            FreeHref(entry);
+            entry = next;
+        }
+        subject->hrefs[i] = NULL;
+    }
+    OICFree(subject->wildcardHref.refs);
+    memset(&subject->wildcardHref, 0, sizeof(subject->wildcardHref));
+    subject->aceCount = 0;
+}
+
+static bool AddHref(AclIndexSubject *subject, const OicSecAce_t *ace, uint32_t order,
+                    const char *href)
+{
+    if (IsWildcardHref(href))
+    {
+        return AddRef(&subject->wildcardHref, ace, order);
+    }
+
+    AclIndexHref **link = FindHrefLink(subject, href);
+    AclIndexHref *entry = *link;
+    if (!entry)
+    {
+        entry = (AclIndexHref *)OICCalloc(1, sizeof(AclIndexHref));
+        if (!entry)
+        {
+            return false;
+        }
+        entry->href = OICStrdup(href);
+        if (!entry->href)
+        {
+            OICFree(entry);
+            return false;
+        }
+        *link = entry;
+    }
+    return AddRef(&entry->aces, ace, order);
+}
+
+static void RemoveHref(AclIndexSubject *subject, const OicSecAce_t *ace, const char *href)
+{
+    if (IsWildcardHref(href))
+    {
+        RemoveRefs(&subject->wildcardHref, ace);
+        return;
+    }
+
+    AclIndexHref **link = FindHrefLink(subject, href);
+    AclIndexHref *entry = *link;
+    if (!entry)
+    {
+        return;
+    }
+
+    RemoveRefs(&entry->aces, ace);
+    if (!entry->aces.count)
+    {
+        *link = entry->next;
+        FreeHref(entry);
+    }
+}
+
+/**
+ * Free a subject entry once no ACE refers to it.
+ */
+static void ReleaseSubject(AclIndexSubject *subject)
+{
+    if (subject->aceCount || subject == &g_wildcardSubject)
+    {
+        return;
+    }
+
+    AclIndexSubject **link = FindSubjectLink(&subject->subjectId);
+    if (*link == subject)
+    {
+        *link = subject->next;
+        ClearSubject(subject);
+        OICFree(subject);
+    }
+}
+
+OCStackResult IndexACE(const OicSecAce_t *ace)
+{
+    if (!ace)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    AclIndexSubject *subject = NULL;
+    if (IsWildcardSubjectId(&ace->subjectuuid))
+    {
+        subject = &g_wildcardSubject;
+    }
+    else
+    {
+        AclIndexSubject **link = FindSubjectLink(&ace->subjectuuid);
+        subject = *link;
+        if (!subject)
+        {
+            subject = (AclIndexSubject *)OICCalloc(1, sizeof(AclIndexSubject));
+            if (!subject)
+            {
+                goto exit;
+            }
+            memcpy(&subject->subjectId, &ace->subjectuuid, sizeof(OicUuid_t));
+            *link = subject;
+        }
+    }
+
+    uint32_t order = g_nextOrder++;
+    subject->aceCount++;
+
+    OicSecRsrc_t *rsrc = NULL;
+    LL_FOREACH(ace->resources, rsrc)
+    {
+        if (rsrc->href && !AddHref(subject, ace, order, rsrc->href))
+        {
+            goto exit;
+        }
+    }
+    return OC_STACK_OK;
+
+exit:
+    OIC_LOG(ERROR, TAG, "Failed to index ACE, falling back to full ACL walks");
+    g_incomplete = true;
+    return OC_STACK_NO_MEMORY;
+}
+
+void UnindexACE(const OicSecAce_t *ace)
+{
+    if (!ace)
+    {
+        return;
+    }
+
+    AclIndexSubject *subject = FindSubject(&ace->subjectuuid);
+    if (!subject)
+    {
+        return;
+    }
+
+    OicSecRsrc_t *rsrc = NULL;
+    LL_FOREACH(ace->resources, rsrc)
+    {
+        if (rsrc->href)
+        {
+            RemoveHref(subject, ace, rsrc->href);
+        }
+    }
+
+    if (subject->aceCount)
+    {
+        subject->aceCount--;
+    }
+    ReleaseSubject(subject);
+}
+
+void UnindexACEResource(const OicSecAce_t *ace, const char *href)
+{
+    if (!ace || !href)
+    {
+        return;
+    }
+
+    AclIndexSubject *subject = FindSubject(&ace->subjectuuid);
+    if (subject)
+    {
+        RemoveHref(subject, ace, href);
+    }
+}
+
+OCStackResult RebuildACLIndex(const OicSecAcl_t *acl)
+{
+    DeleteACLIndex();
+
+    if (!acl)
+    {
+        return OC_STACK_OK;
+    }
+
+    OCStackResult ret = OC_STACK_OK;
+    OicSecAce_t *ace = NULL;
+    LL_FOREACH(acl->aces, ace)
+    {
+        if (OC_STACK_OK != IndexACE(ace))
+        {
+            ret = OC_STACK_NO_MEMORY;
+        }
+    }
+    return ret;
+}
+
+bool FindIndexedACE(const OicUuid_t *subjectId, const char *resource,
+                    const OicSecAce_t **ace, bool *subjectFound)
+{
+    if (!subjectId || !resource || !ace || !subjectFound || g_incomplete)
+    {
+        return false;
+    }
+
+    *ace = NULL;
+    *subjectFound = false;
+
+    AclIndexSubject *subject = FindSubject(subjectId);
+    if (!subject || !subject->aceCount)
+    {
+        return true;
+    }
+    *subjectFound = true;
+
+    // Both lists are in ACL order, so the first match is whichever head comes first.
+    const AclIndexRef *exact = NULL;
+    if (!IsWildcardHref(resource))
+    {
+        AclIndexHref *entry = *FindHrefLink(subject, resource);
+        exact = (entry && entry->aces.count) ? &entry->aces.refs[0] : NULL;
+    }
+    const AclIndexRef *wildcard = subject->wildcardHref.count ? &subject->wildcardHref.refs[0] : NULL;
+
+    if (exact && (!wildcard || exact->order < wildcard->order))
+    {
+        *ace = exact->ace;
+    }
+    else if (wildcard)
+    {
+        *ace = wildcard->ace;
+    }
+    return true;
+}
+
+void DeleteACLIndex()
+{
+    for (size_t i = 0; i < ACL_INDEX_SUBJECT_BUCKETS; i++)
+    {
+        AclIndexSubject *subject = g_subjects[i];
+        while (subject)
+        {
+            AclIndexSubject *next = subject->next;
+            ClearSubject(subject);
+            OICFree(subject);
+            subject = next;
+        }
+        g_subjects[i] = NULL;
+    }
+    ClearSubject(&g_wildcardSubject);
+    g_nextOrder = 0;
+    g_incomplete = false;
+}
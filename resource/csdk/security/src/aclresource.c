@@ -37,6 +37,7 @@
 #include "payload_logging.h"
 #include "srmresourcestrings.h"
 #include "aclresource.h"
+#include "aclindex.h"
 #include "doxmresource.h"
 #include "resourcemanager.h"
 #include "srmutility.h"
@@ -971,6 +972,7 @@ OCStackResult RemoveACE(const OicUuid_t * subject, const char * resource)
         {
             if (memcmp(ace->subjectuuid.id, subject->id, sizeof(subject->id)) == 0)
             {
+                UnindexACE(ace);
                 LL_DELETE(gAcl->aces, ace);
                 FreeACE(ace);
                 deleteFlag = true;
@@ -993,6 +995,7 @@ OCStackResult RemoveACE(const OicUuid_t * subject, const char * resource)
                 {
                     if(strcmp(rsrc->href, resource) == 0)
                     {
+                        UnindexACEResource(ace, rsrc->href);
                         LL_DELETE(ace->resources, rsrc);
                         FreeRsrc(rsrc);
                         deleteFlag = true;
@@ -1003,6 +1006,7 @@ OCStackResult RemoveACE(const OicUuid_t * subject, const char * resource)
                 if(NULL == ace->resources && true == deleteFlag)
                 {
                     //Remove the ACE from ACL
+                    UnindexACE(ace);
                     LL_DELETE(gAcl->aces, ace);
                     FreeACE(ace);
                 }
@@ -1211,6 +1215,7 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
             LL_FOREACH_SAFE(newAcl->aces, newAce, tempAce)
             {
                 LL_APPEND(gAcl->aces, newAce);
+                IndexACE(newAce);
             }
             newAcl->aces = NULL;
 
@@ -1336,6 +1341,7 @@ static OCStackResult CreateACLResource()
 OCStackResult SetDefaultACL(OicSecAcl_t *acl)
 {
     gAcl = acl;
+    RebuildACLIndex(gAcl);
     return OC_STACK_OK;
 }
 
@@ -1547,6 +1553,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NON_NULL(TAG, gAcl, FATAL);
+    RebuildACLIndex(gAcl);
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -1564,6 +1571,7 @@ OCStackResult DeInitACLResource()
     OCStackResult ret =  OCDeleteResource(gAclHandle);
     gAclHandle = NULL;
 
+    DeleteACLIndex();
     if (gAcl)
     {
         DeleteACLList(gAcl);
@@ -1621,6 +1629,60 @@ const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **
     return NULL;
 }
 
+/**
+ * Check whether 'resource' or the wildcard resource is in the passed ACE.
+ */
+static bool IsResourceInAce(const char *resource, const OicSecAce_t *ace)
+{
+    OicSecRsrc_t* rsrc = NULL;
+    LL_FOREACH(ace->resources, rsrc)
+    {
+        if (0 == strcmp(resource, rsrc->href) ||
+            0 == strcmp(WILDCARD_RESOURCE_URI, rsrc->href))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const OicSecAce_t* GetACEForResource(const OicUuid_t* subjectId, const char* resource,
+                                     bool* subjectFound)
+{
+    const OicSecAce_t *found = NULL;
+
+    if (NULL == subjectId || NULL == resource || NULL == subjectFound)
+    {
+        return NULL;
+    }
+    *subjectFound = false;
+
+    if (NULL == gAcl)
+    {
+        return NULL;
+    }
+
+    if (FindIndexedACE(subjectId, resource, &found, subjectFound))
+    {
+        return found;
+    }
+
+    // The index missed an ACE, fall back to walking the ACL.
+    OicSecAce_t *ace = NULL;
+    LL_FOREACH(gAcl->aces, ace)
+    {
+        if (memcmp(&(ace->subjectuuid), subjectId, sizeof(OicUuid_t)) == 0)
+        {
+            *subjectFound = true;
+            if (IsResourceInAce(resource, ace))
+            {
+                return ace;
+            }
+        }
+    }
+    return NULL;
+}
+
 OCStackResult InstallNewACL(const uint8_t *cborPayload, const size_t size)
 {
     OCStackResult ret = OC_STACK_ERROR;
@@ -1632,10 +1694,14 @@ OCStackResult InstallNewACL(const uint8_t *cborPayload, const size_t size)
     {
         // Append the new ACL to existing ACL
         OicSecAce_t* newAce = NULL;
-        LL_FOREACH(newAcl->aces, newAce)
+        OicSecAce_t* tempAce = NULL;
+        LL_FOREACH_SAFE(newAcl->aces, newAce, tempAce)
         {
             LL_APPEND(gAcl->aces, newAce);
+            IndexACE(newAce);
         }
+        newAcl->aces = NULL;
+        DeleteACLList(newAcl);
 
         size_t size = 0;
         uint8_t *payload = NULL;
@@ -1781,6 +1847,7 @@ OCStackResult UpdateDefaultSecProvACE()
                 //If default security resource ACL is detected, delete it.
                 if(NUMBER_OF_SEC_PROV_RSCS == matchedRsrc)
                 {
+                    UnindexACE(ace);
                     LL_DELETE(gAcl->aces, ace);
                     FreeACE(ace);
                     isRemoved = true;
@@ -1800,6 +1867,7 @@ OCStackResult UpdateDefaultSecProvACE()
             if (secDefaultAce)
             {
                 LL_APPEND(gAcl->aces, secDefaultAce);
+                IndexACE(secDefaultAce);
 
                 size_t size = 0;
                 uint8_t *payload = NULL;
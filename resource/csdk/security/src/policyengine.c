@@ -346,37 +346,8 @@ static bool IsAccessWithinValidTime(const OicSecAce_t *ace)
 }
 
 /**
- * Check whether 'resource' is in the passed ACE.
- *
- * @param resource is the resource being searched.
- * @param ace is the ACE to check.
- *
- * @return true if 'resource' found, otherwise false.
- */
- static bool IsResourceInAce(const char *resource, const OicSecAce_t *ace)
-{
-    if (NULL== ace || NULL == resource)
-    {
-        return false;
-    }
-
-    OicSecRsrc_t* rsrc = NULL;
-    LL_FOREACH(ace->resources, rsrc)
-    {
-         if (0 == strcmp(resource, rsrc->href) || // TODO null terms?
-             0 == strcmp(WILDCARD_RESOURCE_URI, rsrc->href))
-         {
-             return true;
-         }
-    }
-    return false;
-}
-
-
-/**
- * Find ACLs containing context->subject.
- * Search each ACL for requested resource.
- * If resource found, check for context->permission and period validity.
+ * Find the first ACE containing context->subject and the requested resource.
+ * If found, check for context->permission and period validity.
  * If the ACL is not found locally and AMACL for the resource is found
  * then sends the request to AMS service for the ACL.
  * Set context->retVal to result from first ACL found which contains
@@ -387,49 +358,42 @@ static void ProcessAccessRequest(PEContext_t *context)
     OIC_LOG(DEBUG, TAG, "Entering ProcessAccessRequest()");
     if (NULL != context)
     {
-        const OicSecAce_t *currentAce = NULL;
-        OicSecAce_t *savePtr = NULL;
+        bool subjectFound = false;
 
         // Start out assuming subject not found.
         context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
 
-        // Loop through all ACLs with a matching Subject searching for the right
-        // ACL for this request.
-        do
+        // Look up the first ACE with a matching Subject that lists this resource.
+        OIC_LOG_V(DEBUG, TAG, "%s: getting ACE..." ,__func__);
+        const OicSecAce_t *currentAce = GetACEForResource(&context->subject, context->resource,
+                                                          &subjectFound);
+        if (subjectFound)
+        {
+            // Subject was found, so err changes to Rsrc not found for now.
+            OIC_LOG_V(DEBUG, TAG, "%s:found ACE matching subject" ,__func__);
+            context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
+        }
+        else
+        {
+            OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
+        }
+
+        if (NULL != currentAce)
         {
-            OIC_LOG_V(DEBUG, TAG, "%s: getting ACE..." ,__func__);
-            currentAce = GetACLResourceData(&context->subject, &savePtr);
+            OIC_LOG_V(INFO, TAG, "%s:found matching resource in ACE" ,__func__);
+            context->matchingAclFound = true;
 
-            if (NULL != currentAce)
+            // Found the resource, so it's down to valid period & permission.
+            context->retVal = ACCESS_DENIED_INVALID_PERIOD;
+            if (IsAccessWithinValidTime(currentAce))
             {
-                // Found the subject, so how about resource?
-                OIC_LOG_V(DEBUG, TAG, "%s:found ACE matching subject" ,__func__);
-
-                // Subject was found, so err changes to Rsrc not found for now.
-                context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
-                OIC_LOG_V(DEBUG, TAG, "%s:Searching for resource..." ,__func__);
-                if (IsResourceInAce(context->resource, currentAce))
+                context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
+                if (IsPermissionAllowingRequest(currentAce->permission, context->permission))
                 {
-                    OIC_LOG_V(INFO, TAG, "%s:found matching resource in ACE" ,__func__);
-                    context->matchingAclFound = true;
-
-                    // Found the resource, so it's down to valid period & permission.
-                    context->retVal = ACCESS_DENIED_INVALID_PERIOD;
-                    if (IsAccessWithinValidTime(currentAce))
-                    {
-                        context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
-                        if (IsPermissionAllowingRequest(currentAce->permission, context->permission))
-                        {
-                            context->retVal = ACCESS_GRANTED;
-                        }
-                    }
+                    context->retVal = ACCESS_GRANTED;
                 }
             }
-            else
-            {
-                OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
-            }
-        } while ((NULL != currentAce) && (false == context->matchingAclFound));
+        }
 
         if (IsAccessGranted(context->retVal))
         {
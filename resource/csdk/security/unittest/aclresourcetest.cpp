@@ -569,3 +569,62 @@ TEST(ACLResourceTest, ACLGetWithQueryTest)
     OICFree(ehReq.query);
     OICFree(payload);
 }
+
+// ACE lookup through the ACL index
+TEST(ACLResourceTest, GetACEForResourceTest)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    OicUuid_t subject = { .id = { 0 } };
+    OicUuid_t otherSubject = { .id = { 0 } };
+    memcpy(subject.id, "2222222222222222", sizeof(subject.id));
+    memcpy(otherSubject.id, "3333333333333333", sizeof(otherSubject.id));
+
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != acl);
+    OicSecAce_t *aces[4] = { NULL };
+    for (int i = 0; i < 4; i++)
+    {
+        aces[i] = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+        ASSERT_TRUE(NULL != aces[i]);
+        memcpy(&aces[i]->subjectuuid, &subject, sizeof(OicUuid_t));
+        aces[i]->permission = PERMISSION_READ;
+        LL_APPEND(acl->aces, aces[i]);
+    }
+    memcpy(&aces[3]->subjectuuid, &WILDCARD_SUBJECT_ID, sizeof(OicUuid_t));
+    EXPECT_TRUE(AddResourceToACE(aces[0], "/a/led", "oic.core", "oic.if.r"));
+    EXPECT_TRUE(AddResourceToACE(aces[1], "*", "oic.core", "oic.if.r"));
+    EXPECT_TRUE(AddResourceToACE(aces[2], "/a/fan", "oic.core", "oic.if.r"));
+    EXPECT_TRUE(AddResourceToACE(aces[3], "/oic/res", "oic.wk.res", "oic.if.ll"));
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+
+    // The first ACE of the subject listing the resource or the wildcard wins.
+    bool subjectFound = false;
+    EXPECT_EQ(aces[0], GetACEForResource(&subject, "/a/led", &subjectFound));
+    EXPECT_TRUE(subjectFound);
+    EXPECT_EQ(aces[1], GetACEForResource(&subject, "/a/fan", &subjectFound));
+    EXPECT_TRUE(subjectFound);
+
+    EXPECT_TRUE(NULL == GetACEForResource(&otherSubject, "/a/led", &subjectFound));
+    EXPECT_FALSE(subjectFound);
+
+    EXPECT_EQ(aces[3], GetACEForResource(&WILDCARD_SUBJECT_ID, "/oic/res", &subjectFound));
+    EXPECT_TRUE(subjectFound);
+    EXPECT_TRUE(NULL == GetACEForResource(&WILDCARD_SUBJECT_ID, "/a/led", &subjectFound));
+    EXPECT_TRUE(subjectFound);
+
+    // Removing ACEs and resources updates the lookup.
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveACE(&subject, "/a/led"));
+    EXPECT_EQ(aces[1], GetACEForResource(&subject, "/a/led", &subjectFound));
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveACE(&subject, "*"));
+    EXPECT_EQ(aces[2], GetACEForResource(&subject, "/a/fan", &subjectFound));
+    EXPECT_TRUE(NULL == GetACEForResource(&subject, "/a/led", &subjectFound));
+    EXPECT_TRUE(subjectFound);
+
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveACE(&subject, NULL));
+    EXPECT_TRUE(NULL == GetACEForResource(&subject, "/a/fan", &subjectFound));
+    EXPECT_FALSE(subjectFound);
+
+    DeInitACLResource();
+}
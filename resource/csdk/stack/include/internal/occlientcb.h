@@ -126,6 +126,9 @@ typedef struct ClientCB {
      * can be explicitly cancelled.*/
     uint32_t TTL;
 
+    /** Deliver response representations to the callback undecoded.*/
+    bool rawPayload;
+
     /** next node in this list.*/
     struct ClientCB    *next;
 } ClientCB;
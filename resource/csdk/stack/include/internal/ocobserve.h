@@ -29,6 +29,8 @@
 #ifndef OC_OBSERVE_H
 #define OC_OBSERVE_H
 
+#include "octimer.h"
+
 /** Sequence number is a 24 bit field, per https://tools.ietf.org/html/draft-ietf-core-observe-16.*/
 #define MAX_SEQUENCE_NUMBER              (0xFFFFFF)
 
@@ -39,6 +41,8 @@
 /** Maximum number of observers to reach for resources with low QOS */
 #define MAX_OBSERVER_NON_COUNT           (3)
 
+struct ObserverGroup;
+
 /**
  * Data structure to hold informations for each registered observer.
  */
@@ -83,6 +87,33 @@ typedef struct ResourceObserver
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
+    /** minimum time (in seconds) between two notifications; 0 if not limited.*/
+    uint32_t pmin;
+
+    /** maximum time (in seconds) without a notification; 0 if not limited.*/
+    uint32_t pmax;
+
+    /** time (in milliseconds) the last notification was sent to this observer.*/
+    uint64_t lastNotifiedTime;
+
+    /** sequence number of the last notification sent to this observer; 0 if none.*/
+    uint32_t sequenceNum;
+
+    /** a change was held back by pmin and is sent when the timer expires.*/
+    bool pendingNotification;
+
+    /** the observer is notified by the current SendAllObserverNotification pass.*/
+    bool notifyNow;
+
+    /** expires when the pmin window of a held back change closes or pmax passes.*/
+    OCTimer timer;
+
+    /** observers of the resource with the same query and accept format.*/
+    struct ObserverGroup *group;
+
+    /** next member of the group, in registration order.*/
+    struct ResourceObserver *nextInGroup;
+
 } ResourceObserver;
 
 #ifdef WITH_PRESENCE
@@ -131,6 +162,19 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         const OCRepPayload *payload, uint32_t maxAge,
         OCQualityOfService qos);
 
+/**
+ * Set the notification rate limit of an observer.
+ *
+ * @param resource        Observed resource.
+ * @param observeId       Observation ID of the observer.
+ * @param pmin            Minimum time in seconds between two notifications; 0 for none.
+ * @param pmax            Maximum time in seconds without a notification; 0 for none.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult SetObserverRateLimit(OCResource *resource, OCObservationId observeId,
+        uint32_t pmin, uint32_t pmax);
+
 /**
  * Delete all observers in the observe list.
  */
@@ -180,6 +224,14 @@ OCStackResult AddObserver (const char         *resUri,
  */
  OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength);
 
+/**
+ * Delete all observers of a resource, e.g. when the resource is deleted.
+ * The observers are removed from the notification deadline queue as well.
+ *
+ * @param resource Observed resource.
+ */
+void DeleteObserversUsingResource(const OCResource *resource);
+
 /**
  * Search the list of observers for the specified token.
  *
@@ -0,0 +1,115 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the arena that a parsed representation payload is allocated from.
+ * The payloads, values, names, strings and arrays of one parse come from a few large
+ * blocks that are released together when the root payload is destroyed.
+ *
+ * A payload of an arena can still be changed with the OCRepPayloadSet* functions; what
+ * they allocate comes from the heap as usual and is freed when the payload is destroyed.
+ * OCRepPayloadClone() copies a payload out of the arena into heap memory, for callers
+ * that keep a part of it beyond the life of the root payload.
+ */
+
+#ifndef OC_PAYLOAD_ARENA_H_
+#define OC_PAYLOAD_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct OCPayloadArenaBlock OCPayloadArenaBlock;
+
+/**
+ * Arena of a parsed payload.
+ */
+typedef struct OCPayloadArena
+{
+    /** Blocks of the arena, the newest first.*/
+    OCPayloadArenaBlock *blocks;
+
+    /** Root payload, whose destruction releases the arena. NULL while parsing.*/
+    OCRepPayload *owner;
+
+    /** Set once the parse is complete; later values are allocated from the heap.*/
+    bool sealed;
+
+    /** Set when a payload of the arena was changed after the parse, so that destroying
+     *  it has to look for heap memory among its values.*/
+    bool mutated;
+} OCPayloadArena;
+
+/**
+ * Create an arena.
+ *
+ * @param sizeHint        Expected number of bytes allocated from the arena.
+ *
+ * @return the arena, or NULL if out of memory.
+ */
+OCPayloadArena *OCPayloadArenaCreate(size_t sizeHint);
+
+/**
+ * Release an arena and everything allocated from it.
+ *
+ * @param arena           Arena to release.
+ */
+void OCPayloadArenaDestroy(OCPayloadArena *arena);
+
+/**
+ * Allocate zeroed memory from an arena.
+ *
+ * @param arena           Arena to allocate from.
+ * @param size            Number of bytes.
+ *
+ * @return the memory, suitably aligned for any payload type, or NULL if out of memory.
+ */
+void *OCPayloadArenaAlloc(OCPayloadArena *arena, size_t size);
+
+/**
+ * Check if memory was allocated from an arena.
+ *
+ * @param arena           Arena to check.
+ * @param ptr             Memory to check.
+ *
+ * @return true if ptr points into the arena.
+ */
+bool OCPayloadArenaContains(const OCPayloadArena *arena, const void *ptr);
+
+/**
+ * Create a representation payload in an arena.
+ *
+ * @param arena           Arena to allocate the payload from, NULL for the heap.
+ *
+ * @return the payload, or NULL if out of memory.
+ */
+OCRepPayload *OCRepPayloadCreateInArena(OCPayloadArena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OC_PAYLOAD_ARENA_H_
@@ -30,8 +30,88 @@ extern "C"
 OC_EXPORT_TEST OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
         const uint8_t* payload, size_t payloadSize);
 
+/**
+ * Parse a payload like OCParsePayload(), allocating a representation payload from an
+ * arena that is released when the root payload is destroyed. Other payload types are
+ * parsed onto the heap.
+ *
+ * @param outPayload    Parsed payload; must be freed with OCPayloadDestroy().
+ * @param type          Type of the payload.
+ * @param payload       Encoded payload.
+ * @param payloadSize   Size of the encoded payload.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT_TEST OCStackResult OCParsePayloadInArena(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize);
+
+/**
+ * Parse a payload like OCParsePayload(), leaving the values of a representation payload
+ * encoded until they are read. The first read indexes the keys of a payload, and each
+ * value is decoded when it is read through the OCRepPayloadGet* functions. All values
+ * are decoded by OCRepPayloadDecodeValues(), and before a payload is changed, cloned or
+ * encoded. Other payload types are parsed right away.
+ *
+ * @param outPayload    Parsed payload; must be freed with OCPayloadDestroy().
+ * @param type          Type of the payload.
+ * @param payload       Encoded payload, copied into the parsed payload.
+ * @param payloadSize   Size of the encoded payload.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure. A malformed value is
+ *         only noticed when it is decoded.
+ */
+OC_EXPORT_TEST OCStackResult OCParsePayloadLazy(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize);
+
+/**
+ * Decode a value of a lazily parsed payload.
+ *
+ * @param payload       Payload with values left encoded.
+ * @param name          Name of the value.
+ *
+ * @return payload holding the decoded value, NULL if there is no such value or it
+ *         cannot be decoded.
+ */
+OCRepPayload* OCRepPayloadLazyDecode(const OCRepPayload* payload, const char* name);
+
+/**
+ * Free the encoded values of a lazily parsed payload.
+ *
+ * @param lazy          Encoded values.
+ */
+void OCRepPayloadLazyDestroy(struct OCRepPayloadLazyValues* lazy);
+
+/**
+ * Encode a payload into a newly allocated buffer of the exact size of the encoding.
+ *
+ * @param payload       Payload to encode.
+ * @param outPayload    Encoded payload; must be freed by the caller.
+ * @param size          Size of the encoded payload.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
 OC_EXPORT_TEST OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
+/**
+ * Encode a payload into a buffer of the caller, e.g. the payload area of a PDU.
+ *
+ * @param payload       Payload to encode.
+ * @param buffer        Buffer receiving the encoded payload.
+ * @param size          In: size of the buffer. Out: size of the encoded payload, or, if the
+ *                      buffer is too small, a larger size to retry with. A payload with
+ *                      nested containers may need more than one retry.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_NO_MEMORY if the buffer is too small,
+ *         some other value upon failure.
+ */
+OC_EXPORT_TEST OCStackResult OCConvertPayloadToBuffer(OCPayload* payload, uint8_t* buffer,
+                                                      size_t* size);
+
+/**
+ * Free the buffer that payloads are encoded into. Called when the stack stops.
+ */
+OC_EXPORT_TEST void OCFreePayloadEncodeBuffer();
+
 #ifdef __cplusplus
 }
 #endif
@@ -240,6 +240,24 @@ typedef struct OCResource {
 
     /** Pointer of ActionSet which to support group action.*/
     OCActionSet *actionsetHead;
+
+    /** How observe notifications of this resource are rendered.*/
+    OCNotificationMode notificationMode;
+
+    /** Entity tag set by the application, used instead of the hash of the representation.*/
+    uint8_t etag[MAX_ETAG_LENGTH];
+
+    /** Length of etag; 0 if the application did not set one.*/
+    uint8_t etagLength;
+
+    /** Deliver request representations to the entity handler undecoded.*/
+    bool rawPayload;
+
+    /** Position in the resource list, increasing with every inserted resource.*/
+    uint32_t listOrder;
+
+    /** Set while the resource is deleted; its observers get their last notification.*/
+    bool deleting;
 } OCResource;
 
 
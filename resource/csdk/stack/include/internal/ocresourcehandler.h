@@ -167,6 +167,26 @@ void DeletePlatformInfo();
  */
 void DeleteDeviceInfo();
 
+/**
+ * Internal API used to mark the cached discovery responses as stale. Called whenever a
+ * resource is created or deleted, or its types, interfaces or properties change.
+ */
+void InvalidateDiscoveryCache();
+
+/**
+ * Internal API used to free the cached discovery responses and reset their statistics.
+ */
+void DeleteDiscoveryCache();
+
+/**
+ * Internal API used to get how many discovery requests were answered from the cache and
+ * how many built a new response since the stack started.
+ *
+ * @param hits      Number of requests answered from the cache; may be NULL.
+ * @param misses    Number of requests that built a new response; may be NULL.
+ */
+void GetDiscoveryCacheStatistics(uint32_t *hits, uint32_t *misses);
+
 /*
  * Prepare payload for resource representation.
  */
@@ -0,0 +1,100 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the index from resource type and interface names to the
+ * resources that carry them, used to answer filtered discovery requests without
+ * walking the whole resource list.
+ */
+
+#ifndef OC_RESOURCEINDEX_H_
+#define OC_RESOURCEINDEX_H_
+
+#include "ocresource.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Add a resource to the resources carrying a resource type.
+ *
+ * @param resource        Resource the type was bound to.
+ * @param typeName        Name of the resource type.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult IndexResourceType(OCResource *resource, const char *typeName);
+
+/**
+ * Add a resource to the resources carrying an interface.
+ *
+ * @param resource        Resource the interface was bound to.
+ * @param interfaceName   Name of the interface.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult IndexResourceInterface(OCResource *resource, const char *interfaceName);
+
+/**
+ * Remove a resource from the index. Must be called while the resource still holds
+ * its resource type and interface lists.
+ *
+ * @param resource        Resource that is deleted.
+ */
+void UnindexResource(OCResource *resource);
+
+/**
+ * Find the resources carrying a resource type, in resource list order.
+ *
+ * @param typeName        Name of the resource type.
+ * @param resources       Set to the array of matching resources, NULL if none. The array
+ *                        is owned by the index and valid until the next index change.
+ * @param count           Set to the number of matching resources.
+ *
+ * @return false if the index is incomplete and the resource list must be walked instead.
+ */
+bool FindIndexedResourcesByType(const char *typeName, OCResource ***resources, size_t *count);
+
+/**
+ * Find the resources carrying an interface, in resource list order.
+ *
+ * @param interfaceName   Name of the interface.
+ * @param resources       Set to the array of matching resources, NULL if none. The array
+ *                        is owned by the index and valid until the next index change.
+ * @param count           Set to the number of matching resources.
+ *
+ * @return false if the index is incomplete and the resource list must be walked instead.
+ */
+bool FindIndexedResourcesByInterface(const char *interfaceName, OCResource ***resources,
+                                     size_t *count);
+
+/**
+ * Free the index.
+ */
+void DeleteResourceIndex();
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OC_RESOURCEINDEX_H_
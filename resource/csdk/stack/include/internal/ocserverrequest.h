@@ -37,6 +37,31 @@
  */
 typedef OCStackResult (* OCEHResponseHandler)(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Additional observer that receives the response rendered for a notification request.
+ * Used to share one encoded payload between observers with the same query and accept format.
+ */
+typedef struct OCNotificationTarget
+{
+    /** Linked list; for multiple targets.*/
+    struct OCNotificationTarget *next;
+
+    /** Remote endpoint address.*/
+    OCDevAddr devAddr;
+
+    /** Quality of service decided for this observer.*/
+    OCQualityOfService qos;
+
+    /** Token of the observe registration.*/
+    char token[CA_MAX_TOKEN_LEN];
+
+    /** Token length of the observe registration.*/
+    uint8_t tokenLength;
+
+    /** Observe sequence number of the notification to this observer.*/
+    uint32_t observationOption;
+} OCNotificationTarget;
+
 /**
  * following structure will be created in occoap and passed up the stack on the server side.
  */
@@ -73,9 +98,12 @@ typedef struct OCServerRequest
     /** Remote endpoint address **/
     OCDevAddr devAddr;
 
-    /** Token for the request.*/
+    /** Token for the request; points to tokenBuffer.*/
     CAToken_t requestToken;
 
+    /** Storage of the token.*/
+    char tokenBuffer[CA_MAX_TOKEN_LEN];
+
     /** token length the request.*/
     uint8_t tokenLength;
 
@@ -94,24 +122,43 @@ typedef struct OCServerRequest
     /** Request to complete.*/
     uint8_t requestComplete;
 
-    /** Linked list; for multiple server request.*/
+    /** Next request in the same token hash bucket, or next free slot of the pool.*/
     struct OCServerRequest * next;
 
+    /** Set while the slot of the pool holds a request.*/
+    uint8_t inUse;
+
+    /** Tells the request from the earlier ones held by the same slot of the pool.*/
+    uint32_t requestId;
+
+    /** Resource the request is dispatched to; cleared when the resource is deleted.*/
+    struct OCResource * resource;
+
+    /** Response that aggregates the responses of a collection; deleted with the request.*/
+    struct OCServerResponse * response;
+
     /** Flag indicating slow response.*/
     uint8_t slowFlag;
 
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
-    /** Payload Size.*/
-    size_t payloadSize;
+    /** Other observers that receive the response to this notification request.*/
+    OCNotificationTarget *notificationTargets;
+
+    /** Encoded response payload, e.g. a cached discovery response; sent instead of
+     *  encoding the payload of the entity handler response.*/
+    const uint8_t *encodedPayload;
 
-    /** payload is retrieved from the payload of the received request PDU.*/
-    uint8_t payload[1];
+    /** Size of encodedPayload.*/
+    size_t encodedPayloadSize;
 
-    // WARNING: Do NOT add attributes after payload as they get overwritten
-    // when payload content gets copied over!
+    /** Payload Size.*/
+    size_t payloadSize;
 
+    /** payload is retrieved from the payload of the received request PDU; owned by
+     *  the request.*/
+    uint8_t *payload;
 } OCServerRequest;
 
 /**
@@ -120,9 +167,6 @@ typedef struct OCServerRequest
  */
 typedef struct OCServerResponse {
 
-    /** Linked list; for multiple server response.*/
-    struct OCServerResponse * next;
-
     /** this is the pointer to server payload data to be transferred.*/
     OCPayload* payload;
 
@@ -158,7 +202,8 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
 OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse);
 
 /**
- * Get a server request from the server request list using the specified token.
+ * Get a server request using the specified token. Requests are hashed by token, so the
+ * lookup does not depend on the number of pending requests.
  *
  * @param token            Token of server request.
  * @param tokenLength      Length of token.
@@ -169,7 +214,8 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse);
 OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tokenLength);
 
 /**
- * Get a server request from the server request list using the specified handle
+ * Get a server request using the specified handle. The handle is checked against the
+ * slots of the request pool, so stale handles of deleted requests are rejected.
  *
  * @param handle    Handle of server request.
  * @return
@@ -178,9 +224,46 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
 OCServerRequest * GetServerRequestUsingHandle (const OCServerRequest * handle);
 
 /**
- * Get a server response from the server response list using the specified handle
+ * Get a server request using the specified handle, provided its slot of the request pool
+ * still holds the request the handle was taken from. An entity handler may answer a
+ * request, and so delete it, before it returns; the slot may hold a newer request then.
  *
- * @param handle    handle of server response.
+ * @param handle    Handle of server request.
+ * @param requestId Id of the request, read before the handle could go stale.
+ * @return
+ *     OCServerRequest*
+ */
+OCServerRequest * GetServerRequestUsingHandleAndId (const OCServerRequest * handle,
+                                                    uint32_t requestId);
+
+/**
+ * Check whether a request carries the given entity tag in one of its ETag options.
+ *
+ * @param request       Server request.
+ * @param etag          Entity tag of the current representation.
+ * @param etagLength    Length of the entity tag.
+ * @return
+ *     true if the client already holds the representation with this tag.
+ */
+bool ServerRequestMatchesETag(const OCServerRequest *request, const uint8_t *etag,
+                              uint8_t etagLength);
+
+/**
+ * Compute the entity tag of a GET response without encoding its payload, so that the
+ * payload can still be written straight into the PDU. A representation is tagged from its
+ * values, a payload the application encoded itself from its bytes.
+ *
+ * @param payload       Payload of the response.
+ * @param etag          Buffer of ::MAX_ETAG_LENGTH bytes receiving the tag.
+ * @return
+ *     Length of the tag, or 0 if the payload has to be encoded to be tagged.
+ */
+uint8_t ComputeRepresentationETag(const OCPayload *payload, uint8_t *etag);
+
+/**
+ * Get the server response aggregated for the request with the specified handle
+ *
+ * @param handle    handle of the server request.
  *
  * @return
  *     OCServerResponse*
@@ -188,7 +271,8 @@ OCServerRequest * GetServerRequestUsingHandle (const OCServerRequest * handle);
 OCServerResponse * GetServerResponseUsingHandle (const OCServerRequest * handle);
 
 /**
- * Add a server request to the server request list
+ * Add a server request. The request is taken from a pool of preallocated slots and takes
+ * over the payload buffer instead of copying it.
  *
  * @param request                               Initialized server request that is created by this function.
  * @param coapID                                ID of CoAP pdu.
@@ -200,7 +284,8 @@ OCServerResponse * GetServerResponseUsingHandle (const OCServerRequest * handle)
  * @param qos                                   Request QOS.
  * @param query                                 Request query.
  * @param rcvdVendorSpecificHeaderOptions       Received vendor specific header options.
- * @param reqJSONPayload                        Request JSON payload.
+ * @param payload                               Request payload allocated with OICMalloc;
+ *                                              owned by the request on success.
  * @param requestToken                          Request token.
  * @param tokenLength                           Request token length.
  * @param resourceUrl                           URL of resource.
@@ -222,6 +307,23 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
         OCPayloadFormat acceptFormat,
         const OCDevAddr *devAddr);
 
+/**
+ * Add an observer to the list of observers that receive the response to a notification request.
+ *
+ * @param request         Notification request.
+ * @param devAddr         Address of the observer.
+ * @param token           Token of the observe registration.
+ * @param tokenLength     Length of token.
+ * @param qos             Quality of service of the notification to this observer.
+ * @param observationOption Observe sequence number of the notification to this observer.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult AddNotificationTarget(OCServerRequest *request, const OCDevAddr *devAddr,
+                                    const CAToken_t token, uint8_t tokenLength,
+                                    OCQualityOfService qos, uint32_t observationOption);
+
 /**
  * Form the OCEntityHandlerRequest struct that is passed to a resource's entity handler
  *
@@ -262,5 +364,17 @@ OCStackResult FormOCEntityHandlerRequest(
  */
 void FindAndDeleteServerRequest(OCServerRequest * serverRequest);
 
+/**
+ * Detach the pending requests from a resource that is deleted.
+ *
+ * @param resource            deleted resource.
+ */
+void ClearServerRequestResource(const struct OCResource * resource);
+
+/**
+ * Delete all server requests and release the request pool.
+ */
+void DeleteServerRequestList();
+
 #endif //OC_SERVER_REQUEST_H
 
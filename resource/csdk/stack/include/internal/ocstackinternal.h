@@ -282,6 +282,13 @@ bool OCResultToSuccess(OCStackResult ocResult);
  */
 CAMessageType_t qualityOfServiceToMessageType(OCQualityOfService qos);
 
+/**
+ * Increment resource sequence number.  Handles rollover.
+ *
+ * @param resPtr Pointer to resource.
+ */
+void incrementSequenceNumber(OCResource * resPtr);
+
 #ifdef WITH_PRESENCE
 /**
  * Enable/disable a resource property.
@@ -0,0 +1,129 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the timer service of the stack. Timers have millisecond resolution,
+ * are kept in a hierarchical timing wheel and fire from OCProcess(). The timer structures
+ * are owned by the caller, so there is no limit on the number of pending timers.
+ * The service is not thread safe; timers must be used from the thread calling OCProcess().
+ */
+
+#ifndef OC_TIMER_H_
+#define OC_TIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Function called when a timer expires.
+ *
+ * @param context         Context given to OCTimerInit().
+ */
+typedef void (*OCTimerCallback)(void *context);
+
+/**
+ * Timer; embed it in the structure the callback works on.
+ * All fields are private to the timer service.
+ */
+typedef struct OCTimer
+{
+    /** Previous timer in the same wheel slot.*/
+    struct OCTimer *prev;
+
+    /** Next timer in the same wheel slot.*/
+    struct OCTimer *next;
+
+    /** Expiry time in milliseconds.*/
+    uint64_t expires;
+
+    /** Function called on expiry.*/
+    OCTimerCallback callback;
+
+    /** Argument of the callback.*/
+    void *context;
+
+    /** Wheel level and slot the timer is linked in.*/
+    uint8_t level;
+    uint8_t slot;
+
+    /** The timer is linked in the wheel.*/
+    bool pending;
+} OCTimer;
+
+/**
+ * Initialize a timer.
+ *
+ * @param timer           Timer.
+ * @param callback        Function called when the timer expires.
+ * @param context         Argument passed to the callback.
+ */
+void OCTimerInit(OCTimer *timer, OCTimerCallback callback, void *context);
+
+/**
+ * Start a timer, or restart it if it is already pending.
+ *
+ * @param timer           Initialized timer.
+ * @param delayMs         Milliseconds until the timer expires.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCTimerStart(OCTimer *timer, uint64_t delayMs);
+
+/**
+ * Stop a timer. Nothing is done if the timer is not pending.
+ *
+ * @param timer           Timer.
+ */
+void OCTimerCancel(OCTimer *timer);
+
+/**
+ * Check whether a timer is pending.
+ *
+ * @param timer           Timer.
+ *
+ * @return true if the timer is started and has not expired yet.
+ */
+bool OCTimerIsPending(const OCTimer *timer);
+
+/**
+ * Fire the expired timers. Called from OCProcess(). A callback may start or cancel any
+ * timer, including the one that fired.
+ */
+void OCTimerProcess();
+
+/**
+ * Get the time until OCTimerProcess() has to run next.
+ *
+ * @return Milliseconds until the next timer may expire, or UINT64_MAX if none is pending.
+ */
+uint64_t OCTimerGetNextTimeout();
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // OC_TIMER_H_
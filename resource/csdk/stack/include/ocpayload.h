@@ -69,6 +69,15 @@ OC_EXPORT size_t calcDimTotal(const size_t dimensions[MAX_REP_ARRAY_DEPTH]);
 
 OC_EXPORT OCRepPayload* OCRepPayloadClone(const OCRepPayload* payload);
 
+/**
+ * Decode the values of a payload received with lazy decoding enabled, see
+ * OCSetLazyPayloadDecoding(). Must be called before walking payload->values directly;
+ * the OCRepPayloadGet* and OCRepPayloadSet* functions work on such a payload as on any.
+ *
+ * @return true if the values list of the payload is complete.
+ */
+OC_EXPORT bool OCRepPayloadDecodeValues(OCRepPayload* payload);
+
 OC_EXPORT void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child);
 
 OC_EXPORT bool OCRepPayloadSetUri(OCRepPayload* payload, const char* uri);
@@ -222,6 +231,10 @@ OC_EXPORT OCDiscoveryPayload* OCDiscoveryPayloadCreate();
 OC_EXPORT OCSecurityPayload* OCSecurityPayloadCreate(const uint8_t* securityData, size_t size);
 OC_EXPORT void OCSecurityPayloadDestroy(OCSecurityPayload* payload);
 
+// Encoded Payload
+OC_EXPORT OCEncodedPayload* OCEncodedPayloadCreate(const uint8_t* data, size_t size);
+OC_EXPORT void OCEncodedPayloadDestroy(OCEncodedPayload* payload);
+
 #ifndef TCP_ADAPTER
 OC_EXPORT void OCDiscoveryPayloadAddResource(OCDiscoveryPayload* payload, const OCResource* res,
                                              uint16_t securePort);
@@ -114,6 +114,29 @@ OCStackResult OCStopMulticastServer();
  */
 OC_EXPORT OCStackResult OCProcess();
 
+/**
+ * This function returns how long the main loop may wait before it has to call OCProcess()
+ * again to fire the stack timers, e.g. scheduled group actions. Incoming messages still
+ * need OCProcess() to be called as before.
+ *
+ * @return Milliseconds until the next timer may expire, 0 if one is due, or UINT32_MAX
+ *         if no timer is pending.
+ */
+OC_EXPORT uint32_t OCGetNextProcessTimeout();
+
+/**
+ * This function makes the client leave the values of received representation payloads
+ * encoded until the application reads them, so that a large representation of which
+ * only a few values are read is not decoded as a whole. The values are read with the
+ * OCRepPayloadGet* functions as before; an application that walks payload->values
+ * directly has to call OCRepPayloadDecodeValues() first. Disabled by default.
+ *
+ * @param enable    true to decode the values of representation payloads on demand.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT OCStackResult OCSetLazyPayloadDecoding(bool enable);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -173,6 +196,31 @@ OC_EXPORT OCStackResult OCCancel(OCDoHandle handle,
                                  OCHeaderOption * options,
                                  uint8_t numOptions);
 
+/**
+ * This function makes the responses to a request carrying a representation reach the
+ * callback as a ::PAYLOAD_TYPE_ENCODED payload holding the received CBOR, for applications
+ * that decode it themselves instead of walking an OCRepPayload. It must be called before
+ * the stack is processed again after @ref OCDoResource, so it covers every response.
+ *
+ * @param handle       Used to identify a specific OCDoResource invocation.
+ * @param raw          true to deliver the representation undecoded.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT OCStackResult OCSetRequestRawPayload(OCDoHandle handle, bool raw);
+
+/**
+ * This function sets how long the stack waits for the response to a request before it
+ * drops the callback, in place of the default ::MAX_CB_TIMEOUT_SECONDS. Observe and
+ * presence requests do not time out and are refused.
+ *
+ * @param handle       Used to identify a specific OCDoResource invocation.
+ * @param timeoutMs    Time from now, in milliseconds, after which the request expires.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT OCStackResult OCSetRequestTimeout(OCDoHandle handle, uint32_t timeoutMs);
+
 /**
  * Register Persistent storage callback.
  * @param   persistentStorageHandler  Pointers to open, read, write, close & unlink handlers.
@@ -489,6 +537,67 @@ OC_EXPORT OCEntityHandler OCGetResourceHandler(OCResourceHandle handle);
  */
 OC_EXPORT OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService qos);
 
+/**
+ * This function sets how observe notifications of the resource are rendered.
+ * With ::OC_NOTIFY_SHARED_PAYLOAD the entity handler is called once per group of observers
+ * that registered with the same query and accept format, so it must not tailor the
+ * representation to the requester of the notification.
+ *
+ * @param handle   Handle of resource.
+ * @param mode     Notification mode. Resources default to ::OC_NOTIFY_PER_OBSERVER.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT OCStackResult OCSetResourceNotificationMode(OCResourceHandle handle,
+                                                      OCNotificationMode mode);
+
+/**
+ * This function sets the entity tag of the current representation of the resource.
+ * A GET request carrying this tag is answered with 2.03 Valid and no payload, without
+ * calling the entity handler. The application must set a new tag whenever the
+ * representation changes. Without a tag, a hash of the representation is used.
+ *
+ * @param handle   Handle of resource.
+ * @param etag     Entity tag, NULL to go back to the hash of the representation.
+ * @param length   Length of the tag, 1 to ::MAX_ETAG_LENGTH bytes.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT OCStackResult OCSetResourceETag(OCResourceHandle handle, const uint8_t *etag,
+                                          uint8_t length);
+
+/**
+ * This function makes requests to the resource that carry a representation reach its
+ * entity handler as a ::PAYLOAD_TYPE_ENCODED payload holding the received CBOR, for
+ * applications that decode it themselves instead of walking an OCRepPayload.
+ *
+ * @param handle   Handle of resource.
+ * @param raw      true to deliver the representation undecoded.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT OCStackResult OCSetResourceRawPayload(OCResourceHandle handle, bool raw);
+
+/**
+ * This function limits the rate of the observe notifications sent to one observer.
+ * Changes notified within pmin seconds of the previous notification are collapsed and the
+ * latest representation is sent once the window has passed. If nothing changed for pmax
+ * seconds, the current representation is sent again. Observers may also request these
+ * limits with the "pmin" and "pmax" query parameters of their observe request.
+ *
+ * @param handle          Handle of resource.
+ * @param observationId   Observation ID of the observer.
+ * @param minPeriod       Minimum period in seconds between two notifications, 0 for none.
+ * @param maxPeriod       Maximum period in seconds without a notification, 0 for none.
+ *                        Must be greater than minPeriod if set.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OC_EXPORT OCStackResult OCSetObserverRateLimit(OCResourceHandle handle,
+                                               OCObservationId observationId,
+                                               uint32_t minPeriod,
+                                               uint32_t maxPeriod);
+
 /**
  * Notify specific observers with updated value of representation.
  * Before this API is invoked by entity handler it has finished processing
@@ -70,6 +70,11 @@
  */
 #define MAX_HEADER_OPTION_DATA_LENGTH (20)
 
+/**
+ *  Maximum Length of the entity tag of a resource representation
+ */
+#define MAX_ETAG_LENGTH (8)
+
 /**
  * Sets the time to live (TTL) for response callback(s).
  * The callback(s) will be up for deletion after such time but are not guaranteed
@@ -80,4 +85,10 @@
  */
 #define MAX_CB_TIMEOUT_SECONDS   (2 * 60 * 60)  // 2 hours = 7200 seconds.
 
+/**
+ * Maximum number of encoded /oic/res responses kept for repeated discovery requests.
+ * Every combination of query filters and transport ports takes one entry.
+ */
+#define MAX_DISCOVERY_CACHE_ENTRIES (8)
+
 #endif //OCSTACK_CONFIG_H_
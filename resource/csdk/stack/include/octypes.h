@@ -158,6 +158,12 @@ extern "C" {
 /** To represent trigger type.*/
 #define OC_RSRVD_TRIGGER                "trg"
 
+/** To represent minimum period (in seconds) between observe notifications.*/
+#define OC_RSRVD_OBSERVE_PMIN           "pmin"
+
+/** To represent maximum period (in seconds) between observe notifications.*/
+#define OC_RSRVD_OBSERVE_PMAX           "pmax"
+
 /** To represent links.*/
 #define OC_RSRVD_LINKS                  "links"
 
@@ -676,6 +682,20 @@ typedef enum
     OC_NA_QOS
 } OCQualityOfService;
 
+/**
+ * How the stack renders observe notifications for a resource.
+ */
+typedef enum
+{
+    /** The entity handler is called and the payload encoded once for every observer.*/
+    OC_NOTIFY_PER_OBSERVER = 0,
+
+    /** The entity handler is called once for every group of observers that registered with
+     *  the same query and accept format. The encoded payload is shared by the group and
+     *  only the token and message type differ between the notifications.*/
+    OC_NOTIFY_SHARED_PAYLOAD
+} OCNotificationMode;
+
 /**
  * Resource Properties.
  * The value of a policy property is defined as bitmap.
@@ -1055,7 +1075,9 @@ typedef enum
     /** The payload is an OCPresencePayload */
     PAYLOAD_TYPE_PRESENCE,
     /** The payload is an OCRDPayload */
-    PAYLOAD_TYPE_RD
+    PAYLOAD_TYPE_RD,
+    /** The payload is an OCEncodedPayload */
+    PAYLOAD_TYPE_ENCODED
 } OCPayloadType;
 
 /**
@@ -1142,6 +1164,18 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+
+    /** Index of values by name, kept by the OCRepPayloadSet* functions. NULL while a
+     *  payload has few values.*/
+    struct OCRepPayloadValueIndex* valueIndex;
+
+    /** Arena the payload was parsed into, see ocpayloadarena.h. NULL for a payload
+     *  allocated from the heap.*/
+    struct OCPayloadArena* arena;
+
+    /** Values still encoded, see OCRepPayloadDecodeValues(). NULL once values is
+     *  complete.*/
+    struct OCRepPayloadLazyValues* lazy;
 } OCRepPayload;
 
 // used inside a discovery payload
@@ -1323,6 +1357,14 @@ typedef struct
     size_t payloadSize;
 } OCSecurityPayload;
 
+/** A representation the application encoded in CBOR itself; it is sent as it is.*/
+typedef struct
+{
+    OCPayload base;
+    uint8_t* data;
+    size_t size;
+} OCEncodedPayload;
+
 #ifdef WITH_PRESENCE
 typedef struct
 {
@@ -77,6 +77,10 @@ INLINE_API void OCPayloadLogRep(LogLevel level, OCRepPayload* payload)
         OCRepPayloadValue* val = rep->values;
 
         OIC_LOG(level, PL_TAG, "\tValues:");
+        if (rep->lazy)
+        {
+            OIC_LOG(level, PL_TAG, "\t\tnot decoded yet");
+        }
 
         while(val)
         {
@@ -310,6 +314,12 @@ INLINE_API void OCPayloadLogSecurity(LogLevel level, OCSecurityPayload* payload)
     OIC_LOG_V(level, PL_TAG, "\tSecurity Data: %s", payload->securityData);
 }
 
+INLINE_API void OCPayloadLogEncoded(LogLevel level, OCEncodedPayload* payload)
+{
+    OIC_LOG(level, PL_TAG, "Payload Type: Encoded");
+    OIC_LOG_BUFFER(level, PL_TAG, payload->data, payload->size);
+}
+
 INLINE_API void OCRDPayloadLog(const LogLevel level, const OCRDPayload *payload)
 {
     if (!payload)
@@ -363,6 +373,9 @@ INLINE_API void OCPayloadLog(LogLevel level, OCPayload* payload)
         case PAYLOAD_TYPE_RD:
             OCRDPayloadLog(level, (OCRDPayload*)payload);
             break;
+        case PAYLOAD_TYPE_ENCODED:
+            OCPayloadLogEncoded(level, (OCEncodedPayload*)payload);
+            break;
         default:
             OIC_LOG_V(level, PL_TAG, "Unknown Payload Type: %d", payload->type);
             break;
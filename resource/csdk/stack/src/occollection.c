@@ -290,6 +290,11 @@ HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
 
     OCResource * collResource = (OCResource *) ehRequest->resource;
 
+    // Every response may complete, and so delete, the request; its slot may be taken by
+    // another request meanwhile, so it is looked up again by its ID before each use.
+    OCServerRequest *request = (OCServerRequest *) ehRequest->requestHandle;
+    uint32_t requestId = request->requestId;
+
     OCRepPayload* payload = OCRepPayloadCreate();
     if (!payload)
     {
@@ -319,6 +324,12 @@ HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
 
             if (tempRsrcResource)
             {
+                if (!GetServerRequestUsingHandleAndId(request, requestId))
+                {
+                    OIC_LOG(INFO, TAG, "The request was answered already");
+                    break;
+                }
+
                 // Note that all entity handlers called through a collection
                 // will get the same pointer to ehRequest, the only difference
                 // is ehRequest->resource
@@ -337,7 +348,10 @@ HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
                 if (ehResult == OC_EH_SLOW)
                 {
                     OIC_LOG(INFO, TAG, "This is a slow resource");
-                    ((OCServerRequest *)ehRequest->requestHandle)->slowFlag = 1;
+                    if (GetServerRequestUsingHandleAndId(request, requestId))
+                    {
+                        request->slowFlag = 1;
+                    }
                     stackRet = EntityHandlerCodeToOCStackCode(ehResult);
                 }
             }
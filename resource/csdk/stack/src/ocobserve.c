@@ -18,6 +18,14 @@
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
+// Defining _POSIX_C_SOURCE macro with 200112L (or greater) as value
+// causes header files to expose definitions
+// corresponding to the POSIX.1-2001 base
+// specification (excluding the XSI extension).
+// For POSIX.1-2001 base specification,
+// Refer http://pubs.opengroup.org/onlinepubs/009695399/
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
 #include <string.h>
 #include "ocstack.h"
 #include "ocstackconfig.h"
@@ -29,6 +37,7 @@
 #include "oic_string.h"
 #include "ocpayload.h"
 #include "ocserverrequest.h"
+#include "oic_time.h"
 #include "logger.h"
 
 #include "utlist.h"
@@ -43,6 +52,270 @@
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
 static struct ResourceObserver * g_serverObsList = NULL;
+
+#define MSECS_PER_SEC (1000)
+
+/** Number of observer group hash buckets; must be a power of two.*/
+#define OBSERVER_GROUP_BUCKETS (64)
+
+/**
+ * Observers of a resource that are served the same notification, i.e. that observe it
+ * with the same query and requested the same payload encoding. Groups are hashed by these
+ * keys and updated as observers register and deregister.
+ */
+typedef struct ObserverGroup
+{
+    /** next group in the same hash bucket.*/
+    struct ObserverGroup *next;
+
+    /** hash of the resource, accept format and query.*/
+    uint32_t hash;
+
+    /** members in registration order; the group is freed with its last member.*/
+    ResourceObserver *members;
+
+    /** SendGroupedObserverNotification pass that notified the group last.*/
+    uint32_t notifyPass;
+} ObserverGroup;
+
+static ObserverGroup * g_obsGroupBuckets[OBSERVER_GROUP_BUCKETS];
+
+/** Number of the last SendGroupedObserverNotification pass.*/
+static uint32_t g_groupNotifyPass = 0;
+
+/**
+ * Check whether two observers are served the same notification, i.e. they observe the same
+ * resource with the same query and requested the same payload encoding.
+ */
+static bool IsSameNotificationGroup(const ResourceObserver *first, const ResourceObserver *second)
+{
+    if (first->resource != second->resource || first->acceptFormat != second->acceptFormat)
+    {
+        return false;
+    }
+    return strcmp(first->query ? first->query : "", second->query ? second->query : "") == 0;
+}
+
+static uint32_t HashNotificationGroup(const ResourceObserver *observer)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    const uint8_t *bytes = (const uint8_t *)&observer->resource;
+    for (size_t i = 0; i < sizeof(observer->resource); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    hash = (hash ^ (uint8_t)observer->acceptFormat) * 16777619u;
+    for (const char *c = observer->query; c && *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Add an observer to the group of the observers it shares notifications with, creating
+ * the group if it is the first member.
+ *
+ * @return ::OC_STACK_OK on success, ::OC_STACK_NO_MEMORY if a group could not be created.
+ */
+static OCStackResult JoinObserverGroup(ResourceObserver *observer)
+{
+    uint32_t hash = HashNotificationGroup(observer);
+    ObserverGroup **bucket = &g_obsGroupBuckets[hash & (OBSERVER_GROUP_BUCKETS - 1)];
+    ObserverGroup *group = *bucket;
+    while (group && !(group->hash == hash && IsSameNotificationGroup(group->members, observer)))
+    {
+        group = group->next;
+    }
+
+    if (!group)
+    {
+        group = (ObserverGroup *) OICCalloc(1, sizeof(ObserverGroup));
+        if (!group)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to allocate observer group");
+            return OC_STACK_NO_MEMORY;
+        }
+        group->hash = hash;
+        group->next = *bucket;
+        *bucket = group;
+    }
+
+    observer->group = group;
+    observer->nextInGroup = NULL;
+    ResourceObserver **link = &group->members;
+    while (*link)
+    {
+        link = &(*link)->nextInGroup;
+    }
+    *link = observer;
+    return OC_STACK_OK;
+}
+
+/**
+ * Remove an observer from its group and free the group when it was the last member.
+ */
+static void LeaveObserverGroup(ResourceObserver *observer)
+{
+    ObserverGroup *group = observer->group;
+    if (!group)
+    {
+        return;
+    }
+
+    ResourceObserver **link = &group->members;
+    while (*link && *link != observer)
+    {
+        link = &(*link)->nextInGroup;
+    }
+    if (*link)
+    {
+        *link = observer->nextInGroup;
+    }
+    observer->group = NULL;
+    observer->nextInGroup = NULL;
+
+    if (!group->members)
+    {
+        ObserverGroup **groupLink =
+            &g_obsGroupBuckets[group->hash & (OBSERVER_GROUP_BUCKETS - 1)];
+        while (*groupLink && *groupLink != group)
+        {
+            groupLink = &(*groupLink)->next;
+        }
+        if (*groupLink)
+        {
+            *groupLink = group->next;
+        }
+        OICFree(group);
+    }
+}
+
+/**
+ * Start the timer of an observer so that it expires at the given time.
+ */
+static void ScheduleObserver(ResourceObserver *observer, uint64_t deadline)
+{
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    if (OCTimerStart(&observer->timer, (deadline > now) ? deadline - now : 0) != OC_STACK_OK)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to schedule observer %u", observer->observeId);
+    }
+}
+
+/**
+ * Record that a notification is sent to an observer now and arm its pmax heartbeat.
+ */
+static void MarkObserverNotified(ResourceObserver *observer, uint64_t now)
+{
+    observer->lastNotifiedTime = now;
+    observer->pendingNotification = false;
+    if (observer->pmax)
+    {
+        ScheduleObserver(observer, now + (uint64_t)observer->pmax * MSECS_PER_SEC);
+    }
+    else
+    {
+        OCTimerCancel(&observer->timer);
+    }
+}
+
+/**
+ * Get the sequence number of the next notification to an observer. That is the sequence
+ * number of the resource, unless the observer already got it, e.g. in a pmax heartbeat.
+ * The numbers an observer sees increase without bumping the number of the resource,
+ * which would show up as a gap to the other observers.
+ */
+static uint32_t NextObserverSequenceNumber(ResourceObserver *observer)
+{
+    uint32_t sequenceNum = observer->resource->sequenceNum;
+    if (observer->sequenceNum && sequenceNum <= observer->sequenceNum)
+    {
+        sequenceNum = observer->sequenceNum + 1;
+        if (sequenceNum == MAX_SEQUENCE_NUMBER)
+        {
+            sequenceNum = OC_OFFSET_SEQUENCE_NUMBER + 1;
+        }
+    }
+    observer->sequenceNum = sequenceNum;
+    return sequenceNum;
+}
+
+/**
+ * Decide whether a change is notified to an observer now or held back by its pmin window.
+ * A held back change is sent when the timer of the observer expires after the window.
+ *
+ * @param observer Observer.
+ * @param now Current time in milliseconds.
+ * @return true if the observer is to be notified now.
+ */
+static bool PrepareObserverNotification(ResourceObserver *observer, uint64_t now)
+{
+    uint64_t windowEnd = observer->lastNotifiedTime + (uint64_t)observer->pmin * MSECS_PER_SEC;
+    if (observer->pmin && observer->lastNotifiedTime && now < windowEnd)
+    {
+        if (!observer->pendingNotification)
+        {
+            OIC_LOG_V(DEBUG, TAG, "Notification to observer %u held back by pmin",
+                      observer->observeId);
+            observer->pendingNotification = true;
+            ScheduleObserver(observer, windowEnd);
+        }
+        return false;
+    }
+
+    MarkObserverNotified(observer, now);
+    return true;
+}
+
+/**
+ * Parse the pmin and pmax parameters of an observe query.
+ * pmax is ignored unless it is greater than pmin.
+ */
+static void ParseObserveRateLimit(const char *query, uint32_t *pmin, uint32_t *pmax)
+{
+    *pmin = 0;
+    *pmax = 0;
+    if (!query || (!strstr(query, OC_RSRVD_OBSERVE_PMIN) && !strstr(query, OC_RSRVD_OBSERVE_PMAX)))
+    {
+        return;
+    }
+
+    char *queryCopy = OICStrdup(query);
+    if (!queryCopy)
+    {
+        return;
+    }
+
+    char *restOfQuery = NULL;
+    char *keyValuePair = strtok_r(queryCopy, OC_QUERY_SEPARATOR, &restOfQuery);
+    while (keyValuePair)
+    {
+        char *value = NULL;
+        char *key = strtok_r(keyValuePair, OC_KEY_VALUE_DELIMITER, &value);
+        if (key && value && *value)
+        {
+            if (strcmp(key, OC_RSRVD_OBSERVE_PMIN) == 0)
+            {
+                *pmin = (uint32_t) strtoul(value, NULL, 10);
+            }
+            else if (strcmp(key, OC_RSRVD_OBSERVE_PMAX) == 0)
+            {
+                *pmax = (uint32_t) strtoul(value, NULL, 10);
+            }
+        }
+        keyValuePair = strtok_r(NULL, OC_QUERY_SEPARATOR, &restOfQuery);
+    }
+    OICFree(queryCopy);
+
+    if (*pmax && *pmax <= *pmin)
+    {
+        OIC_LOG(INFO, TAG, "Ignoring pmax not greater than pmin");
+        *pmax = 0;
+    }
+}
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -96,6 +369,184 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
     return decidedQoS;
 }
 
+/**
+ * Call the entity handler of an observed resource for a notification request.
+ * The entity handler responds through OCDoResponse; the request is deleted if it fails.
+ *
+ * @param resPtr Observed resource.
+ * @param request Notification request.
+ * @return ::OC_STACK_OK if the entity handler request could be formed.
+ */
+static OCStackResult CallNotificationEntityHandler(OCResource *resPtr, OCServerRequest *request)
+{
+    OCEntityHandlerRequest ehRequest = {0};
+    OCEntityHandlerResult ehResult = OC_EH_ERROR;
+
+    OCStackResult result = FormOCEntityHandlerRequest(
+                &ehRequest,
+                (OCRequestHandle) request,
+                request->method,
+                &request->devAddr,
+                (OCResourceHandle) resPtr,
+                request->query,
+                PAYLOAD_TYPE_REPRESENTATION,
+                request->payload,
+                request->payloadSize,
+                request->numRcvdVendorSpecificHeaderOptions,
+                request->rcvdVendorSpecificHeaderOptions,
+                OC_OBSERVE_NO_OPTION,
+                0,
+                request->coapID);
+    if (result == OC_STACK_OK)
+    {
+        ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
+                            resPtr->entityHandlerCallbackParam);
+        if (ehResult == OC_EH_ERROR)
+        {
+            FindAndDeleteServerRequest(request);
+        }
+    }
+    OCPayloadDestroy(ehRequest.payload);
+    return result;
+}
+
+/**
+ * Send a notification of the current representation of the observed resource to one observer.
+ *
+ * @param observer Observer.
+ * @param qos Quality of service of the notification.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendObserverNotification(ResourceObserver *observer, OCQualityOfService qos)
+{
+    OCServerRequest *request = NULL;
+    OCStackResult result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+            0, NextObserverSequenceNumber(observer), qos, observer->query,
+            NULL, NULL,
+            observer->token, observer->tokenLength,
+            observer->resUri, 0, observer->acceptFormat,
+            &observer->devAddr);
+
+    if (request)
+    {
+        request->observeResult = OC_STACK_OK;
+        request->resource = observer->resource;
+        if (result == OC_STACK_OK)
+        {
+            result = CallNotificationEntityHandler(observer->resource, request);
+        }
+    }
+    return result;
+}
+
+/**
+ * Send the notification whose pmin window closed or whose pmax heartbeat expired.
+ *
+ * @param context Observer.
+ */
+static void ObserverTimerExpired(void *context)
+{
+    ResourceObserver *observer = (ResourceObserver *) context;
+    OIC_LOG_V(DEBUG, TAG, "Sending %s notification to observer %u",
+              observer->pendingNotification ? "deferred" : "pmax", observer->observeId);
+
+    // The entity handler may delete the observer, so it is not touched afterwards.
+    MarkObserverNotified(observer, OICGetCurrentTime(TIME_IN_MS));
+    OCQualityOfService qos = DetermineObserverQoS(OC_REST_OBSERVE, observer, OC_NA_QOS);
+    if (SendObserverNotification(observer, qos) != OC_STACK_OK)
+    {
+        OIC_LOG(ERROR, TAG, "Observer notification error");
+    }
+}
+
+/**
+ * Notify all observers of a resource in ::OC_NOTIFY_SHARED_PAYLOAD mode.
+ * The first observer of every group gets its own notification request and the other
+ * members of the group are attached to it as notification targets, so the entity handler
+ * is called and the payload encoded once per group.
+ * Group members are linked in registration order like the observe list, so the members
+ * notified after the first one all follow it in its group.
+ *
+ * @param method RESTful method.
+ * @param resPtr Observed resource.
+ * @param qos Quality of service of resource.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendGroupedObserverNotification(OCMethod method, OCResource *resPtr,
+        OCQualityOfService qos)
+{
+    OCStackResult result = OC_STACK_OK;
+    ResourceObserver *leader = NULL;
+    bool foundObserver = false;
+    bool observeErrorFlag = false;
+    uint32_t pass = ++g_groupNotifyPass;
+
+    LL_FOREACH(g_serverObsList, leader)
+    {
+        if (leader->resource != resPtr)
+        {
+            continue;
+        }
+        foundObserver = true;
+
+        // Skip observers that were already notified as member of an earlier group.
+        if (!leader->notifyNow || leader->group->notifyPass == pass)
+        {
+            continue;
+        }
+        leader->group->notifyPass = pass;
+
+        OCServerRequest *request = NULL;
+        result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                0, NextObserverSequenceNumber(leader), DetermineObserverQoS(method, leader, qos),
+                leader->query, NULL, NULL, leader->token, leader->tokenLength,
+                leader->resUri, 0, leader->acceptFormat, &leader->devAddr);
+
+        if (request)
+        {
+            request->observeResult = OC_STACK_OK;
+            request->resource = resPtr;
+            for (ResourceObserver *member = leader->nextInGroup;
+                 member && result == OC_STACK_OK; member = member->nextInGroup)
+            {
+                if (member->notifyNow)
+                {
+                    result = AddNotificationTarget(request, &member->devAddr, member->token,
+                            member->tokenLength, DetermineObserverQoS(method, member, qos),
+                            NextObserverSequenceNumber(member));
+                }
+            }
+
+            if (result == OC_STACK_OK)
+            {
+                result = CallNotificationEntityHandler(resPtr, request);
+            }
+            else
+            {
+                FindAndDeleteServerRequest(request);
+            }
+        }
+
+        // Since we are in a loop, set an error flag to indicate at least one error occurred.
+        if (result != OC_STACK_OK)
+        {
+            observeErrorFlag = true;
+        }
+    }
+
+    if (!foundObserver)
+    {
+        OIC_LOG(INFO, TAG, "Resource has no observers");
+        result = OC_STACK_NO_OBSERVERS;
+    }
+    else if (observeErrorFlag)
+    {
+        OIC_LOG(ERROR, TAG, "Observer notification error");
+        result = OC_STACK_ERROR;
+    }
+    return result;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -114,10 +565,32 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     ResourceObserver * resourceObserver = g_serverObsList;
     uint8_t numObs = 0;
     OCServerRequest * request = NULL;
-    OCEntityHandlerRequest ehRequest = {0};
-    OCEntityHandlerResult ehResult = OC_EH_ERROR;
     bool observeErrorFlag = false;
 
+#ifdef WITH_PRESENCE
+    if (method != OC_REST_PRESENCE)
+#endif
+    {
+        // Collapse changes into the pending notification of observers inside their pmin window.
+        uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+        LL_FOREACH(g_serverObsList, resourceObserver)
+        {
+            if (resourceObserver->resource == resPtr)
+            {
+                // The observers of a resource that is being deleted are deleted with it,
+                // so its last notification cannot wait for pmin.
+                resourceObserver->notifyNow = resPtr->deleting ||
+                        PrepareObserverNotification(resourceObserver, now);
+            }
+        }
+        resourceObserver = g_serverObsList;
+
+        if (resPtr->notificationMode == OC_NOTIFY_SHARED_PAYLOAD)
+        {
+            return SendGroupedObserverNotification(method, resPtr, qos);
+        }
+    }
+
     // Find clients that are observing this resource
     while (resourceObserver)
     {
@@ -128,46 +601,14 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
             if (method != OC_REST_PRESENCE)
             {
 #endif
-                qos = DetermineObserverQoS(method, resourceObserver, qos);
-
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        &resourceObserver->devAddr);
-
-                if (request)
+                if (resourceObserver->notifyNow)
                 {
-                    request->observeResult = OC_STACK_OK;
-                    if (result == OC_STACK_OK)
-                    {
-                        result = FormOCEntityHandlerRequest(
-                                    &ehRequest,
-                                    (OCRequestHandle) request,
-                                    request->method,
-                                    &request->devAddr,
-                                    (OCResourceHandle) resPtr,
-                                    request->query,
-                                    PAYLOAD_TYPE_REPRESENTATION,
-                                    request->payload,
-                                    request->payloadSize,
-                                    request->numRcvdVendorSpecificHeaderOptions,
-                                    request->rcvdVendorSpecificHeaderOptions,
-                                    OC_OBSERVE_NO_OPTION,
-                                    0,
-                                    request->coapID);
-                        if (result == OC_STACK_OK)
-                        {
-                            ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
-                                                resPtr->entityHandlerCallbackParam);
-                            if (ehResult == OC_EH_ERROR)
-                            {
-                                FindAndDeleteServerRequest(request);
-                            }
-                        }
-                        OCPayloadDestroy(ehRequest.payload);
-                    }
+                    qos = DetermineObserverQoS(method, resourceObserver, qos);
+                    result = SendObserverNotification(resourceObserver, qos);
+                }
+                else
+                {
+                    result = OC_STACK_OK;
                 }
 #ifdef WITH_PRESENCE
             }
@@ -254,19 +695,26 @@ OCStackResult SendListObserverNotification (OCResource * resource,
     bool observeErrorFlag = false;
 
     OIC_LOG(INFO, TAG, "Entering SendListObserverNotification");
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
     while(numIds)
     {
         observer = GetObserverUsingId (*obsIdList);
         if (observer)
         {
             // Found observer - verify if it matches the resource handle
-            if (observer->resource == resource)
+            if (observer->resource == resource &&
+                !resource->deleting && !PrepareObserverNotification(observer, now))
+            {
+                // Counted as notified; the deferred notification renders the
+                // representation the resource has when the pmin window closes.
+                numSentNotification++;
+            }
+            else if (observer->resource == resource)
             {
                 qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
 
-
                 result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resource->sequenceNum, qos, observer->query,
+                        0, NextObserverSequenceNumber(observer), qos, observer->query,
                         NULL, NULL, observer->token, observer->tokenLength,
                         observer->resUri, 0, observer->acceptFormat,
                         &observer->devAddr);
@@ -274,6 +722,7 @@ OCStackResult SendListObserverNotification (OCResource * resource,
                 if (request)
                 {
                     request->observeResult = OC_STACK_OK;
+                    request->resource = resource;
                     if (result == OC_STACK_OK)
                     {
                         OCEntityHandlerResponse ehResponse = {0};
@@ -409,6 +858,20 @@ OCStackResult AddObserver (const char         *resUri,
 
         obsNode->devAddr = *devAddr;
         obsNode->resource = resHandle;
+        OCTimerInit(&obsNode->timer, ObserverTimerExpired, obsNode);
+        if (JoinObserverGroup(obsNode) != OC_STACK_OK)
+        {
+            goto exit;
+        }
+
+        ParseObserveRateLimit(query, &obsNode->pmin, &obsNode->pmax);
+        if (obsNode->pmin || obsNode->pmax)
+        {
+            OIC_LOG_V(INFO, TAG, "Observer %u rate limited, pmin %u pmax %u",
+                      obsId, obsNode->pmin, obsNode->pmax);
+            // The registration response counts as the first notification.
+            MarkObserverNotified(obsNode, OICGetCurrentTime(TIME_IN_MS));
+        }
 
         LL_APPEND (g_serverObsList, obsNode);
 
@@ -420,6 +883,7 @@ exit:
     {
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
+        OICFree(obsNode->token);
         OICFree(obsNode);
     }
     return OC_STACK_NO_MEMORY;
@@ -471,6 +935,20 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
     return NULL;
 }
 
+/**
+ * Unlink an observer from the observe list and its group, stop its timer and free it.
+ */
+static void DeleteObserver(ResourceObserver *observer)
+{
+    LL_DELETE (g_serverObsList, observer);
+    LeaveObserverGroup(observer);
+    OCTimerCancel(&observer->timer);
+    OICFree(observer->resUri);
+    OICFree(observer->query);
+    OICFree(observer->token);
+    OICFree(observer);
+}
+
 OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
 {
     if (!token)
@@ -483,16 +961,26 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
     {
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
-        LL_DELETE (g_serverObsList, obsNode);
-        OICFree(obsNode->resUri);
-        OICFree(obsNode->query);
-        OICFree(obsNode->token);
-        OICFree(obsNode);
+        DeleteObserver(obsNode);
     }
     // it is ok if we did not find the observer...
     return OC_STACK_OK;
 }
 
+void DeleteObserversUsingResource(const OCResource *resource)
+{
+    ResourceObserver *out = NULL;
+    ResourceObserver *tmp = NULL;
+    LL_FOREACH_SAFE (g_serverObsList, out, tmp)
+    {
+        if (out->resource == resource)
+        {
+            OIC_LOG_V(INFO, TAG, "deleting observer id  %u of deleted resource", out->observeId);
+            DeleteObserver(out);
+        }
+    }
+}
+
 void DeleteObserverList()
 {
     ResourceObserver *out = NULL;
@@ -507,6 +995,35 @@ void DeleteObserverList()
     g_serverObsList = NULL;
 }
 
+OCStackResult SetObserverRateLimit(OCResource *resource, OCObservationId observeId,
+        uint32_t pmin, uint32_t pmax)
+{
+    if (!resource || (pmax && pmax <= pmin))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    ResourceObserver *observer = GetObserverUsingId(observeId);
+    if (!observer || observer->resource != resource)
+    {
+        return OC_STACK_NO_OBSERVERS;
+    }
+
+    observer->pmin = pmin;
+    observer->pmax = pmax;
+    if (!observer->pendingNotification)
+    {
+        // Restart the heartbeat from the last notification with the new pmax.
+        MarkObserverNotified(observer, observer->lastNotifiedTime ?
+                observer->lastNotifiedTime : OICGetCurrentTime(TIME_IN_MS));
+    }
+    else
+    {
+        ScheduleObserver(observer, observer->lastNotifiedTime + (uint64_t)pmin * MSECS_PER_SEC);
+    }
+    return OC_STACK_OK;
+}
+
 /*
  * CA layer expects observe registration/de-reg/notiifcations to be passed as a header
  * option, which breaks the protocol abstraction requirement between RI & CA, and
@@ -556,9 +1073,8 @@ CreateObserveHeaderOption (CAHeaderOption_t **caHdrOpt,
  * CA layer passes observe information to the RI layer as a header option, which
  * breaks the protocol abstraction requirement between RI & CA, and has to be fixed
  * in the future. The function below removes the observe header option and processes it.
- * It should be noted that the observe header option is always assumed to be the first
- * option in the list of user defined header options and hence it is deleted from the
- * front of the header options list and the number of options is adjusted accordingly.
+ * Options are ordered by number, so options like ETag may precede the observe header option.
+ * It is deleted from the header options list and the number of options is adjusted accordingly.
  */
 OCStackResult
 GetObserveHeaderOption (uint32_t * observationOption,
@@ -584,7 +1100,7 @@ GetObserveHeaderOption (uint32_t * observationOption,
             *observationOption = options[i].optionData[0];
             for(uint8_t c = i; c < *numOptions-1; c++)
             {
-                options[i] = options[i+1];
+                options[c] = options[c+1];
             }
             (*numOptions)--;
             return OC_STACK_OK;
@@ -29,13 +29,63 @@
 #include "oic_string.h"
 #include "ocstackinternal.h"
 #include "ocresource.h"
+#include "ocpayloadarena.h"
+#include "ocpayloadcbor.h"
 #include "logger.h"
 #include "rdpayload.h"
 
 #define TAG "OIC_RI_PAYLOAD"
+#undef OIC_MALLOC_TAG
+#define OIC_MALLOC_TAG OIC_MEM_TAG_PAYLOAD
 #define CSV_SEPARATOR ','
 
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
+/** Values of a payload are looked up by a linear search up to this number of values.*/
+#define REP_PAYLOAD_INDEX_THRESHOLD (8)
+
+/**
+ * Open addressing hash index of the values of a payload. The values stay in their list,
+ * which keeps the order they were set in; the index only finds them by name.
+ */
+typedef struct OCRepPayloadValueIndex
+{
+    size_t numValues;               /**< values in the list */
+    size_t numSlots;                /**< slots of the table, a power of two */
+    OCRepPayloadValue* tail;        /**< last value of the list */
+    OCRepPayloadValue** slots;      /**< table of values, NULL for an empty slot */
+} OCRepPayloadValueIndex;
+
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val);
+
+/**
+ * Allocate zeroed memory for a payload: from its arena, if it has one, else from the heap.
+ */
+static void* OCRepPayloadAlloc(OCPayloadArena* arena, size_t size)
+{
+    return arena ? OCPayloadArenaAlloc(arena, size) : OICCalloc(1, size);
+}
+
+/**
+ * Free memory of a payload, unless it belongs to the arena of the payload.
+ */
+static void OCRepPayloadFree(const OCPayloadArena* arena, void* ptr)
+{
+    if (!arena || !OCPayloadArenaContains(arena, ptr))
+    {
+        OICFree(ptr);
+    }
+}
+
+/**
+ * Note a change of a payload. Once a payload of an arena is changed, the arena can no
+ * longer be released without looking for heap memory among its values.
+ */
+static void OCRepPayloadChanged(const OCRepPayload* payload)
+{
+    if (payload->arena && payload->arena->sealed)
+    {
+        payload->arena->mutated = true;
+    }
+}
 
 void OCPayloadDestroy(OCPayload* payload)
 {
@@ -67,6 +117,9 @@ void OCPayloadDestroy(OCPayload* payload)
         case PAYLOAD_TYPE_RD:
            OCRDPayloadDestroy((OCRDPayload*)payload);
            break;
+        case PAYLOAD_TYPE_ENCODED:
+            OCEncodedPayloadDestroy((OCEncodedPayload*)payload);
+            break;
         default:
             OIC_LOG_V(ERROR, TAG, "Unsupported payload type in destroy: %d", payload->type);
             OICFree(payload);
@@ -75,7 +128,12 @@ void OCPayloadDestroy(OCPayload* payload)
 }
 OCRepPayload* OCRepPayloadCreate()
 {
-    OCRepPayload* payload = (OCRepPayload*)OICCalloc(1, sizeof(OCRepPayload));
+    return OCRepPayloadCreateInArena(NULL);
+}
+
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena)
+{
+    OCRepPayload* payload = (OCRepPayload*)OCRepPayloadAlloc(arena, sizeof(OCRepPayload));
 
     if (!payload)
     {
@@ -83,6 +141,7 @@ OCRepPayload* OCRepPayloadCreate()
     }
 
     payload->base.type = PAYLOAD_TYPE_REPRESENTATION;
+    payload->arena = arena;
 
     return payload;
 }
@@ -98,11 +157,117 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     {
         parent = parent->next;
     }
+    OCRepPayloadChanged(parent);
 
     parent->next= child;
     child->next = NULL;
 }
 
+static uint32_t OCRepPayloadHashName(const char* name)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Find the slot of a name in the index: the slot holding its value, or the empty slot
+ * where it is to be inserted.
+ */
+static OCRepPayloadValue** OCRepPayloadIndexSlot(const OCRepPayloadValueIndex* index,
+                                                 const char* name)
+{
+    size_t mask = index->numSlots - 1;
+    size_t i = OCRepPayloadHashName(name) & mask;
+    while (index->slots[i] && 0 != strcmp(index->slots[i]->name, name))
+    {
+        i = (i + 1) & mask;
+    }
+    return &index->slots[i];
+}
+
+static void OCRepPayloadIndexDestroy(const OCPayloadArena* arena, OCRepPayloadValueIndex* index)
+{
+    if (index)
+    {
+        OCRepPayloadFree(arena, index->slots);
+        OCRepPayloadFree(arena, index);
+    }
+}
+
+/**
+ * (Re)build the index of a payload with a table sized for its values. On failure the
+ * payload is left without index and searched linearly.
+ */
+static void OCRepPayloadIndexValues(OCRepPayload* payload)
+{
+    size_t numValues = 0;
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next)
+    {
+        numValues++;
+    }
+
+    OCRepPayloadIndexDestroy(payload->arena, payload->valueIndex);
+    payload->valueIndex = NULL;
+    if (numValues <= REP_PAYLOAD_INDEX_THRESHOLD)
+    {
+        return;
+    }
+
+    // Keep the table at most half full.
+    size_t numSlots = REP_PAYLOAD_INDEX_THRESHOLD * 4;
+    while (numSlots < numValues * 2)
+    {
+        numSlots *= 2;
+    }
+
+    OCRepPayloadValueIndex* index = (OCRepPayloadValueIndex*)
+        OCRepPayloadAlloc(payload->arena, sizeof(OCRepPayloadValueIndex));
+    if (!index)
+    {
+        return;
+    }
+    index->slots = (OCRepPayloadValue**)
+        OCRepPayloadAlloc(payload->arena, numSlots * sizeof(OCRepPayloadValue*));
+    if (!index->slots)
+    {
+        OCRepPayloadFree(payload->arena, index);
+        return;
+    }
+    index->numSlots = numSlots;
+
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next)
+    {
+        *OCRepPayloadIndexSlot(index, val->name) = val;
+        index->tail = val;
+    }
+    index->numValues = numValues;
+    payload->valueIndex = index;
+}
+
+/**
+ * Allocate a value along with its name, from the arena while it is being parsed into.
+ */
+static OCRepPayloadValue* OCRepPayloadValueCreate(OCPayloadArena* arena, const char* name,
+                                                  OCRepPayloadPropType type)
+{
+    size_t nameSize = strlen(name) + 1;
+    OCRepPayloadValue* val = (OCRepPayloadValue*)OCRepPayloadAlloc(
+            (arena && !arena->sealed) ? arena : NULL, sizeof(OCRepPayloadValue) + nameSize);
+    if (!val)
+    {
+        return NULL;
+    }
+    val->name = (char*)(val + 1);
+    memcpy(val->name, name, nameSize);
+    val->type = type;
+    return val;
+}
+
 static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
 {
     if (!payload || !name)
@@ -110,6 +275,21 @@ static OCRepPayloadValue* OCRepPayloadFindValue(const OCRepPayload* payload, con
         return NULL;
     }
 
+    if (payload->lazy)
+    {
+        // Only the value asked for is decoded, into a payload of its own.
+        payload = OCRepPayloadLazyDecode(payload, name);
+        if (!payload)
+        {
+            return NULL;
+        }
+    }
+
+    if (payload->valueIndex)
+    {
+        return *OCRepPayloadIndexSlot(payload->valueIndex, name);
+    }
+
     OCRepPayloadValue* val = payload->values;
     while(val)
     {
@@ -212,7 +392,7 @@ exit:
     return;
 }
 
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
     if (!val)
     {
@@ -221,11 +401,11 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
 
     if (val->type == OCREP_PROP_STRING)
     {
-        OICFree(val->str);
+        OCRepPayloadFree(arena, val->str);
     }
     else if (val->type == OCREP_PROP_BYTE_STRING)
     {
-        OICFree(val->ocByteStr.bytes);
+        OCRepPayloadFree(arena, val->ocByteStr.bytes);
     }
     else if (val->type == OCREP_PROP_OBJECT)
     {
@@ -241,28 +421,28 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
             case OCREP_PROP_BOOL:
                 // Since this is a union, iArray will
                 // point to all of the above
-                OICFree(val->arr.iArray);
+                OCRepPayloadFree(arena, val->arr.iArray);
                 break;
             case OCREP_PROP_STRING:
                 for(size_t i = 0; i< dimTotal; ++i)
                 {
-                    OICFree(val->arr.strArray[i]);
+                    OCRepPayloadFree(arena, val->arr.strArray[i]);
                 }
-                OICFree(val->arr.strArray);
+                OCRepPayloadFree(arena, val->arr.strArray);
                 break;
             case OCREP_PROP_BYTE_STRING:
                 for (size_t i = 0; i< dimTotal; ++i)
                 {
-                    OICFree(val->arr.ocByteStrArray[i].bytes);
+                    OCRepPayloadFree(arena, val->arr.ocByteStrArray[i].bytes);
                 }
-                OICFree(val->arr.ocByteStrArray);
+                OCRepPayloadFree(arena, val->arr.ocByteStrArray);
                 break;
             case OCREP_PROP_OBJECT: // This case is the temporary fix for string input
                 for(size_t i = 0; i< dimTotal; ++i)
                 {
                     OCRepPayloadDestroy(val->arr.objArray[i]);
                 }
-                OICFree(val->arr.objArray);
+                OCRepPayloadFree(arena, val->arr.objArray);
                 break;
             case OCREP_PROP_NULL:
             case OCREP_PROP_ARRAY:
@@ -273,17 +453,16 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
     }
 }
 
-static void OCFreeRepPayloadValue(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValue(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
-    if (!val)
+    while (val)
     {
-        return;
+        OCRepPayloadValue* next = val->next;
+        // The name is allocated along with the value.
+        OCFreeRepPayloadValueContents(arena, val);
+        OCRepPayloadFree(arena, val);
+        val = next;
     }
-
-    OICFree(val->name);
-    OCFreeRepPayloadValueContents(val);
-    OCFreeRepPayloadValue(val->next);
-    OICFree(val);
 }
 static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
 {
@@ -292,37 +471,28 @@ static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
         return NULL;
     }
 
-    OCRepPayloadValue *sourceIter = source;
-    OCRepPayloadValue *destIter = (OCRepPayloadValue*) OICCalloc(1, sizeof(OCRepPayloadValue));
-    if (!destIter)
-    {
-        return NULL;
-    }
-
-    OCRepPayloadValue *headOfClone = destIter;
-
-    // Copy payload type and non pointer types in union.
-    *destIter = *sourceIter;
-    destIter->name = OICStrdup (sourceIter->name);
-    OCCopyPropertyValue (destIter, sourceIter);
+    OCRepPayloadValue *headOfClone = NULL;
+    OCRepPayloadValue **destLink = &headOfClone;
 
-    sourceIter = sourceIter->next;
-
-    while (sourceIter)
+    for (OCRepPayloadValue *sourceIter = source; sourceIter; sourceIter = sourceIter->next)
     {
-        destIter->next = (OCRepPayloadValue*) OICCalloc(1, sizeof(OCRepPayloadValue));
-        if (!destIter->next)
+        OCRepPayloadValue *dest = OCRepPayloadValueCreate(NULL, sourceIter->name,
+                                                          sourceIter->type);
+        if (!dest)
         {
-            OCFreeRepPayloadValue (headOfClone);
+            OCFreeRepPayloadValue (NULL, headOfClone);
             return NULL;
         }
 
-        *(destIter->next) = *sourceIter;
-        destIter->next->name = OICStrdup (sourceIter->name);
-        OCCopyPropertyValue (destIter->next, sourceIter);
+        // Copy payload type and non pointer types in union.
+        char *name = dest->name;
+        *dest = *sourceIter;
+        dest->name = name;
+        dest->next = NULL;
+        OCCopyPropertyValue (dest, sourceIter);
 
-        sourceIter = sourceIter->next;
-        destIter = destIter->next;
+        *destLink = dest;
+        destLink = &dest->next;
     }
     return headOfClone;
 }
@@ -330,61 +500,65 @@ static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
 static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, const char* name,
         OCRepPayloadPropType type)
 {
-    if (!payload || !name)
+    if (!payload || !name || !OCRepPayloadDecodeValues(payload))
     {
         return NULL;
     }
 
-    OCRepPayloadValue* val = payload->values;
-    if (val == NULL)
+    OCRepPayloadValueIndex* index = payload->valueIndex;
+    OCRepPayloadValue* val = NULL;
+    OCRepPayloadValue** link = &payload->values;
+    OCRepPayloadValue** slot = NULL;
+    size_t numValues = 0;
+
+    if (index)
     {
-        payload->values = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-        if (!payload->values)
-        {
-            return NULL;
-        }
-        payload->values->name = OICStrdup(name);
-        if (!payload->values->name)
-        {
-            OICFree(payload->values);
-            payload->values = NULL;
-            return NULL;
-        }
-        payload->values->type =type;
-        return payload->values;
+        slot = OCRepPayloadIndexSlot(index, name);
+        val = *slot;
+        link = &index->tail->next;
+        numValues = index->numValues;
     }
-
-    while(val)
+    else
     {
-        if (0 == strcmp(val->name, name))
+        for (val = payload->values; val; val = val->next)
         {
-            OCFreeRepPayloadValueContents(val);
-            val->type = type;
-            return val;
-        }
-        else if (val->next == NULL)
-        {
-            val->next = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-            if (!val->next)
+            if (0 == strcmp(val->name, name))
             {
-                return NULL;
-            }
-            val->next->name = OICStrdup(name);
-            if (!val->next->name)
-            {
-                OICFree(val->next);
-                val->next = NULL;
-                return NULL;
+                break;
             }
-            val->next->type =type;
-            return val->next;
+            link = &val->next;
+            numValues++;
         }
+    }
 
-        val = val->next;
+    OCRepPayloadChanged(payload);
+    if (val)
+    {
+        OCFreeRepPayloadValueContents(payload->arena, val);
+        val->type = type;
+        return val;
     }
 
-    OIC_LOG(ERROR, TAG, "FindAndSetValue reached point after while loop, pointer corruption?");
-    return NULL;
+    // New values go to the end of the list, keeping the order they were set in.
+    val = OCRepPayloadValueCreate(payload->arena, name, type);
+    if (!val)
+    {
+        return NULL;
+    }
+    *link = val;
+    numValues++;
+
+    if (index && (numValues * 2 <= index->numSlots))
+    {
+        *slot = val;
+        index->tail = val;
+        index->numValues = numValues;
+    }
+    else if (index || numValues > REP_PAYLOAD_INDEX_THRESHOLD)
+    {
+        OCRepPayloadIndexValues(payload);
+    }
+    return val;
 }
 
 bool OCRepPayloadAddResourceType(OCRepPayload* payload, const char* resourceType)
@@ -398,6 +572,7 @@ bool OCRepPayloadAddResourceTypeAsOwner(OCRepPayload* payload, char* resourceTyp
     {
         return false;
     }
+    OCRepPayloadChanged(payload);
 
     if (payload->types)
     {
@@ -439,6 +614,7 @@ bool OCRepPayloadAddInterfaceAsOwner(OCRepPayload* payload, char* iface)
     {
         return false;
     }
+    OCRepPayloadChanged(payload);
 
     if (payload->interfaces)
     {
@@ -474,7 +650,8 @@ bool OCRepPayloadSetUri(OCRepPayload* payload, const char*  uri)
     {
         return false;
     }
-    OICFree(payload->uri);
+    OCRepPayloadChanged(payload);
+    OCRepPayloadFree(payload->arena, payload->uri);
     payload->uri = OICStrdup(uri);
     return payload->uri != NULL;
 }
@@ -1343,7 +1520,7 @@ char* OCCreateString(const OCStringLL* ll)
         len += strlen(it->value) + 1;
     }
     len--; // renove trailing separator (just added above)
-    str = (char*) malloc(len + 1);
+    str = (char*) OICMalloc(len + 1);
     if (!str)
         return NULL;
 
@@ -1355,7 +1532,7 @@ char* OCCreateString(const OCStringLL* ll)
         count = snprintf(pos, len + 1, "%s", it->value);
         if (count<sublen)
         {
-            free(str);
+            OICFree(str);
             return NULL;
         }
         len-=sublen;
@@ -1375,7 +1552,8 @@ char* OCCreateString(const OCStringLL* ll)
 
 OCRepPayload* OCRepPayloadClone (const OCRepPayload* payload)
 {
-    if (!payload)
+    // Decoding the values of the payload leaves it the same to its users.
+    if (!payload || !OCRepPayloadDecodeValues((OCRepPayload*)payload))
     {
         return NULL;
     }
@@ -1391,11 +1569,23 @@ OCRepPayload* OCRepPayloadClone (const OCRepPayload* payload)
     clone->types = CloneOCStringLL (payload->types);
     clone->interfaces = CloneOCStringLL (payload->interfaces);
     clone->values = OCRepPayloadValueClone (payload->values);
+    OCRepPayloadIndexValues(clone);
 
     return clone;
 }
 
 
+static void OCFreeRepPayloadStringLL(const OCPayloadArena* arena, OCStringLL* ll)
+{
+    while (ll)
+    {
+        OCStringLL* next = ll->next;
+        OCRepPayloadFree(arena, ll->value);
+        OCRepPayloadFree(arena, ll);
+        ll = next;
+    }
+}
+
 void OCRepPayloadDestroy(OCRepPayload* payload)
 {
     if (!payload)
@@ -1403,12 +1593,32 @@ void OCRepPayloadDestroy(OCRepPayload* payload)
         return;
     }
 
-    OICFree(payload->uri);
-    OCFreeOCStringLL(payload->types);
-    OCFreeOCStringLL(payload->interfaces);
-    OCFreeRepPayloadValue(payload->values);
+    OCPayloadArena* arena = payload->arena;
+    if (arena && !arena->mutated)
+    {
+        // Everything is in the arena; the root payload releases it at once.
+        if (arena->owner == payload)
+        {
+            OCPayloadArenaDestroy(arena);
+        }
+        return;
+    }
+
+    OCRepPayloadFree(arena, payload->uri);
+    OCFreeRepPayloadStringLL(arena, payload->types);
+    OCFreeRepPayloadStringLL(arena, payload->interfaces);
+    OCFreeRepPayloadValue(arena, payload->values);
+    OCRepPayloadIndexDestroy(arena, payload->valueIndex);
+    OCRepPayloadLazyDestroy(payload->lazy);
     OCRepPayloadDestroy(payload->next);
-    OICFree(payload);
+    if (!arena)
+    {
+        OICFree(payload);
+    }
+    else if (arena->owner == payload)
+    {
+        OCPayloadArenaDestroy(arena);
+    }
 }
 
 OCDiscoveryPayload* OCDiscoveryPayloadCreate()
@@ -1458,6 +1668,33 @@ void OCSecurityPayloadDestroy(OCSecurityPayload* payload)
     OICFree(payload);
 }
 
+OCEncodedPayload* OCEncodedPayloadCreate(const uint8_t* data, size_t size)
+{
+    if (!data || !size)
+    {
+        return NULL;
+    }
+
+    // The encoding is kept along with the payload, in one allocation.
+    OCEncodedPayload* payload = (OCEncodedPayload*)OICMalloc(sizeof(OCEncodedPayload) + size);
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    payload->base.type = PAYLOAD_TYPE_ENCODED;
+    payload->data = (uint8_t*)(payload + 1);
+    memcpy(payload->data, data, size);
+    payload->size = size;
+
+    return payload;
+}
+
+void OCEncodedPayloadDestroy(OCEncodedPayload* payload)
+{
+    OICFree(payload);
+}
+
 size_t OCDiscoveryPayloadGetResourceCount(OCDiscoveryPayload* payload)
 {
     size_t i = 0;
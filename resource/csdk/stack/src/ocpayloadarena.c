@@ -0,0 +1,134 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <string.h>
+
+#include "ocpayloadarena.h"
+#include "oic_malloc.h"
+
+#undef OIC_MALLOC_TAG
+#define OIC_MALLOC_TAG OIC_MEM_TAG_PAYLOAD
+
+/** Smallest block of an arena.*/
+#define ARENA_MIN_BLOCK_SIZE (512)
+
+/** Alignment of the allocations; enough for int64_t, double and pointers.*/
+#define ARENA_ALIGNMENT (sizeof(double) > sizeof(void *) ? sizeof(double) : sizeof(void *))
+
+struct OCPayloadArenaBlock
+{
+    OCPayloadArenaBlock *next;
+    size_t size;
+    size_t used;
+    double data[1];
+};
+
+static OCPayloadArenaBlock *AddArenaBlock(OCPayloadArena *arena, size_t size)
+{
+    if (size < ARENA_MIN_BLOCK_SIZE)
+    {
+        size = ARENA_MIN_BLOCK_SIZE;
+    }
+    OCPayloadArenaBlock *block =
+        (OCPayloadArenaBlock *)OICMalloc(offsetof(OCPayloadArenaBlock, data) + size);
+    if (!block)
+    {
+        return NULL;
+    }
+    block->size = size;
+    block->used = 0;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    return block;
+}
+
+OCPayloadArena *OCPayloadArenaCreate(size_t sizeHint)
+{
+    OCPayloadArena *arena = (OCPayloadArena *)OICCalloc(1, sizeof(OCPayloadArena));
+    if (!arena)
+    {
+        return NULL;
+    }
+    if (!AddArenaBlock(arena, sizeHint))
+    {
+        OICFree(arena);
+        return NULL;
+    }
+    return arena;
+}
+
+void OCPayloadArenaDestroy(OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+    OCPayloadArenaBlock *block = arena->blocks;
+    while (block)
+    {
+        OCPayloadArenaBlock *next = block->next;
+        OICFree(block);
+        block = next;
+    }
+    OICFree(arena);
+}
+
+void *OCPayloadArenaAlloc(OCPayloadArena *arena, size_t size)
+{
+    if (!arena)
+    {
+        return NULL;
+    }
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    OCPayloadArenaBlock *block = arena->blocks;
+    if (!block || block->size - block->used < size)
+    {
+        // Blocks double in size, so a parse needs only a few of them.
+        size_t blockSize = block ? block->size * 2 : 0;
+        block = AddArenaBlock(arena, blockSize > size ? blockSize : size);
+        if (!block)
+        {
+            return NULL;
+        }
+    }
+
+    void *ptr = (uint8_t *)block->data + block->used;
+    block->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+bool OCPayloadArenaContains(const OCPayloadArena *arena, const void *ptr)
+{
+    if (!arena || !ptr)
+    {
+        return false;
+    }
+    for (const OCPayloadArenaBlock *block = arena->blocks; block; block = block->next)
+    {
+        const uint8_t *data = (const uint8_t *)block->data;
+        if ((const uint8_t *)ptr >= data && (const uint8_t *)ptr < data + block->used)
+        {
+            return true;
+        }
+    }
+    return false;
+}
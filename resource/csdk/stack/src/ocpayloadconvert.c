@@ -32,9 +32,15 @@
 
 #define TAG "OIC_RI_PAYLOADCONVERT"
 
+#undef OIC_MALLOC_TAG
+#define OIC_MALLOC_TAG OIC_MEM_TAG_PAYLOAD
+
 // Arbitrarily chosen size that seems to contain the majority of packages
 #define INIT_SIZE (255)
 
+// Largest encode buffer kept for the next payload; larger payloads are encoded in place.
+#define MAX_ENCODE_BUFFER_SIZE (16 * 1024)
+
 // Discovery Links Map Length.
 #define LINKS_MAP_LEN 4
 
@@ -63,6 +69,78 @@ static int64_t AddTextStringToMap(CborEncoder *map, const char *key, size_t keyl
 static int64_t ConditionalAddTextStringToMap(CborEncoder *map, const char *key, size_t keylen,
         const char *value);
 
+/**
+ * Buffer every payload is encoded into before it is copied out at its exact size. It grows
+ * to the largest payload seen, so after the first large payload the encode fits at once.
+ * Calls into the stack are serialized by the application, so one buffer is enough.
+ */
+static uint8_t *g_encodeBuffer = NULL;
+static size_t g_encodeBufferSize = 0;
+
+/**
+ * Make the encode buffer hold at least size bytes.
+ *
+ * @return true if the buffer is large enough.
+ */
+static bool ReserveEncodeBuffer(size_t size)
+{
+    if (g_encodeBufferSize >= size)
+    {
+        return true;
+    }
+    uint8_t *buffer = (uint8_t *)OICRealloc(g_encodeBuffer, size);
+    if (!buffer)
+    {
+        return false;
+    }
+    g_encodeBuffer = buffer;
+    g_encodeBufferSize = size;
+    return true;
+}
+
+void OCFreePayloadEncodeBuffer()
+{
+    OICFree(g_encodeBuffer);
+    g_encodeBuffer = NULL;
+    g_encodeBufferSize = 0;
+}
+
+OCStackResult OCConvertPayloadToBuffer(OCPayload* payload, uint8_t* buffer, size_t* size)
+{
+    VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, buffer, "buffer parameter is NULL");
+    VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
+
+    if (PAYLOAD_TYPE_SECURITY == payload->type &&
+        ((OCSecurityPayload *)payload)->payloadSize > *size)
+    {
+        *size = ((OCSecurityPayload *)payload)->payloadSize;
+        return OC_STACK_NO_MEMORY;
+    }
+    if (PAYLOAD_TYPE_ENCODED == payload->type &&
+        ((OCEncodedPayload *)payload)->size > *size)
+    {
+        *size = ((OCEncodedPayload *)payload)->size;
+        return OC_STACK_NO_MEMORY;
+    }
+
+    // On CborErrorOutOfMemory the encoder keeps counting, so size holds the size needed.
+    int64_t err = OCConvertPayloadHelper(payload, buffer, size);
+    if (err == CborErrorOutOfMemory)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    if (err != CborNoError)
+    {
+        //TODO: Proper conversion from CborError to OCStackResult.
+        return (OCStackResult)-err;
+    }
+    return OC_STACK_OK;
+
+exit:
+    return OC_STACK_INVALID_PARAM;
+}
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size)
 {
     // TinyCbor Version 47a78569c0 or better on master is required for the re-allocation
@@ -73,66 +151,60 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     #undef CborNeedsUpdating
 
     OCStackResult ret = OC_STACK_INVALID_PARAM;
-    int64_t err;
     uint8_t *out = NULL;
-    size_t curSize = INIT_SIZE;
+    size_t curSize = 0;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
     VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
 
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
-    if (PAYLOAD_TYPE_SECURITY == payload->type)
+    if (!ReserveEncodeBuffer(INIT_SIZE))
     {
-        size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
-        if (securityPayloadSize > 0)
-        {
-            out = (uint8_t *)OICCalloc(1, ((OCSecurityPayload *)payload)->payloadSize);
-            VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate security payload");
-        }
+        OIC_LOG(ERROR, TAG, "Failed to allocate encode buffer");
+        return OC_STACK_NO_MEMORY;
     }
-    if (out == NULL)
+
+    curSize = g_encodeBufferSize;
+    ret = OCConvertPayloadToBuffer(payload, g_encodeBuffer, &curSize);
+    // curSize is only a lower bound of the size needed when the encoder ran out of room
+    // inside a nested container, so grow and encode again until the payload fits.
+    while (ret == OC_STACK_NO_MEMORY && curSize <= MAX_ENCODE_BUFFER_SIZE)
     {
-        out = (uint8_t *)OICCalloc(1, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        if (!ReserveEncodeBuffer(curSize))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to increase encode buffer size");
+            return OC_STACK_NO_MEMORY;
+        }
+        curSize = g_encodeBufferSize;
+        ret = OCConvertPayloadToBuffer(payload, g_encodeBuffer, &curSize);
     }
-    err = OCConvertPayloadHelper(payload, out, &curSize);
-    ret = OC_STACK_NO_MEMORY;
-
-    if (err == CborErrorOutOfMemory)
+    while (ret == OC_STACK_NO_MEMORY)
     {
-        // reallocate "out" and try again!
+        // Too large to keep around; encode straight into the output.
         uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
+        VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to allocate payload");
         out = out2;
-        err = OCConvertPayloadHelper(payload, out, &curSize);
-        while (err == CborErrorOutOfMemory)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-            err = OCConvertPayloadHelper(payload, out, &curSize);
-        }
+        ret = OCConvertPayloadToBuffer(payload, out, &curSize);
     }
-
-    if (err == CborNoError)
+    if (ret != OC_STACK_OK)
     {
-        if (curSize < INIT_SIZE && PAYLOAD_TYPE_SECURITY != payload->type)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-        }
+        goto exit;
+    }
 
-        *size = curSize;
-        *outPayload = out;
-        OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
-        OIC_LOG_BUFFER(DEBUG, TAG, *outPayload, *size);
-        return OC_STACK_OK;
+    if (!out)
+    {
+        ret = OC_STACK_NO_MEMORY;
+        out = (uint8_t *)OICMalloc(curSize ? curSize : 1);
+        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        memcpy(out, g_encodeBuffer, curSize);
     }
 
-    //TODO: Proper conversion from CborError to OCStackResult.
-    ret = (OCStackResult)-err;
+    *size = curSize;
+    *outPayload = out;
+    OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
+    OIC_LOG_BUFFER(DEBUG, TAG, *outPayload, *size);
+    return OC_STACK_OK;
 
 exit:
     OICFree(out);
@@ -157,6 +229,11 @@ static int64_t OCConvertPayloadHelper(OCPayload* payload, uint8_t* outPayload, s
             return OCConvertSecurityPayload((OCSecurityPayload*)payload, outPayload, size);
         case PAYLOAD_TYPE_RD:
             return OCRDPayloadToCbor((OCRDPayload*)payload, outPayload, size);
+        case PAYLOAD_TYPE_ENCODED:
+            memcpy(outPayload, ((OCEncodedPayload*)payload)->data,
+                   ((OCEncodedPayload*)payload)->size);
+            *size = ((OCEncodedPayload*)payload)->size;
+            return CborNoError;
         default:
             OIC_LOG_V(INFO,TAG, "ConvertPayload default %d", payload->type);
             return CborErrorUnknownType;
@@ -683,6 +760,11 @@ exit:
 static int64_t OCConvertSingleRepPayload(CborEncoder *repMap, const OCRepPayload *payload)
 {
     int64_t err = CborNoError;
+    if (!OCRepPayloadDecodeValues((OCRepPayload *)payload))
+    {
+        OIC_LOG(ERROR, TAG, "Failed decoding values");
+        return CborErrorOutOfMemory;
+    }
     OCRepPayloadValue *value = payload->values;
     while (value)
     {
@@ -32,6 +32,7 @@
 #include "oic_malloc.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
+#include "ocpayloadarena.h"
 #include "ocstackinternal.h"
 #include "payload_logging.h"
 #include "rdpayload.h"
@@ -39,11 +40,56 @@
 
 #define TAG "OIC_RI_PAYLOADPARSE"
 
+#undef OIC_MALLOC_TAG
+#define OIC_MALLOC_TAG OIC_MEM_TAG_PAYLOAD
+
+// Arena bytes reserved per byte of a representation encoding.
+#define ARENA_SIZE_PER_CBOR_BYTE 4
+
+// Keys of a root representation map that are not values.
+static const char *REP_PAYLOAD_PROPERTIES[] = {OC_RSRVD_HREF, OC_RSRVD_RESOURCE_TYPE,
+                                               OC_RSRVD_INTERFACE};
+
+/**
+ * Encoding that lazily decoded payloads decode their values from, shared by the payloads
+ * of one response.
+ */
+typedef struct OCRepPayloadLazySource
+{
+    size_t refCount;        /**< payloads referring to the encoding */
+    CborParser parser;      /**< parser of the encoding */
+    uint8_t *buffer;        /**< copy of the encoding, allocated along with the source */
+} OCRepPayloadLazySource;
+
+/**
+ * Position of an encoded value.
+ */
+typedef struct OCRepPayloadLazyKey
+{
+    CborValue key;          /**< key of the value */
+    CborValue value;        /**< encoded value */
+} OCRepPayloadLazyKey;
+
+/**
+ * Values of a payload that are decoded on demand, see OCParsePayloadLazy().
+ */
+typedef struct OCRepPayloadLazyValues
+{
+    OCRepPayloadLazySource *source; /**< encoding of the values */
+    CborValue map;                  /**< encoded map of the values */
+    bool indexed;                   /**< set once the keys are indexed */
+    size_t numKeys;                 /**< number of indexed keys */
+    OCRepPayloadLazyKey *keys;      /**< indexed keys, in the order of the encoding */
+    OCRepPayload *decoded;          /**< values decoded so far */
+} OCRepPayloadLazyValues;
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseDevicePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParsePlatformPayload(OCPayload **outPayload, CborValue *arrayVal);
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot);
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal);
+static CborError OCParseSingleRepPayload(OCPayloadArena *arena, OCRepPayload **outPayload,
+        CborValue *repParent, bool isRoot);
+static OCStackResult OCParseRepPayload(OCPayloadArena *arena, OCRepPayloadLazySource *source,
+        OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload **outPayload, const uint8_t *payload, size_t size);
 
@@ -78,7 +124,7 @@ OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
             result = OCParsePlatformPayload(outPayload, &rootValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &rootValue);
+            result = OCParseRepPayload(NULL, NULL, outPayload, &rootValue);
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &rootValue);
@@ -101,8 +147,144 @@ exit:
     return result;
 }
 
+OCStackResult OCParsePayloadInArena(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize)
+{
+    if (PAYLOAD_TYPE_REPRESENTATION != payloadType)
+    {
+        return OCParsePayload(outPayload, payloadType, payload, payloadSize);
+    }
+
+    OCStackResult result = OC_STACK_MALFORMED_RESPONSE;
+    OCPayloadArena *arena = NULL;
+
+    VERIFY_PARAM_NON_NULL(TAG, outPayload, "Conversion of outPayload failed");
+    VERIFY_PARAM_NON_NULL(TAG, payload, "Invalid cbor payload value");
+
+    OIC_LOG_V(INFO, TAG, "CBOR Parsing size: %zu of Payload Type: %d in arena, Payload:",
+            payloadSize, payloadType);
+    OIC_LOG_BUFFER(DEBUG, TAG, payload, payloadSize);
+
+    CborParser parser;
+    CborValue rootValue;
+    CborError err = cbor_parser_init(payload, payloadSize, 0, &parser, &rootValue);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed initializing init value")
+
+    // The decoded payload takes a few times the size of its encoding.
+    arena = OCPayloadArenaCreate(payloadSize * ARENA_SIZE_PER_CBOR_BYTE);
+    if (!arena)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    result = OCParseRepPayload(arena, NULL, outPayload, &rootValue);
+    if (OC_STACK_OK == result && *outPayload)
+    {
+        arena->owner = (OCRepPayload *)*outPayload;
+        arena->sealed = true;
+        arena = NULL;
+    }
+    OIC_LOG_V(INFO, TAG, "Finished parse payload, result is %d", result);
+
+exit:
+    OCPayloadArenaDestroy(arena);
+    return result;
+}
+
 void OCFreeOCStringLL(OCStringLL* ll);
 
+/**
+ * Allocate zeroed memory for a parsed payload: from the arena, or the heap without one.
+ */
+static void *ParseAlloc(OCPayloadArena *arena, size_t size)
+{
+    return arena ? OCPayloadArenaAlloc(arena, size) : OICCalloc(1, size);
+}
+
+/**
+ * Free memory of a parsed payload; memory of the arena is released along with it.
+ */
+static void ParseFree(OCPayloadArena *arena, void *ptr)
+{
+    if (!arena)
+    {
+        OICFree(ptr);
+    }
+}
+
+static CborError ParseDupTextString(OCPayloadArena *arena, const CborValue *value,
+        char **str, size_t *len)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_text_string(value, str, len, NULL);
+    }
+
+    size_t size = 0;
+    CborError err = cbor_value_calculate_string_length(value, &size);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    *str = (char *)OCPayloadArenaAlloc(arena, size + 1);
+    if (!*str)
+    {
+        return CborErrorOutOfMemory;
+    }
+    *len = size + 1;
+    err = cbor_value_copy_text_string(value, *str, len, NULL);
+    return err;
+}
+
+static CborError ParseDupByteString(OCPayloadArena *arena, const CborValue *value,
+        uint8_t **bytes, size_t *len)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_byte_string(value, bytes, len, NULL);
+    }
+
+    size_t size = 0;
+    CborError err = cbor_value_calculate_string_length(value, &size);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    // An empty byte string still gets a buffer, as it does from the heap.
+    *bytes = (uint8_t *)OCPayloadArenaAlloc(arena, size ? size : 1);
+    if (!*bytes)
+    {
+        return CborErrorOutOfMemory;
+    }
+    *len = size;
+    err = cbor_value_copy_byte_string(value, *bytes, len, NULL);
+    return err;
+}
+
+static bool ParseAddStringLL(OCPayloadArena *arena, OCStringLL **list, const char *value)
+{
+    if (!arena)
+    {
+        return OCResourcePayloadAddStringLL(list, value);
+    }
+
+    size_t size = strlen(value) + 1;
+    OCStringLL *item = (OCStringLL *)OCPayloadArenaAlloc(arena, sizeof(OCStringLL) + size);
+    if (!item)
+    {
+        return false;
+    }
+    item->value = (char *)(item + 1);
+    memcpy(item->value, value, size);
+
+    while (*list)
+    {
+        list = &(*list)->next;
+    }
+    *list = item;
+    return true;
+}
+
 static OCStackResult OCParseSecurityPayload(OCPayload** outPayload, const uint8_t *payload,
         size_t size)
 {
@@ -135,7 +317,8 @@ static char* InPlaceStringTrim(char* str)
     return str;
 }
 
-static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource)
+static CborError OCParseStringLLInArena(OCPayloadArena *arena, CborValue *map, char *type,
+        OCStringLL **resource)
 {
     CborValue val;
     CborError err = cbor_value_map_find_value(map, type, &val);
@@ -161,7 +344,7 @@ static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resour
                     char *trimmed = InPlaceStringTrim(curPtr);
                     if (trimmed[0] !='\0')
                     {
-                        if (!OCResourcePayloadAddStringLL(resource, trimmed))
+                        if (!ParseAddStringLL(arena, resource, trimmed))
                         {
                             return CborErrorOutOfMemory;
                         }
@@ -181,6 +364,11 @@ exit:
     return err;
 }
 
+static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource)
+{
+    return OCParseStringLLInArena(NULL, map, type, resource);
+}
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *rootValue)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
@@ -746,7 +934,7 @@ static size_t arrayStep(size_t dimensions[MAX_REP_ARRAY_DEPTH], size_t elementNu
         elementNum;
 }
 
-static CborError OCParseArrayFillArray(const CborValue *parent,
+static CborError OCParseArrayFillArray(OCPayloadArena *arena, const CborValue *parent,
         size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray)
 {
     CborValue insideArray;
@@ -779,7 +967,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     }
                     else
                     {
-                        err = OCParseArrayFillArray(&insideArray, newdim, type,
+                        err = OCParseArrayFillArray(arena, &insideArray, newdim, type,
                             &(((int64_t*)targetArray)[arrayStep(dimensions, i)]));
                     }
                     break;
@@ -802,7 +990,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     }
                     else
                     {
-                        err = OCParseArrayFillArray(&insideArray, newdim, type,
+                        err = OCParseArrayFillArray(arena, &insideArray, newdim, type,
                             &(((double*)targetArray)[arrayStep(dimensions, i)]));
                     }
                     break;
@@ -813,47 +1001,47 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     }
                     else
                     {
-                        err = OCParseArrayFillArray(&insideArray, newdim, type,
+                        err = OCParseArrayFillArray(arena, &insideArray, newdim, type,
                             &(((bool*)targetArray)[arrayStep(dimensions, i)]));
                     }
                     break;
                 case OCREP_PROP_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_text_string(&insideArray, &tempStr, &tempLen, NULL);
+                        err = ParseDupTextString(arena, &insideArray, &tempStr, &tempLen);
                         ((char**)targetArray)[i] = tempStr;
                         tempStr = NULL;
                     }
                     else
                     {
-                        err = OCParseArrayFillArray(&insideArray, newdim, type,
+                        err = OCParseArrayFillArray(arena, &insideArray, newdim, type,
                             &(((char**)targetArray)[arrayStep(dimensions, i)]));
                     }
                     break;
                 case OCREP_PROP_BYTE_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_byte_string(&insideArray, &(ocByteStr.bytes),
-                                &(ocByteStr.len), NULL);
+                        err = ParseDupByteString(arena, &insideArray, &(ocByteStr.bytes),
+                                &(ocByteStr.len));
                         ((OCByteString*)targetArray)[i] = ocByteStr;
                     }
                     else
                     {
-                        err = OCParseArrayFillArray(&insideArray, newdim, type,
+                        err = OCParseArrayFillArray(arena, &insideArray, newdim, type,
                                 &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]));
                     }
                     break;
                 case OCREP_PROP_OBJECT:
                     if (dimensions[1] == 0)
                     {
-                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false);
+                        err = OCParseSingleRepPayload(arena, &tempPl, &insideArray, false);
                         ((OCRepPayload**)targetArray)[i] = tempPl;
                         tempPl = NULL;
                         noAdvance = true;
                     }
                     else
                     {
-                        err = OCParseArrayFillArray(&insideArray, newdim, type,
+                        err = OCParseArrayFillArray(arena, &insideArray, newdim, type,
                             &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]));
                     }
                     break;
@@ -876,7 +1064,8 @@ exit:
     return err;
 }
 
-static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *container)
+static CborError OCParseArray(OCPayloadArena *arena, OCRepPayload *out, const char *name,
+        CborValue *container)
 {
     void *arr = NULL;
 
@@ -901,10 +1090,10 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
 
     dimTotal = calcDimTotal(dimensions);
     allocSize = getAllocSize(type);
-    arr = OICCalloc(dimTotal, allocSize);
+    arr = ParseAlloc(arena, dimTotal * allocSize);
     VERIFY_PARAM_NON_NULL(TAG, arr, "Array Parse allocation failed");
 
-    res = OCParseArrayFillArray(container, dimensions, type, arr);
+    res = OCParseArrayFillArray(arena, container, dimensions, type, arr);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed parse array");
 
     switch (type)
@@ -935,6 +1124,11 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting array parameter");
     return CborNoError;
 exit:
+    if (arena)
+    {
+        // Released along with the arena.
+        return err;
+    }
     if (type == OCREP_PROP_STRING)
     {
         for(size_t i = 0; i < dimTotal; ++i)
@@ -960,143 +1154,184 @@ exit:
     return err;
 }
 
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot)
+/**
+ * Decode the value at repMap into payload under name, and advance repMap past it.
+ */
+static CborError OCParseRepValue(OCPayloadArena *arena, OCRepPayload *payload, const char *name,
+        CborValue *repMap)
 {
-    CborError err = CborUnknownError;
-    char *name = NULL;
+    CborError err = CborNoError;
     bool res = false;
-    VERIFY_PARAM_NON_NULL(TAG, outPayload, "Invalid Parameter outPayload");
-    VERIFY_PARAM_NON_NULL(TAG, objMap, "Invalid Parameter objMap");
-
-    if (cbor_value_is_map(objMap))
+    size_t len = 0;
+    CborType type = cbor_value_get_type(repMap);
+    switch (type)
     {
-        if (!*outPayload)
-        {
-            *outPayload = OCRepPayloadCreate();
-            if (!*outPayload)
+        case CborNullType:
+            res = OCRepPayloadSetNull(payload, name);
+            break;
+        case CborIntegerType:
             {
-                return CborErrorOutOfMemory;
+                int64_t intval = 0;
+                err = cbor_value_get_int64(repMap, &intval);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
+                res = OCRepPayloadSetPropInt(payload, name, intval);
             }
-        }
-
-        OCRepPayload *curPayload = *outPayload;
-
-        size_t len = 0;
-        CborValue repMap;
-        err = cbor_value_enter_container(objMap, &repMap);
-        VERIFY_CBOR_SUCCESS(TAG, err, "Failed entering repMap");
-
-        while (!err && cbor_value_is_valid(&repMap))
-        {
-            if (cbor_value_is_text_string(&repMap))
+            break;
+        case CborDoubleType:
             {
-                err = cbor_value_dup_text_string(&repMap, &name, &len, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
-                err = cbor_value_advance(&repMap);
-                VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing rootMap");
-                if (name &&
-                    isRoot &&
-                    ((0 == strcmp(OC_RSRVD_HREF, name)) ||
-                     (0 == strcmp(OC_RSRVD_RESOURCE_TYPE, name)) ||
-                    (0 == strcmp(OC_RSRVD_INTERFACE, name))))
-                {
-                    err = cbor_value_advance(&repMap);
-                    OICFree(name);
-                    continue;
-                }
+                double doubleval = 0;
+                err = cbor_value_get_double(repMap, &doubleval);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
+                res = OCRepPayloadSetPropDouble(payload, name, doubleval);
             }
-            CborType type = cbor_value_get_type(&repMap);
-            switch (type)
+            break;
+        case CborBooleanType:
             {
-                case CborNullType:
-                    res = OCRepPayloadSetNull(curPayload, name);
-                    break;
-                case CborIntegerType:
-                    {
-                        int64_t intval = 0;
-                        err = cbor_value_get_int64(&repMap, &intval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
-                        res = OCRepPayloadSetPropInt(curPayload, name, intval);
-                    }
-                    break;
-                case CborDoubleType:
-                    {
-                        double doubleval = 0;
-                        err = cbor_value_get_double(&repMap, &doubleval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
-                        res = OCRepPayloadSetPropDouble(curPayload, name, doubleval);
-                    }
-                    break;
-                case CborBooleanType:
-                    {
-                        bool boolval = false;
-                        err = cbor_value_get_boolean(&repMap, &boolval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
-                        res = OCRepPayloadSetPropBool(curPayload, name, boolval);
-                    }
-                    break;
-                case CborTextStringType:
-                    {
-                        char *strval = NULL;
-                        err = cbor_value_dup_text_string(&repMap, &strval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
-                        res = OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
-                    }
-                    break;
-                case CborByteStringType:
-                    {
-                        uint8_t* bytestrval = NULL;
-                        err = cbor_value_dup_byte_string(&repMap, &bytestrval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
-                        OCByteString tmp = {.bytes = bytestrval, .len = len};
-                        res = OCRepPayloadSetPropByteStringAsOwner(curPayload, name, &tmp);
-                    }
-                    break;
-                case CborMapType:
-                    {
-                        OCRepPayload *pl = NULL;
-                        err = OCParseSingleRepPayload(&pl, &repMap, false);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
-                        res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
-                    }
-                    break;
-                case CborArrayType:
-                    err = OCParseArray(curPayload, name, &repMap);
-                    break;
-                default:
-                    OIC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap.type);
-                    res = false;
+                bool boolval = false;
+                err = cbor_value_get_boolean(repMap, &boolval);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
+                res = OCRepPayloadSetPropBool(payload, name, boolval);
+            }
+            break;
+        case CborTextStringType:
+            {
+                char *strval = NULL;
+                err = ParseDupTextString(arena, repMap, &strval, &len);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
+                res = OCRepPayloadSetPropStringAsOwner(payload, name, strval);
             }
-            if (type != CborArrayType)
+            break;
+        case CborByteStringType:
             {
-                err = (CborError) !res;
+                uint8_t* bytestrval = NULL;
+                err = ParseDupByteString(arena, repMap, &bytestrval, &len);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
+                OCByteString tmp = {.bytes = bytestrval, .len = len};
+                res = OCRepPayloadSetPropByteStringAsOwner(payload, name, &tmp);
             }
-            VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting value");
+            break;
+        case CborMapType:
+            {
+                OCRepPayload *pl = NULL;
+                err = OCParseSingleRepPayload(arena, &pl, repMap, false);
+                VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
+                res = OCRepPayloadSetPropObjectAsOwner(payload, name, pl);
+            }
+            break;
+        case CborArrayType:
+            err = OCParseArray(arena, payload, name, repMap);
+            break;
+        default:
+            OIC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap->type);
+            res = false;
+    }
+    if (type != CborArrayType)
+    {
+        err = (CborError) !res;
+    }
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting value");
+
+    if (type != CborMapType && cbor_value_is_valid(repMap))
+    {
+        err = cbor_value_advance(repMap);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed advance repMap");
+    }
+
+exit:
+    return err;
+}
+
+/**
+ * Check if a key of a root map is one of the properties kept outside of the values.
+ */
+static bool OCIsRepPayloadProperty(const char *name)
+{
+    for (size_t i = 0; i < sizeof(REP_PAYLOAD_PROPERTIES) / sizeof(REP_PAYLOAD_PROPERTIES[0]); i++)
+    {
+        if (0 == strcmp(REP_PAYLOAD_PROPERTIES[i], name))
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
-            if (type != CborMapType && cbor_value_is_valid(&repMap))
+/**
+ * Decode the entries of objMap into the values of payload; objMap is advanced past the map.
+ */
+static CborError OCParseRepValues(OCPayloadArena *arena, OCRepPayload *payload,
+        CborValue *objMap, bool isRoot)
+{
+    CborError err = CborUnknownError;
+    char *name = NULL;
+    size_t len = 0;
+    CborValue repMap;
+    err = cbor_value_enter_container(objMap, &repMap);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed entering repMap");
+
+    while (!err && cbor_value_is_valid(&repMap))
+    {
+        if (cbor_value_is_text_string(&repMap))
+        {
+            err = ParseDupTextString(arena, &repMap, &name, &len);
+            VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
+            err = cbor_value_advance(&repMap);
+            VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing rootMap");
+            if (name && isRoot && OCIsRepPayloadProperty(name))
             {
                 err = cbor_value_advance(&repMap);
-                VERIFY_CBOR_SUCCESS(TAG, err, "Failed advance repMap");
+                ParseFree(arena, name);
+                name = NULL;
+                continue;
             }
-            OICFree(name);
-            name = NULL;
         }
-        if (cbor_value_is_container(objMap))
+        err = OCParseRepValue(arena, payload, name, &repMap);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed parsing value");
+        ParseFree(arena, name);
+        name = NULL;
+    }
+    if (cbor_value_is_container(objMap))
+    {
+        err = cbor_value_leave_container(objMap, &repMap);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed to leave container");
+    }
+
+exit:
+    ParseFree(arena, name);
+    return err;
+}
+
+static CborError OCParseSingleRepPayload(OCPayloadArena *arena, OCRepPayload **outPayload,
+        CborValue *objMap, bool isRoot)
+{
+    CborError err = CborUnknownError;
+    VERIFY_PARAM_NON_NULL(TAG, outPayload, "Invalid Parameter outPayload");
+    VERIFY_PARAM_NON_NULL(TAG, objMap, "Invalid Parameter objMap");
+
+    if (cbor_value_is_map(objMap))
+    {
+        if (!*outPayload)
         {
-            err = cbor_value_leave_container(objMap, &repMap);
-            VERIFY_CBOR_SUCCESS(TAG, err, "Failed to leave container");
+            *outPayload = OCRepPayloadCreateInArena(arena);
+            if (!*outPayload)
+            {
+                return CborErrorOutOfMemory;
+            }
         }
+
+        err = OCParseRepValues(arena, *outPayload, objMap, isRoot);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed parsing values");
         return err;
     }
 
 exit:
-    OICFree(name);
     OCRepPayloadDestroy(*outPayload);
     *outPayload = NULL;
     return err;
 }
 
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
+static OCStackResult OCParseRepPayload(OCPayloadArena *arena, OCRepPayloadLazySource *source,
+        OCPayload **outPayload, CborValue *root)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     CborError err;
@@ -1115,7 +1350,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
     }
     while (cbor_value_is_valid(&rootMap))
     {
-        temp = OCRepPayloadCreate();
+        temp = OCRepPayloadCreateInArena(arena);
         ret = OC_STACK_NO_MEMORY;
         VERIFY_PARAM_NON_NULL(TAG, temp, "Failed allocating memory");
 
@@ -1134,7 +1369,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             if (cbor_value_is_valid(&curVal))
             {
                 size_t len = 0;
-                err = cbor_value_dup_text_string(&curVal, &temp->uri, &len, NULL);
+                err = ParseDupTextString(arena, &curVal, &temp->uri, &len);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find uri");
             }
         }
@@ -1144,7 +1379,8 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_RESOURCE_TYPE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->types);
+                err =  OCParseStringLLInArena(arena, &rootMap, OC_RSRVD_RESOURCE_TYPE,
+                        &temp->types);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find rt type tag/value");
             }
         }
@@ -1154,14 +1390,28 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_INTERFACE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->interfaces);
+                err =  OCParseStringLLInArena(arena, &rootMap, OC_RSRVD_INTERFACE,
+                        &temp->interfaces);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find interfaces tag/value");
             }
         }
 
-        if (cbor_value_is_map(&rootMap))
+        if (cbor_value_is_map(&rootMap) && source)
         {
-            err = OCParseSingleRepPayload(&temp, &rootMap, true);
+            ret = OC_STACK_NO_MEMORY;
+            temp->lazy = (OCRepPayloadLazyValues *)OICCalloc(1, sizeof(OCRepPayloadLazyValues));
+            VERIFY_PARAM_NON_NULL(TAG, temp->lazy, "Failed allocating lazy values");
+            temp->lazy->source = source;
+            temp->lazy->map = rootMap;
+            source->refCount++;
+            ret = OC_STACK_MALFORMED_RESPONSE;
+
+            err = cbor_value_advance(&rootMap);
+            VERIFY_CBOR_SUCCESS(TAG, err, "Failed to skip single rep payload");
+        }
+        else if (cbor_value_is_map(&rootMap))
+        {
+            err = OCParseSingleRepPayload(arena, &temp, &rootMap, true);
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed to parse single rep payload");
         }
 
@@ -1175,6 +1425,8 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             curPayload->next = temp;
             curPayload = curPayload->next;
         }
+        // Owned by rootPayload from here on.
+        temp = NULL;
 
         if (cbor_value_is_array(&rootMap))
         {
@@ -1192,6 +1444,221 @@ exit:
     return ret;
 }
 
+static void OCRepPayloadLazySourceRelease(OCRepPayloadLazySource *source)
+{
+    if (source && 0 == --source->refCount)
+    {
+        OICFree(source);
+    }
+}
+
+OCStackResult OCParsePayloadLazy(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize)
+{
+    if (PAYLOAD_TYPE_REPRESENTATION != payloadType)
+    {
+        return OCParsePayload(outPayload, payloadType, payload, payloadSize);
+    }
+
+    OCStackResult result = OC_STACK_MALFORMED_RESPONSE;
+    OCRepPayloadLazySource *source = NULL;
+
+    VERIFY_PARAM_NON_NULL(TAG, outPayload, "Conversion of outPayload failed");
+    VERIFY_PARAM_NON_NULL(TAG, payload, "Invalid cbor payload value");
+
+    OIC_LOG_V(INFO, TAG, "CBOR Parsing size: %zu of Payload Type: %d lazily, Payload:",
+            payloadSize, payloadType);
+    OIC_LOG_BUFFER(DEBUG, TAG, payload, payloadSize);
+
+    // The payloads decode their values from a copy of the encoding they share.
+    source = (OCRepPayloadLazySource *)OICMalloc(sizeof(OCRepPayloadLazySource) + payloadSize);
+    if (!source)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    source->refCount = 1;
+    source->buffer = (uint8_t *)(source + 1);
+    memcpy(source->buffer, payload, payloadSize);
+
+    CborValue rootValue;
+    CborError err = cbor_parser_init(source->buffer, payloadSize, 0, &source->parser, &rootValue);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed initializing init value")
+
+    result = OCParseRepPayload(NULL, source, outPayload, &rootValue);
+    OIC_LOG_V(INFO, TAG, "Finished parse payload, result is %d", result);
+
+exit:
+    OCRepPayloadLazySourceRelease(source);
+    return result;
+}
+
+void OCRepPayloadLazyDestroy(OCRepPayloadLazyValues *lazy)
+{
+    if (!lazy)
+    {
+        return;
+    }
+    OCRepPayloadLazySourceRelease(lazy->source);
+    OICFree(lazy->keys);
+    OCRepPayloadDestroy(lazy->decoded);
+    OICFree(lazy);
+}
+
+/**
+ * Index the keys of the encoded values, without decoding the values.
+ */
+static CborError OCRepPayloadLazyIndex(OCRepPayloadLazyValues *lazy)
+{
+    size_t numAllocated = 0;
+    CborValue repMap;
+    CborError err = cbor_value_enter_container(&lazy->map, &repMap);
+    VERIFY_CBOR_SUCCESS(TAG, err, "Failed entering repMap");
+
+    while (cbor_value_is_valid(&repMap))
+    {
+        bool property = false;
+        if (!cbor_value_is_text_string(&repMap))
+        {
+            err = CborErrorIllegalType;
+            VERIFY_CBOR_SUCCESS(TAG, err, "Key is not a text string");
+        }
+        for (size_t i = 0; i < sizeof(REP_PAYLOAD_PROPERTIES) / sizeof(REP_PAYLOAD_PROPERTIES[0])
+                && !property; i++)
+        {
+            err = cbor_value_text_string_equals(&repMap, REP_PAYLOAD_PROPERTIES[i], &property);
+            VERIFY_CBOR_SUCCESS(TAG, err, "Failed comparing key");
+        }
+
+        if (!property)
+        {
+            if (lazy->numKeys == numAllocated)
+            {
+                numAllocated = numAllocated ? numAllocated * 2 : 8;
+                OCRepPayloadLazyKey *keys = (OCRepPayloadLazyKey *)OICRealloc(lazy->keys,
+                        numAllocated * sizeof(OCRepPayloadLazyKey));
+                if (!keys)
+                {
+                    err = CborErrorOutOfMemory;
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed allocating keys");
+                }
+                lazy->keys = keys;
+            }
+            lazy->keys[lazy->numKeys].key = repMap;
+        }
+
+        err = cbor_value_advance(&repMap);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing past key");
+        if (!cbor_value_is_valid(&repMap))
+        {
+            err = CborErrorUnexpectedEOF;
+            VERIFY_CBOR_SUCCESS(TAG, err, "Key without value");
+        }
+        if (!property)
+        {
+            lazy->keys[lazy->numKeys++].value = repMap;
+        }
+        err = cbor_value_advance(&repMap);
+        VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing past value");
+    }
+    lazy->indexed = true;
+
+exit:
+    return err;
+}
+
+OCRepPayload *OCRepPayloadLazyDecode(const OCRepPayload *payload, const char *name)
+{
+    OCRepPayloadLazyValues *lazy = payload->lazy;
+
+    if (lazy->decoded)
+    {
+        for (OCRepPayloadValue *val = lazy->decoded->values; val; val = val->next)
+        {
+            if (0 == strcmp(val->name, name))
+            {
+                return lazy->decoded;
+            }
+        }
+    }
+
+    if (!lazy->indexed && CborNoError != OCRepPayloadLazyIndex(lazy))
+    {
+        OIC_LOG(ERROR, TAG, "Failed indexing lazy values");
+        return NULL;
+    }
+
+    // A key given twice takes the last value, as it does when decoding all values.
+    OCRepPayloadLazyKey *found = NULL;
+    for (size_t i = 0; i < lazy->numKeys; i++)
+    {
+        bool equal = false;
+        if (CborNoError == cbor_value_text_string_equals(&lazy->keys[i].key, name, &equal)
+            && equal)
+        {
+            found = &lazy->keys[i];
+        }
+    }
+    if (!found)
+    {
+        return NULL;
+    }
+
+    if (!lazy->decoded)
+    {
+        lazy->decoded = OCRepPayloadCreate();
+        if (!lazy->decoded)
+        {
+            return NULL;
+        }
+    }
+
+    CborValue value = found->value;
+    if (CborNoError != OCParseRepValue(NULL, lazy->decoded, name, &value))
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed decoding lazy value %s", name);
+        return NULL;
+    }
+    return lazy->decoded;
+}
+
+bool OCRepPayloadDecodeValues(OCRepPayload *payload)
+{
+    if (!payload)
+    {
+        return false;
+    }
+    if (!payload->lazy)
+    {
+        return true;
+    }
+
+    OCRepPayload *values = OCRepPayloadCreate();
+    if (!values)
+    {
+        return false;
+    }
+
+    CborValue map = payload->lazy->map;
+    CborError err = OCParseRepValues(NULL, values, &map, true);
+    if (CborNoError != err)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed decoding lazy values: %d", err);
+        OCRepPayloadDestroy(values);
+        return false;
+    }
+
+    // Values are only set on a payload once it is decoded, so its list is still empty.
+    payload->values = values->values;
+    payload->valueIndex = values->valueIndex;
+    values->values = NULL;
+    values->valueIndex = NULL;
+    OCRepPayloadDestroy(values);
+
+    OCRepPayloadLazyDestroy(payload->lazy);
+    payload->lazy = NULL;
+    return true;
+}
+
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *rootValue)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
@@ -36,12 +36,14 @@
 #include "ocresource.h"
 #include "ocresourcehandler.h"
 #include "ocobserve.h"
+#include "ocresourceindex.h"
 #include "occollection.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "logger.h"
 #include "cJSON.h"
 #include "ocpayload.h"
+#include "ocpayloadcbor.h"
 #include "secureresourcemanager.h"
 #include "cacommon.h"
 #include "cainterface.h"
@@ -71,6 +73,50 @@ extern OCResource *headResource;
 static OCPlatformInfo savedPlatformInfo = {0};
 static OCDeviceInfo savedDeviceInfo = {0};
 
+/**
+ * Encoded /oic/res response for one combination of query filters and transport ports.
+ */
+typedef struct DiscoveryCacheEntry
+{
+    /** Next entry; the list is kept in most recently used order.*/
+    struct DiscoveryCacheEntry *next;
+
+    /** Value of g_discoveryGeneration when the response was built.*/
+    uint32_t generation;
+
+    /** Interface filter of the query, NULL if none.*/
+    char *interfaceQuery;
+
+    /** Resource type filter of the query, NULL if none.*/
+    char *resourceTypeQuery;
+
+    /** Secure port advertised in the response.*/
+    uint16_t securePort;
+
+    /** TCP port advertised in the response.*/
+    uint16_t tcpPort;
+
+    /** Result of building the response; ::OC_STACK_NO_RESOURCE if no resource matched.*/
+    OCStackResult result;
+
+    /** CBOR encoded discovery payload.*/
+    uint8_t *payload;
+
+    /** Size of payload.*/
+    size_t payloadSize;
+} DiscoveryCacheEntry;
+
+static DiscoveryCacheEntry *g_discoveryCache = NULL;
+
+/** Bumped on every change that affects discovery responses; older entries are stale.*/
+static uint32_t g_discoveryGeneration = 0;
+
+/** Discovery requests answered from the cache.*/
+static uint32_t g_discoveryCacheHits = 0;
+
+/** Discovery requests that built a new response.*/
+static uint32_t g_discoveryCacheMisses = 0;
+
 /**
  * Prepares a Payload for response.
  */
@@ -137,6 +183,165 @@ static OCStackResult GetTCPPortInfo(OCDevAddr *endpoint, uint16_t *port)
 }
 #endif
 
+/* Compare two optional discovery filters; a missing filter only matches a missing one. */
+static bool IsSameDiscoveryFilter(const char *first, const char *second)
+{
+    if (!first || !second)
+    {
+        return first == second;
+    }
+    return strcmp(first, second) == 0;
+}
+
+static void FreeDiscoveryCacheEntry(DiscoveryCacheEntry *entry)
+{
+    if (entry)
+    {
+        OICFree(entry->interfaceQuery);
+        OICFree(entry->resourceTypeQuery);
+        OICFree(entry->payload);
+        OICFree(entry);
+    }
+}
+
+/* Ports that the discovery response advertises to the requester. */
+static void GetDiscoveryPorts(OCDevAddr *devAddr, uint16_t *securePort, uint16_t *tcpPort)
+{
+    if (GetSecurePortInfo(devAddr, securePort) != OC_STACK_OK)
+    {
+        *securePort = 0;
+    }
+    *tcpPort = 0;
+#ifdef TCP_ADAPTER
+    if (GetTCPPortInfo(devAddr, tcpPort) != OC_STACK_OK)
+    {
+        *tcpPort = 0;
+    }
+#endif
+}
+
+/*
+ * Look up a cached discovery response. Stale entries found on the way are freed and a hit is
+ * moved to the front of the cache.
+ */
+static DiscoveryCacheEntry *FindDiscoveryCacheEntry(const char *interfaceQuery,
+                                                    const char *resourceTypeQuery,
+                                                    OCDevAddr *devAddr)
+{
+    uint16_t securePort = 0;
+    uint16_t tcpPort = 0;
+    GetDiscoveryPorts(devAddr, &securePort, &tcpPort);
+
+    DiscoveryCacheEntry **link = &g_discoveryCache;
+    while (*link)
+    {
+        DiscoveryCacheEntry *entry = *link;
+        if (entry->generation != g_discoveryGeneration)
+        {
+            *link = entry->next;
+            FreeDiscoveryCacheEntry(entry);
+            continue;
+        }
+
+        if (entry->securePort == securePort && entry->tcpPort == tcpPort
+            && IsSameDiscoveryFilter(entry->interfaceQuery, interfaceQuery)
+            && IsSameDiscoveryFilter(entry->resourceTypeQuery, resourceTypeQuery))
+        {
+            *link = entry->next;
+            entry->next = g_discoveryCache;
+            g_discoveryCache = entry;
+            return entry;
+        }
+        link = &entry->next;
+    }
+    return NULL;
+}
+
+/*
+ * Encode a freshly built discovery response and keep it for identical requests.
+ * The least recently used entry is dropped when the cache is full.
+ */
+static DiscoveryCacheEntry *AddDiscoveryCacheEntry(const char *interfaceQuery,
+                                                   const char *resourceTypeQuery,
+                                                   OCDevAddr *devAddr,
+                                                   OCStackResult result,
+                                                   OCPayload *payload)
+{
+    DiscoveryCacheEntry *entry = (DiscoveryCacheEntry *)OICCalloc(1, sizeof(DiscoveryCacheEntry));
+    if (!entry)
+    {
+        return NULL;
+    }
+
+    entry->generation = g_discoveryGeneration;
+    entry->result = result;
+    GetDiscoveryPorts(devAddr, &entry->securePort, &entry->tcpPort);
+    if ((interfaceQuery && !(entry->interfaceQuery = OICStrdup(interfaceQuery))) ||
+        (resourceTypeQuery && !(entry->resourceTypeQuery = OICStrdup(resourceTypeQuery))))
+    {
+        FreeDiscoveryCacheEntry(entry);
+        return NULL;
+    }
+
+    if (result == OC_STACK_OK &&
+        OCConvertPayload(payload, &entry->payload, &entry->payloadSize) != OC_STACK_OK)
+    {
+        OIC_LOG(ERROR, TAG, "Error converting discovery payload");
+        FreeDiscoveryCacheEntry(entry);
+        return NULL;
+    }
+
+    // Keep the most recently used entries that fit next to the new one.
+    DiscoveryCacheEntry **link = &g_discoveryCache;
+    for (size_t kept = 1; *link && kept < MAX_DISCOVERY_CACHE_ENTRIES; kept++)
+    {
+        link = &(*link)->next;
+    }
+    DiscoveryCacheEntry *evicted = *link;
+    *link = NULL;
+    while (evicted)
+    {
+        DiscoveryCacheEntry *next = evicted->next;
+        FreeDiscoveryCacheEntry(evicted);
+        evicted = next;
+    }
+
+    entry->next = g_discoveryCache;
+    g_discoveryCache = entry;
+    return entry;
+}
+
+void InvalidateDiscoveryCache()
+{
+    g_discoveryGeneration++;
+}
+
+void DeleteDiscoveryCache()
+{
+    DiscoveryCacheEntry *entry = g_discoveryCache;
+    while (entry)
+    {
+        DiscoveryCacheEntry *next = entry->next;
+        FreeDiscoveryCacheEntry(entry);
+        entry = next;
+    }
+    g_discoveryCache = NULL;
+    g_discoveryCacheHits = 0;
+    g_discoveryCacheMisses = 0;
+}
+
+void GetDiscoveryCacheStatistics(uint32_t *hits, uint32_t *misses)
+{
+    if (hits)
+    {
+        *hits = g_discoveryCacheHits;
+    }
+    if (misses)
+    {
+        *misses = g_discoveryCacheMisses;
+    }
+}
+
 /*
  * Function will extract 0, 1 or 2 filters from query.
  * More than 2 filters or unsupported filters will result in error.
@@ -590,6 +795,40 @@ static bool includeThisResourceInResponse(OCResource *resource,
 
 }
 
+/*
+ * Add the resources matching the query filters to a discovery payload. The candidates are
+ * looked up in the resource type index, or the interface index if there is no type filter,
+ * instead of walking the resource list.
+ * Returns false if the index cannot answer the query and the resource list must be walked.
+ */
+static bool BuildIndexedDiscoveryResponse(char *interfaceQuery, char *resourceTypeQuery,
+                                          OCDiscoveryPayload *discPayload, OCDevAddr *devAddr,
+                                          OCStackResult *discoveryResult)
+{
+    OCResource **candidates = NULL;
+    size_t numCandidates = 0;
+    bool indexed = false;
+
+    if (resourceTypeQuery && *resourceTypeQuery)
+    {
+        indexed = FindIndexedResourcesByType(resourceTypeQuery, &candidates, &numCandidates);
+    }
+    else if (interfaceQuery && *interfaceQuery)
+    {
+        indexed = FindIndexedResourcesByInterface(interfaceQuery, &candidates, &numCandidates);
+    }
+
+    for (size_t i = 0; indexed && i < numCandidates && *discoveryResult == OC_STACK_OK; i++)
+    {
+        if (includeThisResourceInResponse(candidates[i], interfaceQuery, resourceTypeQuery))
+        {
+            *discoveryResult = BuildVirtualResourceResponse(candidates[i], discPayload,
+                                                            devAddr, false);
+        }
+    }
+    return indexed;
+}
+
 OCStackResult SendNonPersistantDiscoveryResponse(OCServerRequest *request, OCResource *resource,
                                 OCPayload *discoveryPayload, OCEntityHandlerResult ehResult)
 {
@@ -709,6 +948,7 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 
     OCStackResult discoveryResult = OC_STACK_ERROR;
     OCPayload* payload = NULL;
+    DiscoveryCacheEntry *cacheEntry = NULL;
 
     OIC_LOG(INFO, TAG, "Entering HandleVirtualResource");
 
@@ -737,6 +977,22 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 
         if (discoveryResult == OC_STACK_OK)
         {
+            // Looking the server instance ID up drops the cached responses if it changed.
+            OCGetServerInstanceIDString();
+            cacheEntry = FindDiscoveryCacheEntry(interfaceQuery, resourceTypeQuery,
+                                                 &request->devAddr);
+        }
+
+        bool foundResourceAtRD = false;
+        if (cacheEntry)
+        {
+            OIC_LOG(INFO, TAG, "Using cached discovery response");
+            g_discoveryCacheHits++;
+            discoveryResult = cacheEntry->result;
+        }
+        else if (discoveryResult == OC_STACK_OK)
+        {
+            g_discoveryCacheMisses++;
             payload = (OCPayload *)OCDiscoveryPayloadCreate();
 
             if (payload)
@@ -787,8 +1043,15 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
                         OCResourcePayloadAddStringLL(&discPayload->iface, OC_RSRVD_INTERFACE_DEFAULT);
                         VERIFY_NON_NULL(discPayload->iface, ERROR, OC_STACK_NO_MEMORY);
                     }
-                    bool foundResourceAtRD = false;
-                    for (;resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+                    bool indexed = false;
+#ifndef WITH_RD
+                    // Resources published to the resource directory are not indexed.
+                    indexed = BuildIndexedDiscoveryResponse(interfaceQuery, resourceTypeQuery,
+                                                            discPayload, &request->devAddr,
+                                                            &discoveryResult);
+#endif
+                    for (;!indexed && resource && discoveryResult == OC_STACK_OK;
+                         resource = resource->next)
                     {
 #ifdef WITH_RD
                         if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
@@ -843,6 +1106,15 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
             {
                 discoveryResult = OC_STACK_NO_MEMORY;
             }
+
+            // Responses including resources published to the resource directory are not
+            // cached, the directory changes without touching the local resources.
+            if ((discoveryResult == OC_STACK_OK || discoveryResult == OC_STACK_NO_RESOURCE)
+                && !foundResourceAtRD)
+            {
+                cacheEntry = AddDiscoveryCacheEntry(interfaceQuery, resourceTypeQuery,
+                                                    &request->devAddr, discoveryResult, payload);
+            }
         }
         else
         {
@@ -947,6 +1219,11 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     {
         if(discoveryResult == OC_STACK_OK)
         {
+            if (cacheEntry)
+            {
+                request->encodedPayload = cacheEntry->payload;
+                request->encodedPayloadSize = cacheEntry->payloadSize;
+            }
             SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
         }
         else if(((request->devAddr.flags &  OC_MULTICAST) == false) &&
@@ -999,9 +1276,12 @@ HandleDefaultDeviceEntityHandler (OCServerRequest *request)
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
     // At this point we know for sure that defaultDeviceHandler exists
+    uint32_t requestId = request->requestId;
     ehResult = defaultDeviceHandler(OC_REQUEST_FLAG, &ehRequest,
                                   (char*) request->resourceUrl, defaultDeviceHandlerCallbackParameter);
-    if(ehResult == OC_EH_SLOW)
+    // The handler may have answered, and so deleted, the request meanwhile
+    request = GetServerRequestUsingHandleAndId(request, requestId);
+    if(ehResult == OC_EH_SLOW && request)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
         request->slowFlag = 1;
@@ -1034,6 +1314,7 @@ HandleResourceWithEntityHandler (OCServerRequest *request,
     OCEntityHandlerRequest ehRequest = {0};
 
     OIC_LOG(INFO, TAG, "Entering HandleResourceWithEntityHandler");
+
     OCPayloadType type = PAYLOAD_TYPE_REPRESENTATION;
     // check the security resource
     if (request && request->resourceUrl && SRMIsSecurityResourceURI(request->resourceUrl))
@@ -1047,6 +1328,15 @@ HandleResourceWithEntityHandler (OCServerRequest *request,
         type = PAYLOAD_TYPE_RD;
     }
 
+    // The client holds the representation tagged by the application; no need to render it.
+    if (request && request->method == OC_REST_GET && !collectionResource &&
+        request->observationOption == OC_OBSERVE_NO_OPTION &&
+        ServerRequestMatchesETag(request, resource->etag, resource->etagLength))
+    {
+        OIC_LOG(INFO, TAG, "ETag of the resource matched");
+        return SendNonPersistantDiscoveryResponse(request, resource, NULL, OC_EH_VALID);
+    }
+
     result = FormOCEntityHandlerRequest(&ehRequest,
                                         (OCRequestHandle)request,
                                         request->method,
@@ -1155,8 +1445,11 @@ HandleResourceWithEntityHandler (OCServerRequest *request,
         goto exit;
     }
 
+    uint32_t requestId = request->requestId;
     ehResult = resource->entityHandler(ehFlag, &ehRequest, resource->entityHandlerCallbackParam);
-    if(ehResult == OC_EH_SLOW)
+    // The handler may have answered, and so deleted, the request meanwhile
+    request = GetServerRequestUsingHandleAndId(request, requestId);
+    if(ehResult == OC_EH_SLOW && request)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
         request->slowFlag = 1;
@@ -1211,6 +1504,12 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
 {
     OCStackResult ret = OC_STACK_OK;
 
+    // Virtual resources are answered by the stack and have no entity tag of their own.
+    if (request && resHandling != OC_RESOURCE_VIRTUAL)
+    {
+        request->resource = resource;
+    }
+
     switch (resHandling)
     {
         case OC_RESOURCE_VIRTUAL:
@@ -1349,6 +1648,9 @@ OCStackResult SavePlatformInfo(OCPlatformInfo info)
 
 void DeleteDeviceInfo()
 {
+    // The device name is part of /oic/res responses.
+    InvalidateDiscoveryCache();
+
     OIC_LOG(INFO, TAG, "Deleting device info.");
 
     OICFree(savedDeviceInfo.deviceName);
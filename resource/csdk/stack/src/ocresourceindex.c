@@ -0,0 +1,263 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <string.h>
+#include "ocresourceindex.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "logger.h"
+
+#define TAG "OIC_RI_RESOURCEINDEX"
+
+/** Number of hash buckets of each index; must be a power of two.*/
+#define RESOURCE_INDEX_BUCKETS (32)
+
+/** Initial number of resources an index entry has room for.*/
+#define RESOURCE_INDEX_INITIAL_CAPACITY (4)
+
+/**
+ * One interned name and the resources carrying it.
+ */
+typedef struct ResourceIndexEntry
+{
+    /** Next entry in the same bucket.*/
+    struct ResourceIndexEntry *next;
+
+    /** Resource type or interface name, owned by the entry.*/
+    char *name;
+
+    /** Resources carrying the name, in resource list order.*/
+    OCResource **resources;
+
+    /** Number of resources.*/
+    size_t count;
+
+    /** Number of resources there is room for.*/
+    size_t capacity;
+} ResourceIndexEntry;
+
+typedef struct
+{
+    ResourceIndexEntry *buckets[RESOURCE_INDEX_BUCKETS];
+
+    /** Set when an allocation failed and the index misses a resource.*/
+    bool incomplete;
+} ResourceIndex;
+
+static ResourceIndex g_typeIndex;
+static ResourceIndex g_interfaceIndex;
+
+static uint32_t HashName(const char *name)
+{
+    // djb2
+    uint32_t hash = 5381;
+    for (const unsigned char *c = (const unsigned char *)name; *c; c++)
+    {
+        hash = ((hash << 5) + hash) + *c;
+    }
+    return hash & (RESOURCE_INDEX_BUCKETS - 1);
+}
+
+static ResourceIndexEntry **FindEntryLink(ResourceIndex *index, const char *name)
+{
+    ResourceIndexEntry **link = &index->buckets[HashName(name)];
+    while (*link && strcmp((*link)->name, name) != 0)
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static void FreeEntry(ResourceIndexEntry *entry)
+{
+    OICFree(entry->name);
+    OICFree(entry->resources);
+    OICFree(entry);
+}
+
+static OCStackResult AddToIndex(ResourceIndex *index, OCResource *resource, const char *name)
+{
+    if (!resource || !name)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    ResourceIndexEntry **link = FindEntryLink(index, name);
+    ResourceIndexEntry *entry = *link;
+    if (!entry)
+    {
+        entry = (ResourceIndexEntry *)OICCalloc(1, sizeof(ResourceIndexEntry));
+        if (!entry)
+        {
+            goto exit;
+        }
+        entry->name = OICStrdup(name);
+        if (!entry->name)
+        {
+            OICFree(entry);
+            goto exit;
+        }
+        *link = entry;
+    }
+
+    if (entry->count == entry->capacity)
+    {
+        size_t capacity = entry->capacity ? entry->capacity * 2 : RESOURCE_INDEX_INITIAL_CAPACITY;
+        OCResource **resources =
+            (OCResource **)OICRealloc(entry->resources, capacity * sizeof(OCResource *));
+        if (!resources)
+        {
+            goto exit;
+        }
+        entry->resources = resources;
+        entry->capacity = capacity;
+    }
+
+    // Names are mostly bound right after the resource is created, so the resource
+    // usually goes last; binding to an older resource has to search for its slot.
+    size_t pos = entry->count;
+    if (pos && entry->resources[pos - 1]->listOrder > resource->listOrder)
+    {
+        size_t low = 0;
+        while (low < pos)
+        {
+            size_t mid = low + (pos - low) / 2;
+            if (entry->resources[mid]->listOrder < resource->listOrder)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                pos = mid;
+            }
+        }
+        memmove(&entry->resources[pos + 1], &entry->resources[pos],
+                (entry->count - pos) * sizeof(OCResource *));
+    }
+    entry->resources[pos] = resource;
+    entry->count++;
+    return OC_STACK_OK;
+
+exit:
+    OIC_LOG_V(ERROR, TAG, "Failed to index %s, falling back to full resource walks", name);
+    index->incomplete = true;
+    return OC_STACK_NO_MEMORY;
+}
+
+static void RemoveFromIndex(ResourceIndex *index, OCResource *resource, const char *name)
+{
+    ResourceIndexEntry **link = FindEntryLink(index, name);
+    ResourceIndexEntry *entry = *link;
+    if (!entry)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < entry->count; i++)
+    {
+        if (entry->resources[i] == resource)
+        {
+            memmove(&entry->resources[i], &entry->resources[i + 1],
+                    (entry->count - i - 1) * sizeof(OCResource *));
+            entry->count--;
+            break;
+        }
+    }
+
+    if (!entry->count)
+    {
+        *link = entry->next;
+        FreeEntry(entry);
+    }
+}
+
+static bool FindInIndex(ResourceIndex *index, const char *name, OCResource ***resources,
+                        size_t *count)
+{
+    if (!name || !resources || !count || index->incomplete)
+    {
+        return false;
+    }
+
+    ResourceIndexEntry *entry = *FindEntryLink(index, name);
+    *resources = entry ? entry->resources : NULL;
+    *count = entry ? entry->count : 0;
+    return true;
+}
+
+static void ClearIndex(ResourceIndex *index)
+{
+    for (size_t i = 0; i < RESOURCE_INDEX_BUCKETS; i++)
+    {
+        ResourceIndexEntry *entry = index->buckets[i];
+        while (entry)
+        {
+            ResourceIndexEntry *next = entry->next;
+            FreeEntry(entry);
+            entry = next;
+        }
+        index->buckets[i] = NULL;
+    }
+    index->incomplete = false;
+}
+
+OCStackResult IndexResourceType(OCResource *resource, const char *typeName)
+{
+    return AddToIndex(&g_typeIndex, resource, typeName);
+}
+
+OCStackResult IndexResourceInterface(OCResource *resource, const char *interfaceName)
+{
+    return AddToIndex(&g_interfaceIndex, resource, interfaceName);
+}
+
+void UnindexResource(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    for (OCResourceType *type = resource->rsrcType; type; type = type->next)
+    {
+        RemoveFromIndex(&g_typeIndex, resource, type->resourcetypename);
+    }
+    for (OCResourceInterface *iface = resource->rsrcInterface; iface; iface = iface->next)
+    {
+        RemoveFromIndex(&g_interfaceIndex, resource, iface->name);
+    }
+}
+
+bool FindIndexedResourcesByType(const char *typeName, OCResource ***resources, size_t *count)
+{
+    return FindInIndex(&g_typeIndex, typeName, resources, count);
+}
+
+bool FindIndexedResourcesByInterface(const char *interfaceName, OCResource ***resources,
+                                     size_t *count)
+{
+    return FindInIndex(&g_interfaceIndex, interfaceName, resources, count);
+}
+
+void DeleteResourceIndex()
+{
+    ClearIndex(&g_typeIndex);
+    ClearIndex(&g_interfaceIndex);
+}
@@ -43,13 +43,147 @@
 
 #define TAG  "OIC_RI_SERVERREQUEST"
 
-static struct OCServerRequest * serverRequestList = NULL;
-static struct OCServerResponse * serverResponseList = NULL;
+/** Number of request slots of the first slab of the pool; each further slab doubles it.*/
+#define SERVER_REQUEST_FIRST_SLAB (8)
+
+/** Initial number of token hash buckets; must be a power of two.*/
+#define SERVER_REQUEST_INITIAL_BUCKETS (16)
+
+/**
+ * Slab of request slots. Slabs are never moved, so a request handle stays a valid
+ * pointer into the pool until the pool is released.
+ */
+typedef struct ServerRequestSlab
+{
+    struct ServerRequestSlab *next;
+    size_t numSlots;
+    OCServerRequest slots[1];
+} ServerRequestSlab;
+
+static ServerRequestSlab *requestSlabs = NULL;
+static OCServerRequest *freeRequests = NULL;
+
+/** Pending requests hashed by token, chained through OCServerRequest::next.*/
+static OCServerRequest **requestBuckets = NULL;
+static size_t numRequestBuckets = 0;
+static size_t numRequests = 0;
+
+/** Id given to the last request added.*/
+static uint32_t lastRequestId = 0;
 
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
 
+static uint32_t HashToken(const char *token, uint8_t tokenLength)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < tokenLength; i++)
+    {
+        hash = (hash ^ (uint8_t)token[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static OCServerRequest **GetRequestBucket(const char *token, uint8_t tokenLength)
+{
+    return &requestBuckets[HashToken(token, tokenLength) & (numRequestBuckets - 1)];
+}
+
+/**
+ * Double the token hash table once it holds more than two requests per bucket. On
+ * allocation failure the table is kept as it is; lookups stay correct, just slower.
+ */
+static void GrowRequestBuckets()
+{
+    size_t newNumBuckets = numRequestBuckets ? numRequestBuckets * 2 :
+                                               SERVER_REQUEST_INITIAL_BUCKETS;
+    OCServerRequest **newBuckets =
+        (OCServerRequest **) OICCalloc(newNumBuckets, sizeof(OCServerRequest *));
+    if (!newBuckets)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to grow server request hash table");
+        return;
+    }
+
+    OCServerRequest **oldBuckets = requestBuckets;
+    size_t oldNumBuckets = numRequestBuckets;
+    requestBuckets = newBuckets;
+    numRequestBuckets = newNumBuckets;
+
+    // Rehash keeping the order of each chain, so the oldest request of a token is found first.
+    for (size_t i = 0; i < oldNumBuckets; i++)
+    {
+        OCServerRequest *request = oldBuckets[i];
+        while (request)
+        {
+            OCServerRequest *next = request->next;
+            request->next = NULL;
+            OCServerRequest **link = GetRequestBucket(request->requestToken,
+                                                      request->tokenLength);
+            while (*link)
+            {
+                link = &(*link)->next;
+            }
+            *link = request;
+            request = next;
+        }
+    }
+    OICFree(oldBuckets);
+}
+
+/**
+ * Take a request slot from the pool, adding a slab if all slots are in use.
+ */
+static OCServerRequest *AllocServerRequest()
+{
+    if (!freeRequests)
+    {
+        size_t numSlots = requestSlabs ? requestSlabs->numSlots * 2 : SERVER_REQUEST_FIRST_SLAB;
+        ServerRequestSlab *slab = (ServerRequestSlab *) OICCalloc(1, sizeof(ServerRequestSlab) +
+            (numSlots - 1) * sizeof(OCServerRequest));
+        if (!slab)
+        {
+            return NULL;
+        }
+        slab->numSlots = numSlots;
+        LL_PREPEND(requestSlabs, slab);
+        for (size_t i = numSlots; i > 0; i--)
+        {
+            LL_PREPEND(freeRequests, &slab->slots[i - 1]);
+        }
+    }
+
+    OCServerRequest *request = freeRequests;
+    freeRequests = request->next;
+    memset(request, 0, sizeof(OCServerRequest));
+    return request;
+}
+
+/**
+ * Check that a handle points to a slot of the pool that holds a request.
+ */
+static bool IsServerRequestInPool(const OCServerRequest *handle)
+{
+    if (!handle)
+    {
+        return false;
+    }
+
+    ServerRequestSlab *slab = NULL;
+    LL_FOREACH(requestSlabs, slab)
+    {
+        const OCServerRequest *first = slab->slots;
+        if (handle >= first && handle < first + slab->numSlots)
+        {
+            size_t offset = (size_t)((const char *)handle - (const char *)first);
+            return (offset % sizeof(OCServerRequest)) == 0 && handle->inUse;
+        }
+    }
+    return false;
+}
+
 /**
  * Add a server response to the server response list
  *
@@ -67,6 +201,11 @@ static OCStackResult AddServerResponse (OCServerResponse ** response, OCRequestH
     }
 
     OCServerResponse * serverResponse = NULL;
+    OCServerRequest * serverRequest = GetServerRequestUsingHandle(requestHandle);
+    if (!serverRequest)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
 
     serverResponse = (OCServerResponse *) OICCalloc(1, sizeof(OCServerResponse));
     VERIFY_NON_NULL(serverResponse);
@@ -77,7 +216,7 @@ static OCStackResult AddServerResponse (OCServerResponse ** response, OCRequestH
 
     *response = serverResponse;
     OIC_LOG(INFO, TAG, "Server Response Added!!");
-    LL_APPEND (serverResponseList, serverResponse);
+    serverRequest->response = serverResponse;
     return OC_STACK_OK;
 
 exit:
@@ -91,7 +230,22 @@ exit:
 }
 
 /**
- * Delete a server request from the server request list
+ * Delete a server response
+ *
+ * @param serverResponse - server response to delete
+ */
+static void DeleteServerResponse(OCServerResponse * serverResponse)
+{
+    if(serverResponse)
+    {
+        OCPayloadDestroy(serverResponse->payload);
+        OICFree(serverResponse);
+        OIC_LOG(INFO, TAG, "Server Response Removed!!");
+    }
+}
+
+/**
+ * Delete a server request and its response, and return its slot to the pool
  *
  * @param serverRequest - server request to delete
  */
@@ -99,49 +253,104 @@ static void DeleteServerRequest(OCServerRequest * serverRequest)
 {
     if(serverRequest)
     {
-        LL_DELETE(serverRequestList, serverRequest);
-        OICFree(serverRequest->requestToken);
-        OICFree(serverRequest);
-        serverRequest = NULL;
+        OCNotificationTarget *target = NULL;
+        OCNotificationTarget *tmp = NULL;
+        LL_FOREACH_SAFE(serverRequest->notificationTargets, target, tmp)
+        {
+            LL_DELETE(serverRequest->notificationTargets, target);
+            OICFree(target);
+        }
+
+        OCServerRequest **link = GetRequestBucket(serverRequest->requestToken,
+                                                  serverRequest->tokenLength);
+        while (*link && *link != serverRequest)
+        {
+            link = &(*link)->next;
+        }
+        if (*link)
+        {
+            *link = serverRequest->next;
+        }
+        numRequests--;
+
+        DeleteServerResponse(serverRequest->response);
+        OICFree(serverRequest->payload);
+        serverRequest->inUse = 0;
+        LL_PREPEND(freeRequests, serverRequest);
         OIC_LOG(INFO, TAG, "Server Request Removed!!");
     }
 }
 
 /**
- * Delete a server response from the server response list
- *
- * @param serverResponse - server response to delete
+ * Payload of a response that is written straight into its PDU by CA.
  */
-static void DeleteServerResponse(OCServerResponse * serverResponse)
+typedef struct
 {
-    if(serverResponse)
+    /** Payload encoded into the PDU, if not NULL.*/
+    OCPayload *payload;
+
+    /** Otherwise the encoded payload copied into the PDU.*/
+    const uint8_t *encoded;
+
+    /** Size of the encoded payload.*/
+    size_t encodedSize;
+} ResponsePayloadSource;
+
+/**
+ * Write the payload of a response into the payload area of its PDU.
+ * See ::CAPayloadWriter.
+ */
+static CAResult_t WriteResponsePayload(void *context, uint8_t *buffer, size_t *size)
+{
+    const ResponsePayloadSource *source = (const ResponsePayloadSource *)context;
+
+    if (source->payload)
     {
-        LL_DELETE(serverResponseList, serverResponse);
-        OCPayloadDestroy(serverResponse->payload);
-        OICFree(serverResponse);
-        OIC_LOG(INFO, TAG, "Server Response Removed!!");
+        OCStackResult result = OCConvertPayloadToBuffer(source->payload, buffer, size);
+        if (OC_STACK_NO_MEMORY == result)
+        {
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+        return (OC_STACK_OK == result) ? CA_STATUS_OK : CA_STATUS_FAILED;
     }
+
+    if (source->encodedSize > *size)
+    {
+        *size = source->encodedSize;
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    memcpy(buffer, source->encoded, source->encodedSize);
+    *size = source->encodedSize;
+    return CA_STATUS_OK;
 }
 
 /**
- * Find a server response and delete it from the server response list
+ * Set the payload of a response that was meant to be written into its PDU, for sending
+ * it the regular way.
+ *
+ * @param responseInfo CA response info without payload.
+ * @param source payload of the response.
  *
- * @param serverResponse - server response to find and delete
+ * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static void FindAndDeleteServerResponse(OCServerResponse * serverResponse)
+static OCStackResult SetResponsePayload(CAResponseInfo_t *responseInfo,
+                                        const ResponsePayloadSource *source)
 {
-    OCServerResponse* tmp;
-    if(serverResponse)
+    if (source->payload)
     {
-        LL_FOREACH(serverResponseList, tmp)
-        {
-            if (serverResponse == tmp)
-            {
-                DeleteServerResponse(tmp);
-                return;
-            }
-        }
+        return OCConvertPayload(source->payload, &responseInfo->info.payload,
+                                &responseInfo->info.payloadSize);
+    }
+
+    responseInfo->info.payload = (CAPayload_t)OICMalloc(source->encodedSize);
+    if (!responseInfo->info.payload)
+    {
+        OIC_LOG(ERROR, TAG, "Memory alloc for payload failed");
+        return OC_STACK_NO_MEMORY;
     }
+    memcpy(responseInfo->info.payload, source->encoded, source->encodedSize);
+    responseInfo->info.payloadSize = source->encodedSize;
+    return OC_STACK_OK;
 }
 
 /**
@@ -150,10 +359,14 @@ static void FindAndDeleteServerResponse(OCServerResponse * serverResponse)
  *
  * @param object CA remote endpoint.
  * @param requestInfo CA request info.
+ * @param source Payload written into the PDU, or NULL to send the payload of requestInfo.
+ *               If it does not fit, it is set as the payload of requestInfo and sent
+ *               block-wise.
  *
  * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t *responseInfo)
+static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t *responseInfo,
+                                    const ResponsePayloadSource *source)
 {
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
     // Add route info in RM option.
@@ -167,7 +380,26 @@ static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t
 
     // Do not include the accept header option
     responseInfo->info.acceptFormat = CA_FORMAT_UNDEFINED;
-    CAResult_t result = CASendResponse(object, responseInfo);
+
+    CAResult_t result = CA_NOT_SUPPORTED;
+    if (source && (source->payload || source->encoded))
+    {
+        result = CASendResponseWithPayloadWriter(object, responseInfo,
+                                                 WriteResponsePayload, (void *)source);
+        if (CA_NOT_SUPPORTED == result && !responseInfo->info.payload)
+        {
+            OCStackResult payloadResult = SetResponsePayload(responseInfo, source);
+            if (OC_STACK_OK != payloadResult)
+            {
+                OIC_LOG(ERROR, TAG, "Error converting payload");
+                return payloadResult;
+            }
+        }
+    }
+    if (CA_NOT_SUPPORTED == result)
+    {
+        result = CASendResponse(object, responseInfo);
+    }
     if(CA_STATUS_OK != result)
     {
         OIC_LOG_V(ERROR, TAG, "CASendResponse failed with CA error %u", result);
@@ -176,10 +408,305 @@ static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t
     return OC_STACK_OK;
 }
 
+/**
+ * Set the value of an observe option, encoded in four bytes.
+ */
+static void SetObserveOption(CAHeaderOption_t *option, uint32_t observationOption)
+{
+    option->protocolID = CA_COAP_ID;
+    option->optionID = COAP_OPTION_OBSERVE;
+    option->optionLength = sizeof(uint32_t);
+    uint8_t* observationData = (uint8_t*)option->optionData;
+    for (size_t i=sizeof(uint32_t); i; --i)
+    {
+        observationData[i-1] = observationOption & 0xFF;
+        observationOption >>=8;
+    }
+}
+
+/**
+ * Send the response of a notification request to the other observers of its group.
+ * Only the token, the message type and the observe sequence number differ from the
+ * response that was already sent, so the encoded payload and the other options are
+ * reused as they are.
+ *
+ * @param serverRequest notification request holding the targets.
+ * @param responseInfo CA response info that was sent to the first observer.
+ *
+ * @return ::OC_STACK_OK if the response was sent to all targets.
+ */
+static OCStackResult SendToNotificationTargets(const OCServerRequest *serverRequest,
+                                               CAResponseInfo_t *responseInfo)
+{
+    OCStackResult result = OC_STACK_OK;
+    OCNotificationTarget *target = NULL;
+
+    LL_FOREACH(serverRequest->notificationTargets, target)
+    {
+        CAEndpoint_t targetEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
+        CopyDevAddrToEndpoint(&target->devAddr, &targetEndpoint);
+
+        responseInfo->info.type = (target->qos == OC_HIGH_QOS) ?
+                                  CA_MSG_CONFIRM : CA_MSG_NONCONFIRM;
+        // To assign new messageId in CA.
+        responseInfo->info.messageId = 0;
+        responseInfo->info.token = target->token;
+        responseInfo->info.tokenLength = target->tokenLength;
+        if (responseInfo->info.numOptions &&
+            responseInfo->info.options[0].optionID == COAP_OPTION_OBSERVE)
+        {
+            SetObserveOption(&responseInfo->info.options[0], target->observationOption);
+        }
+
+        OCStackResult tempResult = OCSendResponse(&targetEndpoint, responseInfo, NULL);
+        if (OC_STACK_OK != tempResult)
+        {
+            OIC_LOG_V(ERROR, TAG, "Notification to %s failed", targetEndpoint.addr);
+            result = tempResult;
+        }
+    }
+    return result;
+}
+
+/**
+ * Find the ETag option in a list of header options.
+ *
+ * @param options header options.
+ * @param numOptions number of header options.
+ *
+ * @return the first ETag option, or NULL if there is none.
+ */
+static const OCHeaderOption *FindETagOption(const OCHeaderOption *options, uint8_t numOptions)
+{
+    for (uint8_t i = 0; i < numOptions; i++)
+    {
+        if (options[i].protocolID == OC_COAP_ID && options[i].optionID == COAP_OPTION_ETAG)
+        {
+            return &options[i];
+        }
+    }
+    return NULL;
+}
+
+#define ETAG_HASH_BASIS (14695981039346656037ULL)
+
+/**
+ * Add bytes to a 64 bit FNV-1a hash.
+ */
+static uint64_t HashETagBytes(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Add a string, with its terminator so that adjacent strings stay apart, to a hash.
+ */
+static uint64_t HashETagString(uint64_t hash, const char *str)
+{
+    return str ? HashETagBytes(hash, str, strlen(str) + 1) : HashETagBytes(hash, "", 1);
+}
+
+/**
+ * Write a hash as an entity tag of ::MAX_ETAG_LENGTH bytes.
+ */
+static uint8_t SetETagFromHash(uint64_t hash, uint8_t *etag)
+{
+    for (size_t i = MAX_ETAG_LENGTH; i; --i)
+    {
+        etag[i - 1] = hash & 0xFF;
+        hash >>= 8;
+    }
+    return MAX_ETAG_LENGTH;
+}
+
+/**
+ * Compute the ETag of an encoded payload, the 64 bit FNV-1a hash of its bytes.
+ *
+ * @param payload encoded payload.
+ * @param payloadSize size of the encoded payload.
+ * @param etag buffer of ::MAX_ETAG_LENGTH bytes receiving the tag.
+ *
+ * @return length of the tag.
+ */
+static uint8_t ComputePayloadETag(const uint8_t *payload, size_t payloadSize, uint8_t *etag)
+{
+    return SetETagFromHash(HashETagBytes(ETAG_HASH_BASIS, payload, payloadSize), etag);
+}
+
+static bool HashRepresentation(const OCRepPayload *payload, uint64_t *hash);
+
+/**
+ * Add the elements of an array value to a hash.
+ */
+static bool HashRepresentationArray(const OCRepPayloadValueArray *arr, uint64_t *hash)
+{
+    size_t dimTotal = calcDimTotal(arr->dimensions);
+    *hash = HashETagBytes(*hash, &arr->type, sizeof(arr->type));
+    *hash = HashETagBytes(*hash, arr->dimensions, sizeof(arr->dimensions));
+
+    for (size_t i = 0; i < dimTotal; i++)
+    {
+        switch (arr->type)
+        {
+            case OCREP_PROP_INT:
+                *hash = HashETagBytes(*hash, &arr->iArray[i], sizeof(int64_t));
+                break;
+            case OCREP_PROP_DOUBLE:
+                *hash = HashETagBytes(*hash, &arr->dArray[i], sizeof(double));
+                break;
+            case OCREP_PROP_BOOL:
+                *hash = HashETagBytes(*hash, &arr->bArray[i], sizeof(bool));
+                break;
+            case OCREP_PROP_STRING:
+                *hash = HashETagString(*hash, arr->strArray[i]);
+                break;
+            case OCREP_PROP_BYTE_STRING:
+                *hash = HashETagBytes(*hash, &arr->ocByteStrArray[i].len, sizeof(size_t));
+                *hash = HashETagBytes(*hash, arr->ocByteStrArray[i].bytes,
+                                      arr->ocByteStrArray[i].len);
+                break;
+            case OCREP_PROP_OBJECT:
+                if (!HashRepresentation(arr->objArray[i], hash))
+                {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Add a representation, its values and the representations following it to a hash.
+ *
+ * @return false if a value is still encoded, see OCRepPayloadDecodeValues().
+ */
+static bool HashRepresentation(const OCRepPayload *payload, uint64_t *hash)
+{
+    for (; payload; payload = payload->next)
+    {
+        if (payload->lazy)
+        {
+            return false;
+        }
+
+        *hash = HashETagString(*hash, payload->uri);
+        for (const OCStringLL *type = payload->types; type; type = type->next)
+        {
+            *hash = HashETagString(*hash, type->value);
+        }
+        *hash = HashETagBytes(*hash, "", 1);
+        for (const OCStringLL *itf = payload->interfaces; itf; itf = itf->next)
+        {
+            *hash = HashETagString(*hash, itf->value);
+        }
+        *hash = HashETagBytes(*hash, "", 1);
+
+        for (const OCRepPayloadValue *val = payload->values; val; val = val->next)
+        {
+            *hash = HashETagString(*hash, val->name);
+            *hash = HashETagBytes(*hash, &val->type, sizeof(val->type));
+            switch (val->type)
+            {
+                case OCREP_PROP_NULL:
+                    break;
+                case OCREP_PROP_INT:
+                    *hash = HashETagBytes(*hash, &val->i, sizeof(val->i));
+                    break;
+                case OCREP_PROP_DOUBLE:
+                    *hash = HashETagBytes(*hash, &val->d, sizeof(val->d));
+                    break;
+                case OCREP_PROP_BOOL:
+                    *hash = HashETagBytes(*hash, &val->b, sizeof(val->b));
+                    break;
+                case OCREP_PROP_STRING:
+                    *hash = HashETagString(*hash, val->str);
+                    break;
+                case OCREP_PROP_BYTE_STRING:
+                    *hash = HashETagBytes(*hash, &val->ocByteStr.len, sizeof(size_t));
+                    *hash = HashETagBytes(*hash, val->ocByteStr.bytes, val->ocByteStr.len);
+                    break;
+                case OCREP_PROP_OBJECT:
+                    if (!HashRepresentation(val->obj, hash))
+                    {
+                        return false;
+                    }
+                    break;
+                case OCREP_PROP_ARRAY:
+                    if (!HashRepresentationArray(&val->arr, hash))
+                    {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+            }
+        }
+        // Marks the end of the values, so that a child is not taken for a sibling.
+        *hash = HashETagBytes(*hash, "\xff", 1);
+    }
+    return true;
+}
+
+uint8_t ComputeRepresentationETag(const OCPayload *payload, uint8_t *etag)
+{
+    if (!payload || !etag)
+    {
+        return 0;
+    }
+
+    uint64_t hash = ETAG_HASH_BASIS;
+    switch (payload->type)
+    {
+        case PAYLOAD_TYPE_REPRESENTATION:
+            if (!HashRepresentation((const OCRepPayload *)payload, &hash))
+            {
+                return 0;
+            }
+            return SetETagFromHash(hash, etag);
+        case PAYLOAD_TYPE_ENCODED:
+        {
+            const OCEncodedPayload *encoded = (const OCEncodedPayload *)payload;
+            return ComputePayloadETag(encoded->data, encoded->size, etag);
+        }
+        default:
+            return 0;
+    }
+}
+
 //-------------------------------------------------------------------------------------------------
 // Internal APIs
 //-------------------------------------------------------------------------------------------------
 
+bool ServerRequestMatchesETag(const OCServerRequest *request, const uint8_t *etag,
+                              uint8_t etagLength)
+{
+    if (!request || !etag || !etagLength)
+    {
+        return false;
+    }
+
+    // A client may offer several stored tags; any of them validates the response.
+    for (uint8_t i = 0; i < request->numRcvdVendorSpecificHeaderOptions; i++)
+    {
+        const OCHeaderOption *option = &request->rcvdVendorSpecificHeaderOptions[i];
+        if (option->protocolID == OC_COAP_ID && option->optionID == COAP_OPTION_ETAG
+            && option->optionLength == etagLength
+            && memcmp(option->optionData, etag, etagLength) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * Get a server request from the server request list using the specified token.
  *
@@ -201,13 +728,16 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
     OIC_LOG(INFO, TAG,"Get server request with token");
     OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
 
-    OIC_LOG(INFO, TAG,"Found token");
-    LL_FOREACH (serverRequestList, out)
+    if (numRequestBuckets)
     {
-        OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->requestToken, tokenLength);
-        if(memcmp(out->requestToken, token, tokenLength) == 0)
+        for (out = *GetRequestBucket(token, tokenLength); out; out = out->next)
         {
-            return out;
+            if (out->tokenLength == tokenLength &&
+                memcmp(out->requestToken, token, tokenLength) == 0)
+            {
+                OIC_LOG(INFO, TAG,"Found token");
+                return out;
+            }
         }
     }
     OIC_LOG(ERROR, TAG, "Server Request not found!!");
@@ -223,18 +753,24 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
  */
 OCServerRequest * GetServerRequestUsingHandle (const OCServerRequest * handle)
 {
-    OCServerRequest * out = NULL;
-    LL_FOREACH (serverRequestList, out)
+    if (IsServerRequestInPool(handle))
     {
-        if(out == handle)
-        {
-            return out;
-        }
+        return (OCServerRequest *) handle;
     }
     OIC_LOG(ERROR, TAG, "Server Request not found!!");
     return NULL;
 }
 
+OCServerRequest * GetServerRequestUsingHandleAndId (const OCServerRequest * handle,
+                                                    uint32_t requestId)
+{
+    if (IsServerRequestInPool(handle) && handle->requestId == requestId)
+    {
+        return (OCServerRequest *) handle;
+    }
+    return NULL;
+}
+
 /**
  * Get a server response from the server response list using the specified handle
  *
@@ -245,13 +781,9 @@ OCServerRequest * GetServerRequestUsingHandle (const OCServerRequest * handle)
  */
 OCServerResponse * GetServerResponseUsingHandle (const OCServerRequest * handle)
 {
-    OCServerResponse * out = NULL;
-    LL_FOREACH (serverResponseList, out)
+    if (IsServerRequestInPool(handle) && handle->response)
     {
-        if(out->requestHandle == handle)
-        {
-            return out;
-        }
+        return handle->response;
     }
     OIC_LOG(ERROR, TAG, "Server Response not found!!");
     return NULL;
@@ -273,11 +805,15 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
 
     OCServerRequest * serverRequest = NULL;
 
+    VERIFY_NON_NULL(devAddr);
     OIC_LOG_V(INFO, TAG, "addserverrequest entry!! [%s:%u]", devAddr->addr, devAddr->port);
 
-    serverRequest = (OCServerRequest *) OICCalloc(1, sizeof(OCServerRequest) +
-        (reqTotalSize ? reqTotalSize : 1) - 1);
-    VERIFY_NON_NULL(devAddr);
+    if (tokenLength > CA_MAX_TOKEN_LEN || (tokenLength && !requestToken))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    serverRequest = AllocServerRequest();
     VERIFY_NON_NULL(serverRequest);
 
     serverRequest->coapID = coapID;
@@ -303,26 +839,11 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
         memcpy(serverRequest->rcvdVendorSpecificHeaderOptions, rcvdVendorSpecificHeaderOptions,
             MAX_HEADER_OPTIONS * sizeof(OCHeaderOption));
     }
-    if(payload && reqTotalSize)
-    {
-       // destination is at least 1 greater than the source, so a NULL always exists in the
-        // last character
-        memcpy(serverRequest->payload, payload, reqTotalSize);
-        serverRequest->payloadSize = reqTotalSize;
-    }
-
     serverRequest->requestComplete = 0;
-    if(requestToken)
+    serverRequest->requestToken = serverRequest->tokenBuffer;
+    if (tokenLength)
     {
-        // If tokenLength is zero, the return value depends on the
-        // particular library implementation (it may or may not be a null pointer).
-        if (tokenLength)
-        {
-            serverRequest->requestToken = (CAToken_t) OICMalloc(tokenLength);
-            VERIFY_NON_NULL(serverRequest->requestToken);
-            memcpy(serverRequest->requestToken, requestToken, tokenLength);
-        }
-
+        memcpy(serverRequest->requestToken, requestToken, tokenLength);
     }
     serverRequest->tokenLength = tokenLength;
 
@@ -334,21 +855,73 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
 
     serverRequest->devAddr = *devAddr;
 
+    if (numRequests >= numRequestBuckets * 2)
+    {
+        GrowRequestBuckets();
+    }
+    if (!numRequestBuckets)
+    {
+        LL_PREPEND(freeRequests, serverRequest);
+        serverRequest = NULL;
+        goto exit;
+    }
+
+    // Ownership of the payload passes to the request only once nothing can fail anymore.
+    if(payload && reqTotalSize)
+    {
+        serverRequest->payload = payload;
+        serverRequest->payloadSize = reqTotalSize;
+    }
+
+    serverRequest->inUse = 1;
+    serverRequest->requestId = ++lastRequestId;
+    OCServerRequest **link = GetRequestBucket(serverRequest->requestToken, tokenLength);
+    while (*link)
+    {
+        link = &(*link)->next;
+    }
+    *link = serverRequest;
+    numRequests++;
+
     *request = serverRequest;
     OIC_LOG(INFO, TAG, "Server Request Added!!");
-    LL_APPEND (serverRequestList, serverRequest);
     return OC_STACK_OK;
 
 exit:
-    if (serverRequest)
-    {
-        OICFree(serverRequest);
-        serverRequest = NULL;
-    }
     *request = NULL;
     return OC_STACK_NO_MEMORY;
 }
 
+OCStackResult AddNotificationTarget(OCServerRequest *request, const OCDevAddr *devAddr,
+                                    const CAToken_t token, uint8_t tokenLength,
+                                    OCQualityOfService qos, uint32_t observationOption)
+{
+    if (!request || !devAddr || (tokenLength && !token) || tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCNotificationTarget *target =
+        (OCNotificationTarget *) OICCalloc(1, sizeof(OCNotificationTarget));
+    if (!target)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate notification target");
+        return OC_STACK_NO_MEMORY;
+    }
+
+    target->devAddr = *devAddr;
+    target->qos = qos;
+    target->observationOption = observationOption;
+    if (tokenLength)
+    {
+        memcpy(target->token, token, tokenLength);
+    }
+    target->tokenLength = tokenLength;
+
+    LL_APPEND(request->notificationTargets, target);
+    return OC_STACK_OK;
+}
+
 OCStackResult FormOCEntityHandlerRequest(
         OCEntityHandlerRequest * entityHandlerRequest,
         OCRequestHandle request,
@@ -378,7 +951,17 @@ OCStackResult FormOCEntityHandlerRequest(
 
         if(payload && payloadSize)
         {
-            if(OCParsePayload(&entityHandlerRequest->payload, payloadType,
+            OCResource *target = (OCResource *)resource;
+            if (target && target->rawPayload && payloadType == PAYLOAD_TYPE_REPRESENTATION)
+            {
+                entityHandlerRequest->payload =
+                    (OCPayload *)OCEncodedPayloadCreate(payload, payloadSize);
+                if (!entityHandlerRequest->payload)
+                {
+                    return OC_STACK_NO_MEMORY;
+                }
+            }
+            else if(OCParsePayloadInArena(&entityHandlerRequest->payload, payloadType,
                         payload, payloadSize) != OC_STACK_OK)
             {
                 return OC_STACK_ERROR;
@@ -405,18 +988,52 @@ OCStackResult FormOCEntityHandlerRequest(
  */
 void FindAndDeleteServerRequest(OCServerRequest * serverRequest)
 {
-    OCServerRequest* tmp;
-    if(serverRequest)
+    if (IsServerRequestInPool(serverRequest))
+    {
+        DeleteServerRequest(serverRequest);
+    }
+}
+
+void ClearServerRequestResource(const OCResource * resource)
+{
+    for (size_t i = 0; i < numRequestBuckets; i++)
+    {
+        OCServerRequest *request = NULL;
+        LL_FOREACH(requestBuckets[i], request)
+        {
+            if (request->resource == resource)
+            {
+                request->resource = NULL;
+            }
+        }
+    }
+}
+
+void DeleteServerRequestList()
+{
+    ServerRequestSlab *slab = NULL;
+    ServerRequestSlab *tmp = NULL;
+    LL_FOREACH_SAFE(requestSlabs, slab, tmp)
     {
-        LL_FOREACH(serverRequestList, tmp)
+        for (size_t i = 0; i < slab->numSlots; i++)
         {
-            if (serverRequest == tmp)
+            if (slab->slots[i].inUse)
             {
-                DeleteServerRequest(tmp);
-                return;
+                DeleteServerRequest(&slab->slots[i]);
             }
         }
     }
+    LL_FOREACH_SAFE(requestSlabs, slab, tmp)
+    {
+        LL_DELETE(requestSlabs, slab);
+        OICFree(slab);
+    }
+    freeRequests = NULL;
+
+    OICFree(requestBuckets);
+    requestBuckets = NULL;
+    numRequestBuckets = 0;
+    numRequests = 0;
 }
 
 CAResponseResult_t ConvertEHResultToCAResult (OCEntityHandlerResult result, OCMethod method)
@@ -504,6 +1121,8 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
     CAResponseInfo_t responseInfo = {.result = CA_EMPTY};
     CAHeaderOption_t* optionsPointer = NULL;
+    ResponsePayloadSource source = {.payload = NULL};
+    const ResponsePayloadSource *sourcePointer = NULL;
 
     if(!ehResponse || !ehResponse->requestHandle)
     {
@@ -566,11 +1185,21 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         responseInfo.info.numOptions = ehResponse->numSendVendorSpecificHeaderOptions;
     }
 
-    if(responseInfo.info.numOptions > 0)
+    // Representations returned by GET are tagged, so that the client can validate them later.
+    const OCHeaderOption *ehETag = FindETagOption(ehResponse->sendVendorSpecificHeaderOptions,
+                                                  ehResponse->numSendVendorSpecificHeaderOptions);
+    bool tagResponse = (OC_REST_GET == serverRequest->method) && !ehETag &&
+                       (CA_CONTENT == responseInfo.result || CA_VALID == responseInfo.result);
+    uint8_t optionCapacity = responseInfo.info.numOptions + (tagResponse ? 1 : 0);
+
+    // The request forgets its resource when the resource is deleted.
+    const OCResource *resource = serverRequest->resource;
+    uint8_t resourceETagLength = (tagResponse && resource) ? resource->etagLength : 0;
+
+    if(optionCapacity > 0)
     {
         responseInfo.info.options = (CAHeaderOption_t *)
-                                      OICCalloc(responseInfo.info.numOptions,
-                                              sizeof(CAHeaderOption_t));
+                                      OICCalloc(optionCapacity, sizeof(CAHeaderOption_t));
 
         if(!responseInfo.info.options)
         {
@@ -584,17 +1213,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         // re-factored and handled in the CA layer.
         if(serverRequest->observeResult == OC_STACK_OK)
         {
-            responseInfo.info.options[0].protocolID = CA_COAP_ID;
-            responseInfo.info.options[0].optionID = COAP_OPTION_OBSERVE;
-            responseInfo.info.options[0].optionLength = sizeof(uint32_t);
-            uint8_t* observationData = (uint8_t*)responseInfo.info.options[0].optionData;
-            uint32_t observationOption= serverRequest->observationOption;
-
-            for (size_t i=sizeof(uint32_t); i; --i)
-            {
-                observationData[i-1] = observationOption & 0xFF;
-                observationOption >>=8;
-            }
+            SetObserveOption(&responseInfo.info.options[0], serverRequest->observationOption);
 
             // Point to the next header option before copying vender specific header options
             optionsPointer += 1;
@@ -617,8 +1236,40 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     responseInfo.info.payloadSize = 0;
     responseInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
 
+    // Representations are tagged from their values, so that they can still be written
+    // into the PDU.
+    uint8_t payloadETag[MAX_ETAG_LENGTH] = {0};
+    uint8_t payloadETagLength = (tagResponse && !resourceETagLength &&
+                                 !serverRequest->encodedPayload) ?
+                                ComputeRepresentationETag(ehResponse->payload, payloadETag) : 0;
+
+    // A unicast response to a single client gets its payload written straight into the PDU
+    // by CA. It is only encoded beforehand when its ETag is computed from the encoding.
+    bool writePayload = !serverRequest->notificationTargets;
+    bool hashPayload = tagResponse && !resourceETagLength && !payloadETagLength;
+
+    if (serverRequest->encodedPayload && serverRequest->encodedPayloadSize)
+    {
+        switch(serverRequest->acceptFormat)
+        {
+            case OC_FORMAT_UNDEFINED:
+            case OC_FORMAT_CBOR:
+                source.encoded = serverRequest->encodedPayload;
+                source.encodedSize = serverRequest->encodedPayloadSize;
+                if (!writePayload &&
+                    OC_STACK_OK != (result = SetResponsePayload(&responseInfo, &source)))
+                {
+                    OICFree(responseInfo.info.options);
+                    return result;
+                }
+                responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+                break;
+            default:
+                responseInfo.result = CA_NOT_ACCEPTABLE;
+        }
+    }
     // Put the JSON prefix and suffix around the payload
-    if(ehResponse->payload)
+    else if(ehResponse->payload)
     {
         if (ehResponse->payload->type == PAYLOAD_TYPE_PRESENCE)
         {
@@ -634,6 +1285,12 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
             case OC_FORMAT_UNDEFINED:
                 // No preference set by the client, so default to CBOR then
             case OC_FORMAT_CBOR:
+                if (writePayload && !responseInfo.isMulticast && !hashPayload)
+                {
+                    source.payload = ehResponse->payload;
+                    responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+                    break;
+                }
                 if((result = OCConvertPayload(ehResponse->payload, &responseInfo.info.payload,
                                 &responseInfo.info.payloadSize))
                         != OC_STACK_OK)
@@ -647,12 +1304,71 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
                 {
                     responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
                 }
+                // The encoding is copied into the PDU once.
+                source.encoded = responseInfo.info.payload;
+                source.encodedSize = responseInfo.info.payloadSize;
                 break;
             default:
                 responseInfo.result = CA_NOT_ACCEPTABLE;
         }
     }
 
+    if (OC_REST_GET == serverRequest->method &&
+        (CA_CONTENT == responseInfo.result || CA_VALID == responseInfo.result))
+    {
+        uint8_t etag[MAX_ETAG_LENGTH] = {0};
+        uint8_t etagLength = 0;
+
+        if (ehETag)
+        {
+            etagLength = (uint8_t)ehETag->optionLength;
+            memcpy(etag, ehETag->optionData, etagLength);
+        }
+        else if (resourceETagLength)
+        {
+            etagLength = resourceETagLength;
+            memcpy(etag, resource->etag, etagLength);
+        }
+        else if (payloadETagLength)
+        {
+            etagLength = payloadETagLength;
+            memcpy(etag, payloadETag, etagLength);
+        }
+        else if (source.encoded && source.encodedSize)
+        {
+            etagLength = ComputePayloadETag(source.encoded, source.encodedSize, etag);
+        }
+
+        if (etagLength && tagResponse)
+        {
+            CAHeaderOption_t *etagOption = &responseInfo.info.options[responseInfo.info.numOptions];
+            etagOption->protocolID = CA_COAP_ID;
+            etagOption->optionID = COAP_OPTION_ETAG;
+            etagOption->optionLength = etagLength;
+            memcpy(etagOption->optionData, etag, etagLength);
+            responseInfo.info.numOptions++;
+        }
+
+        // The client holds this representation already; confirm it without a payload.
+        if (etagLength && ServerRequestMatchesETag(serverRequest, etag, etagLength))
+        {
+            OIC_LOG(INFO, TAG, "ETag matched, responding with 2.03 Valid");
+            responseInfo.result = CA_VALID;
+            OICFree(responseInfo.info.payload);
+            responseInfo.info.payload = NULL;
+            responseInfo.info.payloadSize = 0;
+            responseInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
+            source.payload = NULL;
+            source.encoded = NULL;
+            source.encodedSize = 0;
+        }
+    }
+
+    if (writePayload && !responseInfo.isMulticast)
+    {
+        sourcePointer = &source;
+    }
+
 #ifdef WITH_PRESENCE
     CATransportAdapter_t CAConnTypes[] = {
                             CA_ADAPTER_IP,
@@ -694,7 +1410,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         {
             //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
             //response on all the n/w interfaces else it is set to OC_STACK_ERROR
-            tempResult = OCSendResponse(&responseEndpoint, &responseInfo);
+            tempResult = OCSendResponse(&responseEndpoint, &responseInfo, sourcePointer);
         }
         if(OC_STACK_OK != tempResult)
         {
@@ -709,9 +1425,19 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo.result);
     OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo.info.resourceUri);
 
-    result = OCSendResponse(&responseEndpoint, &responseInfo);
+    result = OCSendResponse(&responseEndpoint, &responseInfo, sourcePointer);
 #endif
 
+    // Observers grouped with this notification get the same encoded payload.
+    if (serverRequest->notificationTargets)
+    {
+        OCStackResult targetResult = SendToNotificationTargets(serverRequest, &responseInfo);
+        if (OC_STACK_OK == result)
+        {
+            result = targetResult;
+        }
+    }
+
     OICFree(responseInfo.info.payload);
     OICFree(responseInfo.info.options);
     //Delete the request
@@ -761,14 +1487,29 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
             VERIFY_NON_NULL(serverResponse);
         }
 
-        if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
+        OCRepPayload *newPayload = NULL;
+        if (ehResponse->payload->type == PAYLOAD_TYPE_ENCODED)
+        {
+            // Fragments are merged as representations, so an encoded one is parsed back.
+            OCEncodedPayload *encoded = (OCEncodedPayload *)ehResponse->payload;
+            stackRet = OCParsePayload((OCPayload **)&newPayload, PAYLOAD_TYPE_REPRESENTATION,
+                                      encoded->data, encoded->size);
+            if (OC_STACK_OK != stackRet)
+            {
+                OIC_LOG(ERROR, TAG, "Error parsing encoded payload");
+                goto exit;
+            }
+        }
+        else if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
         {
             stackRet = OC_STACK_ERROR;
             OIC_LOG(ERROR, TAG, "Error adding payload, as it was the incorrect type");
             goto exit;
         }
-
-        OCRepPayload *newPayload = OCRepPayloadClone((OCRepPayload *)ehResponse->payload);
+        else
+        {
+            newPayload = OCRepPayloadClone((OCRepPayload *)ehResponse->payload);
+        }
 
         if(!serverResponse->payload)
         {
@@ -787,9 +1528,8 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
             OIC_LOG(INFO, TAG, "This is the last response fragment");
             ehResponse->payload = serverResponse->payload;
             stackRet = HandleSingleResponse(ehResponse);
-            //Delete the request and response
+            //Delete the request and its response
             FindAndDeleteServerRequest(serverRequest);
-            FindAndDeleteServerResponse(serverResponse);
         }
         else
         {
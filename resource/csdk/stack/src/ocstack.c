@@ -43,8 +43,10 @@
 #include "ocstack.h"
 #include "ocstackinternal.h"
 #include "ocresourcehandler.h"
+#include "ocresourceindex.h"
 #include "occlientcb.h"
 #include "ocobserve.h"
+#include "octimer.h"
 #include "ocrandom.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
@@ -117,6 +119,7 @@ static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
 OCResource *headResource = NULL;
 static OCResource *tailResource = NULL;
+static uint32_t lastListOrder = 0;
 static OCResourceHandle platformResource = {0};
 static OCResourceHandle deviceResource = {0};
 #ifdef WITH_PRESENCE
@@ -131,6 +134,7 @@ static OCMode myStackMode;
 //TODO: revisit this design
 static bool gRASetInfo = false;
 #endif
+static bool gLazyPayloadDecoding = false;
 OCDeviceEntityHandler defaultDeviceHandler;
 void* defaultDeviceHandlerCallbackParameter = NULL;
 static const char COAP_TCP[] = "coap+tcp:";
@@ -271,13 +275,6 @@ static OCStackResult deleteResource(OCResource *resource);
  */
 static void deleteAllResources();
 
-/**
- * Increment resource sequence number.  Handles rollover.
- *
- * @param resPtr Pointer to resource.
- */
-static void incrementSequenceNumber(OCResource * resPtr);
-
 /*
  * Attempts to initialize every network interface that the CA Layer might have compiled in.
  *
@@ -1351,10 +1348,22 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                     return;
                 }
 
-                if(OC_STACK_OK != OCParsePayload(&response.payload,
-                            type,
-                            responseInfo->info.payload,
-                            responseInfo->info.payloadSize))
+                OCStackResult parseResult = OC_STACK_OK;
+                if (cbNode->rawPayload && type == PAYLOAD_TYPE_REPRESENTATION)
+                {
+                    response.payload = (OCPayload *)OCEncodedPayloadCreate(
+                            responseInfo->info.payload, responseInfo->info.payloadSize);
+                    parseResult = response.payload ? OC_STACK_OK : OC_STACK_NO_MEMORY;
+                }
+                else
+                {
+                    parseResult = gLazyPayloadDecoding ?
+                        OCParsePayloadLazy(&response.payload, type,
+                                responseInfo->info.payload, responseInfo->info.payloadSize) :
+                        OCParsePayloadInArena(&response.payload, type,
+                                responseInfo->info.payload, responseInfo->info.payloadSize);
+                }
+                if(OC_STACK_OK != parseResult)
                 {
                     OIC_LOG(ERROR, TAG, "Error converting payload");
                     OCPayloadDestroy(response.payload);
@@ -1365,40 +1374,34 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
             response.numRcvdVendorSpecificHeaderOptions = 0;
             if(responseInfo->info.numOptions > 0)
             {
-                int start = 0;
-                //First option always with option ID is COAP_OPTION_OBSERVE if it is available.
-                if(responseInfo->info.options[0].optionID == COAP_OPTION_OBSERVE)
+                // Options are ordered by number; an ETag option precedes COAP_OPTION_OBSERVE.
+                for (uint8_t i = 0; i < responseInfo->info.numOptions; i++)
                 {
-                    size_t i;
-                    uint32_t observationOption;
-                    uint8_t* optionData = (uint8_t*)responseInfo->info.options[0].optionData;
-                    for (observationOption=0, i=0;
-                            i<sizeof(uint32_t) && i<responseInfo->info.options[0].optionLength;
-                            i++)
+                    if(responseInfo->info.options[i].optionID == COAP_OPTION_OBSERVE)
                     {
-                        observationOption =
-                            (observationOption << 8) | optionData[i];
+                        size_t c;
+                        uint32_t observationOption;
+                        uint8_t* optionData = (uint8_t*)responseInfo->info.options[i].optionData;
+                        for (observationOption=0, c=0;
+                                c<sizeof(uint32_t) && c<responseInfo->info.options[i].optionLength;
+                                c++)
+                        {
+                            observationOption =
+                                (observationOption << 8) | optionData[c];
+                        }
+                        response.sequenceNumber = observationOption;
+                        continue;
                     }
-                    response.sequenceNumber = observationOption;
 
-                    response.numRcvdVendorSpecificHeaderOptions = responseInfo->info.numOptions - 1;
-                    start = 1;
-                }
-                else
-                {
-                    response.numRcvdVendorSpecificHeaderOptions = responseInfo->info.numOptions;
-                }
-
-                if(response.numRcvdVendorSpecificHeaderOptions > MAX_HEADER_OPTIONS)
-                {
-                    OIC_LOG(ERROR, TAG, "#header options are more than MAX_HEADER_OPTIONS");
-                    OCPayloadDestroy(response.payload);
-                    return;
-                }
+                    if(response.numRcvdVendorSpecificHeaderOptions >= MAX_HEADER_OPTIONS)
+                    {
+                        OIC_LOG(ERROR, TAG, "#header options are more than MAX_HEADER_OPTIONS");
+                        OCPayloadDestroy(response.payload);
+                        return;
+                    }
 
-                for (uint8_t i = start; i < responseInfo->info.numOptions; i++)
-                {
-                    memcpy (&(response.rcvdVendorSpecificHeaderOptions[i-start]),
+                    memcpy (&(response.rcvdVendorSpecificHeaderOptions[
+                                response.numRcvdVendorSpecificHeaderOptions++]),
                             &(responseInfo->info.options[i]), sizeof(OCHeaderOption));
                 }
             }
@@ -1725,6 +1728,9 @@ OCStackResult HandleStackRequests(OCServerProtocolRequest * protocolRequest)
             return OC_STACK_NO_MEMORY;
         }
 
+        // The payload buffer now belongs to the server request.
+        protocolRequest->payload = NULL;
+
         if(!protocolRequest->reqMorePacket)
         {
             request->requestComplete = 1;
@@ -1919,7 +1925,7 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
     serverRequest.observationOption = OC_OBSERVE_NO_OPTION;
 
     GetObserveHeaderOption(&serverRequest.observationOption, requestInfo->info.options, &tempNum);
-    if (requestInfo->info.numOptions > MAX_HEADER_OPTIONS)
+    if (tempNum > MAX_HEADER_OPTIONS)
     {
         OIC_LOG(ERROR, TAG,
                 "The request info numOptions is greater than MAX_HEADER_OPTIONS");
@@ -1962,7 +1968,8 @@ void OCHandleRequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
                 requestInfo->info.tokenLength, requestInfo->info.resourceUri);
     }
     // requestToken is fed to HandleStackRequests, which then goes to AddServerRequest.
-    // The token is copied in there, and is thus still owned by this function.
+    // The token is copied in there, and is thus still owned by this function. The payload
+    // is taken over by a new server request and is NULL here in that case.
     OICFree(serverRequest.payload);
     OICFree(serverRequest.requestToken);
     OIC_LOG(INFO, TAG, "Exit OCHandleRequests");
@@ -2280,9 +2287,15 @@ OCStackResult OCStop()
     deleteAllResources();
     DeleteDeviceInfo();
     DeletePlatformInfo();
+    DeleteDiscoveryCache();
+    DeleteResourceIndex();
     CATerminate();
     // Remove all observers
     DeleteObserverList();
+    // Remove all pending server requests
+    DeleteServerRequestList();
+    // Free the buffer payloads are encoded into
+    OCFreePayloadEncodeBuffer();
     // Remove all the client callbacks
     DeleteClientCBList();
 
@@ -2913,6 +2926,48 @@ OCStackResult OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHeaderOption
     return ret;
 }
 
+OCStackResult OCSetRequestRawPayload(OCDoHandle handle, bool raw)
+{
+    VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
+
+    ClientCB *clientCB = GetClientCB(NULL, 0, handle, NULL);
+    if (!clientCB)
+    {
+        OIC_LOG(ERROR, TAG, "Callback not found");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    clientCB->rawPayload = raw;
+    return OC_STACK_OK;
+}
+
+OCStackResult OCSetRequestTimeout(OCDoHandle handle, uint32_t timeoutMs)
+{
+    VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
+
+    if (0 == timeoutMs)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    ClientCB *clientCB = GetClientCB(NULL, 0, handle, NULL);
+    if (!clientCB)
+    {
+        OIC_LOG(ERROR, TAG, "Callback not found");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    // A TTL of 0 marks observe and presence callbacks, which never expire
+    if (0 == clientCB->TTL)
+    {
+        OIC_LOG(ERROR, TAG, "Request does not time out");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    clientCB->TTL = GetTicks(timeoutMs);
+    return OC_STACK_OK;
+}
+
 /**
  * @brief   Register Persistent storage callback.
  * @param   persistentStorageHandler [IN] Pointers to open, read, write, close & unlink handlers.
@@ -3054,6 +3109,21 @@ OCStackResult OCProcess()
 #ifdef TCP_ADAPTER
     ProcessKeepAlive();
 #endif
+
+    OCTimerProcess();
+    return OC_STACK_OK;
+}
+
+uint32_t OCGetNextProcessTimeout()
+{
+    uint64_t timeout = OCTimerGetNextTimeout();
+    return (timeout < UINT32_MAX) ? (uint32_t)timeout : UINT32_MAX;
+}
+
+OCStackResult OCSetLazyPayloadDecoding(bool enable)
+{
+    OIC_LOG_V(INFO, TAG, "Lazy payload decoding %s", enable ? "enabled" : "disabled");
+    gLazyPayloadDecoding = enable;
     return OC_STACK_OK;
 }
 
@@ -3997,6 +4067,92 @@ OCStackResult OCNotifyAllObservers(OCResourceHandle handle, OCQualityOfService q
     }
 }
 
+OCStackResult OCSetResourceNotificationMode(OCResourceHandle handle, OCNotificationMode mode)
+{
+    VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
+
+    if (mode != OC_NOTIFY_PER_OBSERVER && mode != OC_NOTIFY_SHARED_PAYLOAD)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid notification mode");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCResource *resource = findResource((OCResource *) handle);
+    if (!resource)
+    {
+        OIC_LOG(ERROR, TAG, "Resource not found");
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    resource->notificationMode = mode;
+    return OC_STACK_OK;
+}
+
+OCStackResult OCSetResourceETag(OCResourceHandle handle, const uint8_t *etag, uint8_t length)
+{
+    VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
+
+    if (etag && (length == 0 || length > MAX_ETAG_LENGTH))
+    {
+        OIC_LOG(ERROR, TAG, "Invalid ETag length");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCResource *resource = findResource((OCResource *) handle);
+    if (!resource)
+    {
+        OIC_LOG(ERROR, TAG, "Resource not found");
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    if (etag)
+    {
+        memcpy(resource->etag, etag, length);
+        resource->etagLength = length;
+    }
+    else
+    {
+        resource->etagLength = 0;
+    }
+    return OC_STACK_OK;
+}
+
+OCStackResult OCSetResourceRawPayload(OCResourceHandle handle, bool raw)
+{
+    VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
+
+    OCResource *resource = findResource((OCResource *) handle);
+    if (!resource)
+    {
+        OIC_LOG(ERROR, TAG, "Resource not found");
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    resource->rawPayload = raw;
+    return OC_STACK_OK;
+}
+
+OCStackResult OCSetObserverRateLimit(OCResourceHandle handle, OCObservationId observationId,
+                                     uint32_t minPeriod, uint32_t maxPeriod)
+{
+    VERIFY_NON_NULL(handle, ERROR, OC_STACK_INVALID_PARAM);
+
+    if (maxPeriod && maxPeriod <= minPeriod)
+    {
+        OIC_LOG(ERROR, TAG, "pmax must be greater than pmin");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCResource *resource = findResource((OCResource *) handle);
+    if (!resource)
+    {
+        OIC_LOG(ERROR, TAG, "Resource not found");
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    return SetObserverRateLimit(resource, observationId, minPeriod, maxPeriod);
+}
+
 OCStackResult
 OCNotifyListOfObservers (OCResourceHandle handle,
                          OCObservationId  *obsIdList,
@@ -4126,6 +4282,7 @@ OCStackResult OCChangeResourceProperty(OCResourceProperty * inputProperty,
     {
         *inputProperty = (OCResourceProperty) (*inputProperty | resourceProperties);
     }
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 #endif
@@ -4208,6 +4365,8 @@ void insertResource(OCResource *resource)
         tailResource = resource;
     }
     resource->next = NULL;
+    resource->listOrder = ++lastListOrder;
+    InvalidateDiscoveryCache();
 }
 
 OCResource *findResource(OCResource *resource)
@@ -4275,6 +4434,8 @@ OCStackResult deleteResource(OCResource *resource)
         {
             // Invalidate all Resource Properties.
             resource->resourceProperties = (OCResourceProperty) 0;
+            resource->deleting = true;
+            InvalidateDiscoveryCache();
 #ifdef WITH_PRESENCE
             if(resource != (OCResource *) presenceResource.handle)
             {
@@ -4311,6 +4472,10 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            // Observers and requests left behind would reach the freed resource.
+            DeleteObserversUsingResource(temp);
+            ClearServerRequestResource(temp);
+            UnindexResource(temp);
             deleteResourceElements(temp);
             OICFree(temp);
             return OC_STACK_OK;
@@ -4401,6 +4566,8 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
         }
     }
     resourceType->next = NULL;
+    IndexResourceType(resource, resourceType->resourcetypename);
+    InvalidateDiscoveryCache();
 
     OIC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
 }
@@ -4463,6 +4630,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
     OCResourceInterface *previous = NULL;
 
     newInterface->next = NULL;
+    InvalidateDiscoveryCache();
 
     OCResourceInterface **firstInterface = &(resource->rsrcInterface);
 
@@ -4524,6 +4692,8 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             previous->next = newInterface;
         }
     }
+
+    IndexResourceInterface(resource, newInterface->name);
 }
 
 OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
@@ -4618,41 +4788,39 @@ OCStackResult getQueryFromUri(const char * uri, char** query, char ** uriWithout
         return OC_STACK_NO_MEMORY;
 }
 
-static const OicUuid_t* OCGetServerInstanceID(void)
+const char* OCGetServerInstanceIDString(void)
 {
     static bool generated = false;
     static OicUuid_t sid;
-    if (generated)
-    {
-        return &sid;
-    }
+    static char sidStr[UUID_STRING_SIZE];
 
-    if (OC_STACK_OK != GetDoxmDeviceID(&sid))
+    // The device ID is read on every call, since provisioning may assign a new one.
+    OicUuid_t deviceId;
+    if (OC_STACK_OK != GetDoxmDeviceID(&deviceId))
     {
+        if (generated)
+        {
+            return sidStr;
+        }
         OIC_LOG(FATAL, TAG, "Generate UUID for Server Instance failed!");
         return NULL;
     }
-    generated = true;
-    return &sid;
-}
-
-const char* OCGetServerInstanceIDString(void)
-{
-    static bool generated = false;
-    static char sidStr[UUID_STRING_SIZE];
 
-    if(generated)
+    if (generated && memcmp(&sid, &deviceId, sizeof(sid)) == 0)
     {
         return sidStr;
     }
 
-    const OicUuid_t *sid = OCGetServerInstanceID();
-    if(OCConvertUuidToString(sid->id, sidStr) != RAND_UUID_OK)
+    if(OCConvertUuidToString(deviceId.id, sidStr) != RAND_UUID_OK)
     {
         OIC_LOG(FATAL, TAG, "Generate UUID String for Server Instance failed!");
+        generated = false;
         return NULL;
     }
 
+    // Cached discovery responses carry the previous server instance ID.
+    InvalidateDiscoveryCache();
+    sid = deviceId;
     generated = true;
     return sidStr;
 }
@@ -0,0 +1,285 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <stddef.h>
+#include "octimer.h"
+#include "oic_time.h"
+#include "logger.h"
+#include "utlist.h"
+
+#define TAG "OIC_RI_TIMER"
+
+/*
+ * The wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots. A slot of level 0
+ * spans one millisecond, a slot of level n spans all slots of level n - 1. Timers are
+ * linked in the level that covers their remaining time and move down a level ("cascade")
+ * when the lower level wraps around into their slot. Timers beyond the range of the
+ * wheel are parked in the last slot of the top level and cascaded again.
+ */
+#define TIMER_WHEEL_BITS    (6)
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK    (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS  (4)
+#define TIMER_WHEEL_RANGE   ((uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+/** Level of the timers that expired and wait for their callback.*/
+#define TIMER_LEVEL_EXPIRED (0xFF)
+
+static OCTimer *g_wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+/** Bitmap of the non-empty slots of each level.*/
+static uint64_t g_occupied[TIMER_WHEEL_LEVELS];
+
+/** Timers whose callback is due in the current OCTimerProcess() run.*/
+static OCTimer *g_expired = NULL;
+
+/** Next millisecond tick the wheel has to process.*/
+static uint64_t g_wheelTime = 0;
+
+/** Number of timers linked in the wheel or the expired list.*/
+static size_t g_numPending = 0;
+
+static uint8_t SlotOf(uint64_t time, uint8_t level)
+{
+    return (uint8_t)((time >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+}
+
+static void LinkTimer(OCTimer *timer)
+{
+    uint64_t expires = timer->expires;
+    if (expires < g_wheelTime)
+    {
+        // Already due; fire on the next tick processed.
+        expires = g_wheelTime;
+    }
+    else if (expires - g_wheelTime >= TIMER_WHEEL_RANGE)
+    {
+        expires = g_wheelTime + TIMER_WHEEL_RANGE - 1;
+    }
+
+    uint64_t delta = expires - g_wheelTime;
+    uint8_t level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1
+           && delta >= ((uint64_t)1 << (TIMER_WHEEL_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    timer->level = level;
+    timer->slot = SlotOf(expires, level);
+    DL_APPEND(g_wheel[level][timer->slot], timer);
+    g_occupied[level] |= ((uint64_t)1 << timer->slot);
+}
+
+static void UnlinkTimer(OCTimer *timer)
+{
+    if (timer->level == TIMER_LEVEL_EXPIRED)
+    {
+        DL_DELETE(g_expired, timer);
+        return;
+    }
+
+    DL_DELETE(g_wheel[timer->level][timer->slot], timer);
+    if (!g_wheel[timer->level][timer->slot])
+    {
+        g_occupied[timer->level] &= ~((uint64_t)1 << timer->slot);
+    }
+}
+
+static void Cascade(uint8_t level, uint8_t slot)
+{
+    OCTimer *timers = g_wheel[level][slot];
+    g_wheel[level][slot] = NULL;
+    g_occupied[level] &= ~((uint64_t)1 << slot);
+
+    OCTimer *timer = NULL;
+    OCTimer *tmp = NULL;
+    DL_FOREACH_SAFE(timers, timer, tmp)
+    {
+        DL_DELETE(timers, timer);
+        LinkTimer(timer);
+    }
+}
+
+/*
+ * Advance the wheel to the given time and move the timers that expired on the way to the
+ * expired list. Runs of empty level 0 slots are skipped in one step.
+ */
+static void AdvanceWheel(uint64_t now)
+{
+    while (g_wheelTime <= now)
+    {
+        uint8_t index = SlotOf(g_wheelTime, 0);
+        for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            // A lower level wrapped around; bring down the next slot of this level.
+            if (SlotOf(g_wheelTime, level - 1) != 0)
+            {
+                break;
+            }
+            Cascade(level, SlotOf(g_wheelTime, level));
+        }
+
+        OCTimer *timer = NULL;
+        OCTimer *tmp = NULL;
+        DL_FOREACH_SAFE(g_wheel[0][index], timer, tmp)
+        {
+            DL_DELETE(g_wheel[0][index], timer);
+            timer->level = TIMER_LEVEL_EXPIRED;
+            DL_APPEND(g_expired, timer);
+        }
+        g_occupied[0] &= ~((uint64_t)1 << index);
+
+        // Jump to the next occupied slot of level 0, or to the next wrap around.
+        uint64_t later = (index == TIMER_WHEEL_MASK) ? 0 : (g_occupied[0] >> (index + 1));
+        uint8_t step = TIMER_WHEEL_SLOTS - index;
+        for (uint8_t i = 1; later; i++, later >>= 1)
+        {
+            if (later & 1)
+            {
+                step = i;
+                break;
+            }
+        }
+        g_wheelTime = (g_wheelTime + step <= now + 1) ? g_wheelTime + step : now + 1;
+    }
+}
+
+void OCTimerInit(OCTimer *timer, OCTimerCallback callback, void *context)
+{
+    if (timer)
+    {
+        timer->prev = NULL;
+        timer->next = NULL;
+        timer->expires = 0;
+        timer->callback = callback;
+        timer->context = context;
+        timer->level = 0;
+        timer->slot = 0;
+        timer->pending = false;
+    }
+}
+
+OCStackResult OCTimerStart(OCTimer *timer, uint64_t delayMs)
+{
+    if (!timer || !timer->callback)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    OCTimerCancel(timer);
+    if (!g_numPending)
+    {
+        // Nothing to process in between; start the empty wheel at the current time.
+        g_wheelTime = now;
+    }
+
+    timer->expires = now + delayMs;
+    timer->pending = true;
+    LinkTimer(timer);
+    g_numPending++;
+    return OC_STACK_OK;
+}
+
+void OCTimerCancel(OCTimer *timer)
+{
+    if (timer && timer->pending)
+    {
+        UnlinkTimer(timer);
+        timer->pending = false;
+        g_numPending--;
+    }
+}
+
+bool OCTimerIsPending(const OCTimer *timer)
+{
+    return timer && timer->pending;
+}
+
+void OCTimerProcess()
+{
+    if (!g_numPending)
+    {
+        return;
+    }
+
+    AdvanceWheel(OICGetCurrentTime(TIME_IN_MS));
+
+    while (g_expired)
+    {
+        OCTimer *timer = g_expired;
+        DL_DELETE(g_expired, timer);
+        timer->pending = false;
+        g_numPending--;
+
+        // The callback may free the timer, so it must not be touched afterwards.
+        timer->callback(timer->context);
+    }
+}
+
+uint64_t OCTimerGetNextTimeout()
+{
+    if (!g_numPending)
+    {
+        return UINT64_MAX;
+    }
+    if (g_expired)
+    {
+        return 0;
+    }
+
+    uint64_t next = UINT64_MAX;
+    for (uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (!g_occupied[level])
+        {
+            continue;
+        }
+
+        // Time at which the first occupied slot of the level is reached. The current slot
+        // of an upper level was already cascaded, unless the wheel stands right at its start.
+        uint8_t shift = TIMER_WHEEL_BITS * level;
+        uint8_t current = SlotOf(g_wheelTime, level);
+        bool cascaded = (g_wheelTime & (((uint64_t)1 << shift) - 1)) != 0;
+        uint8_t first = cascaded ? (uint8_t)(current + 1) : current;
+        for (uint8_t i = 0; i < TIMER_WHEEL_SLOTS; i++)
+        {
+            uint8_t slot = (uint8_t)((first + i) & TIMER_WHEEL_MASK);
+            if (g_occupied[level] & ((uint64_t)1 << slot))
+            {
+                uint64_t distance = (uint64_t)(first - current + i) << shift;
+                uint64_t reached = ((g_wheelTime >> shift) << shift) + distance;
+                if (reached < g_wheelTime)
+                {
+                    reached = g_wheelTime;
+                }
+                if (reached < next)
+                {
+                    next = reached;
+                }
+                break;
+            }
+        }
+    }
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    return (next > now) ? next - now : 0;
+}
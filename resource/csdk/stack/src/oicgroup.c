@@ -30,7 +30,8 @@
 #include "oic_string.h"
 #include "occollection.h"
 #include "logger.h"
-#include "timer.h"
+#include "octimer.h"
+#include "oic_time.h"
 
 #include "platform_features.h"
 
@@ -105,11 +106,10 @@ typedef struct scheduledresourceinfo
     OCResource *resource;
     OCActionSet *actionset;
 
-    int timer_id;
+    OCTimer timer;
 
     OCServerRequest *ehRequest;
 
-    time_t time;
     struct scheduledresourceinfo* next;
 } ScheduledResourceInfo;
 
@@ -140,51 +140,6 @@ void AddScheduledResource(ScheduledResourceInfo **head,
     MUTEX_UNLOCK(&lock);
 }
 
-ScheduledResourceInfo* GetScheduledResource(ScheduledResourceInfo *head)
-{
-    OIC_LOG(INFO, TAG, "GetScheduledResource Entering...");
-
-    MUTEX_LOCK(&lock);
-
-    time_t t_now;
-
-    ScheduledResourceInfo *tmp = NULL;
-    tmp = head;
-
-#if !defined(WITH_ARDUINO)
-    time(&t_now);
-#else
-    t_now = now();
-#endif
-
-    if (tmp)
-    {
-        while (tmp)
-        {
-            time_t diffTm = 0;
-            diffTm = timespec_diff(tmp->time, t_now);
-
-            if (diffTm <= (time_t) 0)
-            {
-                OIC_LOG(INFO, TAG, "return Call INFO.");
-                goto exit;
-            }
-
-            tmp = tmp->next;
-        }
-    }
-
-    exit:
-
-    MUTEX_UNLOCK(&lock);
-
-    if (tmp == NULL)
-    {
-        OIC_LOG(INFO, TAG, "Cannot Find Call Info.");
-    }
-    return tmp;
-}
-
 ScheduledResourceInfo* GetScheduledResourceByActionSetName(ScheduledResourceInfo *head, char *setName)
 {
     OIC_LOG(INFO, TAG, "GetScheduledResourceByActionSetName Entering...");
@@ -252,6 +207,7 @@ void RemoveScheduledResource(ScheduledResourceInfo **head,
         }
     }
 
+    OCTimerCancel(&del->timer);
     OCFREE(del)
 
     MUTEX_UNLOCK(&lock);
@@ -974,7 +930,7 @@ OCStackResult BuildActionJSON(OCAction* action, unsigned char* bufferPtr,
     }
 
     cJSON_Delete(json);
-    free(jsonStr);
+    OICFree(jsonStr);
 
     return ret;
 }
@@ -1080,10 +1036,10 @@ OCStackResult DoAction(OCResource* resource, OCActionSet* actionset,
     return result;
 }
 
-void DoScheduledGroupAction()
+static void DoScheduledGroupAction(void *context)
 {
     OIC_LOG(INFO, TAG, "DoScheduledGroupAction Entering...");
-    ScheduledResourceInfo* info = GetScheduledResource(scheduleResourceList);
+    ScheduledResourceInfo* info = (ScheduledResourceInfo *) context;
 
     if (info == NULL)
     {
@@ -1113,36 +1069,14 @@ void DoScheduledGroupAction()
     MUTEX_UNLOCK(&lock);
 
 
-    if (info->actionset->type == RECURSIVE)
+    if (info->actionset->type == RECURSIVE && info->actionset->timesteps > 0)
     {
-        ScheduledResourceInfo *schedule;
-        schedule = (ScheduledResourceInfo *) OICMalloc(
-                sizeof(ScheduledResourceInfo));
-
-        if (schedule)
+        // Keep the call info and rearm its timer for the next period.
+        OIC_LOG(INFO, TAG, "Reregisteration.");
+        if (OCTimerStart(&info->timer,
+                (uint64_t) info->actionset->timesteps * MS_PER_SEC) == OC_STACK_OK)
         {
-            OIC_LOG(INFO, TAG, "Building New Call Info.");
-            memset(schedule, 0, sizeof(ScheduledResourceInfo));
-
-            if (info->actionset->timesteps > 0)
-            {
-                MUTEX_LOCK(&lock);
-                schedule->resource = info->resource;
-                schedule->actionset = info->actionset;
-                schedule->ehRequest = info->ehRequest;
-
-                schedule->time = registerTimer(info->actionset->timesteps,
-                        &schedule->timer_id,
-                        &DoScheduledGroupAction);
-
-                OIC_LOG(INFO, TAG, "Reregisteration.");
-                MUTEX_UNLOCK(&lock);
-                AddScheduledResource(&scheduleResourceList, schedule);
-            }
-            else
-            {
-                OICFree(schedule);
-            }
+            goto exit;
         }
     }
 
@@ -1354,18 +1288,24 @@ OCStackResult BuildCollectionGroupActionCBORResponse(
                             {
                                 OIC_LOG_V(INFO, TAG, "delay_time is %ld seconds.",
                                         actionset->timesteps);
-                                MUTEX_LOCK(&lock);
-                                schedule->time = registerTimer(delay,
-                                        &schedule->timer_id,
-                                        &DoScheduledGroupAction);
-                                MUTEX_UNLOCK(&lock);
+                                OCTimerInit(&schedule->timer,
+                                        DoScheduledGroupAction, schedule);
+                                stackRet = OCTimerStart(&schedule->timer,
+                                        (uint64_t) delay * MS_PER_SEC);
+                            }
+                            else
+                            {
+                                stackRet = OC_STACK_ERROR;
+                            }
+
+                            if (stackRet == OC_STACK_OK)
+                            {
                                 AddScheduledResource(&scheduleResourceList,
                                         schedule);
-                                stackRet = OC_STACK_OK;
                             }
                             else
                             {
-                                stackRet = OC_STACK_ERROR;
+                                OICFree(schedule);
                             }
                         }
                     }
@@ -1379,8 +1319,6 @@ OCStackResult BuildCollectionGroupActionCBORResponse(
 
             if(info != NULL)
             {
-                unregisterTimer(info->timer_id);
-
                 RemoveScheduledResource(&scheduleResourceList, info);
                 stackRet = OC_STACK_OK;
             }
@@ -28,6 +28,9 @@
 
 #define TAG "OIC_RI_RDPAYLOAD"
 
+#undef OIC_MALLOC_TAG
+#define OIC_MALLOC_TAG OIC_MEM_TAG_PAYLOAD
+
 #define CBOR_ROOT_ARRAY_LENGTH 1
 
 static int64_t OCTagsPayloadToCbor(OCTagsPayload *tags, CborEncoder *setMap);
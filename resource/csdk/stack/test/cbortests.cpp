@@ -26,6 +26,7 @@ extern "C"
     #include "ocpayloadcbor.h"
     #include "logger.h"
     #include "oic_malloc.h"
+    #include "oic_string.h"
 }
 
 #include "gtest/gtest.h"
@@ -222,3 +223,306 @@ TEST_F(CborByteStringTest, ByteStringArrayConvertParseTest )
 
     OCPayloadDestroy((OCPayload*)payload_out);
 }
+
+TEST_F(CborByteStringTest, ConvertPayloadToBufferTest)
+{
+    OCRepPayloadSetUri(payload_in, "/a/quake_sensor");
+
+    // Larger than the initial encode buffer
+    uint8_t binval[1024];
+    for (size_t i = 0; i < sizeof(binval); i++)
+    {
+        binval[i] = (uint8_t)i;
+    }
+    OCByteString quakedata_in = { binval, sizeof(binval)};
+    EXPECT_EQ(true, OCRepPayloadSetPropByteString(payload_in, "quakedata", quakedata_in));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor, &payload_cbor_size));
+    EXPECT_LT(sizeof(binval), payload_cbor_size);
+
+    // Too small a buffer reports the size needed
+    uint8_t buffer[2 * sizeof(binval)];
+    size_t size = 16;
+    EXPECT_EQ(OC_STACK_NO_MEMORY, OCConvertPayloadToBuffer((OCPayload*) payload_in, buffer, &size));
+    EXPECT_EQ(payload_cbor_size, size);
+
+    size = payload_cbor_size;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayloadToBuffer((OCPayload*) payload_in, buffer, &size));
+    ASSERT_EQ(payload_cbor_size, size);
+    EXPECT_EQ(0, memcmp(payload_cbor, buffer, size));
+
+    // Encoded again from the grown encode buffer
+    uint8_t *payload_cbor2 = NULL;
+    size_t payload_cbor_size2 = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor2, &payload_cbor_size2));
+    ASSERT_EQ(payload_cbor_size, payload_cbor_size2);
+    EXPECT_EQ(0, memcmp(payload_cbor, payload_cbor2, payload_cbor_size));
+
+    OICFree(payload_cbor);
+    OICFree(payload_cbor2);
+    OCFreePayloadEncodeBuffer();
+}
+
+TEST(CborEncodeBufferTest, ConvertNestedPayloadLargerThanBuffer)
+{
+    OCFreePayloadEncodeBuffer();
+
+    // Nested containers that overflow report less than the size they need in the end.
+    OCDiscoveryPayload *payload_in = OCDiscoveryPayloadCreate();
+    ASSERT_TRUE(NULL != payload_in);
+    payload_in->sid = OICStrdup("8af7ae23-53d6-4a28-8e6c-d76e5d5b7de2");
+    for (int i = 0; i < 16; i++)
+    {
+        OCResourcePayload *res = (OCResourcePayload *) OICCalloc(1, sizeof(OCResourcePayload));
+        ASSERT_TRUE(NULL != res);
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/a/light/with/a/long/path/%d", i);
+        res->uri = OICStrdup(uri);
+        EXPECT_TRUE(OCResourcePayloadAddStringLL(&res->types, "core.light"));
+        EXPECT_TRUE(OCResourcePayloadAddStringLL(&res->interfaces, "oic.if.baseline"));
+        res->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+        OCDiscoveryPayloadAddNewResource(payload_in, res);
+    }
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor,
+                                            &payload_cbor_size));
+
+    OCPayload *payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, PAYLOAD_TYPE_DISCOVERY,
+                                          payload_cbor, payload_cbor_size));
+    size_t count = 0;
+    for (OCResourcePayload *res = payload_out ? ((OCDiscoveryPayload *) payload_out)->resources
+                                              : NULL; res; res = res->next)
+    {
+        count++;
+    }
+    EXPECT_EQ(16u, count);
+
+    OCPayloadDestroy(payload_out);
+    OCDiscoveryPayloadDestroy(payload_in);
+    OICFree(payload_cbor);
+    OCFreePayloadEncodeBuffer();
+}
+
+TEST(CborArenaParseTest, ParseMutateAndDestroy)
+{
+    OCRepPayload *payload_in = OCRepPayloadCreate();
+    ASSERT_TRUE(NULL != payload_in);
+    OCRepPayloadSetUri(payload_in, "/a/light");
+    OCRepPayloadAddResourceType(payload_in, "core.light");
+    OCRepPayloadAddInterface(payload_in, "oic.if.baseline");
+    OCRepPayloadSetPropInt(payload_in, "power", 42);
+    OCRepPayloadSetPropString(payload_in, "name", "kitchen");
+    uint8_t binval[] = {0x1, 0x2, 0x3};
+    OCByteString bytes_in = {binval, sizeof(binval)};
+    OCRepPayloadSetPropByteString(payload_in, "bytes", bytes_in);
+
+    OCRepPayload *child_in = OCRepPayloadCreate();
+    OCRepPayloadSetPropBool(child_in, "on", true);
+    OCRepPayloadSetPropObjectAsOwner(payload_in, "state", child_in);
+
+    size_t dims[MAX_REP_ARRAY_DEPTH] = {2, 0, 0};
+    const char *strs[] = {"red", "green"};
+    OCRepPayloadSetStringArray(payload_in, "colors", strs, dims);
+
+    OCRepPayload *next_in = OCRepPayloadCreate();
+    OCRepPayloadSetUri(next_in, "/a/fan");
+    OCRepPayloadAppend(payload_in, next_in);
+
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) payload_in, &cbor, &cborSize));
+    OCRepPayloadDestroy(payload_in);
+
+    OCRepPayload *payload_out = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayloadInArena((OCPayload **) &payload_out,
+            PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize));
+    OICFree(cbor);
+
+    EXPECT_STREQ("/a/light", payload_out->uri);
+    EXPECT_STREQ("core.light", payload_out->types->value);
+    EXPECT_STREQ("oic.if.baseline", payload_out->interfaces->value);
+    int64_t power = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload_out, "power", &power));
+    EXPECT_EQ(42, power);
+    char *name = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropString(payload_out, "name", &name));
+    EXPECT_STREQ("kitchen", name);
+    OICFree(name);
+    OCByteString bytes_out = {NULL, 0};
+    EXPECT_TRUE(OCRepPayloadGetPropByteString(payload_out, "bytes", &bytes_out));
+    ASSERT_EQ(sizeof(binval), bytes_out.len);
+    EXPECT_EQ(0, memcmp(binval, bytes_out.bytes, bytes_out.len));
+    OICFree(bytes_out.bytes);
+    char **colors = NULL;
+    size_t dims_out[MAX_REP_ARRAY_DEPTH] = {0};
+    EXPECT_TRUE(OCRepPayloadGetStringArray(payload_out, "colors", &colors, dims_out));
+    ASSERT_EQ(2u, dims_out[0]);
+    EXPECT_STREQ("green", colors[1]);
+    OICFree(colors[0]);
+    OICFree(colors[1]);
+    OICFree(colors);
+    ASSERT_TRUE(NULL != payload_out->next);
+    EXPECT_STREQ("/a/fan", payload_out->next->uri);
+
+    // A nested payload is copied out of the arena and outlives it
+    OCRepPayload *state = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropObject(payload_out, "state", &state));
+
+    // Changes after the parse replace and add values allocated from the heap
+    EXPECT_TRUE(OCRepPayloadSetPropString(payload_out, "name", "living room"));
+    EXPECT_TRUE(OCRepPayloadSetPropInt(payload_out, "level", 7));
+    OCRepPayload *extra = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(extra, "speed", 3);
+    EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(payload_out, "extra", extra));
+    EXPECT_TRUE(OCRepPayloadSetUri(payload_out->next, "/a/fan2"));
+    EXPECT_STREQ("/a/fan2", payload_out->next->uri);
+    EXPECT_TRUE(OCRepPayloadAddResourceType(payload_out, "core.dimmer"));
+
+    EXPECT_TRUE(OCRepPayloadGetPropString(payload_out, "name", &name));
+    EXPECT_STREQ("living room", name);
+    OICFree(name);
+
+    OCRepPayload *copy = OCRepPayloadClone(payload_out);
+    OCRepPayloadDestroy(payload_out);
+
+    bool on = false;
+    EXPECT_TRUE(OCRepPayloadGetPropBool(state, "on", &on));
+    EXPECT_TRUE(on);
+    OCRepPayloadDestroy(state);
+
+    int64_t level = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(copy, "level", &level));
+    EXPECT_EQ(7, level);
+    int64_t speed = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropObject(copy, "extra", &extra));
+    EXPECT_TRUE(OCRepPayloadGetPropInt(extra, "speed", &speed));
+    EXPECT_EQ(3, speed);
+    OCRepPayloadDestroy(extra);
+    OCRepPayloadDestroy(copy);
+}
+
+TEST(CborArenaParseTest, MalformedPayload)
+{
+    // A map whose second key is cut off
+    const uint8_t cbor[] = {0x9f, 0xa2, 0x61, 0x61, 0x01, 0x61};
+    OCPayload *payload_out = NULL;
+    EXPECT_NE(OC_STACK_OK, OCParsePayloadInArena(&payload_out, PAYLOAD_TYPE_REPRESENTATION,
+            cbor, sizeof(cbor)));
+    EXPECT_EQ(NULL, payload_out);
+}
+
+TEST(CborLazyParseTest, ReadValuesOnDemand)
+{
+    OCRepPayload *payload_in = OCRepPayloadCreate();
+    ASSERT_TRUE(NULL != payload_in);
+    OCRepPayloadSetUri(payload_in, "/a/light");
+    OCRepPayloadAddResourceType(payload_in, "core.light");
+    OCRepPayloadSetPropInt(payload_in, "power", 42);
+    OCRepPayloadSetPropString(payload_in, "name", "kitchen");
+    OCRepPayloadSetNull(payload_in, "unset");
+    OCRepPayload *child_in = OCRepPayloadCreate();
+    OCRepPayloadSetPropBool(child_in, "on", true);
+    OCRepPayloadSetPropObjectAsOwner(payload_in, "state", child_in);
+    size_t dims[MAX_REP_ARRAY_DEPTH] = {3, 0, 0};
+    int64_t levels[] = {1, 2, 3};
+    OCRepPayloadSetIntArray(payload_in, "levels", levels, dims);
+    OCRepPayload *next_in = OCRepPayloadCreate();
+    OCRepPayloadSetUri(next_in, "/a/fan");
+    OCRepPayloadSetPropInt(next_in, "speed", 3);
+    OCRepPayloadAppend(payload_in, next_in);
+
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) payload_in, &cbor, &cborSize));
+    OCRepPayloadDestroy(payload_in);
+
+    OCRepPayload *payload_out = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayloadLazy((OCPayload **) &payload_out,
+            PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize));
+
+    // The properties are decoded, the values are left for the reads
+    EXPECT_STREQ("/a/light", payload_out->uri);
+    EXPECT_STREQ("core.light", payload_out->types->value);
+    EXPECT_TRUE(NULL == payload_out->values);
+    ASSERT_TRUE(NULL != payload_out->next);
+    EXPECT_STREQ("/a/fan", payload_out->next->uri);
+
+    int64_t power = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload_out, "power", &power));
+    EXPECT_EQ(42, power);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload_out, "power", &power));
+    EXPECT_EQ(42, power);
+    EXPECT_FALSE(OCRepPayloadGetPropInt(payload_out, "missing", &power));
+    EXPECT_FALSE(OCRepPayloadGetPropInt(payload_out, "href", &power));
+    EXPECT_TRUE(OCRepPayloadIsNull(payload_out, "unset"));
+    int64_t speed = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload_out->next, "speed", &speed));
+    EXPECT_EQ(3, speed);
+
+    OCRepPayload *state = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropObject(payload_out, "state", &state));
+    bool on = false;
+    EXPECT_TRUE(OCRepPayloadGetPropBool(state, "on", &on));
+    EXPECT_TRUE(on);
+    OCRepPayloadDestroy(state);
+
+    int64_t *levels_out = NULL;
+    size_t dims_out[MAX_REP_ARRAY_DEPTH] = {0};
+    EXPECT_TRUE(OCRepPayloadGetIntArray(payload_out, "levels", &levels_out, dims_out));
+    ASSERT_EQ(3u, dims_out[0]);
+    EXPECT_EQ(3, levels_out[2]);
+    OICFree(levels_out);
+    EXPECT_TRUE(NULL == payload_out->values);
+
+    // Encoding the payload again decodes all values, in their order
+    uint8_t *cbor2 = NULL;
+    size_t cborSize2 = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *) payload_out, &cbor2, &cborSize2));
+    ASSERT_EQ(cborSize, cborSize2);
+    EXPECT_EQ(0, memcmp(cbor, cbor2, cborSize));
+    OICFree(cbor2);
+    ASSERT_TRUE(NULL != payload_out->values);
+    EXPECT_STREQ("power", payload_out->values->name);
+
+    OCRepPayloadDestroy(payload_out);
+
+    // A change decodes the values first
+    ASSERT_EQ(OC_STACK_OK, OCParsePayloadLazy((OCPayload **) &payload_out,
+            PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize));
+    EXPECT_TRUE(NULL != payload_out->next->lazy);
+    EXPECT_TRUE(OCRepPayloadSetPropInt(payload_out->next, "mode", 1));
+    EXPECT_TRUE(NULL == payload_out->next->lazy);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload_out->next, "speed", &speed));
+    EXPECT_EQ(3, speed);
+    OCRepPayloadDestroy(payload_out);
+
+    // A payload that is never read frees its encoding
+    ASSERT_EQ(OC_STACK_OK, OCParsePayloadLazy((OCPayload **) &payload_out,
+            PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize));
+    OCRepPayload *copy = OCRepPayloadClone(payload_out->next);
+    OCRepPayloadDestroy(payload_out);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(copy, "speed", &speed));
+    OCRepPayloadDestroy(copy);
+    OICFree(cbor);
+}
+
+TEST(CborLazyParseTest, MalformedValue)
+{
+    // [{"a": 1, "b": undefined}], with a value of a type that is not supported
+    const uint8_t cbor[] = {0x81, 0xa2, 0x61, 0x61, 0x01, 0x61, 0x62, 0xf7};
+    OCRepPayload *payload_out = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayloadLazy((OCPayload **) &payload_out,
+            PAYLOAD_TYPE_REPRESENTATION, cbor, sizeof(cbor)));
+    int64_t a = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload_out, "a", &a));
+    EXPECT_EQ(1, a);
+    EXPECT_FALSE(OCRepPayloadIsNull(payload_out, "b"));
+    EXPECT_FALSE(OCRepPayloadDecodeValues(payload_out));
+    EXPECT_FALSE(OCRepPayloadSetPropInt(payload_out, "c", 1));
+    OCRepPayloadDestroy(payload_out);
+}
@@ -24,6 +24,12 @@ extern "C"
     #include "ocpayload.h"
     #include "ocstack.h"
     #include "ocstackinternal.h"
+    #include "ocobserve.h"
+    #include "ocresourcehandler.h"
+    #include "ocresourceindex.h"
+    #include "octimer.h"
+    #include "ocserverrequest.h"
+    #include "doxmresource.h"
     #include "logger.h"
     #include "oic_malloc.h"
 }
@@ -46,6 +52,11 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include "gtest_helper.h"
 
@@ -141,6 +152,101 @@ OCEntityHandlerResult entityHandler(OCEntityHandlerFlag /*flag*/,
     return OC_EH_OK;
 }
 
+static std::vector<std::string> gNotifiedTokens;
+static std::vector<uint32_t> gNotifiedSequenceNumbers;
+static size_t gNotificationCount = 0;
+
+OCEntityHandlerResult notificationEntityHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void* /*callbackParam*/)
+{
+    if (!(flag & OC_REQUEST_FLAG))
+    {
+        return OC_EH_OK;
+    }
+
+    OCServerRequest *request = (OCServerRequest *) entityHandlerRequest->requestHandle;
+    gNotificationCount++;
+    gNotifiedTokens.push_back(std::string(request->requestToken, request->tokenLength));
+    gNotifiedSequenceNumbers.push_back(request->observationOption);
+    for (OCNotificationTarget *target = request->notificationTargets; target;
+         target = target->next)
+    {
+        gNotifiedTokens.push_back(std::string(target->token, target->tokenLength));
+        gNotifiedSequenceNumbers.push_back(target->observationOption);
+    }
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) OCRepPayloadCreate();
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCPayloadDestroy(response.payload);
+    return OC_EH_OK;
+}
+
+static bool gRequestForgotResource = false;
+
+// Deletes its resource before it answers the request.
+OCEntityHandlerResult selfDeletingEntityHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void* /*callbackParam*/)
+{
+    if (!(flag & OC_REQUEST_FLAG))
+    {
+        return OC_EH_OK;
+    }
+
+    OCServerRequest *request = (OCServerRequest *) entityHandlerRequest->requestHandle;
+    EXPECT_TRUE(entityHandlerRequest->resource == (OCResourceHandle) request->resource);
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(entityHandlerRequest->resource));
+    gRequestForgotResource = (NULL == request->resource);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) OCRepPayloadCreate();
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCPayloadDestroy(response.payload);
+    return OC_EH_OK;
+}
+
+static OCServerRequest *gLaterRequest = NULL;
+static OCEntityHandlerResult gLaterResult = OC_EH_OK;
+
+// Answers the request, which deletes it, and has another request take its slot before
+// returning gLaterResult.
+OCEntityHandlerResult earlyResponseEntityHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void* /*callbackParam*/)
+{
+    if (!(flag & OC_REQUEST_FLAG))
+    {
+        return OC_EH_OK;
+    }
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) OCRepPayloadCreate();
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCPayloadDestroy(response.payload);
+
+    OCServerRequest *request = (OCServerRequest *) entityHandlerRequest->requestHandle;
+    char token[] = "later";
+    EXPECT_EQ(OC_STACK_OK, AddServerRequest(&gLaterRequest, 0, 0, 0, OC_REST_GET, 0,
+                                            OC_OBSERVE_NO_OPTION, OC_LOW_QOS, NULL, NULL,
+                                            NULL, token, sizeof(token) - 1, NULL, 0,
+                                            OC_FORMAT_CBOR, &request->devAddr));
+    return gLaterResult;
+}
+
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
@@ -152,6 +258,45 @@ void InitStack(OCMode mode)
     OIC_LOG(INFO, TAG, "Leaving InitStack");
 }
 
+OCStackResult AddLoopbackObserver(OCResourceHandle handle, const char *token,
+                                  const char *query, OCObservationId observeId)
+{
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.flags = OC_IP_USE_V4;
+    devAddr.port = 5683;
+    strcpy(devAddr.addr, "127.0.0.1");
+
+    return AddObserver(OCGetResourceUri(handle), query, observeId, (CAToken_t) token,
+                       (uint8_t) strlen(token), (OCResource *) handle, OC_LOW_QOS,
+                       OC_FORMAT_CBOR, &devAddr);
+}
+
+OCStackResult HandleLoopbackGetRequest(const char *uri, const char *token)
+{
+    OCServerProtocolRequest request;
+    memset(&request, 0, sizeof(request));
+    request.method = OC_REST_GET;
+    request.acceptFormat = OC_FORMAT_CBOR;
+    request.qos = OC_LOW_QOS;
+    request.observationOption = OC_OBSERVE_NO_OPTION;
+    strcpy(request.resourceUrl, uri);
+    request.devAddr.adapter = OC_ADAPTER_IP;
+    request.devAddr.flags = OC_IP_USE_V4;
+    request.devAddr.port = 5683;
+    strcpy(request.devAddr.addr, "127.0.0.1");
+    request.requestToken = (CAToken_t) token;
+    request.tokenLength = (uint8_t) strlen(token);
+
+    return HandleStackRequests(&request);
+}
+
+OCStackResult HandleLoopbackDiscoveryRequest(const char *token)
+{
+    return HandleLoopbackGetRequest(OC_RSRVD_WELL_KNOWN_URI, token);
+}
+
 uint8_t InitNumExpectedResources()
 {
 #ifdef WITH_PRESENCE
@@ -1021,6 +1166,210 @@ TEST(StackResource, StackTestResourceDiscoverManyResources)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResource, DiscoveryCacheHitAndInvalidation)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DiscoveryCacheHitAndInvalidation test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led1",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-01"));
+    GetDiscoveryCacheStatistics(&hits, &misses);
+    EXPECT_EQ(0u, hits);
+    EXPECT_EQ(1u, misses);
+
+    // An identical request is answered from the cache.
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-02"));
+    GetDiscoveryCacheStatistics(&hits, &misses);
+    EXPECT_EQ(1u, hits);
+    EXPECT_EQ(1u, misses);
+
+    // Creating a resource makes the cached response stale.
+    OCResourceHandle handle2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle2,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led2",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-03"));
+    GetDiscoveryCacheStatistics(&hits, &misses);
+    EXPECT_EQ(1u, hits);
+    EXPECT_EQ(2u, misses);
+
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-04"));
+    GetDiscoveryCacheStatistics(&hits, &misses);
+    EXPECT_EQ(2u, hits);
+    EXPECT_EQ(2u, misses);
+
+    // So does deleting one.
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle2));
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-05"));
+    GetDiscoveryCacheStatistics(&hits, &misses);
+    EXPECT_EQ(2u, hits);
+    EXPECT_EQ(3u, misses);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, DiscoveryCacheFollowsDeviceId)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DiscoveryCacheFollowsDeviceId test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-11"));
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-12"));
+    GetDiscoveryCacheStatistics(&hits, &misses);
+    EXPECT_EQ(1u, hits);
+    EXPECT_EQ(1u, misses);
+
+    // Provisioning assigns the device a new ID, which the next response has to carry.
+    OicSecDoxm_t *doxm = const_cast<OicSecDoxm_t *>(GetDoxmResourceData());
+    ASSERT_TRUE(NULL != doxm);
+    OicUuid_t oldId = doxm->deviceID;
+    std::string oldSid = OCGetServerInstanceIDString();
+    doxm->deviceID.id[0] ^= 0xFF;
+
+    EXPECT_EQ(OC_STACK_OK, HandleLoopbackDiscoveryRequest("disc-13"));
+    GetDiscoveryCacheStatistics(&hits, &misses);
+    EXPECT_EQ(1u, hits);
+    EXPECT_EQ(2u, misses);
+    EXPECT_NE(oldSid, std::string(OCGetServerInstanceIDString()));
+
+    doxm->deviceID = oldId;
+    EXPECT_EQ(oldSid, std::string(OCGetServerInstanceIDString()));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, IndexLookupInsertionAndDeletion)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting IndexLookupInsertionAndDeletion test");
+    InitStack(OC_SERVER);
+
+    OCResource **resources = NULL;
+    size_t count = 0;
+    EXPECT_TRUE(FindIndexedResourcesByType("core.led", &resources, &count));
+    EXPECT_EQ(0u, count);
+    EXPECT_EQ(NULL, resources);
+
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led1",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    OCResourceHandle handle2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle2,
+                                            "core.fan",
+                                            "core.rw",
+                                            "/a/fan1",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(handle2, "core.fanspeed"));
+
+    EXPECT_TRUE(FindIndexedResourcesByType("core.led", &resources, &count));
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ((OCResource *) handle1, resources[0]);
+
+    EXPECT_TRUE(FindIndexedResourcesByInterface("core.rw", &resources, &count));
+    ASSERT_EQ(2u, count);
+    EXPECT_EQ((OCResource *) handle1, resources[0]);
+    EXPECT_EQ((OCResource *) handle2, resources[1]);
+
+    EXPECT_TRUE(FindIndexedResourcesByInterface("core.fanspeed", &resources, &count));
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ((OCResource *) handle2, resources[0]);
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle1));
+
+    EXPECT_TRUE(FindIndexedResourcesByType("core.led", &resources, &count));
+    EXPECT_EQ(0u, count);
+    EXPECT_TRUE(FindIndexedResourcesByInterface("core.rw", &resources, &count));
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ((OCResource *) handle2, resources[0]);
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle2));
+
+    EXPECT_TRUE(FindIndexedResourcesByType("core.fan", &resources, &count));
+    EXPECT_EQ(0u, count);
+    EXPECT_TRUE(FindIndexedResourcesByInterface("core.fanspeed", &resources, &count));
+    EXPECT_EQ(0u, count);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, IndexKeepsResourceListOrder)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting IndexKeepsResourceListOrder test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handles[4];
+    const char *uris[] = { "/a/led1", "/a/led2", "/a/led3", "/a/led4" };
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handles[i],
+                                                "core.led",
+                                                "core.rw",
+                                                uris[i],
+                                                0,
+                                                NULL,
+                                                OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+
+    // Bind the type to the resources out of creation order.
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handles[3], "core.brightled"));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handles[1], "core.brightled"));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handles[2], "core.brightled"));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handles[0], "core.brightled"));
+
+    OCResource **resources = NULL;
+    size_t count = 0;
+    EXPECT_TRUE(FindIndexedResourcesByType("core.brightled", &resources, &count));
+    ASSERT_EQ(4u, count);
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ((OCResource *) handles[i], resources[i]);
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handles[2]));
+    EXPECT_TRUE(FindIndexedResourcesByType("core.brightled", &resources, &count));
+    ASSERT_EQ(3u, count);
+    EXPECT_EQ((OCResource *) handles[0], resources[0]);
+    EXPECT_EQ((OCResource *) handles[1], resources[1]);
+    EXPECT_EQ((OCResource *) handles[3], resources[2]);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackBind, BindResourceTypeNameBad)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -1412,6 +1761,345 @@ TEST(StackBind, BindEntityHandlerGood)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackBind, SetNotificationModeBad)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SetNotificationModeBad test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM,
+              OCSetResourceNotificationMode(NULL, OC_NOTIFY_SHARED_PAYLOAD));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM,
+              OCSetResourceNotificationMode(handle, (OCNotificationMode) 42));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, SetNotificationModeGood)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SetNotificationModeGood test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceNotificationMode(handle, OC_NOTIFY_SHARED_PAYLOAD));
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCNotifyAllObservers(handle, OC_NA_QOS));
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceNotificationMode(handle, OC_NOTIFY_PER_OBSERVER));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, SharedPayloadNotificationReachesEveryObserver)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SharedPayloadNotificationReachesEveryObserver test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            notificationEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceNotificationMode(handle, OC_NOTIFY_SHARED_PAYLOAD));
+
+    // Three observers without a query and two with the same query form two groups.
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-a1", NULL, 11));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-b1", "if=oic.if.baseline", 12));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-a2", NULL, 13));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-b2", "if=oic.if.baseline", 14));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-a3", NULL, 15));
+
+    gNotificationCount = 0;
+    gNotifiedTokens.clear();
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+
+    EXPECT_EQ(2u, gNotificationCount);
+    std::sort(gNotifiedTokens.begin(), gNotifiedTokens.end());
+    std::vector<std::string> expected = {"token-a1", "token-a2", "token-a3",
+                                         "token-b1", "token-b2"};
+    EXPECT_EQ(expected, gNotifiedTokens);
+
+    // Per observer mode calls the entity handler for every observer.
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceNotificationMode(handle, OC_NOTIFY_PER_OBSERVER));
+    gNotificationCount = 0;
+    gNotifiedTokens.clear();
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(5u, gNotificationCount);
+    EXPECT_EQ(5u, gNotifiedTokens.size());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, SharedPayloadGroupsFollowRegistrations)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SharedPayloadGroupsFollowRegistrations test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            notificationEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceNotificationMode(handle, OC_NOTIFY_SHARED_PAYLOAD));
+
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-a1", NULL, 11));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-b1", "if=oic.if.baseline", 12));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-a2", NULL, 13));
+
+    // The remaining member leads the group once the first one is gone.
+    char leaderToken[] = "token-a1";
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(leaderToken, sizeof(leaderToken) - 1));
+    gNotificationCount = 0;
+    gNotifiedTokens.clear();
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(2u, gNotificationCount);
+    std::vector<std::string> expected = {"token-b1", "token-a2"};
+    EXPECT_EQ(expected, gNotifiedTokens);
+
+    // A group left empty is gone; a new observer with its query starts a new one.
+    char onlyToken[] = "token-b1";
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken(onlyToken, sizeof(onlyToken) - 1));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-b2", "if=oic.if.baseline", 14));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-a3", NULL, 15));
+    gNotificationCount = 0;
+    gNotifiedTokens.clear();
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(2u, gNotificationCount);
+    expected = {"token-a2", "token-a3", "token-b2"};
+    EXPECT_EQ(expected, gNotifiedTokens);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, SetObserverRateLimit)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SetObserverRateLimit test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetObserverRateLimit(NULL, 1, 1, 10));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetObserverRateLimit(handle, 1, 10, 10));
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCSetObserverRateLimit(handle, 1, 1, 10));
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, ObserverRateLimitDefersAndHeartbeats)
+{
+    itst::DeadmanTimer killSwitch(std::chrono::seconds(10));
+    OIC_LOG(INFO, TAG, "Starting ObserverRateLimitDefersAndHeartbeats test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            notificationEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    // The registration counts as the first notification and opens the pmin window.
+    std::chrono::steady_clock::time_point registered = std::chrono::steady_clock::now();
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-r1", "pmin=1;pmax=2", 21));
+
+    gNotificationCount = 0;
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(0u, gNotificationCount);
+
+    // Both changes are sent as one deferred notification once pmin has passed.
+    while (gNotificationCount < 1)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::chrono::steady_clock::time_point deferred = std::chrono::steady_clock::now();
+    EXPECT_EQ(1u, gNotificationCount);
+    EXPECT_LE(900, std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deferred - registered).count());
+
+    // Without further changes the observer hears from the resource again after pmax.
+    while (gNotificationCount < 2)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(2u, gNotificationCount);
+    EXPECT_LE(1900, std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - deferred).count());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, HeartbeatLeavesOtherObserversInSequence)
+{
+    itst::DeadmanTimer killSwitch(std::chrono::seconds(10));
+    OIC_LOG(INFO, TAG, "Starting HeartbeatLeavesOtherObserversInSequence test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            notificationEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-h1", "pmax=1", 41));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-h2", NULL, 42));
+
+    OCResource *resource = (OCResource *) handle;
+    uint32_t first = resource->sequenceNum + 1;
+    gNotificationCount = 0;
+    gNotifiedSequenceNumbers.clear();
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    std::vector<uint32_t> expected = {first, first};
+    EXPECT_EQ(expected, gNotifiedSequenceNumbers);
+
+    // The heartbeat gets a number of its own without moving the one of the resource.
+    while (gNotificationCount < 3)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(first, resource->sequenceNum);
+    EXPECT_EQ(first + 1, gNotifiedSequenceNumbers.back());
+
+    // The next change reaches the other observer without a gap.
+    gNotifiedSequenceNumbers.clear();
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    expected = {first + 2, first + 1};
+    EXPECT_EQ(expected, gNotifiedSequenceNumbers);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, ListNotificationHonoursPmin)
+{
+    itst::DeadmanTimer killSwitch(std::chrono::seconds(10));
+    OIC_LOG(INFO, TAG, "Starting ListNotificationHonoursPmin test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            notificationEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-l1", "pmin=1", 51));
+
+    // Inside the pmin window the change is held back and rendered when the window closes.
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCObservationId observers[] = {51};
+    gNotificationCount = 0;
+    EXPECT_EQ(OC_STACK_OK, OCNotifyListOfObservers(handle, observers, 1, payload, OC_LOW_QOS));
+    OCRepPayloadDestroy(payload);
+    ASSERT_TRUE(NULL != GetObserverUsingId(51));
+    EXPECT_TRUE(GetObserverUsingId(51)->pendingNotification);
+    EXPECT_EQ(0u, gNotificationCount);
+
+    while (gNotificationCount < 1)
+    {
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_FALSE(GetObserverUsingId(51)->pendingNotification);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, ResourceWithoutPropertiesKeepsPmin)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ResourceWithoutPropertiesKeepsPmin test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            notificationEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-p1", "pmin=1", 61));
+
+    // Clearing every property of a resource does not make it look deleted.
+    OCResource *resource = (OCResource *) handle;
+    EXPECT_EQ(OC_STACK_OK, OCChangeResourceProperty(&resource->resourceProperties,
+            (OCResourceProperty) (OC_ACTIVE|OC_DISCOVERABLE|OC_OBSERVABLE), 0));
+    EXPECT_EQ(0, resource->resourceProperties);
+    gNotificationCount = 0;
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(0u, gNotificationCount);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, DeleteResourceDeletesRateLimitedObservers)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DeleteResourceDeletesRateLimitedObservers test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            notificationEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, AddLoopbackObserver(handle, "token-d1", "pmin=1;pmax=2", 31));
+
+    // The deletion is notified at once, even inside the pmin window.
+    gNotificationCount = 0;
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+    EXPECT_EQ(1u, gNotificationCount);
+
+    EXPECT_TRUE(NULL == GetObserverUsingId(31));
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackResourceAccess, GetResourceByIndex)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -1805,6 +2493,61 @@ TEST(StackPayload, CloneByteString)
     OCRepPayloadDestroy(clone);
 }
 
+TEST(StackPayload, ManyValuesKeepOrder)
+{
+    const int64_t numValues = 100;
+    char name[16];
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    ASSERT_TRUE(payload != NULL);
+    for (int64_t i = 0; i < numValues; i++)
+    {
+        snprintf(name, sizeof(name), "v%d", (int) i);
+        EXPECT_TRUE(OCRepPayloadSetPropInt(payload, name, i));
+    }
+    // Setting a value again replaces it in place.
+    EXPECT_TRUE(OCRepPayloadSetPropString(payload, "v7", "seven"));
+
+    OCRepPayload *clone = OCRepPayloadClone(payload);
+    ASSERT_TRUE(clone != NULL);
+    EXPECT_TRUE(OCRepPayloadSetPropBool(clone, "last", true));
+
+    OCRepPayload *payloads[] = { payload, clone };
+    for (size_t p = 0; p < sizeof(payloads) / sizeof(payloads[0]); p++)
+    {
+        int64_t i = 0;
+        for (OCRepPayloadValue *val = payloads[p]->values; val && i < numValues; val = val->next, i++)
+        {
+            snprintf(name, sizeof(name), "v%d", (int) i);
+            EXPECT_STREQ(name, val->name);
+
+            int64_t value = -1;
+            char *str = NULL;
+            if (7 == i)
+            {
+                EXPECT_TRUE(OCRepPayloadGetPropString(payloads[p], name, &str));
+                EXPECT_STREQ("seven", str);
+                OICFree(str);
+            }
+            else
+            {
+                EXPECT_TRUE(OCRepPayloadGetPropInt(payloads[p], name, &value));
+                EXPECT_EQ(i, value);
+            }
+        }
+        EXPECT_EQ(numValues, i);
+        EXPECT_FALSE(OCRepPayloadIsNull(payloads[p], "v0"));
+    }
+
+    bool last = false;
+    EXPECT_TRUE(OCRepPayloadGetPropBool(clone, "last", &last));
+    EXPECT_TRUE(last);
+    EXPECT_FALSE(OCRepPayloadGetPropBool(payload, "last", &last));
+
+    OCRepPayloadDestroy(payload);
+    OCRepPayloadDestroy(clone);
+}
+
 TEST(StackUri, Rfc6874_Noop_1)
 {
     char validIPv6Address[] = "FF01:0:0:0:0:0:0:FB";
@@ -1903,3 +2646,240 @@ TEST(StackUri, Rfc6874_NoOverflow_2)
     EXPECT_EQ(OC_STACK_ERROR, result);
 }
 
+
+static void timerCallback(void *context)
+{
+    (*(int *)context)++;
+}
+
+TEST(StackTimer, FireAndCancel)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(UINT32_MAX, OCGetNextProcessTimeout());
+
+    int fired = 0;
+    int cancelled = 0;
+    OCTimer timer;
+    OCTimer other;
+    OCTimerInit(&timer, timerCallback, &fired);
+    OCTimerInit(&other, timerCallback, &cancelled);
+
+    EXPECT_EQ(OC_STACK_OK, OCTimerStart(&timer, 20));
+    EXPECT_EQ(OC_STACK_OK, OCTimerStart(&other, 10));
+    EXPECT_TRUE(OCTimerIsPending(&timer));
+    EXPECT_GE(20u, OCGetNextProcessTimeout());
+
+    OCTimerCancel(&other);
+    EXPECT_FALSE(OCTimerIsPending(&other));
+
+    while (OCTimerIsPending(&timer))
+    {
+        OCTimerProcess();
+    }
+    EXPECT_EQ(1, fired);
+    EXPECT_EQ(0, cancelled);
+    EXPECT_EQ(UINT32_MAX, OCGetNextProcessTimeout());
+}
+
+TEST(StackServerRequest, TokenAndHandleLookup)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCDevAddr devAddr = {};
+    devAddr.adapter = OC_ADAPTER_IP;
+    char uri[] = "/a/light";
+    const int numRequests = 100;
+    OCServerRequest *requests[numRequests];
+    char tokens[numRequests][CA_MAX_TOKEN_LEN];
+
+    for (int i = 0; i < numRequests; i++)
+    {
+        memset(tokens[i], 0, sizeof(tokens[i]));
+        memcpy(tokens[i], &i, sizeof(i));
+        uint8_t *payload = (uint8_t *)OICMalloc(1);
+        ASSERT_TRUE(payload != NULL);
+        EXPECT_EQ(OC_STACK_OK, AddServerRequest(&requests[i], i, 0, 0, OC_REST_PUT, 0,
+                                                OC_OBSERVE_NO_OPTION, OC_LOW_QOS, NULL, NULL,
+                                                payload, tokens[i], CA_MAX_TOKEN_LEN, uri, 1,
+                                                OC_FORMAT_CBOR, &devAddr));
+    }
+
+    for (int i = 0; i < numRequests; i++)
+    {
+        EXPECT_EQ(requests[i], GetServerRequestUsingToken(tokens[i], CA_MAX_TOKEN_LEN));
+        EXPECT_EQ(requests[i], GetServerRequestUsingHandle(requests[i]));
+    }
+    EXPECT_TRUE(NULL == GetServerRequestUsingToken(tokens[0], 1));
+
+    FindAndDeleteServerRequest(requests[0]);
+    EXPECT_TRUE(NULL == GetServerRequestUsingToken(tokens[0], CA_MAX_TOKEN_LEN));
+    EXPECT_TRUE(NULL == GetServerRequestUsingHandle(requests[0]));
+    EXPECT_EQ(requests[1], GetServerRequestUsingToken(tokens[1], CA_MAX_TOKEN_LEN));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    EXPECT_TRUE(NULL == GetServerRequestUsingHandle(requests[1]));
+}
+
+TEST(StackServerRequest, ETagMatch)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            0, NULL, OC_DISCOVERABLE));
+    const uint8_t etag[] = { 0x12, 0x00, 0x34 };
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetResourceETag(NULL, etag, sizeof(etag)));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetResourceETag(handle, etag, 0));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetResourceETag(handle, etag, MAX_ETAG_LENGTH + 1));
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceETag(handle, etag, sizeof(etag)));
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceETag(handle, NULL, 0));
+
+    OCHeaderOption options[MAX_HEADER_OPTIONS] = {};
+    options[0].protocolID = OC_COAP_ID;
+    options[0].optionID = 2048;
+    options[0].optionLength = 1;
+    options[1].protocolID = OC_COAP_ID;
+    options[1].optionID = CA_OPTION_ETAG;
+    options[1].optionLength = sizeof(etag);
+    memcpy(options[1].optionData, etag, sizeof(etag));
+
+    OCDevAddr devAddr = {};
+    devAddr.adapter = OC_ADAPTER_IP;
+    char uri[] = "/a/led";
+    char token[CA_MAX_TOKEN_LEN] = { 1 };
+    OCServerRequest *request = NULL;
+    EXPECT_EQ(OC_STACK_OK, AddServerRequest(&request, 1, 0, 0, OC_REST_GET, MAX_HEADER_OPTIONS,
+                                            OC_OBSERVE_NO_OPTION, OC_LOW_QOS, NULL, options,
+                                            NULL, token, CA_MAX_TOKEN_LEN, uri, 0,
+                                            OC_FORMAT_CBOR, &devAddr));
+    ASSERT_TRUE(NULL != request);
+
+    EXPECT_TRUE(ServerRequestMatchesETag(request, etag, sizeof(etag)));
+    EXPECT_FALSE(ServerRequestMatchesETag(request, etag, sizeof(etag) - 1));
+    const uint8_t other[] = { 0x12, 0x00, 0x35 };
+    EXPECT_FALSE(ServerRequestMatchesETag(request, other, sizeof(other)));
+    EXPECT_FALSE(ServerRequestMatchesETag(request, etag, 0));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackServerRequest, DefaultGetIsTaggedWithoutEncoding)
+{
+    OCRepPayload *rep = OCRepPayloadCreate();
+    OCRepPayloadSetUri(rep, "/a/light");
+    OCRepPayloadAddResourceType(rep, "core.light");
+    OCRepPayloadSetPropInt(rep, "power", 10);
+    OCRepPayloadSetPropString(rep, "name", "light");
+    OCRepPayload *child = OCRepPayloadCreate();
+    OCRepPayloadSetPropBool(child, "state", true);
+    OCRepPayloadSetPropObjectAsOwner(rep, "child", child);
+    int64_t values[] = { 1, 2, 3 };
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = { 3, 0, 0 };
+    OCRepPayloadSetIntArray(rep, "values", values, dimensions);
+
+    // The representation an entity handler answers a GET with is tagged from its values,
+    // so the response is not encoded before it is written into the PDU.
+    uint8_t etag[MAX_ETAG_LENGTH];
+    EXPECT_EQ(MAX_ETAG_LENGTH, ComputeRepresentationETag((OCPayload *)rep, etag));
+
+    OCRepPayload *same = OCRepPayloadClone(rep);
+    uint8_t sameETag[MAX_ETAG_LENGTH];
+    EXPECT_EQ(MAX_ETAG_LENGTH, ComputeRepresentationETag((OCPayload *)same, sameETag));
+    EXPECT_EQ(0, memcmp(etag, sameETag, sizeof(etag)));
+
+    OCRepPayloadSetPropBool(child, "state", false);
+    uint8_t changedETag[MAX_ETAG_LENGTH];
+    EXPECT_EQ(MAX_ETAG_LENGTH, ComputeRepresentationETag((OCPayload *)rep, changedETag));
+    EXPECT_NE(0, memcmp(etag, changedETag, sizeof(etag)));
+
+    // Other payloads are still tagged from their encoding.
+    OCDiscoveryPayload *discovery = OCDiscoveryPayloadCreate();
+    EXPECT_EQ(0, ComputeRepresentationETag((OCPayload *)discovery, etag));
+
+    OCPayloadDestroy((OCPayload *)discovery);
+    OCRepPayloadDestroy(same);
+    OCRepPayloadDestroy(rep);
+}
+
+TEST(StackServerRequest, ResponseAfterResourceDeleted)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            selfDeletingEntityHandler, NULL, OC_DISCOVERABLE));
+    const uint8_t tag[] = { 0x12, 0x00, 0x34 };
+    EXPECT_EQ(OC_STACK_OK, OCSetResourceETag(handle, tag, sizeof(tag)));
+
+    // The handler deletes the resource before it answers; the request must forget it.
+    gRequestForgotResource = false;
+    HandleLoopbackGetRequest("/a/led", "selfdel");
+    EXPECT_TRUE(gRequestForgotResource);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackServerRequest, HandlerAnsweringEarlyLeavesLaterRequestAlone)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.led", "core.rw", "/a/led",
+                                            earlyResponseEntityHandler, NULL, OC_DISCOVERABLE));
+
+    // A failing handler has the stack delete the request, but not the one now in its slot.
+    gLaterResult = OC_EH_ERROR;
+    HandleLoopbackGetRequest("/a/led", "early-1");
+    ASSERT_TRUE(NULL != gLaterRequest);
+    EXPECT_EQ(gLaterRequest, GetServerRequestUsingHandle(gLaterRequest));
+    FindAndDeleteServerRequest(gLaterRequest);
+
+    // Nor is the later request marked slow for a handler that claims to be.
+    gLaterResult = OC_EH_SLOW;
+    gLaterRequest = NULL;
+    HandleLoopbackGetRequest("/a/led", "early-2");
+    ASSERT_TRUE(NULL != gLaterRequest);
+    EXPECT_EQ(gLaterRequest, GetServerRequestUsingHandle(gLaterRequest));
+    EXPECT_EQ(0, gLaterRequest->slowFlag);
+    FindAndDeleteServerRequest(gLaterRequest);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackClientCB, RequestTimeout)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT);
+
+    OCCallbackData cbData = {};
+    cbData.cb = asyncDoResourcesCallback;
+    cbData.context = (void*)DEFAULT_CONTEXT_VALUE;
+
+    OCDevAddr devAddr = {};
+    devAddr.adapter = OC_ADAPTER_IP;
+    strcpy(devAddr.addr, "127.0.0.1");
+    devAddr.port = 5683;
+
+    OCDoHandle handle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(&handle, OC_REST_GET, "/a/light", &devAddr, NULL,
+                                        CT_ADAPTER_IP, OC_LOW_QOS, &cbData, NULL, 0));
+    ClientCB *clientCB = GetClientCB(NULL, 0, handle, NULL);
+    ASSERT_TRUE(NULL != clientCB);
+    uint32_t defaultTTL = clientCB->TTL;
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetRequestTimeout(NULL, 1000));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetRequestTimeout(handle, 0));
+    EXPECT_EQ(OC_STACK_OK, OCSetRequestTimeout(handle, 1000));
+    EXPECT_LT(clientCB->TTL, defaultTTL);
+
+    OCDoHandle observeHandle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(&observeHandle, OC_REST_OBSERVE, "/a/light", &devAddr,
+                                        NULL, CT_ADAPTER_IP, OC_LOW_QOS, &cbData, NULL, 0));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetRequestTimeout(observeHandle, 1000));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
@@ -0,0 +1,151 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+///
+/// This sample discovers every resource on the network, then reads them all
+/// twice: once one GET at a time and once with OCPlatform::getAll, printing how
+/// long each took.
+///
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "OCPlatform.h"
+#include "OCApi.h"
+
+using namespace OC;
+
+typedef std::map<OCResourceIdentifier, std::shared_ptr<OCResource>> DiscoveredResourceMap;
+
+static DiscoveredResourceMap discoveredResources;
+static std::mutex discoveredLock;
+
+void foundResource(std::shared_ptr<OCResource> resource)
+{
+    std::lock_guard<std::mutex> lock(discoveredLock);
+    if (resource && resource->uri() != OC_RSRVD_WELL_KNOWN_URI)
+    {
+        discoveredResources[resource->uniqueIdentifier()] = resource;
+    }
+}
+
+int countOk(const std::vector<RequestResult>& results)
+{
+    int ok = 0;
+    for (const RequestResult& result : results)
+    {
+        if (result.result == OC_STACK_OK)
+        {
+            ++ok;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    int discoverySeconds = 3;
+    int timeoutMs = 2000;
+    if (argc > 1)
+    {
+        discoverySeconds = std::atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        timeoutMs = std::atoi(argv[2]);
+    }
+    if (argc > 3 || discoverySeconds <= 0 || timeoutMs <= 0)
+    {
+        std::cout << "Usage : fanoutclient [discovery seconds] [timeout ms]" << std::endl;
+        return -1;
+    }
+
+    PlatformConfig cfg {
+        OC::ServiceType::InProc,
+        OC::ModeType::Client,
+        "0.0.0.0",
+        0,
+        OC::QualityOfService::LowQos
+    };
+
+    OCPlatform::Configure(cfg);
+    try
+    {
+        OCPlatform::findResource("", OC_RSRVD_WELL_KNOWN_URI, CT_DEFAULT, &foundResource);
+        std::this_thread::sleep_for(std::chrono::seconds(discoverySeconds));
+
+        std::vector<std::shared_ptr<OCResource>> resources;
+        {
+            std::lock_guard<std::mutex> lock(discoveredLock);
+            for (auto& entry : discoveredResources)
+            {
+                resources.push_back(entry.second);
+            }
+        }
+        std::cout << "Discovered " << resources.size() << " resources" << std::endl;
+        if (resources.empty())
+        {
+            return 0;
+        }
+
+        std::chrono::milliseconds timeout(timeoutMs);
+        QueryParamsMap query;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<RequestResult> sequential;
+        for (auto& resource : resources)
+        {
+            RequestFuture future = resource->getAsync(query);
+            if (std::future_status::ready == future.wait_for(timeout))
+            {
+                sequential.push_back(future.get());
+            }
+            else
+            {
+                sequential.push_back(RequestResult());
+            }
+        }
+        auto sequentialTime = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        std::vector<RequestResult> batched = OCPlatform::getAll(resources, query, timeout);
+        auto batchedTime = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Sequential get: " << countOk(sequential) << "/" << resources.size()
+                  << " in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(sequentialTime).count()
+                  << " ms" << std::endl;
+        std::cout << "getAll:         " << countOk(batched) << "/" << resources.size()
+                  << " in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(batchedTime).count()
+                  << " ms" << std::endl;
+    }
+    catch (OCException& e)
+    {
+        oclog() << "Exception in main: " << e.what();
+    }
+
+    return 0;
+}
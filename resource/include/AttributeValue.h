@@ -34,7 +34,11 @@
 #define BOOST_MPL_LIMIT_LIST_SIZE 30
 #define BOOST_MPL_LIMIT_VECTOR_SIZE 30
 #include <boost/variant.hpp>
+#include <algorithm>
 #include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
 #include <OCUtilities.h>
 namespace OC
 {
@@ -82,6 +86,179 @@ namespace OC
         std::vector<uint8_t>
     > AttributeValue;
 
+    /**
+    *   @brief  The attributes of an OCRepresentation, sorted by name in a single vector.
+    *           Copies share the vector until one of them changes it, so copying a
+    *           representation does not copy its attributes.
+    *
+    *   Only the parts of the std::map interface the representation needs are here.
+    *   Iterating is read-only and leaves the vector shared; only set, setAll, erase and
+    *   clear change it. It converts to a std::map, copying the attributes.
+    */
+    template<typename V>
+    class BasicAttributeMap
+    {
+    public:
+        typedef std::string key_type;
+        typedef V mapped_type;
+        typedef std::pair<std::string, V> value_type;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+        typedef const_iterator iterator;
+
+        const_iterator begin() const { return items().begin(); }
+        const_iterator end() const { return items().end(); }
+        const_iterator cbegin() const { return items().begin(); }
+        const_iterator cend() const { return items().end(); }
+
+        size_t size() const { return items().size(); }
+        bool empty() const { return items().empty(); }
+
+        const_iterator find(const std::string& key) const
+        {
+            const_iterator it = lowerBound(items(), key);
+            return (it != items().end() && it->first == key) ? it : items().end();
+        }
+
+        size_t count(const std::string& key) const
+        {
+            return find(key) != end() ? 1 : 0;
+        }
+
+        /**
+        *   Sets the attribute named key to value, adding it if there is none. A new key
+        *   sorting after all others is appended; any other new key moves the ones after
+        *   it, so many attributes in no particular order are better set with setAll.
+        */
+        template<typename T>
+        void set(const std::string& key, T&& value)
+        {
+            std::vector<value_type>& values = m_items.edit();
+            auto it = values.end();
+            if (!values.empty() && !(values.back().first < key))
+            {
+                it = lowerBound(values, key);
+            }
+            if (it == values.end() || it->first != key)
+            {
+                it = values.insert(it, value_type(key, V()));
+            }
+            it->second = std::forward<T>(value);
+        }
+
+        /**
+        *   Sets every attribute of items, as set would one after the other, but sorts
+        *   them once and merges them in a single pass.
+        */
+        void setAll(std::vector<value_type>&& items)
+        {
+            std::stable_sort(items.begin(), items.end(),
+                    [](const value_type& a, const value_type& b)
+                    {
+                        return a.first < b.first;
+                    });
+
+            // Of the values set for a key, the last one stays.
+            auto last = items.begin();
+            for (auto it = items.begin(); it != items.end(); ++it)
+            {
+                if (last != items.begin() && (last - 1)->first == it->first)
+                {
+                    (last - 1)->second = std::move(it->second);
+                }
+                else
+                {
+                    if (last != it)
+                    {
+                        *last = std::move(*it);
+                    }
+                    ++last;
+                }
+            }
+            items.erase(last, items.end());
+            if (items.empty())
+            {
+                return;
+            }
+
+            std::vector<value_type>& values = m_items.edit();
+            if (values.empty())
+            {
+                values.swap(items);
+                return;
+            }
+
+            std::vector<value_type> merged;
+            merged.reserve(values.size() + items.size());
+            auto current = values.begin();
+            auto added = items.begin();
+            while (current != values.end() || added != items.end())
+            {
+                if (added == items.end() ||
+                    (current != values.end() && current->first < added->first))
+                {
+                    merged.push_back(std::move(*current++));
+                }
+                else
+                {
+                    if (current != values.end() && current->first == added->first)
+                    {
+                        ++current;
+                    }
+                    merged.push_back(std::move(*added++));
+                }
+            }
+            values.swap(merged);
+        }
+
+        size_t erase(const std::string& key)
+        {
+            if (find(key) == cend())
+            {
+                return 0;
+            }
+            std::vector<value_type>& values = m_items.edit();
+            values.erase(lowerBound(values, key));
+            return 1;
+        }
+
+        void clear()
+        {
+            m_items.reset();
+        }
+
+        bool operator==(const BasicAttributeMap& other) const
+        {
+            return m_items.shares(other.m_items) || items() == other.items();
+        }
+
+        bool operator!=(const BasicAttributeMap& other) const
+        {
+            return !(*this == other);
+        }
+
+        operator std::map<std::string, V>() const
+        {
+            return std::map<std::string, V>(begin(), end());
+        }
+
+    private:
+        const std::vector<value_type>& items() const { return m_items.get(); }
+
+        template<typename Items>
+        static auto lowerBound(Items& values, const std::string& key) -> decltype(values.begin())
+        {
+            return std::lower_bound(values.begin(), values.end(), key,
+                    [](const value_type& item, const std::string& name)
+                    {
+                        return item.first < name;
+                    });
+        }
+
+        CopyOnWrite<std::vector<value_type>> m_items;
+    };
+
+    typedef BasicAttributeMap<AttributeValue> AttributeMap;
+
     enum class AttributeType
     {
         Null,
@@ -0,0 +1,133 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the executor running client callbacks and
+ * entity handlers.
+ */
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    /**
+    *   @brief  Runs client callbacks or entity handlers on a fixed set of threads or
+    *           inline on the caller.
+    *
+    *   Callbacks posted with the same key run one at a time, in the order they were
+    *   posted. The stack thread posting them holds the stack lock, so it never waits
+    *   for room: once queueSize callbacks are waiting, a callback whose key has
+    *   nothing pending runs on the posting thread instead, and one whose key has
+    *   callbacks pending is handled as its Overflow says. Only the keys with callbacks
+    *   pending can take the queue past queueSize.
+    */
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        /**
+        *   What post does with a callback once the queue is full and its key has
+        *   callbacks pending.
+        */
+        enum class Overflow
+        {
+            /** queue it behind the pending ones, past the bound. */
+            Enqueue,
+
+            /**
+            *   queue it in place of the oldest callback waiting for the key, for
+            *   callbacks that supersede the earlier ones such as observe notifications.
+            */
+            DropOldest
+        };
+
+        /**
+        *   What tryPost did with a callback.
+        */
+        enum class PostResult
+        {
+            /** it is queued. */
+            Queued,
+
+            /** the queue is full and its key has nothing pending; the caller may run it. */
+            Full,
+
+            /** the queue is full and its key has callbacks pending; it would overtake them. */
+            KeyBusy
+        };
+
+        CallbackExecutor(CallbackExecution execution, size_t threads, size_t queueSize);
+
+        /**
+        *   Runs the callbacks already posted, then stops the threads.
+        */
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        /**
+        *   Runs task after every task posted earlier with the same key.
+        */
+        void post(const void* key, Task task, Overflow overflow = Overflow::Enqueue);
+
+        /**
+        *   Like post, but leaves a task that does not fit in the queue to the caller and
+        *   never queues past the bound.
+        */
+        PostResult tryPost(const void* key, const Task& task);
+
+        /**
+        *   Whether the calling thread is one of the threads running the callbacks.
+        */
+        bool isWorkerThread() const;
+
+    private:
+        PostResult enqueue(const void* key, const Task& task, Overflow overflow, bool bounded);
+        void workerFunc();
+
+        CallbackExecution m_execution;
+        size_t m_queueSize;
+        size_t m_queued;
+        bool m_stop;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        // Keys with tasks queued or running; a key is in m_ready while it waits for a thread.
+        std::map<const void*, std::deque<Task>> m_strands;
+        std::deque<const void*> m_ready;
+        std::vector<std::thread> m_threads;
+    };
+}
+
+#endif // OC_CALLBACK_EXECUTOR_H_
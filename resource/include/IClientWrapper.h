@@ -21,9 +21,12 @@
 #ifndef OC_I_CLIENT_WRAPPER_H_
 #define OC_I_CLIENT_WRAPPER_H_
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 #include <OCApi.h>
+#include <OCDiscoverySession.h>
 
 namespace OC
 {
@@ -36,6 +39,19 @@ namespace OC
     public:
         typedef std::shared_ptr<IClientWrapper> Ptr;
 
+        /**
+        * One GET of a batch sent by GetResourceRepresentations.
+        */
+        struct GetRequest
+        {
+            OCDevAddr devAddr;
+            std::string uri;
+            HeaderOptions headerOptions;
+            GetCallback callback;
+            /** set to the outcome of sending the request. */
+            OCStackResult result;
+        };
+
         IClientWrapper()
         {}
 
@@ -52,6 +68,15 @@ namespace OC
                         FindErrorCallback& errorCallback,
                         QualityOfService QoS) = 0;
 
+        virtual OCStackResult DiscoverResources(OCDiscoverySession::Ptr* session,
+                        const std::string& serviceUrl,
+                        const std::string& resourceType,
+                        OCConnectivityType connectivityType,
+                        std::chrono::milliseconds timeout,
+                        FindResourcesCallback& callback,
+                        FindDoneCallback& doneCallback,
+                        QualityOfService QoS) = 0;
+
         virtual OCStackResult ListenForDevice(const std::string& serviceUrl,
                         const std::string& deviceURI,
                         OCConnectivityType connectivityType,
@@ -65,6 +90,11 @@ namespace OC
                         const HeaderOptions& headerOptions,
                         GetCallback& callback, QualityOfService QoS)=0;
 
+        virtual OCStackResult GetResourceRepresentations(
+                        std::vector<GetRequest>& requests,
+                        const QueryParamsMap& queryParams,
+                        QualityOfService QoS, uint32_t timeoutMs)=0;
+
         virtual OCStackResult PutResourceRepresentation(
                         const OCDevAddr& devAddr,
                         const std::string& uri,
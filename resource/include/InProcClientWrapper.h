@@ -21,8 +21,12 @@
 #ifndef OC_IN_PROC_CLIENT_WRAPPER_H_
 #define OC_IN_PROC_CLIENT_WRAPPER_H_
 
+#include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <map>
 #include <sstream>
 #include <iostream>
 
@@ -33,6 +37,22 @@
 
 namespace OC
 {
+    class CallbackExecutor;
+    class ResourceDiscovery;
+
+    namespace details
+    {
+        // The thread running OCProcess, while it runs
+        extern std::atomic<std::thread::id> processThreadId;
+
+        /**
+        * Whether responses reach the application through the calling thread, a thread
+        * running client callbacks or the one processing the stack, so that waiting on it
+        * for a response would never end.
+        */
+        bool isResponseThread();
+    }
+
     namespace ClientCallbackContext
     {
         struct GetContext
@@ -118,6 +138,12 @@ namespace OC
             const std::string& resourceType, OCConnectivityType transportFlags,
             FindCallback& callback, FindErrorCallback& errorCallback, QualityOfService QoS);
 
+        virtual OCStackResult DiscoverResources(OCDiscoverySession::Ptr* session,
+            const std::string& serviceUrl, const std::string& resourceType,
+            OCConnectivityType transportFlags, std::chrono::milliseconds timeout,
+            FindResourcesCallback& callback, FindDoneCallback& doneCallback,
+            QualityOfService QoS);
+
         virtual OCStackResult ListenForDevice(const std::string& serviceUrl,
             const std::string& deviceURI, OCConnectivityType transportFlags,
             FindDeviceCallback& callback, QualityOfService QoS);
@@ -128,6 +154,15 @@ namespace OC
             const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
             GetCallback& callback, QualityOfService QoS);
 
+        /**
+        * Sends every request of the batch in one pass under the stack lock. Each request
+        * expires timeoutMs from now; see OCSetRequestTimeout.
+        */
+        virtual OCStackResult GetResourceRepresentations(
+            std::vector<GetRequest>& requests,
+            const QueryParamsMap& queryParams,
+            QualityOfService QoS, uint32_t timeoutMs);
+
         virtual OCStackResult PutResourceRepresentation(
             const OCDevAddr& devAddr,
             const std::string& uri,
@@ -181,6 +216,7 @@ namespace OC
 
     private:
         void listeningFunc();
+        void deadlineFunc();
         std::string assembleSetResourceUri(std::string uri, const QueryParamsMap& queryParams);
         OCPayload* assembleSetResourcePayload(const OCRepresentation& attributes);
         OCHeaderOption* assembleHeaderOptions(OCHeaderOption options[],
@@ -192,6 +228,16 @@ namespace OC
 
     private:
         PlatformConfig  m_cfg;
+        std::shared_ptr<CallbackExecutor> m_callbackExecutor;
+
+        // Ends the discoveries started by DiscoverResources when their timeout expires;
+        // the thread starts with the first one.
+        std::mutex m_deadlineLock;
+        std::condition_variable m_deadlineCond;
+        std::multimap<std::chrono::steady_clock::time_point,
+                      std::weak_ptr<ResourceDiscovery>> m_deadlines;
+        std::thread m_deadlineThread;
+        bool m_deadlineStop;
     };
 }
 
@@ -22,12 +22,41 @@
 #define OC_IN_PROC_SERVER_WRAPPER_H_
 
 #include <thread>
+#include <map>
 #include <mutex>
+#include <memory>
+#include <set>
+#include <utility>
 
 #include <IServerWrapper.h>
 
 namespace OC
 {
+    class CallbackExecutor;
+    struct ResourceEntityHandler;
+
+    /**
+    *   @brief  Held while a thread other than the stack processing thread creates,
+    *           deletes or binds resources or notifies observers, and by the processing
+    *           thread while it runs an entity handler with the stack lock released. It
+    *           is always taken before the stack lock, and application code never runs
+    *           on another thread with the stack lock held but not this one, so the
+    *           processing thread may take the stack lock again while holding it. On the
+    *           processing thread the constructor does not take it at all.
+    */
+    class ResourceTableLock
+    {
+    public:
+        ResourceTableLock();
+        ~ResourceTableLock();
+
+        ResourceTableLock(const ResourceTableLock&) = delete;
+        ResourceTableLock& operator=(const ResourceTableLock&) = delete;
+
+    private:
+        bool m_locked;
+    };
+
     class InProcServerWrapper : public IServerWrapper
     {
     public:
@@ -68,10 +97,46 @@ namespace OC
         virtual OCStackResult setDefaultDeviceEntityHandler(EntityHandler entityHandler);
 
         virtual OCStackResult sendResponse(const std::shared_ptr<OCResourceResponse> pResponse);
+
+        /**
+        * Runs an application entity handler. When called from the processing thread
+        * and no resource is being changed, the stack lock is released while it runs
+        * so other threads can send requests, responses and notifications meanwhile.
+        */
+        OCEntityHandlerResult runEntityHandler(const EntityHandler& entityHandler,
+                                               std::shared_ptr<OCResourceRequest> request);
+
+        /**
+        * Hands a request to an application entity handler. With an entity handler pool
+        * the handler is queued behind earlier requests to the same resource and the
+        * stack is told to expect a slow response.
+        */
+        OCEntityHandlerResult dispatchEntityHandler(const EntityHandler& entityHandler,
+                                                    std::shared_ptr<OCResourceRequest> request);
+
+        /**
+        * Builds the request for a resource registered through this wrapper and
+        * dispatches it to the resource's entity handler.
+        */
+        OCEntityHandlerResult dispatchEntityHandler(
+                    const std::shared_ptr<ResourceEntityHandler>& resource,
+                    OCEntityHandlerFlag flag,
+                    OCEntityHandlerRequest* entityHandlerRequest);
     private:
         void processFunc();
+        void runPooledEntityHandler(const EntityHandler& entityHandler,
+                                    std::shared_ptr<OCResourceRequest> request);
         std::thread m_processThread;
         bool m_threadRun;
+        // Set on the processing thread while an entity handler runs, so a nested
+        // handler call (e.g. from a notification it sends) keeps the lock held.
+        bool m_inEntityHandler;
+        std::unique_ptr<CallbackExecutor> m_entityHandlerExecutor;
+        // Requests handed to the pool whose handler has not responded yet
+        std::mutex m_pendingLock;
+        std::set<std::pair<OCRequestHandle, OCResourceHandle>> m_pendingResponses;
+        // Owns the callback parameter of every resource registered with a handler
+        std::map<OCResourceHandle, std::shared_ptr<ResourceEntityHandler>> m_resourceHandlers;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
     };
 }
@@ -129,6 +129,34 @@ namespace OC
         NaQos       = OC_NA_QOS
     };
 
+    /** Default number of threads running client callbacks. */
+    const size_t DEFAULT_CALLBACK_THREADS = 4;
+
+    /** Default number of client callbacks that may wait for a thread. */
+    const size_t DEFAULT_CALLBACK_QUEUE_SIZE = 256;
+
+    /** Default number of threads running entity handlers. */
+    const size_t DEFAULT_ENTITY_HANDLER_THREADS = 4;
+
+    /** Default number of entity handlers that may wait for a thread. */
+    const size_t DEFAULT_ENTITY_HANDLER_QUEUE_SIZE = 256;
+
+    /**
+     * How responses to client requests are handed to the application callbacks, and
+     * requests to a server are handed to its entity handlers.
+     */
+    enum class CallbackExecution
+    {
+        /**
+         * on a fixed pool of threads, in order per request or observe handle, or per
+         * resource for entity handlers.
+         */
+        ThreadPool,
+
+        /** on the thread processing the stack, before it moves on. */
+        Inline
+    };
+
     /**
      *  Data structure to provide the configuration.
      */
@@ -158,6 +186,37 @@ namespace OC
         /** persistant storage Handler structure (open/read/write/close/unlink). */
         OCPersistentStorage        *ps;
 
+        /** where client callbacks run. */
+        CallbackExecution          callbackExecution;
+
+        /** number of threads running client callbacks with CallbackExecution::ThreadPool. */
+        size_t                     callbackThreads;
+
+        /**
+         * callbacks that may wait for a thread; past this a callback runs inline, unless
+         * callbacks of the same request are pending: it then waits behind them, and an
+         * observe or presence notification replaces the oldest one waiting for the same
+         * observe.
+         */
+        size_t                     callbackQueueSize;
+
+        /**
+         * where entity handlers run. On a pool, requests are answered as slow responses
+         * once the handler calls sendResponse; a handler returning without having
+         * responded is answered with its result and no representation, unless it
+         * returns OC_EH_SLOW.
+         */
+        CallbackExecution          entityHandlerExecution;
+
+        /** number of threads running entity handlers with CallbackExecution::ThreadPool. */
+        size_t                     entityHandlerThreads;
+
+        /**
+         * handlers that may wait for a thread; past this a handler runs inline, or, if
+         * handlers of its resource are still pending, the request is answered with an error.
+         */
+        size_t                     entityHandlerQueueSize;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
@@ -167,7 +226,13 @@ namespace OC
                 ipAddress("0.0.0.0"),
                 port(0),
                 QoS(QualityOfService::NaQos),
-                ps(nullptr)
+                ps(nullptr),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(DEFAULT_CALLBACK_THREADS),
+                callbackQueueSize(DEFAULT_CALLBACK_QUEUE_SIZE),
+                entityHandlerExecution(CallbackExecution::Inline),
+                entityHandlerThreads(DEFAULT_ENTITY_HANDLER_THREADS),
+                entityHandlerQueueSize(DEFAULT_ENTITY_HANDLER_QUEUE_SIZE)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -182,7 +247,13 @@ namespace OC
                 ipAddress(""),
                 port(0),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(DEFAULT_CALLBACK_THREADS),
+                callbackQueueSize(DEFAULT_CALLBACK_QUEUE_SIZE),
+                entityHandlerExecution(CallbackExecution::Inline),
+                entityHandlerThreads(DEFAULT_ENTITY_HANDLER_THREADS),
+                entityHandlerQueueSize(DEFAULT_ENTITY_HANDLER_QUEUE_SIZE)
         {}
             // for backward compatibility
             PlatformConfig(const ServiceType serviceType_,
@@ -198,7 +269,13 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackExecution(CallbackExecution::ThreadPool),
+                callbackThreads(DEFAULT_CALLBACK_THREADS),
+                callbackQueueSize(DEFAULT_CALLBACK_QUEUE_SIZE),
+                entityHandlerExecution(CallbackExecution::Inline),
+                entityHandlerThreads(DEFAULT_ENTITY_HANDLER_THREADS),
+                entityHandlerQueueSize(DEFAULT_ENTITY_HANDLER_QUEUE_SIZE)
         {}
     };
 
@@ -263,6 +340,11 @@ namespace OC
 
     typedef std::function<void(const std::string&, const int)> FindErrorCallback;
 
+    typedef std::function<void(const std::vector<std::shared_ptr<OCResource>>&)>
+                            FindResourcesCallback;
+
+    typedef std::function<void()> FindDoneCallback;
+
     typedef std::function<void(const OCRepresentation&)> FindDeviceCallback;
 
     typedef std::function<void(const OCRepresentation&)> FindPlatformCallback;
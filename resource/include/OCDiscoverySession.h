@@ -0,0 +1,65 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the handle to a resource discovery started
+ * with OCPlatform::findResources.
+ */
+
+#ifndef OC_DISCOVERY_SESSION_H_
+#define OC_DISCOVERY_SESSION_H_
+
+#include <memory>
+
+namespace OC
+{
+    /**
+    *   @brief  A resource discovery running until its deadline passes or it is cancelled.
+    *
+    *   Each resource is reported once, however many times it answers: the same resource
+    *   answering over IPv4 and IPv6 or to several multicast probes is recognized by its
+    *   device ID and URI. Resources are reported in batches, one per discovery response,
+    *   in the order the responses arrived, and the done callback always comes last.
+    *
+    *   Dropping the session does not stop the discovery; cancel does.
+    */
+    class OCDiscoverySession
+    {
+    public:
+        typedef std::shared_ptr<OCDiscoverySession> Ptr;
+
+        virtual ~OCDiscoverySession() {}
+
+        /**
+        *   Stops the discovery before its deadline. No batch is reported after the done
+        *   callback, which still runs once. Does nothing if the discovery is already over.
+        */
+        virtual void cancel() = 0;
+
+        /**
+        *   @return true once the deadline has passed or the discovery was cancelled
+        */
+        virtual bool isDone() const = 0;
+    };
+}
+
+#endif // OC_DISCOVERY_SESSION_H_
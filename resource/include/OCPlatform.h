@@ -29,6 +29,7 @@
 #define OC_PLATFORM_H_
 #include <OCApi.h>
 #include <OCPlatform_impl.h>
+#include <OCResourceSchema.h>
 namespace OC
 {
     /**
@@ -173,6 +174,47 @@ namespace OC
                     OCConnectivityType connectivityType, FindCallback resourceHandler,
                     FindErrorCallback errorHandler, QualityOfService QoS);
 
+        /**
+         * API for Resource Discovery reporting each resource once.
+         * @note This API applies to client side only.
+         *
+         * Unlike findResource, a resource answering several times, over IPv4 and IPv6 or
+         * to several multicast probes, is reported only once; resources are told apart by
+         * device ID and URI. The resources of each discovery response are reported
+         * together, in the order the responses arrived. When the timeout expires the
+         * discovery stops and doneHandler is called, after the last batch.
+         *
+         * @param session Handle to the discovery, which can cancel it. Dropping the handle
+         *        does not stop the discovery.
+         * @param host Host IP Address of a service to direct resource discovery query. If null or
+         *        empty, performs multicast resource discovery query
+         * @param resourceURI name of the resource. If null or empty, performs search for all
+         *       resource names
+         * @param connectivityType ::OCConnectivityType type of connectivity indicating the
+         *                           interface. Example: CT_DEFAULT, CT_ADAPTER_IP, CT_ADAPTER_TCP.
+         * @param timeout how long the discovery runs
+         * @param resourcesHandler called with the resources of each response not reported yet
+         * @param doneHandler called once when the discovery is over
+         *
+         * @return Returns ::OC_STACK_OK if success.
+         * @see findResources(OCDiscoverySession::Ptr&, const std::string&, const std::string&, OCConnectivityType, std::chrono::milliseconds, FindResourcesCallback, FindDoneCallback, QualityOfService)
+         */
+        OCStackResult findResources(OCDiscoverySession::Ptr& session, const std::string& host,
+                    const std::string& resourceURI, OCConnectivityType connectivityType,
+                    std::chrono::milliseconds timeout, FindResourcesCallback resourcesHandler,
+                    FindDoneCallback doneHandler);
+
+        /**
+         * @overload
+         *
+         * @param QoS QualityOfService the quality of communication
+         * @see findResources(OCDiscoverySession::Ptr&, const std::string&, const std::string&, OCConnectivityType, std::chrono::milliseconds, FindResourcesCallback, FindDoneCallback)
+         */
+        OCStackResult findResources(OCDiscoverySession::Ptr& session, const std::string& host,
+                    const std::string& resourceURI, OCConnectivityType connectivityType,
+                    std::chrono::milliseconds timeout, FindResourcesCallback resourcesHandler,
+                    FindDoneCallback doneHandler, QualityOfService QoS);
+
         /**
          * API for Device Discovery
          *
@@ -287,6 +329,35 @@ namespace OC
         OCStackResult registerResource(OCResourceHandle& resourceHandle,
                         const std::shared_ptr< OCResource > resource);
 
+        /**
+        * This API registers a resource whose representation is described by a schema
+        * (see OCResourceSchema.h). The resource type is taken from the schema. Requests
+        * to it skip building an OCRepresentation; the entity handler reads the request
+        * with OCResourceRequest::getSchemaRepresentation and answers with
+        * OCResourceResponse::setSchemaRepresentation.
+        * @note This API applies to server side only.
+        *
+        * @param resourceHandle Upon successful registration, resourceHandle will be filled
+        * @param resourceURI The URI of the resource. Example: "a/light"
+        * @param resourceInterface The resource interface (whether it is collection etc).
+        * @param entityHandler entity handler callback.
+        * @param resourceProperty indicates the property of the resource. Defined in ocstack.h.
+        *
+        * @return Returns ::OC_STACK_OK if success.
+        */
+        template<typename T>
+        OCStackResult registerResource(OCResourceHandle& resourceHandle,
+                        std::string& resourceURI,
+                        const std::string& resourceInterface,
+                        EntityHandler entityHandler,
+                        uint8_t resourceProperty)
+        {
+            return registerResource(resourceHandle, resourceURI,
+                                    ResourceSchema<T>::resourceType(), resourceInterface,
+                                    SchemaEntityHandler(std::move(entityHandler)),
+                                    resourceProperty);
+        }
+
         /**
         * Register Device Info
         *
@@ -572,6 +643,24 @@ namespace OC
                         const std::vector<std::string>& resourceTypes,
                         const std::vector<std::string>& interfaces);
 
+        /**
+         * GETs a set of resources at once and waits for their responses. The requests are
+         * all sent in a single pass through the stack, and the stack drops any still
+         * unanswered when the timeout expires.
+         *
+         * @param resources the resources to get
+         * @param queryParametersMap map which can have the query parameter name and value
+         * @param timeout how long to wait for the responses
+         *
+         * @return the response of each resource, in the order of resources. A resource that
+         *         did not answer in time has result OC_STACK_TIMEOUT.
+         * @throws OCException when called from a client callback, or an entity handler
+         *         run by the stack thread, which the responses would have to come through.
+         */
+        std::vector<RequestResult> getAll(const std::vector<OCResource::Ptr>& resources,
+                        const QueryParamsMap& queryParametersMap,
+                        std::chrono::milliseconds timeout);
+
         /**
          * Allows application entity handler to send response to an incoming request.
          *
@@ -29,6 +29,7 @@
 #ifndef OC_PLATFORM_IMPL_H_
 #define OC_PLATFORM_IMPL_H_
 
+#include <chrono>
 #include <map>
 
 #include "OCApi.h"
@@ -38,6 +39,7 @@
 #include "OCResourceResponse.h"
 #include "OCRepresentation.h"
 #include "OCDirectPairing.h"
+#include "OCDiscoverySession.h"
 
 #include "oc_logger.hpp"
 
@@ -88,6 +90,16 @@ namespace OC
                     OCConnectivityType connectivityType, FindCallback resourceHandler,
                     FindErrorCallback errorHandler, QualityOfService QoS);
 
+        OCStackResult findResources(OCDiscoverySession::Ptr& session, const std::string& host,
+                    const std::string& resourceURI, OCConnectivityType connectivityType,
+                    std::chrono::milliseconds timeout, FindResourcesCallback resourcesHandler,
+                    FindDoneCallback doneHandler);
+
+        OCStackResult findResources(OCDiscoverySession::Ptr& session, const std::string& host,
+                    const std::string& resourceURI, OCConnectivityType connectivityType,
+                    std::chrono::milliseconds timeout, FindResourcesCallback resourcesHandler,
+                    FindDoneCallback doneHandler, QualityOfService QoS);
+
         OCStackResult getDeviceInfo(const std::string& host, const std::string& deviceURI,
                     OCConnectivityType connectivityType, FindDeviceCallback deviceInfoHandler);
 
@@ -229,6 +241,9 @@ namespace OC
                         OCConnectivityType connectivityType, bool isObservable,
                         const std::vector<std::string>& resourceTypes,
                         const std::vector<std::string>& interfaces);
+        std::vector<RequestResult> getAll(const std::vector<OCResource::Ptr>& resources,
+                        const QueryParamsMap& queryParametersMap,
+                        std::chrono::milliseconds timeout);
         OCStackResult sendResponse(const std::shared_ptr<OCResourceResponse> pResponse);
 
         std::weak_ptr<std::recursive_mutex> csdkLock();
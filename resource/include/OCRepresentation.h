@@ -67,12 +67,24 @@ namespace OC
 
             void setPayload(const OCRepPayload* rep);
 
+            void setPayload(const OCEncodedPayload* rep);
+
             OCRepPayload* getPayload() const;
 
+            /**
+             * Encodes the representations straight to CBOR, without building an
+             * OCRepPayload. The bytes are the same OCConvertPayload writes for getPayload().
+             */
+            OCPayload* getEncodedPayload() const;
+
             const std::vector<OCRepresentation>& representations() const;
 
+            std::vector<OCRepresentation>& representations();
+
             void addRepresentation(const OCRepresentation& rep);
 
+            void addRepresentation(OCRepresentation&& rep);
+
             const OCRepresentation& operator[](int index) const
             {
                 return m_reps[index];
@@ -131,6 +143,8 @@ namespace OC
 
             void addChild(const OCRepresentation&);
 
+            void addChild(OCRepresentation&&);
+
             void clearChildren();
 
             const std::vector<OCRepresentation>& getChildren() const;
@@ -168,17 +182,17 @@ namespace OC
             template <typename T>
             void setValue(const std::string& str, const T& val)
             {
-                m_values[str] = val;
+                m_values.set(str, val);
             }
 
             // using R-value(or universal ref depending) to move string and vector<uint8_t>
             template <typename T>
             void setValue(const std::string& str, T&& val)
             {
-                m_values[str] = std::forward<T>(val);
+                m_values.set(str, std::forward<T>(val));
             }
 
-            const std::map<std::string, AttributeValue>& getValues() const {
+            const AttributeMap& getValues() const {
                 return m_values;
             }
 
@@ -272,9 +286,6 @@ namespace OC
 
             bool isNULL(const std::string& str) const;
 
-        private:
-            std::string m_host;
-
             // STL Container stuff
         public:
             class iterator;
@@ -296,7 +307,7 @@ namespace OC
                     {
                         try
                         {
-                            return boost::get<T>(m_values[m_attrName]);
+                            return boost::get<T>(value());
                         }
                         catch (boost::bad_get& e)
                         {
@@ -310,14 +321,14 @@ namespace OC
                     template<typename T>
                     AttributeItem& operator=(T&& rhs)
                     {
-                        m_values[m_attrName] = std::forward<T>(rhs);
+                        m_values.set(m_attrName, std::forward<T>(rhs));
                         return *this;
                     }
 
                     AttributeItem& operator=(std::nullptr_t /*rhs*/)
                     {
                         NullType t;
-                        m_values[m_attrName] = t;
+                        m_values.set(m_attrName, t);
                         return *this;
                     }
 
@@ -372,11 +383,11 @@ namespace OC
                     }
 
                 private:
-                    AttributeItem(const std::string& name,
-                            std::map<std::string, AttributeValue>& vals);
+                    AttributeItem(const std::string& name, AttributeMap& vals);
                     AttributeItem(const AttributeItem&) = default;
+                    const AttributeValue& value() const;
                     std::string m_attrName;
-                    std::map<std::string, AttributeValue>& m_values;
+                    AttributeMap& m_values;
             };
 
             // Iterator to allow iteration via STL containers/methods
@@ -403,11 +414,12 @@ namespace OC
                     reference operator*();
                     pointer operator->();
                 private:
-                    iterator(std::map<std::string, AttributeValue>::iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
-                        : m_iterator(std::move(itr)),
-                        m_item(m_iterator != vals.end() ? m_iterator->first:"", vals){}
-                    std::map<std::string, AttributeValue>::iterator m_iterator;
+                    // A position rather than an AttributeMap iterator, which writing
+                    // through the item invalidates when it unshares the attributes.
+                    iterator(size_t index, AttributeMap& vals)
+                        : m_index(index),
+                        m_item(index < vals.size() ? vals.cbegin()[index].first : "", vals){}
+                    size_t m_index;
                     AttributeItem m_item;
             };
 
@@ -423,7 +435,7 @@ namespace OC
                     typedef int difference_type;
 
                     const_iterator(const iterator& rhs)
-                        :m_iterator(rhs.m_iterator), m_item(rhs.m_item){}
+                        :m_index(rhs.m_index), m_item(rhs.m_item){}
                     const_iterator(const const_iterator&) = default;
                     ~const_iterator() = default;
 
@@ -436,11 +448,10 @@ namespace OC
                     const_reference operator*() const;
                     const_pointer operator->() const;
                 private:
-                    const_iterator(std::map<std::string, AttributeValue>::const_iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
-                        : m_iterator(std::move(itr)),
-                        m_item(m_iterator != vals.end() ? m_iterator->first: "", vals){}
-                    std::map<std::string, AttributeValue>::const_iterator m_iterator;
+                    const_iterator(size_t index, AttributeMap& vals)
+                        : m_index(index),
+                        m_item(index < vals.size() ? vals.cbegin()[index].first : "", vals){}
+                    size_t m_index;
                     AttributeItem m_item;
             };
 
@@ -458,6 +469,7 @@ namespace OC
         private:
             friend class OCResourceResponse;
             friend class MessageContainer;
+            friend class RepresentationCodec;
 
             template<typename T>
             void payload_array_helper(const OCRepPayloadValue* pl, size_t depth);
@@ -495,12 +507,20 @@ namespace OC
                     std::vector<std::string>& m_interfaces;
             };
         private:
-            std::string m_uri;
-            std::vector<OCRepresentation> m_children;
-            mutable std::map<std::string, AttributeValue> m_values;
-            std::vector<std::string> m_resourceTypes;
-            std::vector<std::string> m_interfaces;
-            std::vector<std::string> m_dataModelVersions;
+            // Everything but the attributes, shared between copies like the attributes
+            // are so that copying a representation only copies two pointers.
+            struct Body
+            {
+                std::string host;
+                std::string uri;
+                std::vector<OCRepresentation> children;
+                std::vector<std::string> resourceTypes;
+                std::vector<std::string> interfaces;
+                std::vector<std::string> dataModelVersions;
+            };
+
+            CopyOnWrite<Body> m_body;
+            AttributeMap m_values;
 
             InterfaceType m_interfaceType;
     };
@@ -29,8 +29,10 @@
 #define OC_RESOURCE_H_
 
 #include <memory>
+#include <mutex>
 #include <random>
 #include <algorithm>
+#include <future>
 
 #include <OCApi.h>
 #include <ResourceInitException.h>
@@ -43,6 +45,80 @@ namespace OC
     class OCResource;
     class OCResourceIdentifier;
     std::ostream& operator <<(std::ostream& os, const OCResourceIdentifier& ri);
+
+    /**
+    *  @brief  The response to a request made through a future: what the callback of the
+    *          same request is given.
+    */
+    struct RequestResult
+    {
+        RequestResult()
+         : result(OC_STACK_ERROR)
+        {
+        }
+
+        RequestResult(const HeaderOptions& options, const OCRepresentation& rep, int eCode)
+         : headerOptions(options), representation(rep), result(eCode)
+        {
+        }
+
+        HeaderOptions headerOptions;
+        OCRepresentation representation;
+        /** OC_STACK_OK, the error of the request, or OC_STACK_TIMEOUT without a response. */
+        int result;
+    };
+
+    /**
+    *  @brief  The future response to a request. Responses reach the application through
+    *          the threads running client callbacks or the one processing the stack, so
+    *          get and wait throw an OCException on those until the response is in, rather
+    *          than wait forever. The bounded waits only run out there.
+    */
+    class RequestFuture
+    {
+    public:
+        RequestFuture() = default;
+
+        explicit RequestFuture(std::future<RequestResult>&& future)
+         : m_future(std::move(future))
+        {
+        }
+
+        bool valid() const
+        {
+            return m_future.valid();
+        }
+
+        RequestResult get()
+        {
+            checkWait();
+            return m_future.get();
+        }
+
+        void wait() const
+        {
+            checkWait();
+            m_future.wait();
+        }
+
+        template<typename Rep, typename Period>
+        std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+        {
+            return m_future.wait_for(timeout);
+        }
+
+        template<typename Clock, typename Duration>
+        std::future_status wait_until(
+                const std::chrono::time_point<Clock, Duration>& deadline) const
+        {
+            return m_future.wait_until(deadline);
+        }
+
+    private:
+        void checkWait() const;
+
+        std::future<RequestResult> m_future;
+    };
     /**
     *  @brief  OCResourceIdentifier represents the identity information for a server. This
     *          object combined with the OCResource's URI property uniquely identify an
@@ -124,7 +200,8 @@ namespace OC
             m_interfaces(std::move(o.m_interfaces)),
             m_children(std::move(m_children)),
             m_observeHandle(std::move(m_observeHandle)),
-            m_headerOptions(std::move(m_headerOptions))
+            m_headerOptions(std::move(m_headerOptions)),
+            m_validationCache(std::move(o.m_validationCache))
         {
         }
 #else
@@ -164,6 +241,9 @@ namespace OC
         * @param QoS the quality of communication
         * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
         * @note OCStackResult is defined in ocstack.h.
+        * @note The entity tag of the last representation received is sent with the request.
+        *       If the server answers that it is still valid, the callback is invoked with
+        *       that representation.
         */
         OCStackResult get(const QueryParamsMap& queryParametersMap, GetCallback attributeHandler,
                           QualityOfService QoS);
@@ -402,6 +482,69 @@ namespace OC
                         const OCRepresentation& representation, const QueryParamsMap& queryParametersMap,
                         PostCallback attributeHandler, QualityOfService QoS);
 
+        /**
+        * Function to get the attributes of a resource, with the response delivered
+        * through a future instead of a callback.
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @return future of the response. It holds the error if the request could not be
+        *         sent, and OC_STACK_TIMEOUT if the stack dropped it unanswered.
+        */
+        RequestFuture getAsync(const QueryParamsMap& queryParametersMap);
+        /**
+        * Function to get the attributes of a resource through a future.
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param QoS the quality of communication
+        * @return future of the response, as for getAsync without QoS
+        */
+        RequestFuture getAsync(const QueryParamsMap& queryParametersMap,
+                               QualityOfService QoS);
+
+        /**
+        * Function to set the representation of a resource (via PUT) through a future.
+        * @param representation representation of the resource
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @return future of the response, as for getAsync
+        */
+        RequestFuture putAsync(const OCRepresentation& representation,
+                               const QueryParamsMap& queryParametersMap);
+        /**
+        * Function to set the representation of a resource (via PUT) through a future.
+        * @param representation representation of the resource
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param QoS the quality of communication
+        * @return future of the response, as for getAsync
+        */
+        RequestFuture putAsync(const OCRepresentation& representation,
+                               const QueryParamsMap& queryParametersMap,
+                               QualityOfService QoS);
+
+        /**
+        * Function to post on a resource through a future.
+        * @param representation representation of the resource
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @return future of the response, as for getAsync
+        */
+        RequestFuture postAsync(const OCRepresentation& representation,
+                                const QueryParamsMap& queryParametersMap);
+        /**
+        * Function to post on a resource through a future.
+        * @param representation representation of the resource
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param QoS the quality of communication
+        * @return future of the response, as for getAsync
+        */
+        RequestFuture postAsync(const OCRepresentation& representation,
+                                const QueryParamsMap& queryParametersMap,
+                                QualityOfService QoS);
+
+        /**
+        * Returns a callback completing future with the first response it is given, to
+        * wait for any request taking a GetCallback. If every copy of the callback goes
+        * away uncalled, as when the stack drops the request, future holds
+        * OC_STACK_TIMEOUT.
+        */
+        static GetCallback futureCallback(RequestFuture& future);
+
         /**
         * Function to perform DELETE operation
         *
@@ -559,6 +702,15 @@ namespace OC
 
     private:
         void setHost(const std::string& host);
+
+        /**
+        * Adds the cached entity tag to headerOptions and wraps attributeHandler to answer
+        * a 2.03 Valid response from the cache, for a GET with queryParametersMap.
+        */
+        GetCallback validatingGetHandler(const QueryParamsMap& queryParametersMap,
+                                         GetCallback attributeHandler,
+                                         HeaderOptions& headerOptions);
+
         std::weak_ptr<IClientWrapper> m_clientWrapper;
         std::string m_uri;
         OCResourceIdentifier m_resourceId;
@@ -572,6 +724,19 @@ namespace OC
         OCDoHandle m_observeHandle;
         HeaderOptions m_headerOptions;
 
+        /**
+        * Last representation received by get and its entity tag. Shared with the callbacks
+        * of pending requests, which may outlive the resource.
+        */
+        struct ValidationCache
+        {
+            std::mutex mutex;
+            QueryParamsMap query;
+            std::string etag;
+            OCRepresentation rep;
+        };
+        std::shared_ptr<ValidationCache> m_validationCache;
+
     private:
         OCResource(std::weak_ptr<IClientWrapper> clientWrapper,
                     const OCDevAddr& devAddr, const std::string& uri,
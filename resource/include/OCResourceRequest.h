@@ -30,10 +30,12 @@
 
 #include "OCApi.h"
 #include "OCRepresentation.h"
+#include "OCResourceSchema.h"
 
 void formResourceRequest(OCEntityHandlerFlag,
                          OCEntityHandlerRequest*,
-                         std::shared_ptr<OC::OCResourceRequest>);
+                         std::shared_ptr<OC::OCResourceRequest>,
+                         bool);
 
 
 namespace OC
@@ -56,7 +58,9 @@ namespace OC
             m_observationInfo{},
             m_headerOptions{},
             m_requestHandle{nullptr},
-            m_resourceHandle{nullptr}
+            m_resourceHandle{nullptr},
+            m_schemaPayload{nullptr},
+            m_schemaPayloadCopy{}
         {
         }
 
@@ -70,7 +74,9 @@ namespace OC
             m_observationInfo(std::move(o.m_observationInfo)),
             m_headerOptions(std::move(o.m_headerOptions)),
             m_requestHandle(std::move(o.m_requestHandle)),
-            m_resourceHandle(std::move(o.m_resourceHandle))
+            m_resourceHandle(std::move(o.m_resourceHandle)),
+            m_schemaPayload(o.m_schemaPayload),
+            m_schemaPayloadCopy(std::move(o.m_schemaPayloadCopy))
         {
         }
         OCResourceRequest& operator=(OCResourceRequest&& o)
@@ -84,6 +90,8 @@ namespace OC
             m_headerOptions = std::move(o.m_headerOptions);
             m_requestHandle = std::move(o.m_requestHandle);
             m_resourceHandle = std::move(o.m_resourceHandle);
+            m_schemaPayload = o.m_schemaPayload;
+            m_schemaPayloadCopy = std::move(o.m_schemaPayloadCopy);
         }
 #else
         OCResourceRequest(OCResourceRequest&&) = default;
@@ -141,7 +149,7 @@ namespace OC
         */
         void setResourceUri(const std::string resourceUri)
         {
-            m_resourceUri = resourceUri;
+            m_resourceUri = std::make_shared<const std::string>(resourceUri);
         }
 
         /**
@@ -150,7 +158,7 @@ namespace OC
         */
         std::string getResourceUri(void)
         {
-            return m_resourceUri;
+            return m_resourceUri ? *m_resourceUri : std::string();
         }
 
         /**
@@ -190,9 +198,23 @@ namespace OC
         */
         int16_t getMessageID() const {return m_messageID;}
 
+        /**
+        * Reads the request representation of a resource registered with a schema
+        * straight from the request payload.
+        *
+        * @param value schema value the properties in the payload are written to
+        * @return false if there is no payload or a property does not fit its field
+        */
+        template<typename T>
+        bool getSchemaRepresentation(T& value) const
+        {
+            return decodeSchema(m_schemaPayload, value);
+        }
+
     private:
         std::string m_requestType;
-        std::string m_resourceUri;
+        // shared with the registration of the resource instead of copied per request
+        std::shared_ptr<const std::string> m_resourceUri;
         QueryParamsMap m_queryParameters;
         int m_requestHandlerFlag;
         int16_t m_messageID;
@@ -201,11 +223,17 @@ namespace OC
         HeaderOptions m_headerOptions;
         OCRequestHandle m_requestHandle;
         OCResourceHandle m_resourceHandle;
+        // only valid while the entity handler of a schema resource runs
+        const OCRepPayload* m_schemaPayload;
+        // owns m_schemaPayload when the handler runs after the stack has freed its own
+        std::shared_ptr<OCRepPayload> m_schemaPayloadCopy;
 
 
     private:
         friend void (::formResourceRequest)(OCEntityHandlerFlag, OCEntityHandlerRequest*,
-            std::shared_ptr<OC::OCResourceRequest>);
+            std::shared_ptr<OC::OCResourceRequest>, bool);
+        friend class SchemaEntityHandler;
+        friend class InProcServerWrapper;
         void setRequestType(const std::string& requestType)
         {
             m_requestType = requestType;
@@ -213,6 +241,21 @@ namespace OC
 
         void setPayload(OCPayload* requestPayload);
 
+        void setSchemaPayload(OCPayload* requestPayload)
+        {
+            if (requestPayload && requestPayload->type == PAYLOAD_TYPE_REPRESENTATION)
+            {
+                m_schemaPayload = reinterpret_cast<OCRepPayload*>(requestPayload);
+            }
+        }
+
+        void keepSchemaPayload();
+
+        void setResourceUri(std::shared_ptr<const std::string> resourceUri)
+        {
+            m_resourceUri = std::move(resourceUri);
+        }
+
         void setQueryParams(QueryParamsMap& queryParams)
         {
             m_queryParameters = queryParams;
@@ -32,6 +32,7 @@
 #include <IServerWrapper.h>
 #include <ocstack.h>
 #include <OCRepresentation.h>
+#include <OCResourceSchema.h>
 
 namespace OC
 {
@@ -51,6 +52,7 @@ namespace OC
             m_headerOptions{},
             m_interface{},
             m_representation{},
+            m_encodedPayload{},
             m_requestHandle{nullptr},
             m_resourceHandle{nullptr},
             m_responseResult{}
@@ -64,6 +66,7 @@ namespace OC
             m_headerOptions(std::move(o.m_headerOptions)),
             m_interface(std::move(o.m_interface)),
             m_representation(std::move(o.m_representation)),
+            m_encodedPayload(std::move(o.m_encodedPayload)),
             m_requestHandle(std::move(o.m_requestHandle)),
             m_resourceHandle(std::move(o.m_resourceHandle)),
             m_responseResult(std::move(o.m_responseResult))
@@ -76,6 +79,7 @@ namespace OC
             m_headerOptions = std::move(o.m_headerOptions);
             m_interface = std::move(o.m_interface);
             m_representation = std::move(o.m_representation);
+            m_encodedPayload = std::move(o.m_encodedPayload);
             m_requestHandle = std::move(o.m_requestHandle);
             m_resourceHandle = std::move(o.m_resourceHandle);
             m_responseResult = std::move(o.m_responseResult);
@@ -186,12 +190,26 @@ namespace OC
             // Call the above function
             setResourceRepresentation(rep);
         }
+
+        /**
+        *  API to set the response representation from a schema value. It is encoded
+        *  right away and sent in place of the resource representation.
+        *  @param value schema value of the resource
+        *  @param iface specifies the interface
+        */
+        template<typename T>
+        void setSchemaRepresentation(const T& value, const std::string& iface = DEFAULT_INTERFACE)
+        {
+            m_interface = iface;
+            m_encodedPayload = encodeSchema(value, iface);
+        }
     private:
         std::string m_newResourceUri;
         int m_errorCode;
         HeaderOptions m_headerOptions;
         std::string m_interface;
         OCRepresentation m_representation;
+        std::vector<uint8_t> m_encodedPayload;
         OCRequestHandle m_requestHandle;
         OCResourceHandle m_resourceHandle;
         OCEntityHandlerResult m_responseResult;
@@ -199,7 +217,12 @@ namespace OC
     private:
         friend class InProcServerWrapper;
 
-        OCRepPayload* getPayload() const
+        const std::vector<uint8_t>& getSchemaPayload() const
+        {
+            return m_encodedPayload;
+        }
+
+        OCPayload* getPayload() const
         {
             MessageContainer inf;
             OCRepresentation first(m_representation);
@@ -240,7 +263,7 @@ namespace OC
 
             }
 
-            return inf.getPayload();
+            return inf.getEncodedPayload();
         }
     public:
 
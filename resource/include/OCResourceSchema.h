@@ -0,0 +1,473 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of typed resource schemas. A schema describes
+ * a resource whose properties are fixed as a plain struct, and gets a CBOR encoder
+ * and decoder specialised for it in place of the dynamic OCRepresentation.
+ *
+ * A schema is declared by specializing ResourceSchema:
+ *
+ *     struct Temperature { double temperature; std::string units; };
+ *
+ *     template<>
+ *     struct ResourceSchema<Temperature>
+ *     {
+ *         static const char* resourceType() { return "oic.r.temperature"; }
+ *
+ *         template<typename Visitor>
+ *         static void fields(Visitor& visit)
+ *         {
+ *             visit(schemaField("temperature", &Temperature::temperature));
+ *             visit(schemaField("units", &Temperature::units));
+ *         }
+ *     };
+ *
+ * Supported member types are bool, integral types, floating point types and std::string.
+ */
+
+#ifndef OC_RESOURCE_SCHEMA_H_
+#define OC_RESOURCE_SCHEMA_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    /**
+    *   @brief  Specialize for a struct to make it a resource schema.
+    */
+    template<typename T>
+    struct ResourceSchema;
+
+    /**
+    *   @brief  One property of a resource schema: its name and the member holding it.
+    */
+    template<typename T, typename M>
+    struct SchemaField
+    {
+        const char* name;
+        size_t nameLength;
+        M T::* member;
+    };
+
+    /**
+    *   Declares a schema property. The name length is taken from the literal.
+    */
+    template<typename T, typename M, size_t N>
+    inline SchemaField<T, M> schemaField(const char (&name)[N], M T::* member)
+    {
+        return SchemaField<T, M>{name, N - 1, member};
+    }
+
+    namespace detail
+    {
+        /**
+        *   Writes CBOR the way OCConvertPayload does for a single representation,
+        *   so a schema encodes to the same bytes as the equivalent OCRepPayload.
+        *   Past the end of the buffer it only counts, so size() is what is needed.
+        */
+        class SchemaWriter
+        {
+        public:
+            SchemaWriter(uint8_t* buffer, size_t capacity)
+             : m_buffer(buffer), m_capacity(capacity), m_size(0)
+            {
+            }
+
+            size_t size() const { return m_size; }
+
+            void beginMap() { byte(0xbf); }
+            void endMap() { byte(0xff); }
+            void beginArray(size_t count) { head(4, count); }
+
+            void text(const char* str, size_t length)
+            {
+                head(3, length);
+                put(reinterpret_cast<const uint8_t*>(str), length);
+            }
+
+            void value(bool b)
+            {
+                byte(b ? 0xf5 : 0xf4);
+            }
+
+            void value(const std::string& str)
+            {
+                text(str.data(), str.length());
+            }
+
+            void value(double d)
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                byte(0xfb);
+                for (int shift = 56; shift >= 0; shift -= 8)
+                {
+                    byte(static_cast<uint8_t>(bits >> shift));
+                }
+            }
+
+            template<typename I>
+            typename std::enable_if<std::is_integral<I>::value>::type value(I i)
+            {
+                int64_t v = static_cast<int64_t>(i);
+                if (v < 0)
+                {
+                    head(1, static_cast<uint64_t>(-1 - v));
+                }
+                else
+                {
+                    head(0, static_cast<uint64_t>(v));
+                }
+            }
+
+            template<typename F>
+            typename std::enable_if<std::is_floating_point<F>::value>::type value(F f)
+            {
+                value(static_cast<double>(f));
+            }
+
+        private:
+            void head(uint8_t major, uint64_t v)
+            {
+                uint8_t type = static_cast<uint8_t>(major << 5);
+                int bytes = 0;
+                if (v < 24)
+                {
+                    byte(type | static_cast<uint8_t>(v));
+                    return;
+                }
+                else if (v <= 0xff)
+                {
+                    byte(type | 24);
+                    bytes = 1;
+                }
+                else if (v <= 0xffff)
+                {
+                    byte(type | 25);
+                    bytes = 2;
+                }
+                else if (v <= 0xffffffffULL)
+                {
+                    byte(type | 26);
+                    bytes = 4;
+                }
+                else
+                {
+                    byte(type | 27);
+                    bytes = 8;
+                }
+                for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+                {
+                    byte(static_cast<uint8_t>(v >> shift));
+                }
+            }
+
+            void byte(uint8_t b)
+            {
+                put(&b, 1);
+            }
+
+            void put(const uint8_t* data, size_t length)
+            {
+                if (m_size + length <= m_capacity)
+                {
+                    std::memcpy(m_buffer + m_size, data, length);
+                }
+                m_size += length;
+            }
+
+            uint8_t* m_buffer;
+            size_t m_capacity;
+            size_t m_size;
+        };
+
+        template<typename T>
+        class SchemaEncoder
+        {
+        public:
+            SchemaEncoder(SchemaWriter& writer, const T& value)
+             : m_writer(writer), m_value(value)
+            {
+            }
+
+            template<typename M>
+            void operator()(const SchemaField<T, M>& field)
+            {
+                m_writer.text(field.name, field.nameLength);
+                m_writer.value(m_value.*field.member);
+            }
+
+        private:
+            SchemaWriter& m_writer;
+            const T& m_value;
+        };
+
+        inline bool schemaValue(const OCRepPayloadValue* val, bool& out)
+        {
+            if (val->type != OCREP_PROP_BOOL)
+            {
+                return false;
+            }
+            out = val->b;
+            return true;
+        }
+
+        inline bool schemaValue(const OCRepPayloadValue* val, std::string& out)
+        {
+            if (val->type != OCREP_PROP_STRING)
+            {
+                return false;
+            }
+            out = val->str ? val->str : "";
+            return true;
+        }
+
+        template<typename I>
+        typename std::enable_if<std::is_integral<I>::value, bool>::type
+        schemaValue(const OCRepPayloadValue* val, I& out)
+        {
+            if (val->type != OCREP_PROP_INT)
+            {
+                return false;
+            }
+            out = static_cast<I>(val->i);
+            return true;
+        }
+
+        template<typename F>
+        typename std::enable_if<std::is_floating_point<F>::value, bool>::type
+        schemaValue(const OCRepPayloadValue* val, F& out)
+        {
+            // A whole number on the wire may have been encoded as an integer.
+            if (val->type == OCREP_PROP_DOUBLE)
+            {
+                out = static_cast<F>(val->d);
+            }
+            else if (val->type == OCREP_PROP_INT)
+            {
+                out = static_cast<F>(val->i);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+
+        template<typename T>
+        class SchemaDecoder
+        {
+        public:
+            SchemaDecoder(const OCRepPayloadValue* val, T& value)
+             : m_val(val), m_nameLength(std::strlen(val->name)), m_value(value), m_ok(true)
+            {
+            }
+
+            template<typename M>
+            void operator()(const SchemaField<T, M>& field)
+            {
+                if (field.nameLength == m_nameLength &&
+                    0 == std::memcmp(field.name, m_val->name, m_nameLength))
+                {
+                    m_ok = m_ok && schemaValue(m_val, m_value.*field.member);
+                }
+            }
+
+            bool ok() const { return m_ok; }
+
+        private:
+            const OCRepPayloadValue* m_val;
+            size_t m_nameLength;
+            T& m_value;
+            bool m_ok;
+        };
+
+        /**
+        *   Decodes the values of a payload still holding them as CBOR.
+        *   Kept out of line so this header does not pull ocpayload.h, and with it the
+        *   C OCResource type, into every client of OCPlatform.h.
+        */
+        bool decodeSchemaValues(const OCRepPayload* payload);
+
+        template<typename T>
+        size_t encodeSchemaTo(const T& value, const std::string& iface,
+                              uint8_t* buffer, size_t capacity)
+        {
+            SchemaWriter writer(buffer, capacity);
+            writer.beginMap();
+            if (iface == DEFAULT_INTERFACE)
+            {
+                const char* rt = ResourceSchema<T>::resourceType();
+                writer.text(OC_RSRVD_RESOURCE_TYPE, sizeof(OC_RSRVD_RESOURCE_TYPE) - 1);
+                writer.beginArray(1);
+                writer.text(rt, std::strlen(rt));
+                writer.text(OC_RSRVD_INTERFACE, sizeof(OC_RSRVD_INTERFACE) - 1);
+                writer.beginArray(1);
+                writer.value(iface);
+            }
+            SchemaEncoder<T> encoder(writer, value);
+            ResourceSchema<T>::fields(encoder);
+            writer.endMap();
+            return writer.size();
+        }
+    }
+
+    /**
+    *   Encodes a schema value as the CBOR representation of a resource.
+    *   @param value the value to encode
+    *   @param iface the interface the representation is for; the baseline interface
+    *                also carries the resource type and interface properties
+    *   @return the encoded representation
+    */
+    template<typename T>
+    std::vector<uint8_t> encodeSchema(const T& value,
+                                      const std::string& iface = DEFAULT_INTERFACE)
+    {
+        uint8_t stackBuffer[256];
+        size_t size = detail::encodeSchemaTo(value, iface, stackBuffer, sizeof(stackBuffer));
+        if (size <= sizeof(stackBuffer))
+        {
+            return std::vector<uint8_t>(stackBuffer, stackBuffer + size);
+        }
+        std::vector<uint8_t> out(size);
+        detail::encodeSchemaTo(value, iface, out.data(), out.size());
+        return out;
+    }
+
+    /**
+    *   Reads a schema value out of a parsed representation payload. Properties not
+    *   in the schema are ignored and schema fields missing from the payload keep
+    *   their value.
+    *   @return false if a property has a type its field cannot hold.
+    */
+    template<typename T>
+    bool decodeSchema(const OCRepPayload* payload, T& value)
+    {
+        if (!payload || !detail::decodeSchemaValues(payload))
+        {
+            return false;
+        }
+        for (const OCRepPayloadValue* val = payload->values; val; val = val->next)
+        {
+            detail::SchemaDecoder<T> decoder(val, value);
+            ResourceSchema<T>::fields(decoder);
+            if (!decoder.ok())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+    *   @brief  Wraps the entity handler of a resource registered with a schema. Requests
+    *           to it keep their payload undecoded for OCResourceRequest::getSchemaRepresentation
+    *           instead of building an OCRepresentation.
+    */
+    class SchemaEntityHandler
+    {
+    public:
+        explicit SchemaEntityHandler(EntityHandler handler)
+         : m_handler(std::move(handler))
+        {
+        }
+
+        OCEntityHandlerResult operator()(std::shared_ptr<OCResourceRequest> request) const;
+
+    private:
+        EntityHandler m_handler;
+    };
+
+    namespace Schema
+    {
+        /**
+        *   @brief  oic.r.temperature
+        */
+        struct Temperature
+        {
+            double temperature;
+            std::string units;
+        };
+
+        /**
+        *   @brief  oic.r.switch.binary
+        */
+        struct BinarySwitch
+        {
+            bool value;
+        };
+
+        /**
+        *   @brief  oic.r.light.brightness
+        */
+        struct Brightness
+        {
+            int64_t brightness;
+        };
+    }
+
+    template<>
+    struct ResourceSchema<Schema::Temperature>
+    {
+        static const char* resourceType() { return "oic.r.temperature"; }
+
+        template<typename Visitor>
+        static void fields(Visitor& visit)
+        {
+            visit(schemaField("temperature", &Schema::Temperature::temperature));
+            visit(schemaField("units", &Schema::Temperature::units));
+        }
+    };
+
+    template<>
+    struct ResourceSchema<Schema::BinarySwitch>
+    {
+        static const char* resourceType() { return "oic.r.switch.binary"; }
+
+        template<typename Visitor>
+        static void fields(Visitor& visit)
+        {
+            visit(schemaField("value", &Schema::BinarySwitch::value));
+        }
+    };
+
+    template<>
+    struct ResourceSchema<Schema::Brightness>
+    {
+        static const char* resourceType() { return "oic.r.light.brightness"; }
+
+        template<typename Visitor>
+        static void fields(Visitor& visit)
+        {
+            visit(schemaField("brightness", &Schema::Brightness::brightness));
+        }
+    };
+}
+
+#endif // OC_RESOURCE_SCHEMA_H_
@@ -21,6 +21,7 @@
 #ifndef OC_UTILITIES_H_
 #define OC_UTILITIES_H_
 
+#include <atomic>
 #include <map>
 #include <vector>
 #include <memory>
@@ -142,6 +143,60 @@ namespace OC
         BOOST_STATIC_CONSTEXPR bool value = std::is_same<ToTest, T>::value
             || is_component<ToTest, Base<Rest...> >::value;
     };
+
+    /**
+    *   @brief  Holds a T that copies share until one of them changes it. An empty
+    *           holder stands for a default constructed T and allocates nothing.
+    */
+    template<typename T>
+    class CopyOnWrite
+    {
+    public:
+        const T& get() const
+        {
+            if (m_data)
+            {
+                return *m_data;
+            }
+            static const T empty{};
+            return empty;
+        }
+
+        /**
+        *   Returns the T for writing, copying it first if another holder shares it.
+        */
+        T& edit()
+        {
+            if (!m_data)
+            {
+                m_data = std::make_shared<T>();
+            }
+            else if (m_data.use_count() > 1)
+            {
+                m_data = std::make_shared<T>(*m_data);
+            }
+            else
+            {
+                // Pairs with the release of the last other holder, which may have
+                // been reading on another thread.
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+            return *m_data;
+        }
+
+        bool shares(const CopyOnWrite& other) const
+        {
+            return m_data == other.m_data;
+        }
+
+        void reset()
+        {
+            m_data.reset();
+        }
+
+    private:
+        std::shared_ptr<T> m_data;
+    };
 } // namespace OC
 
 #endif
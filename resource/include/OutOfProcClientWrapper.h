@@ -47,6 +47,16 @@ namespace OC
                                                      QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
+        virtual OCStackResult DiscoverResources(OCDiscoverySession::Ptr* /*session*/,
+                                                const std::string& /*servUrl*/,
+                                                const std::string& /*rsrcType*/,
+                                                OCConnectivityType /*connType*/,
+                                                std::chrono::milliseconds /*timeout*/,
+                                                FindResourcesCallback& /*callback*/,
+                                                FindDoneCallback& /*doneCallback*/,
+                                                QualityOfService /*QoS*/)
+            {return OC_STACK_NOTIMPL;}
+
         virtual OCStackResult ListenForDevice(const std::string& /*serviceUrl*/,
                                               const std::string& /*deviceURI*/,
                                               OCConnectivityType /*connType*/,
@@ -68,6 +78,12 @@ namespace OC
             GetCallback& /*callback*/, QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
+        virtual OCStackResult GetResourceRepresentations(
+            std::vector<GetRequest>& /*requests*/,
+            const QueryParamsMap& /*queryParams*/,
+            QualityOfService /*QoS*/, uint32_t /*timeoutMs*/)
+            {return OC_STACK_NOTIMPL;}
+
         virtual OCStackResult PutResourceRepresentation(
             const OCDevAddr& /*devAddr*/,
             const std::string& /*uri*/,
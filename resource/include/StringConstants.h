@@ -68,6 +68,8 @@ namespace OC
         static const char STR_NULL_RESPONSE[]          = "Response is NULL";
         static const char STR_PAYLOAD_OVERFLOW[]       = "Payload overflow";
         static const char NIL_GUARD_NULL[]             = "nullptr at nil_guard()";
+        static const char WAIT_ON_RESPONSE_THREAD[]    =
+                            "Waiting for a response on a thread delivering responses";
         static const char GENERAL_JSON_PARSE_FAILED[]  = "JSON Parser Error";
         static const char RESOURCE_UNREG_FAILED[]      = "Unregistering resource failed";
         static const char OPTION_ID_RANGE_INVALID[]    =
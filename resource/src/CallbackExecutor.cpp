@@ -0,0 +1,191 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <CallbackExecutor.h>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    namespace
+    {
+        void runTask(const CallbackExecutor::Task& task)
+        {
+            try
+            {
+                task();
+            }
+            catch (std::exception& e)
+            {
+                oclog() << "Exception in callback: " << e.what() << std::flush;
+            }
+            catch (...)
+            {
+                oclog() << "Unknown exception in callback" << std::flush;
+            }
+        }
+    }
+
+    CallbackExecutor::CallbackExecutor(CallbackExecution execution, size_t threads,
+                                       size_t queueSize)
+        : m_execution(execution), m_queueSize(queueSize), m_queued(0), m_stop(false)
+    {
+        if (m_execution != CallbackExecution::ThreadPool)
+        {
+            return;
+        }
+
+        if (threads == 0)
+        {
+            threads = 1;
+        }
+        for (size_t i = 0; i < threads; ++i)
+        {
+            m_threads.push_back(std::thread(&CallbackExecutor::workerFunc, this));
+        }
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+
+    void CallbackExecutor::post(const void* key, Task task, Overflow overflow)
+    {
+        if (enqueue(key, task, overflow, false) != PostResult::Queued)
+        {
+            runTask(task);
+        }
+    }
+
+    CallbackExecutor::PostResult CallbackExecutor::tryPost(const void* key, const Task& task)
+    {
+        return enqueue(key, task, Overflow::Enqueue, true);
+    }
+
+    CallbackExecutor::PostResult CallbackExecutor::enqueue(const void* key, const Task& task,
+                                                           Overflow overflow, bool bounded)
+    {
+        if (m_execution == CallbackExecution::Inline)
+        {
+            return PostResult::Full;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto strand = m_strands.find(key);
+            if (m_stop || m_queued >= m_queueSize)
+            {
+                if (strand == m_strands.end())
+                {
+                    return PostResult::Full;
+                }
+                if (bounded)
+                {
+                    return PostResult::KeyBusy;
+                }
+
+                // Running it here would overtake the key's pending callbacks, so it waits
+                // behind them; a key with nothing waiting behind its running task keeps
+                // one slot past the bound, so the newest callback is never the one dropped.
+                if (overflow == Overflow::DropOldest && m_queued >= m_queueSize &&
+                    !strand->second.empty())
+                {
+                    strand->second.pop_front();
+                    --m_queued;
+                    oclog() << "Callback queue full, dropped the oldest callback of a key"
+                            << std::flush;
+                }
+            }
+
+            if (strand == m_strands.end())
+            {
+                strand = m_strands.insert(std::make_pair(key, std::deque<Task>())).first;
+                m_ready.push_back(key);
+            }
+            strand->second.push_back(task);
+            ++m_queued;
+        }
+        m_cond.notify_one();
+        return PostResult::Queued;
+    }
+
+    bool CallbackExecutor::isWorkerThread() const
+    {
+        // The threads are only started by the constructor
+        for (const auto& thread : m_threads)
+        {
+            if (thread.get_id() == std::this_thread::get_id())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void CallbackExecutor::workerFunc()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_cond.wait(lock, [this]{ return m_stop || !m_ready.empty(); });
+            if (m_ready.empty())
+            {
+                return;
+            }
+
+            const void* key = m_ready.front();
+            m_ready.pop_front();
+            auto strand = m_strands.find(key);
+            Task task = std::move(strand->second.front());
+            strand->second.pop_front();
+            --m_queued;
+
+            lock.unlock();
+            runTask(task);
+            task = nullptr;
+            lock.lock();
+
+            // Only one thread runs a key at a time; it goes to the back of the line so
+            // a busy observe does not starve the others.
+            if (strand->second.empty())
+            {
+                m_strands.erase(strand);
+            }
+            else
+            {
+                m_ready.push_back(key);
+                m_cond.notify_one();
+            }
+        }
+    }
+}
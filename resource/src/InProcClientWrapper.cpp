@@ -25,15 +25,78 @@
 #include "OCResource.h"
 #include "ocpayload.h"
 #include <OCSerialization.h>
+#include <CallbackExecutor.h>
+#include <set>
 using namespace std;
 
 namespace OC
 {
+    namespace
+    {
+        std::mutex callbackExecutorLock;
+        std::weak_ptr<CallbackExecutor> clientCallbackExecutor;
+
+        // Callbacks posted for the same context, such as the notifications of one
+        // observe, reach the application in the order they arrived.
+        void postCallback(const void* context, CallbackExecutor::Task task,
+                CallbackExecutor::Overflow overflow = CallbackExecutor::Overflow::Enqueue)
+        {
+            std::shared_ptr<CallbackExecutor> executor;
+            {
+                std::lock_guard<std::mutex> lock(callbackExecutorLock);
+                executor = clientCallbackExecutor.lock();
+            }
+
+            if (executor)
+            {
+                executor->post(context, std::move(task), overflow);
+            }
+            else
+            {
+                task();
+            }
+        }
+
+        // Options are set on a request OCDoResource already queued, so a request they
+        // fail on is cancelled: its callback must not run once the error is returned.
+        OCStackResult cancelOnFailure(OCDoHandle handle, OCStackResult result)
+        {
+            if (OC_STACK_OK != result)
+            {
+                OCCancel(handle, OC_LOW_QOS, nullptr, 0);
+            }
+            return result;
+        }
+    }
+
+    bool details::isResponseThread()
+    {
+        if (std::this_thread::get_id() == processThreadId.load())
+        {
+            return true;
+        }
+
+        std::shared_ptr<CallbackExecutor> executor;
+        {
+            std::lock_guard<std::mutex> lock(callbackExecutorLock);
+            executor = clientCallbackExecutor.lock();
+        }
+        return executor && executor->isWorkerThread();
+    }
+
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
-              m_cfg { cfg }
+              m_cfg { cfg },
+              m_callbackExecutor(std::make_shared<CallbackExecutor>(cfg.callbackExecution,
+                          cfg.callbackThreads, cfg.callbackQueueSize)),
+              m_deadlineStop(false)
     {
+        {
+            std::lock_guard<std::mutex> lock(callbackExecutorLock);
+            clientCallbackExecutor = m_callbackExecutor;
+        }
+
         // if the config type is server, we ought to never get called.  If the config type
         // is both, we count on the server to run the thread and do the initialize
 
@@ -63,16 +126,35 @@ namespace OC
             m_listeningThread.join();
         }
 
+        {
+            std::lock_guard<std::mutex> lock(m_deadlineLock);
+            m_deadlineStop = true;
+        }
+        m_deadlineCond.notify_all();
+        if (m_deadlineThread.joinable())
+        {
+            m_deadlineThread.join();
+        }
+
         // only stop if we are the ones who actually called 'init'.  We are counting
         // on the server to do the stop.
         if (m_cfg.mode == ModeType::Client)
         {
             OCStop();
         }
+
+        // Callbacks already posted still run before the executor goes away.
+        {
+            std::lock_guard<std::mutex> lock(callbackExecutorLock);
+            clientCallbackExecutor.reset();
+        }
+        m_callbackExecutor.reset();
     }
 
     void InProcClientWrapper::listeningFunc()
     {
+        details::processThreadId = std::this_thread::get_id();
+
         while(m_threadRun)
         {
             OCStackResult result;
@@ -95,6 +177,8 @@ namespace OC
             // To minimize CPU utilization we may wish to do this with sleep
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
+
+        details::processThreadId = std::thread::id();
     }
 
     OCRepresentation parseGetSetCallback(OCClientResponse* clientResponse)
@@ -103,7 +187,8 @@ namespace OC
                 (
                     clientResponse->payload->type != PAYLOAD_TYPE_DEVICE &&
                     clientResponse->payload->type != PAYLOAD_TYPE_PLATFORM &&
-                    clientResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION
+                    clientResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION &&
+                    clientResponse->payload->type != PAYLOAD_TYPE_ENCODED
                 )
           )
         {
@@ -115,21 +200,22 @@ namespace OC
         oc.setPayload(clientResponse->payload);
         //OCPayloadDestroy(clientResponse->payload);
 
-        std::vector<OCRepresentation>::const_iterator it = oc.representations().begin();
-        if (it == oc.representations().end())
+        std::vector<OCRepresentation>& reps = oc.representations();
+        if (reps.empty())
         {
             return OCRepresentation();
         }
 
         // first one is considered the root, everything else is considered a child of this one.
-        OCRepresentation root = *it;
+        // They are moved out of the container so the root is not shared when it is changed.
+        OCRepresentation root = std::move(reps.front());
         root.setDevAddr(clientResponse->devAddr);
         root.setUri(clientResponse->resourceUri);
-        ++it;
 
-        std::for_each(it, oc.representations().end(),
-                [&root](const OCRepresentation& repItr)
-                {root.addChild(repItr);});
+        for (auto it = reps.begin() + 1; it != reps.end(); ++it)
+        {
+            root.addChild(std::move(*it));
+        }
         return root;
 
     }
@@ -171,8 +257,7 @@ namespace OC
             // loop to ensure valid construction of all resources
             for(auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                postCallback(context, std::bind(context->callback, resource));
             }
         }
         catch (std::exception &e){
@@ -223,15 +308,13 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                postCallback(context, std::bind(context->callback, resource));
             }
             return OC_STACK_KEEP_TRANSACTION;
         }
 
         std::string resourceURI = clientResponse->resourceUri;
-        std::thread exec(context->errorCallback, resourceURI, result);
-        exec.detach();
+        postCallback(context, std::bind(context->errorCallback, resourceURI, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -276,6 +359,279 @@ namespace OC
         return result;
     }
 
+    /**
+    * One discovery started by DiscoverResources. The stack callback holds a reference
+    * to it until the discovery ends, so it outlives the handle given to the application.
+    */
+    class ResourceDiscovery : public OCDiscoverySession,
+                              public std::enable_shared_from_this<ResourceDiscovery>
+    {
+    public:
+        ResourceDiscovery(std::weak_ptr<IClientWrapper> clientWrapper,
+                          std::weak_ptr<std::recursive_mutex> csdkLock,
+                          FindResourcesCallback callback, FindDoneCallback doneCallback)
+            : m_clientWrapper(clientWrapper), m_csdkLock(csdkLock),
+              m_callback(callback), m_doneCallback(doneCallback),
+              m_handle(nullptr), m_done(false), m_reporting(false), m_endPending(false)
+        {}
+
+        virtual void cancel()
+        {
+            finish();
+        }
+
+        virtual bool isDone() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_done;
+        }
+
+        // Called with the stack lock held, like everything touching m_handle,
+        // m_reporting and m_endPending.
+        void setHandle(OCDoHandle handle)
+        {
+            m_handle = handle;
+        }
+
+        /**
+        * Reports the resources of a discovery response not reported yet. Called from the
+        * stack callback.
+        *
+        * @return false once the discovery has ended and the stack callback should go
+        */
+        bool report(OCClientResponse* clientResponse);
+
+        /**
+        * Ends the discovery and reports it done. Only the first call does anything.
+        */
+        void finish();
+
+    private:
+        std::weak_ptr<IClientWrapper> m_clientWrapper;
+        std::weak_ptr<std::recursive_mutex> m_csdkLock;
+        FindResourcesCallback m_callback;
+        FindDoneCallback m_doneCallback;
+        OCDoHandle m_handle;
+        mutable std::mutex m_lock;
+        bool m_done;
+        bool m_reporting;
+        bool m_endPending;
+        // The (device ID, URI) of every resource reported
+        std::set<std::pair<std::string, std::string>> m_found;
+    };
+
+    bool ResourceDiscovery::report(OCClientResponse* clientResponse)
+    {
+        auto clientWrapper = m_clientWrapper.lock();
+        if (!clientWrapper)
+        {
+            oclog() << "discoveryCallback(): failed to get a shared_ptr to the client wrapper"
+                    << std::flush;
+            return true;
+        }
+
+        std::vector<std::shared_ptr<OCResource>> found;
+        try
+        {
+            ListenOCContainer container(clientWrapper, clientResponse->devAddr,
+                                reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_done)
+            {
+                return true;
+            }
+            for (auto& resource : container.Resources())
+            {
+                // Servers without a device ID can only be told apart by address
+                std::string device = resource->sid();
+                if (device.empty())
+                {
+                    device = resource->host();
+                }
+                if (m_found.insert(std::make_pair(std::move(device), resource->uri())).second)
+                {
+                    found.push_back(resource);
+                }
+            }
+        }
+        catch (std::exception &e)
+        {
+            oclog() << "Exception in discoveryCallback, ignoring response: "
+                    << e.what() << std::flush;
+            return true;
+        }
+
+        if (!found.empty())
+        {
+            // A batch run inline may cancel the discovery; the stack is still using the
+            // callback then, so ending it is left to us.
+            m_reporting = true;
+            postCallback(this, std::bind(m_callback, std::move(found)));
+            m_reporting = false;
+
+            if (m_endPending)
+            {
+                postCallback(this, m_doneCallback);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void ResourceDiscovery::finish()
+    {
+        // Cancelling the stack callback drops the reference it holds
+        auto self = shared_from_this();
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_done)
+            {
+                return;
+            }
+            m_done = true;
+        }
+
+        auto cLock = m_csdkLock.lock();
+        if (cLock)
+        {
+            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            if (m_reporting)
+            {
+                m_endPending = true;
+                return;
+            }
+            if (m_handle && OC_STACK_OK != OCCancel(m_handle, OC_LOW_QOS, nullptr, 0))
+            {
+                oclog() << "finish(): failed to cancel the discovery" << std::flush;
+            }
+        }
+
+        // Run inline, the callback may register resources; it must not hold the stack lock.
+        postCallback(this, m_doneCallback);
+    }
+
+    OCStackApplicationResult discoveryCallback(void* ctx, OCDoHandle /*handle*/,
+        OCClientResponse* clientResponse)
+    {
+        ResourceDiscovery* discovery = static_cast<std::shared_ptr<ResourceDiscovery>*>(ctx)->get();
+
+        if (clientResponse->result != OC_STACK_OK)
+        {
+            oclog() << "discoveryCallback(): failed to create resource. clientResponse: "
+                    << clientResponse->result
+                    << std::flush;
+            return OC_STACK_KEEP_TRANSACTION;
+        }
+
+        if (!clientResponse->payload || clientResponse->payload->type != PAYLOAD_TYPE_DISCOVERY)
+        {
+            oclog() << "discoveryCallback(): clientResponse payload was null or the wrong type"
+                    << std::flush;
+            return OC_STACK_KEEP_TRANSACTION;
+        }
+
+        return discovery->report(clientResponse) ? OC_STACK_KEEP_TRANSACTION
+                                                 : OC_STACK_DELETE_TRANSACTION;
+    }
+
+    OCStackResult InProcClientWrapper::DiscoverResources(
+            OCDiscoverySession::Ptr* session,
+            const std::string& serviceUrl,
+            const std::string& resourceType,
+            OCConnectivityType connectivityType,
+            std::chrono::milliseconds timeout,
+            FindResourcesCallback& callback,
+            FindDoneCallback& doneCallback,
+            QualityOfService QoS)
+    {
+        if (!session || !callback || !doneCallback || timeout.count() <= 0)
+        {
+            return OC_STACK_INVALID_PARAM;
+        }
+
+        ostringstream resourceUri;
+        resourceUri << serviceUrl << resourceType;
+
+        auto discovery = std::make_shared<ResourceDiscovery>(shared_from_this(), m_csdkLock,
+                                                             callback, doneCallback);
+        OCCallbackData cbdata(
+                new std::shared_ptr<ResourceDiscovery>(discovery),
+                discoveryCallback,
+                [](void* c){delete static_cast<std::shared_ptr<ResourceDiscovery>*>(c);}
+            );
+
+        OCStackResult result;
+        auto cLock = m_csdkLock.lock();
+        if (cLock)
+        {
+            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            OCDoHandle handle = nullptr;
+            result = OCDoResource(&handle, OC_REST_DISCOVER,
+                                  resourceUri.str().c_str(),
+                                  nullptr, nullptr, connectivityType,
+                                  static_cast<OCQualityOfService>(QoS),
+                                  &cbdata,
+                                  nullptr, 0);
+            discovery->setHandle(handle);
+        }
+        else
+        {
+            cbdata.cd(cbdata.context);
+            result = OC_STACK_ERROR;
+        }
+
+        if (OC_STACK_OK != result)
+        {
+            return result;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_deadlineLock);
+            m_deadlines.insert(std::make_pair(std::chrono::steady_clock::now() + timeout,
+                                              std::weak_ptr<ResourceDiscovery>(discovery)));
+            if (!m_deadlineThread.joinable())
+            {
+                m_deadlineThread = std::thread(&InProcClientWrapper::deadlineFunc, this);
+            }
+        }
+        m_deadlineCond.notify_one();
+
+        *session = discovery;
+        return OC_STACK_OK;
+    }
+
+    void InProcClientWrapper::deadlineFunc()
+    {
+        std::unique_lock<std::mutex> lock(m_deadlineLock);
+        while (!m_deadlineStop)
+        {
+            if (m_deadlines.empty())
+            {
+                m_deadlineCond.wait(lock);
+                continue;
+            }
+
+            auto next = m_deadlines.begin();
+            if (std::chrono::steady_clock::now() < next->first)
+            {
+                m_deadlineCond.wait_until(lock, next->first);
+                continue;
+            }
+
+            // Already gone if the stack stopped or the discovery ended some other way
+            std::shared_ptr<ResourceDiscovery> discovery = next->second.lock();
+            m_deadlines.erase(next);
+            if (discovery)
+            {
+                lock.unlock();
+                discovery->finish();
+                discovery.reset();
+                lock.lock();
+            }
+        }
+    }
+
     OCStackResult InProcClientWrapper::ListenErrorForResource(
             const std::string& serviceUrl,
             const std::string& resourceType,
@@ -335,8 +691,7 @@ namespace OC
         try
         {
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            postCallback(context, std::bind(context->callback, std::move(rep)));
         }
         catch(OC::OCException& e)
         {
@@ -401,8 +756,18 @@ namespace OC
             for(int i = 0; i < clientResponse->numRcvdVendorSpecificHeaderOptions; i++)
             {
                 optionID = clientResponse->rcvdVendorSpecificHeaderOptions[i].optionID;
-                optionData = reinterpret_cast<const char*>
-                                (clientResponse->rcvdVendorSpecificHeaderOptions[i].optionData);
+                if (HeaderOption::ETAG_OPTION_ID == optionID)
+                {
+                    // opaque bytes, may contain null characters
+                    optionData.assign(reinterpret_cast<const char*>
+                            (clientResponse->rcvdVendorSpecificHeaderOptions[i].optionData),
+                            clientResponse->rcvdVendorSpecificHeaderOptions[i].optionLength);
+                }
+                else
+                {
+                    optionData = reinterpret_cast<const char*>
+                            (clientResponse->rcvdVendorSpecificHeaderOptions[i].optionData);
+                }
                 HeaderOption::OCHeaderOption headerOption(optionID, optionData);
                 serverHeaderOptions.push_back(headerOption);
             }
@@ -438,8 +803,8 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        postCallback(context, std::bind(context->callback, std::move(serverHeaderOptions),
+                    std::move(rep), result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -469,10 +834,11 @@ namespace OC
         if (cLock)
         {
             std::lock_guard<std::recursive_mutex> lock(*cLock);
+            OCDoHandle handle;
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
             result = OCDoResource(
-                                  nullptr, OC_REST_GET,
+                                  &handle, OC_REST_GET,
                                   uri.c_str(),
                                   &devAddr, nullptr,
                                   CT_DEFAULT,
@@ -480,6 +846,10 @@ namespace OC
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   headerOptions.size());
+            if (OC_STACK_OK == result)
+            {
+                result = cancelOnFailure(handle, OCSetRequestRawPayload(handle, true));
+            }
         }
         else
         {
@@ -489,6 +859,70 @@ namespace OC
         return result;
     }
 
+    OCStackResult InProcClientWrapper::GetResourceRepresentations(
+        std::vector<GetRequest>& requests,
+        const QueryParamsMap& queryParams,
+        QualityOfService QoS, uint32_t timeoutMs)
+    {
+        std::vector<std::string> uris;
+        uris.reserve(requests.size());
+        for (const GetRequest& request : requests)
+        {
+            uris.push_back(assembleSetResourceUri(request.uri, queryParams));
+        }
+
+        auto cLock = m_csdkLock.lock();
+        if (!cLock)
+        {
+            for (GetRequest& request : requests)
+            {
+                request.result = OC_STACK_ERROR;
+            }
+            return OC_STACK_ERROR;
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(*cLock);
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            GetRequest& request = requests[i];
+            if (!request.callback)
+            {
+                request.result = OC_STACK_INVALID_PARAM;
+                continue;
+            }
+
+            ClientCallbackContext::GetContext* ctx =
+                new ClientCallbackContext::GetContext(request.callback);
+            OCCallbackData cbdata;
+            cbdata.context = static_cast<void*>(ctx),
+            cbdata.cb      = getResourceCallback;
+            cbdata.cd      = [](void* c){delete (ClientCallbackContext::GetContext*)c;};
+
+            OCDoHandle handle;
+            OCHeaderOption options[MAX_HEADER_OPTIONS];
+
+            request.result = OCDoResource(
+                                  &handle, OC_REST_GET,
+                                  uris[i].c_str(),
+                                  &request.devAddr, nullptr,
+                                  CT_DEFAULT,
+                                  static_cast<OCQualityOfService>(QoS),
+                                  &cbdata,
+                                  assembleHeaderOptions(options, request.headerOptions),
+                                  request.headerOptions.size());
+            if (OC_STACK_OK == request.result)
+            {
+                request.result = OCSetRequestRawPayload(handle, true);
+                if (OC_STACK_OK == request.result)
+                {
+                    request.result = OCSetRequestTimeout(handle, timeoutMs);
+                }
+                cancelOnFailure(handle, request.result);
+            }
+        }
+        return OC_STACK_OK;
+    }
+
 
     OCStackApplicationResult setResourceCallback(void* ctx,
                                                  OCDoHandle /*handle*/,
@@ -516,8 +950,8 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        postCallback(context, std::bind(context->callback, std::move(serverHeaderOptions),
+                    std::move(attrs), result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -568,7 +1002,7 @@ namespace OC
             ocInfo.addRepresentation(r);
         }
 
-        return reinterpret_cast<OCPayload*>(ocInfo.getPayload());
+        return ocInfo.getEncodedPayload();
     }
 
     OCStackResult InProcClientWrapper::PostResourceRepresentation(
@@ -583,6 +1017,8 @@ namespace OC
         {
             return OC_STACK_INVALID_PARAM;
         }
+        // Encoded before taking the stack lock, which only covers queuing the request
+        OCPayload* payload = assembleSetResourcePayload(rep);
         OCStackResult result;
         ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
         OCCallbackData cbdata;
@@ -598,20 +1034,26 @@ namespace OC
         if (cLock)
         {
             std::lock_guard<std::recursive_mutex> lock(*cLock);
+            OCDoHandle handle;
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(nullptr, OC_REST_POST,
+            result = OCDoResource(&handle, OC_REST_POST,
                                   url.c_str(), &devAddr,
-                                  assembleSetResourcePayload(rep),
+                                  payload,
                                   connectivityType,
                                   static_cast<OCQualityOfService>(QoS),
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   headerOptions.size());
+            if (OC_STACK_OK == result)
+            {
+                result = cancelOnFailure(handle, OCSetRequestRawPayload(handle, true));
+            }
         }
         else
         {
             delete ctx;
+            OCPayloadDestroy(payload);
             result = OC_STACK_ERROR;
         }
 
@@ -629,6 +1071,8 @@ namespace OC
         {
             return OC_STACK_INVALID_PARAM;
         }
+        // Encoded before taking the stack lock, which only covers queuing the request
+        OCPayload* payload = assembleSetResourcePayload(rep);
         OCStackResult result;
         ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
         OCCallbackData cbdata;
@@ -649,16 +1093,21 @@ namespace OC
 
             result = OCDoResource(&handle, OC_REST_PUT,
                                   url.c_str(), &devAddr,
-                                  assembleSetResourcePayload(rep),
+                                  payload,
                                   CT_DEFAULT,
                                   static_cast<OCQualityOfService>(QoS),
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   headerOptions.size());
+            if (OC_STACK_OK == result)
+            {
+                result = cancelOnFailure(handle, OCSetRequestRawPayload(handle, true));
+            }
         }
         else
         {
             delete ctx;
+            OCPayloadDestroy(payload);
             result = OC_STACK_ERROR;
         }
 
@@ -677,8 +1126,8 @@ namespace OC
         {
             parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         }
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        postCallback(context, std::bind(context->callback, std::move(serverHeaderOptions),
+                    clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -750,9 +1199,10 @@ namespace OC
                 result = e.code();
             }
         }
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        // A notification supersedes the ones still waiting when the application falls behind.
+        postCallback(context, std::bind(context->callback, std::move(serverHeaderOptions),
+                    std::move(attrs), result, sequenceNumber),
+                CallbackExecutor::Overflow::DropOldest);
         if (sequenceNumber == OC_OBSERVE_DEREGISTER)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -811,6 +1261,14 @@ namespace OC
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   headerOptions.size());
+            if (OC_STACK_OK == result)
+            {
+                result = cancelOnFailure(*handle, OCSetRequestRawPayload(*handle, true));
+                if (OC_STACK_OK != result)
+                {
+                    *handle = nullptr;
+                }
+            }
         }
         else
         {
@@ -861,10 +1319,9 @@ namespace OC
          */
         std::string url = clientResponse->devAddr.addr;
 
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        postCallback(context, std::bind(context->callback, clientResponse->result,
+                    clientResponse->sequenceNumber, url),
+                CallbackExecutor::Overflow::DropOldest);
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -947,8 +1404,18 @@ namespace OC
             options[i] = OCHeaderOption();
             options[i].protocolID = OC_COAP_ID;
             options[i].optionID = it->getOptionID();
-            options[i].optionLength = it->getOptionData().length() + 1;
-            strcpy((char*)options[i].optionData, (it->getOptionData().c_str()));
+            if (HeaderOption::ETAG_OPTION_ID == options[i].optionID)
+            {
+                options[i].optionLength = std::min(it->getOptionData().length(),
+                                                   sizeof(options[i].optionData));
+                memcpy(options[i].optionData, it->getOptionData().data(),
+                       options[i].optionLength);
+            }
+            else
+            {
+                options[i].optionLength = it->getOptionData().length() + 1;
+                strcpy((char*)options[i].optionData, (it->getOptionData().c_str()));
+            }
             i++;
         }
 
@@ -1004,8 +1471,6 @@ namespace OC
             }
             else {
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
                 result = OC_STACK_OK;
             }
         }
@@ -1014,6 +1479,12 @@ namespace OC
             result = OC_STACK_ERROR;
         }
 
+        // Run inline, the callback must not hold the stack lock.
+        if (OC_STACK_OK == result)
+        {
+            postCallback(this, std::bind(callback, dpDeviceList));
+        }
+
         return result;
     }
 
@@ -1043,8 +1514,6 @@ namespace OC
             }
             else {
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
                 result = OC_STACK_OK;
             }
         }
@@ -1053,6 +1522,12 @@ namespace OC
             result = OC_STACK_ERROR;
         }
 
+        // Run inline, the callback must not hold the stack lock.
+        if (OC_STACK_OK == result)
+        {
+            postCallback(this, std::bind(callback, dpDeviceList));
+        }
+
         return result;
     }
 
@@ -1063,8 +1538,7 @@ namespace OC
         ClientCallbackContext::DirectPairingContext* context =
             static_cast<ClientCallbackContext::DirectPairingContext*>(ctx);
 
-        std::thread exec(context->callback, cloneDevice(peer), result);
-        exec.detach();
+        postCallback(context, std::bind(context->callback, cloneDevice(peer), result));
     }
 
     OCStackResult InProcClientWrapper::DoDirectPairing(std::shared_ptr<OCDirectPairing> peer,
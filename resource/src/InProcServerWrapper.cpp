@@ -23,15 +23,19 @@
 #include <cstdlib>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <InProcServerWrapper.h>
+#include <CallbackExecutor.h>
 #include <InitializeException.h>
 #include <OCResourceRequest.h>
 #include <OCResourceResponse.h>
 #include <ocstack.h>
+#include <ocpayload.h>
 #include <OCApi.h>
 #include <oic_malloc.h>
 #include <OCPlatform.h>
@@ -45,15 +49,178 @@ namespace OC
     namespace details
     {
         std::mutex serverWrapperLock;
-        std::map <OCResourceHandle, OC::EntityHandler>  entityHandlerMap;
-        std::map <OCResourceHandle, std::string> resourceUriMap;
         EntityHandler defaultDeviceEntityHandler;
+
+        std::recursive_mutex resourceTableLock;
+        std::atomic<std::thread::id> processThreadId;
+    }
+
+    ResourceTableLock::ResourceTableLock()
+     : m_locked(std::this_thread::get_id() != OC::details::processThreadId.load())
+    {
+        if(m_locked)
+        {
+            OC::details::resourceTableLock.lock();
+        }
+    }
+
+    ResourceTableLock::~ResourceTableLock()
+    {
+        if(m_locked)
+        {
+            OC::details::resourceTableLock.unlock();
+        }
+    }
+
+    /**
+    * The entity handler of a resource and what its requests are built with. The stack
+    * hands it back as the callback parameter of every request to the resource, so
+    * dispatching a request does not look anything up.
+    */
+    struct ResourceEntityHandler : public std::enable_shared_from_this<ResourceEntityHandler>
+    {
+        InProcServerWrapper* server;
+        EntityHandler handler;
+        std::string uri;
+        // Resources registered with a schema read the payload themselves
+        bool convertPayload;
+    };
+}
+
+namespace
+{
+    // Releases a held lock for its lifetime and takes it again on the way out.
+    class ReverseLock
+    {
+    public:
+        explicit ReverseLock(std::recursive_mutex& mutex)
+         : m_mutex(mutex)
+        {
+            m_mutex.unlock();
+        }
+
+        ~ReverseLock()
+        {
+            m_mutex.lock();
+        }
+
+    private:
+        std::recursive_mutex& m_mutex;
+    };
+
+    // Keeps the blocks of released requests for the next ones, so once warmed up
+    // building a request does not allocate its OCResourceRequest.
+    class RequestBlockPool
+    {
+    public:
+        RequestBlockPool()
+         : m_blockSize(0)
+        {
+            m_blocks.reserve(MAX_POOLED_REQUESTS);
+        }
+
+        ~RequestBlockPool()
+        {
+            for(void* block : m_blocks)
+            {
+                ::operator delete(block);
+            }
+        }
+
+        void* allocate(size_t size)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if(size == m_blockSize && !m_blocks.empty())
+                {
+                    void* block = m_blocks.back();
+                    m_blocks.pop_back();
+                    return block;
+                }
+            }
+            return ::operator new(size);
+        }
+
+        void deallocate(void* block, size_t size)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if(0 == m_blockSize)
+                {
+                    m_blockSize = size;
+                }
+                if(size == m_blockSize && m_blocks.size() < MAX_POOLED_REQUESTS)
+                {
+                    m_blocks.push_back(block);
+                    return;
+                }
+            }
+            ::operator delete(block);
+        }
+
+    private:
+        static const size_t MAX_POOLED_REQUESTS = 32;
+
+        std::mutex m_lock;
+        size_t m_blockSize;
+        std::vector<void*> m_blocks;
+    };
+
+    template<typename T>
+    class RequestAllocator
+    {
+    public:
+        typedef T value_type;
+
+        explicit RequestAllocator(std::shared_ptr<RequestBlockPool> pool)
+         : m_pool(std::move(pool))
+        {
+        }
+
+        template<typename U>
+        RequestAllocator(const RequestAllocator<U>& other)
+         : m_pool(other.m_pool)
+        {
+        }
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(m_pool->allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            m_pool->deallocate(p, n * sizeof(T));
+        }
+
+        template<typename U>
+        bool operator==(const RequestAllocator<U>& other) const
+        {
+            return m_pool == other.m_pool;
+        }
+
+        template<typename U>
+        bool operator!=(const RequestAllocator<U>& other) const
+        {
+            return m_pool != other.m_pool;
+        }
+
+        // Requests handed to the application keep the pool alive
+        std::shared_ptr<RequestBlockPool> m_pool;
+    };
+
+    std::shared_ptr<OCResourceRequest> makeResourceRequest()
+    {
+        static std::shared_ptr<RequestBlockPool> pool = std::make_shared<RequestBlockPool>();
+        return std::allocate_shared<OCResourceRequest>(
+                RequestAllocator<OCResourceRequest>(pool));
     }
 }
 
 void formResourceRequest(OCEntityHandlerFlag flag,
                          OCEntityHandlerRequest * entityHandlerRequest,
-                         std::shared_ptr<OCResourceRequest> pRequest)
+                         std::shared_ptr<OCResourceRequest> pRequest,
+                         bool convertPayload)
 {
     if(pRequest && entityHandlerRequest)
     {
@@ -90,8 +257,18 @@ void formResourceRequest(OCEntityHandlerFlag flag,
                     i++)
                 {
                     optionID = entityHandlerRequest->rcvdVendorSpecificHeaderOptions[i].optionID;
-                    optionData = reinterpret_cast<const char*>
+                    if (HeaderOption::ETAG_OPTION_ID == optionID)
+                    {
+                        // opaque bytes, may contain null characters
+                        optionData.assign(reinterpret_cast<const char*>
+                             (entityHandlerRequest->rcvdVendorSpecificHeaderOptions[i].optionData),
+                             entityHandlerRequest->rcvdVendorSpecificHeaderOptions[i].optionLength);
+                    }
+                    else
+                    {
+                        optionData = reinterpret_cast<const char*>
                              (entityHandlerRequest->rcvdVendorSpecificHeaderOptions[i].optionData);
+                    }
                     HeaderOption::OCHeaderOption headerOption(optionID, optionData);
                     headerOptions.push_back(headerOption);
                 }
@@ -105,12 +282,26 @@ void formResourceRequest(OCEntityHandlerFlag flag,
             else if(OC_REST_PUT == entityHandlerRequest->method)
             {
                 pRequest->setRequestType(OC::PlatformCommands::PUT);
-                pRequest->setPayload(entityHandlerRequest->payload);
+                if (convertPayload)
+                {
+                    pRequest->setPayload(entityHandlerRequest->payload);
+                }
+                else
+                {
+                    pRequest->setSchemaPayload(entityHandlerRequest->payload);
+                }
             }
             else if(OC_REST_POST == entityHandlerRequest->method)
             {
                 pRequest->setRequestType(OC::PlatformCommands::POST);
-                pRequest->setPayload(entityHandlerRequest->payload);
+                if (convertPayload)
+                {
+                    pRequest->setPayload(entityHandlerRequest->payload);
+                }
+                else
+                {
+                    pRequest->setSchemaPayload(entityHandlerRequest->payload);
+                }
             }
             else if(OC_REST_DELETE == entityHandlerRequest->method)
             {
@@ -143,7 +334,7 @@ void formResourceRequest(OCEntityHandlerFlag flag,
 OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
                                                   OCEntityHandlerRequest * entityHandlerRequest,
                                                   char* uri,
-                                                  void * /*callbackParam*/)
+                                                  void * callbackParam)
 {
     OCEntityHandlerResult result = OC_EH_ERROR;
 
@@ -155,9 +346,9 @@ OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
         return OC_EH_ERROR;
     }
 
-    auto pRequest = std::make_shared<OC::OCResourceRequest>();
+    auto pRequest = makeResourceRequest();
 
-    formResourceRequest(flag, entityHandlerRequest, pRequest);
+    formResourceRequest(flag, entityHandlerRequest, pRequest, true);
 
     pRequest->setResourceUri(std::string(uri));
 
@@ -169,7 +360,8 @@ OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
 
     if(defHandler)
     {
-        result = defHandler(pRequest);
+        result = static_cast<InProcServerWrapper*>(callbackParam)->dispatchEntityHandler(
+                    defHandler, pRequest);
     }
     else
     {
@@ -183,10 +375,8 @@ OCEntityHandlerResult DefaultEntityHandlerWrapper(OCEntityHandlerFlag flag,
 
 OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
                                            OCEntityHandlerRequest * entityHandlerRequest,
-                                           void* /*callbackParam*/)
+                                           void* callbackParam)
 {
-    OCEntityHandlerResult result = OC_EH_ERROR;
-
     oclog() << "\nIn entity handler wrapper: " << endl;
 
     if(NULL == entityHandlerRequest)
@@ -195,64 +385,24 @@ OCEntityHandlerResult EntityHandlerWrapper(OCEntityHandlerFlag flag,
         return OC_EH_ERROR;
     }
 
-    auto pRequest = std::make_shared<OC::OCResourceRequest>();
-
-    formResourceRequest(flag, entityHandlerRequest, pRequest);
-
-    std::map <OCResourceHandle, std::string>::iterator resourceUriEntry;
-    std::map <OCResourceHandle, std::string>::iterator resourceUriEnd;
-    {
-        std::lock_guard<std::mutex> lock(OC::details::serverWrapperLock);
-        resourceUriEntry = OC::details::resourceUriMap.find(entityHandlerRequest->resource);
-        resourceUriEnd = OC::details::resourceUriMap.end();
-    }
-    // Finding the corresponding URI for a resource handle and set the URI in the request
-    if(resourceUriEntry != resourceUriEnd)
-    {
-        pRequest->setResourceUri(resourceUriEntry->second);
-    }
-    else
-    {
-        oclog() << "Resource handle not found; Resource URI not set in request";
-        return OC_EH_ERROR;
-    }
-
-    std::map <OCResourceHandle, OC::EntityHandler>::iterator entityHandlerEntry;
-    std::map <OCResourceHandle, OC::EntityHandler>::iterator entityHandlerEnd;
-    {
-        // Finding the corresponding CPP Application entityHandler for a given resource
-        std::lock_guard<std::mutex> lock(OC::details::serverWrapperLock);
-        entityHandlerEntry = OC::details::entityHandlerMap.find(entityHandlerRequest->resource);
-        entityHandlerEnd = OC::details::entityHandlerMap.end();
-    }
-
-    if(entityHandlerEntry != entityHandlerEnd)
-    {
-        // Call CPP Application Entity Handler
-        if(entityHandlerEntry->second)
-        {
-            result = entityHandlerEntry->second(pRequest);
-        }
-        else
-        {
-            oclog() << "C stack should not call again for parent resource\n";
-            return OC_EH_ERROR;
-        }
-    }
-    else
+    if(NULL == callbackParam)
     {
         oclog() << "No entity handler found."  << endl;
         return OC_EH_ERROR;
     }
 
-    return result;
+    // The stack calls this holding its lock, which a resource being unregistered
+    // also needs, so the handler is still registered here; the reference taken
+    // keeps it while the handler runs.
+    auto resource = static_cast<ResourceEntityHandler*>(callbackParam)->shared_from_this();
+    return resource->server->dispatchEntityHandler(resource, flag, entityHandlerRequest);
 }
 
 namespace OC
 {
     InProcServerWrapper::InProcServerWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
-     : m_csdkLock(csdkLock)
+     : m_inEntityHandler(false), m_csdkLock(csdkLock)
     {
         OCMode initType;
 
@@ -285,12 +435,20 @@ namespace OC
             throw InitializeException(OC::InitException::STACK_INIT_ERROR, result);
         }
 
+        if(cfg.entityHandlerExecution == CallbackExecution::ThreadPool)
+        {
+            m_entityHandlerExecutor.reset(new CallbackExecutor(cfg.entityHandlerExecution,
+                        cfg.entityHandlerThreads, cfg.entityHandlerQueueSize));
+        }
+
         m_threadRun = true;
         m_processThread = std::thread(&InProcServerWrapper::processFunc, this);
     }
 
     void InProcServerWrapper::processFunc()
     {
+        OC::details::processThreadId = std::this_thread::get_id();
+
         auto cLock = m_csdkLock.lock();
         while(cLock && m_threadRun)
         {
@@ -309,6 +467,163 @@ namespace OC
 
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
+
+        OC::details::processThreadId = std::thread::id();
+    }
+
+    OCEntityHandlerResult InProcServerWrapper::runEntityHandler(
+                    const EntityHandler& entityHandler,
+                    std::shared_ptr<OCResourceRequest> request)
+    {
+        auto cLock = m_csdkLock.lock();
+        if(!cLock || m_inEntityHandler ||
+           std::this_thread::get_id() != OC::details::processThreadId.load())
+        {
+            return entityHandler(request);
+        }
+
+        // Another thread waiting to change resources holds the table lock; the stack
+        // may still be using the resource afterwards, so keep the stack lock then.
+        // Otherwise no thread holding the stack lock can be waiting for the table
+        // lock, see ResourceTableLock, so the stack lock is released and taken back.
+        std::unique_lock<std::recursive_mutex> tableLock(OC::details::resourceTableLock,
+                                                         std::try_to_lock);
+        OCEntityHandlerResult result = OC_EH_ERROR;
+        m_inEntityHandler = true;
+        try
+        {
+            if(tableLock.owns_lock())
+            {
+                ReverseLock unlocked(*cLock);
+                result = entityHandler(request);
+            }
+            else
+            {
+                result = entityHandler(request);
+            }
+        }
+        catch(...)
+        {
+            m_inEntityHandler = false;
+            throw;
+        }
+        m_inEntityHandler = false;
+
+        return result;
+    }
+
+    OCEntityHandlerResult InProcServerWrapper::dispatchEntityHandler(
+                    const EntityHandler& entityHandler,
+                    std::shared_ptr<OCResourceRequest> request)
+    {
+        // Only requests get a response; observe-only calls still run in place
+        if(!m_entityHandlerExecutor ||
+           !(request->getRequestHandlerFlag() & RequestHandlerFlag::RequestFlag))
+        {
+            return runEntityHandler(entityHandler, request);
+        }
+
+        // The stack frees the request payload when the wrapper returns
+        request->keepSchemaPayload();
+
+        auto pending = std::make_pair(request->getRequestHandle(), request->getResourceHandle());
+        {
+            std::lock_guard<std::mutex> lock(m_pendingLock);
+            m_pendingResponses.insert(pending);
+        }
+
+        CallbackExecutor::PostResult posted = m_entityHandlerExecutor->tryPost(
+                    request->getResourceHandle(),
+                    std::bind(&InProcServerWrapper::runPooledEntityHandler, this,
+                              entityHandler, request));
+        if(CallbackExecutor::PostResult::Queued == posted)
+        {
+            return OC_EH_SLOW;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_pendingLock);
+            m_pendingResponses.erase(pending);
+        }
+
+        // The pool is full. Handlers of a resource run one at a time, so a request to a
+        // resource whose handlers are still pending is refused, and the stack answers it
+        // with an error.
+        if(CallbackExecutor::PostResult::KeyBusy == posted)
+        {
+            oclog() << "Entity handler queue full, refusing request to "
+                    << request->getResourceUri() << std::flush;
+            return OC_EH_ERROR;
+        }
+
+        // Otherwise the handler runs in place, as it would without a pool.
+        return runEntityHandler(entityHandler, request);
+    }
+
+    OCEntityHandlerResult InProcServerWrapper::dispatchEntityHandler(
+                    const std::shared_ptr<ResourceEntityHandler>& resource,
+                    OCEntityHandlerFlag flag,
+                    OCEntityHandlerRequest* entityHandlerRequest)
+    {
+        auto request = makeResourceRequest();
+        try
+        {
+            formResourceRequest(flag, entityHandlerRequest, request, resource->convertPayload);
+        }
+        catch(OC::OCException& e)
+        {
+            oclog() << "Malformed request payload: " << e.what() << endl;
+            return OC_EH_ERROR;
+        }
+        request->setResourceUri(std::shared_ptr<const std::string>(resource, &resource->uri));
+
+        return dispatchEntityHandler(resource->handler, request);
+    }
+
+    void InProcServerWrapper::runPooledEntityHandler(const EntityHandler& entityHandler,
+                    std::shared_ptr<OCResourceRequest> request)
+    {
+        OCEntityHandlerResult result = OC_EH_ERROR;
+        try
+        {
+            result = entityHandler(request);
+        }
+        catch(std::exception& e)
+        {
+            oclog() << "Exception in entity handler: " << e.what() << std::flush;
+        }
+        catch(...)
+        {
+            oclog() << "Unknown exception in entity handler" << std::flush;
+        }
+
+        bool responded;
+        {
+            std::lock_guard<std::mutex> lock(m_pendingLock);
+            responded = 0 == m_pendingResponses.erase(
+                    std::make_pair(request->getRequestHandle(), request->getResourceHandle()));
+        }
+
+        // The request is already slow, so the stack keeps it until it is answered.
+        // Answer a handler that did not respond with its result, unless it said it
+        // will respond later
+        if(!responded && OC_EH_SLOW != result)
+        {
+            OCEntityHandlerResponse response {};
+            response.requestHandle = request->getRequestHandle();
+            response.resourceHandle = request->getResourceHandle();
+            response.ehResult = result;
+
+            auto cLock = m_csdkLock.lock();
+            if(cLock)
+            {
+                std::lock_guard<std::recursive_mutex> lock(*cLock);
+                if(OC_STACK_OK != OCDoResponse(&response))
+                {
+                    oclog() << "Error sending response\n";
+                }
+            }
+        }
     }
 
     OCStackResult InProcServerWrapper::registerDeviceInfo(const OCDeviceInfo deviceInfo)
@@ -350,16 +665,24 @@ namespace OC
 
         if(cLock)
         {
+            ResourceTableLock tableLock;
             std::lock_guard<std::recursive_mutex> lock(*cLock);
 
+            std::shared_ptr<ResourceEntityHandler> resource;
             if(NULL != eHandler)
             {
+                resource = std::make_shared<ResourceEntityHandler>();
+                resource->server = this;
+                resource->handler = eHandler;
+                resource->uri = resourceURI;
+                resource->convertPayload = !eHandler.target<SchemaEntityHandler>();
+
                 result = OCCreateResource(&resourceHandle, // OCResourceHandle *handle
                             resourceTypeName.c_str(), // const char * resourceTypeName
                             resourceInterface.c_str(), //const char * resourceInterfaceName //TODO fix this
                             resourceURI.c_str(), // const char * uri
                             EntityHandlerWrapper, // OCEntityHandler entityHandler
-                            NULL,
+                            resource.get(), // void* callbackParam
                             resourceProperties // uint8_t resourceProperties
                             );
             }
@@ -381,9 +704,15 @@ namespace OC
             }
             else
             {
-                std::lock_guard<std::mutex> lock(OC::details::serverWrapperLock);
-                OC::details::entityHandlerMap[resourceHandle] = eHandler;
-                OC::details::resourceUriMap[resourceHandle] = resourceURI;
+                if (resource)
+                {
+                    // Schema resources decode the parsed payload, the rest decode the CBOR
+                    if (resource->convertPayload)
+                    {
+                        OCSetResourceRawPayload(resourceHandle, true);
+                    }
+                    m_resourceHandlers[resourceHandle] = resource;
+                }
             }
         }
         else
@@ -406,9 +735,17 @@ namespace OC
             OC::details::defaultDeviceEntityHandler = entityHandler;
         }
 
+        auto cLock = m_csdkLock.lock();
+        if(!cLock)
+        {
+            return result;
+        }
+
+        ResourceTableLock tableLock;
+        std::lock_guard<std::recursive_mutex> lock(*cLock);
         if(entityHandler)
         {
-            result = OCSetDefaultDeviceEntityHandler(DefaultEntityHandlerWrapper, NULL);
+            result = OCSetDefaultDeviceEntityHandler(DefaultEntityHandlerWrapper, this);
         }
         else
         {
@@ -426,13 +763,13 @@ namespace OC
 
         if(cLock)
         {
+            ResourceTableLock tableLock;
             std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCDeleteResource(resourceHandle);
 
             if(result == OC_STACK_OK)
             {
-                std::lock_guard<std::mutex> lock(OC::details::serverWrapperLock);
-                OC::details::resourceUriMap.erase(resourceHandle);
+                m_resourceHandlers.erase(resourceHandle);
             }
             else
             {
@@ -454,6 +791,7 @@ namespace OC
         OCStackResult result;
         if(cLock)
         {
+            ResourceTableLock tableLock;
             std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCBindResourceTypeToResource(resourceHandle, resourceTypeName.c_str());
         }
@@ -477,6 +815,7 @@ namespace OC
         OCStackResult result;
         if(cLock)
         {
+            ResourceTableLock tableLock;
             std::lock_guard<std::recursive_mutex> lock(*cLock);
             result = OCBindResourceInterfaceToResource(resourceHandle,
                         resourceInterfaceName.c_str());
@@ -548,7 +887,23 @@ namespace OC
             response.resourceHandle = pResponse->getResourceHandle();
             response.ehResult = pResponse->getResponseResult();
 
-            response.payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+            if(m_entityHandlerExecutor)
+            {
+                std::lock_guard<std::mutex> lock(m_pendingLock);
+                m_pendingResponses.erase(
+                        std::make_pair(response.requestHandle, response.resourceHandle));
+            }
+
+            const std::vector<uint8_t>& schemaPayload = pResponse->getSchemaPayload();
+            if (!schemaPayload.empty())
+            {
+                response.payload = reinterpret_cast<OCPayload*>(
+                        OCEncodedPayloadCreate(schemaPayload.data(), schemaPayload.size()));
+            }
+            else
+            {
+                response.payload = pResponse->getPayload();
+            }
 
             response.persistentBufferFlag = 0;
 
@@ -559,14 +914,28 @@ namespace OC
                 response.sendVendorSpecificHeaderOptions[i].protocolID = OC_COAP_ID;
                 response.sendVendorSpecificHeaderOptions[i].optionID =
                     static_cast<uint16_t>(it->getOptionID());
-                response.sendVendorSpecificHeaderOptions[i].optionLength =
-                    (it->getOptionData()).length() + 1;
                 std::string optionData = it->getOptionData();
-                std::copy(optionData.begin(),
-                         optionData.end(),
-                         response.sendVendorSpecificHeaderOptions[i].optionData);
-                response.sendVendorSpecificHeaderOptions[i].optionData[it->getOptionData().length()]
-                    = '\0';
+                if (HeaderOption::ETAG_OPTION_ID == it->getOptionID())
+                {
+                    // sent as is; entity tags are opaque
+                    optionData.resize(std::min(optionData.length(),
+                                               static_cast<size_t>(MAX_ETAG_LENGTH)));
+                    response.sendVendorSpecificHeaderOptions[i].optionLength =
+                        optionData.length();
+                    std::copy(optionData.begin(),
+                             optionData.end(),
+                             response.sendVendorSpecificHeaderOptions[i].optionData);
+                }
+                else
+                {
+                    response.sendVendorSpecificHeaderOptions[i].optionLength =
+                        optionData.length() + 1;
+                    std::copy(optionData.begin(),
+                             optionData.end(),
+                             response.sendVendorSpecificHeaderOptions[i].optionData);
+                    response.sendVendorSpecificHeaderOptions[i].optionData[optionData.length()]
+                        = '\0';
+                }
                 i++;
             }
 
@@ -604,6 +973,9 @@ namespace OC
             m_processThread.join();
         }
 
+        // Handlers still queued may send their responses
+        m_entityHandlerExecutor.reset();
+
         OCStop();
     }
 }
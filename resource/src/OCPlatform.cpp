@@ -83,6 +83,13 @@ namespace OC
                                      resourceTypes, interfaces);
         }
 
+        std::vector<RequestResult> getAll(const std::vector<OCResource::Ptr>& resources,
+                                     const QueryParamsMap& queryParametersMap,
+                                     std::chrono::milliseconds timeout)
+        {
+            return OCPlatform_impl::Instance().getAll(resources, queryParametersMap, timeout);
+        }
+
         OCStackResult findResource(const std::string& host,
                                  const std::string& resourceName,
                                  OCConnectivityType connectivityType,
@@ -123,6 +130,31 @@ namespace OC
                                     connectivityType, resourceHandler, errorHandler, QoS);
         }
 
+        OCStackResult findResources(OCDiscoverySession::Ptr& session,
+                                 const std::string& host,
+                                 const std::string& resourceName,
+                                 OCConnectivityType connectivityType,
+                                 std::chrono::milliseconds timeout,
+                                 FindResourcesCallback resourcesHandler,
+                                 FindDoneCallback doneHandler)
+        {
+            return OCPlatform_impl::Instance().findResources(session, host, resourceName,
+                                 connectivityType, timeout, resourcesHandler, doneHandler);
+        }
+
+        OCStackResult findResources(OCDiscoverySession::Ptr& session,
+                                 const std::string& host,
+                                 const std::string& resourceName,
+                                 OCConnectivityType connectivityType,
+                                 std::chrono::milliseconds timeout,
+                                 FindResourcesCallback resourcesHandler,
+                                 FindDoneCallback doneHandler,
+                                 QualityOfService QoS)
+        {
+            return OCPlatform_impl::Instance().findResources(session, host, resourceName,
+                                 connectivityType, timeout, resourcesHandler, doneHandler, QoS);
+        }
+
         OCStackResult getDeviceInfo(const std::string& host,
                                  const std::string& deviceURI,
                                  OCConnectivityType connectivityType,
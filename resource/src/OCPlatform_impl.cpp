@@ -32,6 +32,8 @@
 
 #include "OCPlatform_impl.h"
 
+#include <algorithm>
+#include <chrono>
 #include <random>
 #include <utility>
 #include <functional>
@@ -108,6 +110,10 @@ namespace OC
     OCStackResult OCPlatform_impl::notifyAllObservers(OCResourceHandle resourceHandle,
                                                 QualityOfService QoS)
     {
+        // The stack renders the notification with the entity handler, which may register
+        // resources of its own.
+        ResourceTableLock tableLock;
+        std::lock_guard<std::recursive_mutex> lock(*m_csdkLock);
         return result_guard(OCNotifyAllObservers(resourceHandle,
                     static_cast<OCQualityOfService>(QoS)));
     }
@@ -135,11 +141,15 @@ namespace OC
         }
 
         OCRepPayload* pl = pResponse->getResourceRepresentation().getPayload();
-        OCStackResult result =
-                   OCNotifyListOfObservers(resourceHandle,
+        OCStackResult result;
+        {
+            ResourceTableLock tableLock;
+            std::lock_guard<std::recursive_mutex> lock(*m_csdkLock);
+            result = OCNotifyListOfObservers(resourceHandle,
                             &observationIds[0], observationIds.size(),
                             pl,
                             static_cast<OCQualityOfService>(QoS));
+        }
         OCRepPayloadDestroy(pl);
         return result_guard(result);
     }
@@ -169,6 +179,65 @@ namespace OC
                                             interfaces));
     }
 
+    std::vector<RequestResult> OCPlatform_impl::getAll(
+                                            const std::vector<OCResource::Ptr>& resources,
+                                            const QueryParamsMap& queryParametersMap,
+                                            std::chrono::milliseconds timeout)
+    {
+        // The responses could only arrive once this returns
+        if (details::isResponseThread())
+        {
+            throw OCException(OC::Exception::WAIT_ON_RESPONSE_THREAD, OC_STACK_ERROR);
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        uint32_t timeoutMs = static_cast<uint32_t>(std::max<int64_t>(1,
+                    std::min<int64_t>(timeout.count(), UINT32_MAX)));
+
+        std::vector<IClientWrapper::GetRequest> requests;
+        std::vector<RequestFuture> futures;
+        requests.reserve(resources.size());
+        futures.reserve(resources.size());
+        for (const OCResource::Ptr& resource : resources)
+        {
+            IClientWrapper::GetRequest request;
+            RequestFuture future;
+            if (resource)
+            {
+                request.devAddr = resource->m_devAddr;
+                request.uri = resource->m_uri;
+                request.callback = resource->validatingGetHandler(queryParametersMap,
+                        OCResource::futureCallback(future), request.headerOptions);
+            }
+            request.result = OC_STACK_INVALID_PARAM;
+            requests.push_back(std::move(request));
+            futures.push_back(std::move(future));
+        }
+
+        QualityOfService defaultQos = OC::QualityOfService::NaQos;
+        checked_guard(m_client, &IClientWrapper::GetDefaultQos, defaultQos);
+        checked_guard(m_client, &IClientWrapper::GetResourceRepresentations,
+                      requests, queryParametersMap, defaultQos, timeoutMs);
+
+        std::vector<RequestResult> results(resources.size());
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            if (OC_STACK_OK != requests[i].result)
+            {
+                results[i].result = requests[i].result;
+            }
+            else if (std::future_status::ready == futures[i].wait_until(deadline))
+            {
+                results[i] = futures[i].get();
+            }
+            else
+            {
+                results[i].result = OC_STACK_TIMEOUT;
+            }
+        }
+        return results;
+    }
+
     OCStackResult OCPlatform_impl::findResource(const std::string& host,
                                             const std::string& resourceName,
                                             OCConnectivityType connectivityType,
@@ -209,6 +278,32 @@ namespace OC
                              errorHandler, QoS);
     }
 
+    OCStackResult OCPlatform_impl::findResources(OCDiscoverySession::Ptr& session,
+                                            const std::string& host,
+                                            const std::string& resourceName,
+                                            OCConnectivityType connectivityType,
+                                            std::chrono::milliseconds timeout,
+                                            FindResourcesCallback resourcesHandler,
+                                            FindDoneCallback doneHandler)
+    {
+        return findResources(session, host, resourceName, connectivityType, timeout,
+                             resourcesHandler, doneHandler, m_cfg.QoS);
+    }
+
+    OCStackResult OCPlatform_impl::findResources(OCDiscoverySession::Ptr& session,
+                                            const std::string& host,
+                                            const std::string& resourceName,
+                                            OCConnectivityType connectivityType,
+                                            std::chrono::milliseconds timeout,
+                                            FindResourcesCallback resourcesHandler,
+                                            FindDoneCallback doneHandler,
+                                            QualityOfService QoS)
+    {
+        return checked_guard(m_client, &IClientWrapper::DiscoverResources,
+                             &session, host, resourceName, connectivityType, timeout,
+                             resourcesHandler, doneHandler, QoS);
+    }
+
     OCStackResult OCPlatform_impl::getDeviceInfo(const std::string& host,
                                             const std::string& deviceURI,
                                             OCConnectivityType connectivityType,
@@ -290,12 +385,16 @@ namespace OC
     OCStackResult OCPlatform_impl::unbindResource(OCResourceHandle collectionHandle,
                                             OCResourceHandle resourceHandle)
     {
+        ResourceTableLock tableLock;
+        std::lock_guard<std::recursive_mutex> lock(*m_csdkLock);
         return result_guard(OCUnBindResource(std::ref(collectionHandle), std::ref(resourceHandle)));
     }
 
     OCStackResult OCPlatform_impl::unbindResources(const OCResourceHandle collectionHandle,
                                             const std::vector<OCResourceHandle>& resourceHandles)
     {
+        ResourceTableLock tableLock;
+        std::lock_guard<std::recursive_mutex> lock(*m_csdkLock);
         for(const auto& h : resourceHandles)
         {
            OCStackResult r;
@@ -312,12 +411,16 @@ namespace OC
     OCStackResult OCPlatform_impl::bindResource(const OCResourceHandle collectionHandle,
                                             const OCResourceHandle resourceHandle)
     {
+        ResourceTableLock tableLock;
+        std::lock_guard<std::recursive_mutex> lock(*m_csdkLock);
         return result_guard(OCBindResource(collectionHandle, resourceHandle));
     }
 
     OCStackResult OCPlatform_impl::bindResources(const OCResourceHandle collectionHandle,
                                             const std::vector<OCResourceHandle>& resourceHandles)
     {
+        ResourceTableLock tableLock;
+        std::lock_guard<std::recursive_mutex> lock(*m_csdkLock);
         for(const auto& h : resourceHandles)
         {
            OCStackResult r;
@@ -59,6 +59,9 @@ namespace OC
             case PAYLOAD_TYPE_PLATFORM:
                 setPayload(reinterpret_cast<const OCPlatformPayload*>(rep));
                 break;
+            case PAYLOAD_TYPE_ENCODED:
+                setPayload(reinterpret_cast<const OCEncodedPayload*>(rep));
+                break;
             default:
                 throw OC::OCException("Invalid Payload type in setPayload");
                 break;
@@ -156,7 +159,7 @@ namespace OC
             cur.setPayload(pl);
 
             pl = pl->next;
-            this->addRepresentation(cur);
+            addRepresentation(std::move(cur));
         }
     }
 
@@ -183,10 +186,20 @@ namespace OC
         return m_reps;
     }
 
+    std::vector<OCRepresentation>& MessageContainer::representations()
+    {
+        return m_reps;
+    }
+
     void MessageContainer::addRepresentation(const OCRepresentation& rep)
     {
         m_reps.push_back(rep);
     }
+
+    void MessageContainer::addRepresentation(OCRepresentation&& rep)
+    {
+        m_reps.push_back(std::move(rep));
+    }
 }
 
 namespace OC
@@ -194,13 +207,13 @@ namespace OC
     struct get_payload_array: boost::static_visitor<>
     {
         template<typename T>
-        void operator()(T& /*arr*/)
+        void operator()(const T& /*arr*/)
         {
             throw std::logic_error("Invalid calc_dimensions_visitor type");
         }
 
         template<typename T>
-        void operator()(std::vector<T>& arr)
+        void operator()(const std::vector<T>& arr)
         {
             root_size_calc<T>();
             dimensions[0] = arr.size();
@@ -217,7 +230,7 @@ namespace OC
 
         }
         template<typename T>
-        void operator()(std::vector<std::vector<T>>& arr)
+        void operator()(const std::vector<std::vector<T>>& arr)
         {
             root_size_calc<T>();
             dimensions[0] = arr.size();
@@ -239,7 +252,7 @@ namespace OC
             }
         }
         template<typename T>
-        void operator()(std::vector<std::vector<std::vector<T>>>& arr)
+        void operator()(const std::vector<std::vector<std::vector<T>>>& arr)
         {
             root_size_calc<T>();
             dimensions[0] = arr.size();
@@ -351,7 +364,7 @@ namespace OC
                     const OCRepresentation::AttributeItem& item) const
     {
         get_payload_array vis{};
-        boost::apply_visitor(vis, m_values[item.attrname()]);
+        boost::apply_visitor(vis, item.value());
 
 
         switch(item.base_type())
@@ -525,7 +538,7 @@ namespace OC
             {
                 val[i] = payload_array_helper_copy<T>(i, pl);
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else if (depth == 2)
         {
@@ -539,7 +552,7 @@ namespace OC
                             i * pl->arr.dimensions[1] + j, pl);
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else if (depth == 3)
         {
@@ -560,7 +573,7 @@ namespace OC
                     }
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else
         {
@@ -612,6 +625,11 @@ namespace OC
             ll = ll->next;
         }
 
+        // A representation holds all values, so lazily parsed ones are decoded here.
+        if (!OCRepPayloadDecodeValues(const_cast<OCRepPayload*>(pl)))
+        {
+            throw std::logic_error("setPayload failed decoding values");
+        }
         OCRepPayloadValue* val = pl->values;
 
         while(val)
@@ -637,7 +655,7 @@ namespace OC
                     {
                         OCRepresentation cur;
                         cur.setPayload(val->obj);
-                        setValue<OCRepresentation>(val->name, cur);
+                        setValue(val->name, std::move(cur));
                     }
                     break;
                 case OCREP_PROP_ARRAY:
@@ -660,22 +678,30 @@ namespace OC
 
     void OCRepresentation::addChild(const OCRepresentation& rep)
     {
-        m_children.push_back(rep);
+        m_body.edit().children.push_back(rep);
+    }
+
+    void OCRepresentation::addChild(OCRepresentation&& rep)
+    {
+        m_body.edit().children.push_back(std::move(rep));
     }
 
     void OCRepresentation::clearChildren()
     {
-        m_children.clear();
+        if (!m_body.get().children.empty())
+        {
+            m_body.edit().children.clear();
+        }
     }
 
     const std::vector<OCRepresentation>& OCRepresentation::getChildren() const
     {
-        return m_children;
+        return m_body.get().children;
     }
 
     void OCRepresentation::setChildren(const std::vector<OCRepresentation>& children)
     {
-        m_children = children;
+        m_body.edit().children = children;
     }
 
     void OCRepresentation::setDevAddr(const OCDevAddr m_devAddr)
@@ -705,67 +731,67 @@ namespace OC
         {
             ss << ':' << m_devAddr.port;
         }
-        m_host = ss.str();
+        m_body.edit().host = ss.str();
     }
 
     const std::string OCRepresentation::getHost() const
     {
-        return m_host;
+        return m_body.get().host;
     }
 
     void OCRepresentation::setUri(const char* uri)
     {
-        m_uri = uri ? uri : "";
+        m_body.edit().uri = uri ? uri : "";
     }
 
     void OCRepresentation::setUri(const std::string& uri)
     {
-        m_uri = uri;
+        m_body.edit().uri = uri;
     }
 
     std::string OCRepresentation::getUri() const
     {
-        return m_uri;
+        return m_body.get().uri;
     }
 
     const std::vector<std::string>& OCRepresentation::getResourceTypes() const
     {
-        return m_resourceTypes;
+        return m_body.get().resourceTypes;
     }
 
     void OCRepresentation::setResourceTypes(const std::vector<std::string>& resourceTypes)
     {
-        m_resourceTypes = resourceTypes;
+        m_body.edit().resourceTypes = resourceTypes;
     }
 
     void OCRepresentation::addResourceType(const std::string& str)
     {
-        m_resourceTypes.push_back(str);
+        m_body.edit().resourceTypes.push_back(str);
     }
 
     const std::vector<std::string>& OCRepresentation::getResourceInterfaces() const
     {
-        return m_interfaces;
+        return m_body.get().interfaces;
     }
 
     void OCRepresentation::addResourceInterface(const std::string& str)
     {
-        m_interfaces.push_back(str);
+        m_body.edit().interfaces.push_back(str);
     }
 
     void OCRepresentation::setResourceInterfaces(const std::vector<std::string>& resourceInterfaces)
     {
-        m_interfaces = resourceInterfaces;
+        m_body.edit().interfaces = resourceInterfaces;
     }
 
     const std::vector<std::string>& OCRepresentation::getDataModelVersions() const
     {
-        return m_dataModelVersions;
+        return m_body.get().dataModelVersions;
     }
 
     void OCRepresentation::addDataModelVersion(const std::string& str)
     {
-        m_dataModelVersions.push_back(str);
+        m_body.edit().dataModelVersions.push_back(str);
     }
 
     bool OCRepresentation::hasAttribute(const std::string& str) const
@@ -781,15 +807,16 @@ namespace OC
         // child of a default or link item.
         // Our values array is only printed in the if we are the child of a Batch resource,
         // the parent in a 'default' situation, or not in a child/parent relationship.
-        if (!m_uri.empty())
+        const Body& body = m_body.get();
+        if (!body.uri.empty())
         {
             return false;
         }
         else if ((m_interfaceType == InterfaceType::None
                         || m_interfaceType==InterfaceType::DefaultChild
                         || m_interfaceType==InterfaceType::LinkChild)
-                    && (m_resourceTypes.size()>0 || m_interfaces.size()>0
-                        || m_dataModelVersions.size()>0))
+                    && (body.resourceTypes.size()>0 || body.interfaces.size()>0
+                        || body.dataModelVersions.size()>0))
         {
             return false;
         }
@@ -801,7 +828,7 @@ namespace OC
             return false;
         }
 
-        if (m_children.size() > 0)
+        if (body.children.size() > 0)
         {
             return false;
         }
@@ -821,7 +848,7 @@ namespace OC
 
     void OCRepresentation::setNULL(const std::string& str)
     {
-        m_values[str] = OC::NullType();
+        m_values.set(str, OC::NullType());
     }
 
     bool OCRepresentation::isNULL(const std::string& str) const
@@ -877,7 +904,7 @@ namespace OC
 namespace OC
 {
     OCRepresentation::AttributeItem::AttributeItem(const std::string& name,
-            std::map<std::string, AttributeValue>& vals):
+            AttributeMap& vals):
             m_attrName(name), m_values(vals){}
 
     OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key)
@@ -888,7 +915,8 @@ namespace OC
 
     const OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key) const
     {
-        OCRepresentation::AttributeItem attr{key, m_values};
+        // A const AttributeItem only reads through the map.
+        OCRepresentation::AttributeItem attr{key, const_cast<AttributeMap&>(m_values)};
         return std::move(attr);
     }
 
@@ -897,6 +925,15 @@ namespace OC
         return m_attrName;
     }
 
+    const AttributeValue& OCRepresentation::AttributeItem::value() const
+    {
+        // A missing attribute reads as null, without adding it to the attributes
+        static const AttributeValue null = NullType();
+
+        auto x = m_values.find(m_attrName);
+        return x != m_values.cend() ? x->second : null;
+    }
+
     template<typename T, typename = void>
     struct type_info
     {
@@ -965,52 +1002,53 @@ namespace OC
     AttributeType OCRepresentation::AttributeItem::type() const
     {
         type_introspection_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return vis.type;
     }
 
     AttributeType OCRepresentation::AttributeItem::base_type() const
     {
         type_introspection_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return vis.base_type;
     }
 
     size_t OCRepresentation::AttributeItem::depth() const
     {
         type_introspection_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return vis.depth;
     }
 
     OCRepresentation::iterator OCRepresentation::begin()
     {
-        return OCRepresentation::iterator(m_values.begin(), m_values);
+        return OCRepresentation::iterator(0, m_values);
     }
 
     OCRepresentation::const_iterator OCRepresentation::begin() const
     {
-         return OCRepresentation::const_iterator(m_values.begin(), m_values);
+        return cbegin();
     }
 
     OCRepresentation::const_iterator OCRepresentation::cbegin() const
     {
-        return OCRepresentation::const_iterator(m_values.cbegin(), m_values);
+        return OCRepresentation::const_iterator(0, const_cast<AttributeMap&>(m_values));
     }
 
     OCRepresentation::iterator OCRepresentation::end()
     {
-        return OCRepresentation::iterator(m_values.end(), m_values);
+        return OCRepresentation::iterator(m_values.size(), m_values);
     }
 
     OCRepresentation::const_iterator OCRepresentation::end() const
     {
-        return OCRepresentation::const_iterator(m_values.end(), m_values);
+        return cend();
     }
 
     OCRepresentation::const_iterator OCRepresentation::cend() const
     {
-        return OCRepresentation::const_iterator(m_values.cend(), m_values);
+        return OCRepresentation::const_iterator(m_values.size(),
+                const_cast<AttributeMap&>(m_values));
     }
 
     size_t OCRepresentation::size() const
@@ -1025,24 +1063,24 @@ namespace OC
 
     bool OCRepresentation::iterator::operator==(const OCRepresentation::iterator& rhs) const
     {
-        return m_iterator == rhs.m_iterator;
+        return m_index == rhs.m_index;
     }
 
     bool OCRepresentation::iterator::operator!=(const OCRepresentation::iterator& rhs) const
     {
-        return m_iterator != rhs.m_iterator;
+        return m_index != rhs.m_index;
     }
 
     bool OCRepresentation::const_iterator::operator==(
             const OCRepresentation::const_iterator& rhs) const
     {
-        return m_iterator == rhs.m_iterator;
+        return m_index == rhs.m_index;
     }
 
     bool OCRepresentation::const_iterator::operator!=(
             const OCRepresentation::const_iterator& rhs) const
     {
-        return m_iterator != rhs.m_iterator;
+        return m_index != rhs.m_index;
     }
 
     OCRepresentation::iterator::reference OCRepresentation::iterator::operator*()
@@ -1069,10 +1107,10 @@ namespace OC
 
     OCRepresentation::iterator& OCRepresentation::iterator::operator++()
     {
-        m_iterator++;
-        if (m_iterator != m_item.m_values.end())
+        m_index++;
+        if (m_index < m_item.m_values.size())
         {
-            m_item.m_attrName = m_iterator->first;
+            m_item.m_attrName = m_item.m_values.cbegin()[m_index].first;
         }
         else
         {
@@ -1083,10 +1121,10 @@ namespace OC
 
     OCRepresentation::const_iterator& OCRepresentation::const_iterator::operator++()
     {
-        m_iterator++;
-        if (m_iterator != m_item.m_values.end())
+        m_index++;
+        if (m_index < m_item.m_values.size())
         {
-            m_item.m_attrName = m_iterator->first;
+            m_item.m_attrName = m_item.m_values.cbegin()[m_index].first;
         }
         else
         {
@@ -1175,7 +1213,7 @@ namespace OC
     std::string OCRepresentation::AttributeItem::getValueToString() const
     {
         to_string_visitor vis;
-        boost::apply_visitor(vis, m_values[m_attrName]);
+        boost::apply_visitor(vis, value());
         return std::move(vis.str);
     }
 
@@ -0,0 +1,691 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the CBOR codec of OCRepresentation. It reads and writes the
+ * representation format of ocpayloadconvert.c and ocpayloadparse.c directly, without
+ * building an OCRepPayload in between.
+ */
+
+#include <OCRepresentation.h>
+
+#include <algorithm>
+#include "ocpayload.h"
+#include "cbor.h"
+
+namespace OC
+{
+    namespace
+    {
+        // Representations up to this size are encoded without a heap allocation.
+        const size_t STACK_ENCODE_SIZE = 1024;
+
+        const char MALFORMED_CBOR[] = "Malformed CBOR representation";
+        const char ENCODE_FAILED[] = "Failed to encode representation";
+
+        // Like VERIFY_CBOR_SUCCESS: running out of buffer is not a failure, the encoder
+        // carries on counting so the size needed is known at the end.
+        bool encodeFailed(int64_t err)
+        {
+            return err != CborNoError && (err & CborErrorOutOfMemory) != CborErrorOutOfMemory;
+        }
+
+        void throwIfError(CborError err)
+        {
+            if (err != CborNoError)
+            {
+                throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+            }
+        }
+    }
+
+    class RepresentationCodec
+    {
+    public:
+        static int64_t encode(const std::vector<OCRepresentation>& reps,
+                              CborEncoder* encoder);
+        static void decode(const uint8_t* data, size_t size,
+                           std::vector<OCRepresentation>& reps);
+
+        static int64_t encodeMap(CborEncoder* parent, const OCRepresentation& rep);
+        static void decodeMap(CborValue* map, OCRepresentation& rep, bool isRoot);
+
+    private:
+        static int64_t encodeValues(CborEncoder* map, const OCRepresentation& rep);
+        static int64_t encodeStrings(CborEncoder* map, const char* key,
+                                     const std::vector<std::string>& strings);
+        static void decodeStrings(CborValue* value, std::vector<std::string>& strings);
+        static AttributeValue decodeValue(CborValue* value);
+        static AttributeValue decodeArray(CborValue* value);
+    };
+
+    // Arrays are written rectangular, padded the way OCRepresentation::getPayload pads them.
+    struct encode_value: boost::static_visitor<int64_t>
+    {
+        explicit encode_value(CborEncoder* enc) : encoder(enc) {}
+
+        int64_t operator()(const NullType&) const
+        {
+            return cbor_encode_null(encoder);
+        }
+        int64_t operator()(int i) const
+        {
+            return cbor_encode_int(encoder, i);
+        }
+        int64_t operator()(double d) const
+        {
+            return cbor_encode_double(encoder, d);
+        }
+        int64_t operator()(bool b) const
+        {
+            return cbor_encode_boolean(encoder, b);
+        }
+        int64_t operator()(const std::string& str) const
+        {
+            return cbor_encode_text_string(encoder, str.data(), str.length());
+        }
+        int64_t operator()(const OCRepresentation& rep) const
+        {
+            return RepresentationCodec::encodeMap(encoder, rep);
+        }
+        int64_t operator()(const std::vector<uint8_t>& bytes) const
+        {
+            return cbor_encode_byte_string(encoder, bytes.data(), bytes.size());
+        }
+
+        template<typename T>
+        int64_t operator()(const std::vector<T>& arr) const
+        {
+            return encodeArray(arr, arr.size());
+        }
+        template<typename T>
+        int64_t operator()(const std::vector<std::vector<T>>& arr) const
+        {
+            size_t dim1 = 0;
+            for (const auto& inner : arr)
+            {
+                dim1 = std::max(dim1, inner.size());
+            }
+            return encodeArray(arr, arr.size(), dim1);
+        }
+        template<typename T>
+        int64_t operator()(const std::vector<std::vector<std::vector<T>>>& arr) const
+        {
+            size_t dim1 = 0;
+            size_t dim2 = 0;
+            for (const auto& inner : arr)
+            {
+                dim1 = std::max(dim1, inner.size());
+                for (const auto& innermost : inner)
+                {
+                    dim2 = std::max(dim2, innermost.size());
+                }
+            }
+            return encodeArray(arr, arr.size(), dim1, dim2);
+        }
+
+    private:
+        template<typename T>
+        int64_t encodeArray(const std::vector<T>& arr, size_t dim0) const
+        {
+            CborEncoder array;
+            int64_t err = cbor_encoder_create_array(encoder, &array, dim0);
+            encode_value item(&array);
+            for (size_t i = 0; i < dim0 && !encodeFailed(err); ++i)
+            {
+                if (i < arr.size())
+                {
+                    err |= item(static_cast<typename std::vector<T>::const_reference>(arr[i]));
+                }
+                else
+                {
+                    err |= item.pad(static_cast<const T*>(nullptr));
+                }
+            }
+            err |= cbor_encoder_close_container(encoder, &array);
+            return err;
+        }
+
+        template<typename T>
+        int64_t encodeArray(const std::vector<std::vector<T>>& arr,
+                            size_t dim0, size_t dim1) const
+        {
+            static const std::vector<T> empty;
+            CborEncoder array;
+            int64_t err = cbor_encoder_create_array(encoder, &array, dim0);
+            encode_value item(&array);
+            for (size_t i = 0; i < dim0 && !encodeFailed(err); ++i)
+            {
+                err |= item.encodeArray(i < arr.size() ? arr[i] : empty, dim1);
+            }
+            err |= cbor_encoder_close_container(encoder, &array);
+            return err;
+        }
+
+        template<typename T>
+        int64_t encodeArray(const std::vector<std::vector<std::vector<T>>>& arr,
+                            size_t dim0, size_t dim1, size_t dim2) const
+        {
+            static const std::vector<std::vector<T>> empty;
+            CborEncoder array;
+            int64_t err = cbor_encoder_create_array(encoder, &array, dim0);
+            encode_value item(&array);
+            for (size_t i = 0; i < dim0 && !encodeFailed(err); ++i)
+            {
+                err |= item.encodeArray(i < arr.size() ? arr[i] : empty, dim1, dim2);
+            }
+            err |= cbor_encoder_close_container(encoder, &array);
+            return err;
+        }
+
+        int64_t pad(const int*) const { return cbor_encode_int(encoder, 0); }
+        int64_t pad(const double*) const { return cbor_encode_double(encoder, 0); }
+        int64_t pad(const bool*) const { return cbor_encode_boolean(encoder, false); }
+        int64_t pad(const std::string*) const { return cbor_encode_null(encoder); }
+        int64_t pad(const OCRepresentation*) const { return cbor_encode_null(encoder); }
+
+        CborEncoder* encoder;
+    };
+
+    int64_t RepresentationCodec::encodeStrings(CborEncoder* map, const char* key,
+                                               const std::vector<std::string>& strings)
+    {
+        if (strings.empty())
+        {
+            return CborNoError;
+        }
+        CborEncoder array;
+        int64_t err = cbor_encode_text_stringz(map, key);
+        err |= cbor_encoder_create_array(map, &array, strings.size());
+        for (size_t i = 0; i < strings.size() && !encodeFailed(err); ++i)
+        {
+            err |= cbor_encode_text_string(&array, strings[i].data(), strings[i].length());
+        }
+        err |= cbor_encoder_close_container(map, &array);
+        return err;
+    }
+
+    int64_t RepresentationCodec::encodeValues(CborEncoder* map, const OCRepresentation& rep)
+    {
+        int64_t err = CborNoError;
+        encode_value value(map);
+        for (auto itr = rep.m_values.cbegin(); itr != rep.m_values.cend() && !encodeFailed(err);
+             ++itr)
+        {
+            err |= cbor_encode_text_string(map, itr->first.data(), itr->first.length());
+            err |= boost::apply_visitor(value, itr->second);
+        }
+        return err;
+    }
+
+    int64_t RepresentationCodec::encodeMap(CborEncoder* parent, const OCRepresentation& rep)
+    {
+        CborEncoder map;
+        int64_t err = cbor_encoder_create_map(parent, &map, CborIndefiniteLength);
+        err |= encodeValues(&map, rep);
+        err |= cbor_encoder_close_container(parent, &map);
+        return err;
+    }
+
+    int64_t RepresentationCodec::encode(const std::vector<OCRepresentation>& reps,
+                                        CborEncoder* encoder)
+    {
+        CborEncoder array;
+        CborEncoder* parent = encoder;
+        int64_t err = CborNoError;
+        if (reps.size() > 1)
+        {
+            err |= cbor_encoder_create_array(encoder, &array, reps.size());
+            parent = &array;
+        }
+
+        for (size_t i = 0; i < reps.size() && !encodeFailed(err); ++i)
+        {
+            const OCRepresentation& rep = reps[i];
+            const OCRepresentation::Body& body = rep.m_body.get();
+            CborEncoder map;
+            err |= cbor_encoder_create_map(parent, &map, CborIndefiniteLength);
+            // Only in case of collection href is included.
+            if (reps.size() > 1 && !body.uri.empty())
+            {
+                err |= cbor_encode_text_stringz(&map, OC_RSRVD_HREF);
+                err |= cbor_encode_text_string(&map, body.uri.data(), body.uri.length());
+            }
+            err |= encodeStrings(&map, OC_RSRVD_RESOURCE_TYPE, body.resourceTypes);
+            err |= encodeStrings(&map, OC_RSRVD_INTERFACE, body.interfaces);
+            err |= encodeValues(&map, rep);
+            err |= cbor_encoder_close_container(parent, &map);
+        }
+
+        if (reps.size() > 1)
+        {
+            err |= cbor_encoder_close_container(encoder, &array);
+        }
+        return err;
+    }
+
+    namespace
+    {
+        std::string readText(CborValue* value)
+        {
+            size_t length = 0;
+            throwIfError(cbor_value_calculate_string_length(value, &length));
+            std::vector<char> buffer(length + 1);
+            size_t copied = buffer.size();
+            throwIfError(cbor_value_copy_text_string(value, buffer.data(), &copied, nullptr));
+            return std::string(buffer.data(), copied);
+        }
+
+        double readDouble(CborValue* value)
+        {
+            if (cbor_value_get_type(value) == CborDoubleType)
+            {
+                double d = 0;
+                throwIfError(cbor_value_get_double(value, &d));
+                return d;
+            }
+            if (cbor_value_get_type(value) == CborFloatType)
+            {
+                float f = 0;
+                throwIfError(cbor_value_get_float(value, &f));
+                return f;
+            }
+            throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+        }
+
+        void readItem(CborValue* value, int& out)
+        {
+            int64_t i = 0;
+            throwIfError(cbor_value_get_int64(value, &i));
+            out = static_cast<int>(i);
+        }
+
+        void readItem(CborValue* value, double& out)
+        {
+            out = readDouble(value);
+        }
+
+        void readItem(CborValue* value, bool& out)
+        {
+            throwIfError(cbor_value_get_boolean(value, &out));
+        }
+
+        void readItem(CborValue* value, std::string& out)
+        {
+            out = readText(value);
+        }
+
+        void readItem(CborValue* value, OCRepresentation& out)
+        {
+            if (!cbor_value_is_map(value))
+            {
+                throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+            }
+            RepresentationCodec::decodeMap(value, out, false);
+        }
+
+        // Like OCParseArrayFindDimensionsAndType: all leaves must share one type.
+        enum class ArrayType { None, Integer, Double, Boolean, String, Binary, Map };
+
+        ArrayType leafType(CborType type)
+        {
+            switch (type)
+            {
+                case CborIntegerType:
+                    return ArrayType::Integer;
+                case CborDoubleType:
+                case CborFloatType:
+                    return ArrayType::Double;
+                case CborBooleanType:
+                    return ArrayType::Boolean;
+                case CborTextStringType:
+                    return ArrayType::String;
+                case CborByteStringType:
+                    return ArrayType::Binary;
+                case CborMapType:
+                    return ArrayType::Map;
+                default:
+                    return ArrayType::None;
+            }
+        }
+
+        void arrayShape(const CborValue* array, size_t dims[MAX_REP_ARRAY_DEPTH],
+                        ArrayType& type, size_t depth)
+        {
+            if (depth > MAX_REP_ARRAY_DEPTH)
+            {
+                throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+            }
+            CborValue item;
+            throwIfError(cbor_value_enter_container(array, &item));
+            size_t count = 0;
+            while (cbor_value_is_valid(&item))
+            {
+                if (cbor_value_is_array(&item))
+                {
+                    arrayShape(&item, dims, type, depth + 1);
+                }
+                else
+                {
+                    ArrayType itemType = leafType(cbor_value_get_type(&item));
+                    if (type == ArrayType::None)
+                    {
+                        type = itemType;
+                    }
+                    else if (itemType != ArrayType::None && itemType != type)
+                    {
+                        throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+                    }
+                }
+                ++count;
+                throwIfError(cbor_value_advance(&item));
+            }
+            dims[depth - 1] = std::max(dims[depth - 1], count);
+        }
+
+        template<typename T>
+        void fillArray(CborValue* array, std::vector<T>& out, const size_t* dims)
+        {
+            out.resize(dims[0]);
+            CborValue item;
+            throwIfError(cbor_value_enter_container(array, &item));
+            for (size_t i = 0; i < dims[0] && cbor_value_is_valid(&item); ++i)
+            {
+                if (cbor_value_get_type(&item) == CborNullType)
+                {
+                    throwIfError(cbor_value_advance(&item));
+                    continue;
+                }
+                // Reading a map moves past it, other items are advanced here.
+                bool isMap = cbor_value_is_map(&item);
+                T value{};
+                readItem(&item, value);
+                out[i] = std::move(value);
+                if (!isMap)
+                {
+                    throwIfError(cbor_value_advance(&item));
+                }
+            }
+        }
+
+        template<typename T>
+        void fillArray(CborValue* array, std::vector<std::vector<T>>& out, const size_t* dims)
+        {
+            out.resize(dims[0]);
+            CborValue item;
+            throwIfError(cbor_value_enter_container(array, &item));
+            for (size_t i = 0; i < dims[0] && cbor_value_is_valid(&item); ++i)
+            {
+                if (cbor_value_is_array(&item))
+                {
+                    fillArray(&item, out[i], dims + 1);
+                }
+                else if (cbor_value_get_type(&item) == CborNullType)
+                {
+                    out[i].resize(dims[1]);
+                }
+                else
+                {
+                    throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+                }
+                throwIfError(cbor_value_advance(&item));
+            }
+        }
+
+        template<typename T>
+        AttributeValue decodeArrayOf(CborValue* array, const size_t dims[MAX_REP_ARRAY_DEPTH])
+        {
+            if (dims[1] == 0)
+            {
+                std::vector<T> val;
+                fillArray(array, val, dims);
+                return val;
+            }
+            else if (dims[2] == 0)
+            {
+                std::vector<std::vector<T>> val;
+                fillArray(array, val, dims);
+                return val;
+            }
+            std::vector<std::vector<std::vector<T>>> val;
+            fillArray(array, val, dims);
+            return val;
+        }
+    }
+
+    AttributeValue RepresentationCodec::decodeArray(CborValue* value)
+    {
+        size_t dims[MAX_REP_ARRAY_DEPTH] = {0};
+        ArrayType type = ArrayType::None;
+        arrayShape(value, dims, type, 1);
+
+        switch (type)
+        {
+            case ArrayType::None:
+                return NullType();
+            case ArrayType::Integer:
+                return decodeArrayOf<int>(value, dims);
+            case ArrayType::Double:
+                return decodeArrayOf<double>(value, dims);
+            case ArrayType::Boolean:
+                return decodeArrayOf<bool>(value, dims);
+            case ArrayType::String:
+                return decodeArrayOf<std::string>(value, dims);
+            case ArrayType::Map:
+                return decodeArrayOf<OCRepresentation>(value, dims);
+            default:
+                throw OCException("Byte string arrays are not supported",
+                                  OC_STACK_MALFORMED_RESPONSE);
+        }
+    }
+
+    AttributeValue RepresentationCodec::decodeValue(CborValue* value)
+    {
+        switch (cbor_value_get_type(value))
+        {
+            case CborNullType:
+                return NullType();
+            case CborIntegerType:
+                {
+                    int i = 0;
+                    readItem(value, i);
+                    return i;
+                }
+            case CborDoubleType:
+            case CborFloatType:
+                return readDouble(value);
+            case CborBooleanType:
+                {
+                    bool b = false;
+                    readItem(value, b);
+                    return b;
+                }
+            case CborTextStringType:
+                return readText(value);
+            case CborByteStringType:
+                {
+                    size_t length = 0;
+                    throwIfError(cbor_value_calculate_string_length(value, &length));
+                    std::vector<uint8_t> bytes(length);
+                    throwIfError(cbor_value_copy_byte_string(value, bytes.data(), &length,
+                                                             nullptr));
+                    return bytes;
+                }
+            case CborMapType:
+                {
+                    OCRepresentation rep;
+                    decodeMap(value, rep, false);
+                    return rep;
+                }
+            case CborArrayType:
+                return decodeArray(value);
+            default:
+                throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+        }
+    }
+
+    void RepresentationCodec::decodeStrings(CborValue* value, std::vector<std::string>& strings)
+    {
+        if (!cbor_value_is_array(value))
+        {
+            return;
+        }
+        CborValue item;
+        throwIfError(cbor_value_enter_container(value, &item));
+        while (cbor_value_is_text_string(&item))
+        {
+            // A value may hold several names separated by spaces.
+            std::string joined = readText(&item);
+            size_t start = joined.find_first_not_of(' ');
+            while (start != std::string::npos)
+            {
+                size_t end = joined.find(' ', start);
+                strings.push_back(joined.substr(start, end - start));
+                start = joined.find_first_not_of(' ', end);
+            }
+            throwIfError(cbor_value_advance(&item));
+        }
+    }
+
+    // Decodes the map at value and advances value past it.
+    void RepresentationCodec::decodeMap(CborValue* map, OCRepresentation& rep, bool isRoot)
+    {
+        // The attributes may come in any order, so they are sorted once at the end.
+        std::vector<AttributeMap::value_type> values;
+        CborValue item;
+        throwIfError(cbor_value_enter_container(map, &item));
+        while (cbor_value_is_valid(&item))
+        {
+            if (!cbor_value_is_text_string(&item))
+            {
+                throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+            }
+            std::string name = readText(&item);
+            throwIfError(cbor_value_advance(&item));
+
+            if (isRoot && name == OC_RSRVD_HREF)
+            {
+                if (cbor_value_is_text_string(&item))
+                {
+                    rep.m_body.edit().uri = readText(&item);
+                }
+            }
+            else if (isRoot && name == OC_RSRVD_RESOURCE_TYPE)
+            {
+                decodeStrings(&item, rep.m_body.edit().resourceTypes);
+            }
+            else if (isRoot && name == OC_RSRVD_INTERFACE)
+            {
+                decodeStrings(&item, rep.m_body.edit().interfaces);
+            }
+            else
+            {
+                bool isMap = cbor_value_is_map(&item);
+                values.push_back(AttributeMap::value_type(std::move(name), decodeValue(&item)));
+                if (isMap)
+                {
+                    // decodeMap has already moved past the nested map.
+                    continue;
+                }
+            }
+            throwIfError(cbor_value_advance(&item));
+        }
+        throwIfError(cbor_value_leave_container(map, &item));
+        rep.m_values.setAll(std::move(values));
+    }
+
+    void RepresentationCodec::decode(const uint8_t* data, size_t size,
+                                     std::vector<OCRepresentation>& reps)
+    {
+        CborParser parser;
+        CborValue root;
+        throwIfError(cbor_parser_init(data, size, 0, &parser, &root));
+
+        if (cbor_value_is_map(&root))
+        {
+            OCRepresentation rep;
+            decodeMap(&root, rep, true);
+            reps.push_back(std::move(rep));
+        }
+        else if (cbor_value_is_array(&root))
+        {
+            CborValue item;
+            throwIfError(cbor_value_enter_container(&root, &item));
+            while (cbor_value_is_valid(&item))
+            {
+                if (!cbor_value_is_map(&item))
+                {
+                    throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+                }
+                OCRepresentation rep;
+                decodeMap(&item, rep, true);
+                reps.push_back(std::move(rep));
+            }
+        }
+        else
+        {
+            throw OCException(MALFORMED_CBOR, OC_STACK_MALFORMED_RESPONSE);
+        }
+    }
+
+    void MessageContainer::setPayload(const OCEncodedPayload* payload)
+    {
+        if (payload == nullptr)
+        {
+            return;
+        }
+        RepresentationCodec::decode(payload->data, payload->size, m_reps);
+    }
+
+    OCPayload* MessageContainer::getEncodedPayload() const
+    {
+        if (m_reps.empty())
+        {
+            return nullptr;
+        }
+
+        uint8_t stackBuffer[STACK_ENCODE_SIZE];
+        CborEncoder encoder;
+        cbor_encoder_init(&encoder, stackBuffer, sizeof(stackBuffer), 0);
+        int64_t err = RepresentationCodec::encode(m_reps, &encoder);
+        if (err == CborNoError)
+        {
+            return reinterpret_cast<OCPayload*>(OCEncodedPayloadCreate(stackBuffer,
+                        encoder.ptr - stackBuffer));
+        }
+        if (encodeFailed(err))
+        {
+            throw OCException(ENCODE_FAILED, OC_STACK_ERROR);
+        }
+
+        // On CborErrorOutOfMemory the encoder keeps counting, so this is the size needed.
+        std::vector<uint8_t> buffer(sizeof(stackBuffer) + (encoder.ptr - encoder.end));
+        cbor_encoder_init(&encoder, buffer.data(), buffer.size(), 0);
+        err = RepresentationCodec::encode(m_reps, &encoder);
+        if (err != CborNoError)
+        {
+            throw OCException(ENCODE_FAILED, OC_STACK_ERROR);
+        }
+        return reinterpret_cast<OCPayload*>(OCEncodedPayloadCreate(buffer.data(),
+                    encoder.ptr - buffer.data()));
+    }
+}
@@ -22,6 +22,7 @@
 #include "OCUtilities.h"
 
 #include <boost/lexical_cast.hpp>
+#include <atomic>
 #include <sstream>
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
@@ -54,7 +55,7 @@ OCResource::OCResource(std::weak_ptr<IClientWrapper> clientWrapper,
     m_resourceId(serverId, m_uri), m_devAddr(devAddr),
     m_property(property), m_isCollection(false),
     m_resourceTypes(resourceTypes), m_interfaces(interfaces),
-    m_observeHandle(nullptr)
+    m_observeHandle(nullptr), m_validationCache(std::make_shared<ValidationCache>())
 {
     m_isCollection = std::find(m_interfaces.begin(), m_interfaces.end(), LINK_INTERFACE)
                         != m_interfaces.end();
@@ -79,7 +80,7 @@ OCResource::OCResource(std::weak_ptr<IClientWrapper> clientWrapper,
     m_resourceId(serverId, m_uri),
     m_property(property), m_isCollection(false),
     m_resourceTypes(resourceTypes), m_interfaces(interfaces),
-    m_observeHandle(nullptr)
+    m_observeHandle(nullptr), m_validationCache(std::make_shared<ValidationCache>())
 {
     m_devAddr = OCDevAddr{OC_DEFAULT_ADAPTER, OC_DEFAULT_FLAGS, 0, {0}, 0,
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
@@ -274,14 +275,143 @@ void OCResource::setHost(const std::string& host)
     }
 }
 
+static std::string findETag(const HeaderOptions& headerOptions)
+{
+    for (const auto& option : headerOptions)
+    {
+        if (option.getOptionID() == HeaderOption::ETAG_OPTION_ID)
+        {
+            return option.getOptionData();
+        }
+    }
+    return std::string();
+}
+
+namespace
+{
+    // Completes the future of a request. If every copy of its callback goes away
+    // uncalled, the stack dropped the request without a response.
+    class PendingResult
+    {
+    public:
+        PendingResult()
+         : m_done(false)
+        {
+        }
+
+        ~PendingResult()
+        {
+            set(RequestResult(HeaderOptions(), OCRepresentation(), OC_STACK_TIMEOUT));
+        }
+
+        std::future<RequestResult> future()
+        {
+            return m_promise.get_future();
+        }
+
+        void set(const RequestResult& result)
+        {
+            if (!m_done.exchange(true))
+            {
+                m_promise.set_value(result);
+            }
+        }
+
+    private:
+        std::atomic<bool> m_done;
+        std::promise<RequestResult> m_promise;
+    };
+
+    std::future<RequestResult> failedResult(OCStackResult result)
+    {
+        std::promise<RequestResult> promise;
+        promise.set_value(RequestResult(HeaderOptions(), OCRepresentation(), result));
+        return promise.get_future();
+    }
+}
+
+void RequestFuture::checkWait() const
+{
+    if (m_future.valid() &&
+        std::future_status::ready != m_future.wait_for(std::chrono::seconds(0)) &&
+        details::isResponseThread())
+    {
+        throw OCException(OC::Exception::WAIT_ON_RESPONSE_THREAD, OC_STACK_ERROR);
+    }
+}
+
+GetCallback OCResource::futureCallback(RequestFuture& future)
+{
+    auto pending = std::make_shared<PendingResult>();
+    future = RequestFuture(pending->future());
+    return [pending](const HeaderOptions& headerOptions, const OCRepresentation& rep,
+                     const int eCode)
+    {
+        pending->set(RequestResult(headerOptions, rep, eCode));
+    };
+}
+
+GetCallback OCResource::validatingGetHandler(const QueryParamsMap& queryParametersMap,
+                                             GetCallback attributeHandler,
+                                             HeaderOptions& headerOptions)
+{
+    headerOptions = m_headerOptions;
+    std::string etag;
+    {
+        std::lock_guard<std::mutex> lock(m_validationCache->mutex);
+        if (!m_validationCache->etag.empty() && m_validationCache->query == queryParametersMap
+            && headerOptions.size() < MAX_HEADER_OPTIONS && findETag(headerOptions).empty())
+        {
+            etag = m_validationCache->etag;
+            headerOptions.push_back(HeaderOption::OCHeaderOption(HeaderOption::ETAG_OPTION_ID,
+                                                                 etag));
+        }
+    }
+
+    std::shared_ptr<ValidationCache> cache = m_validationCache;
+    GetCallback validatingHandler = [cache, queryParametersMap, etag, attributeHandler](
+            const HeaderOptions& serverHeaderOptions, const OCRepresentation& rep,
+            const int eCode)
+    {
+        std::string receivedETag = findETag(serverHeaderOptions);
+        if (eCode != OC_STACK_OK || receivedETag.empty())
+        {
+            attributeHandler(serverHeaderOptions, rep, eCode);
+            return;
+        }
+
+        OCRepresentation validRep = rep;
+        {
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            if (receivedETag == etag && rep.emptyData() && cache->etag == etag)
+            {
+                // 2.03 Valid, the server sent no payload
+                validRep = cache->rep;
+            }
+            else
+            {
+                cache->query = queryParametersMap;
+                cache->etag = receivedETag;
+                cache->rep = rep;
+            }
+        }
+        attributeHandler(serverHeaderOptions, validRep, eCode);
+    };
+    return validatingHandler;
+}
+
 OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
                               GetCallback attributeHandler, QualityOfService QoS)
 {
+    HeaderOptions headerOptions;
+    GetCallback validatingHandler = validatingGetHandler(queryParametersMap, attributeHandler,
+                                                         headerOptions);
+
     return checked_guard(m_clientWrapper.lock(),
                             &IClientWrapper::GetResourceRepresentation,
                             m_devAddr, m_uri,
-                            queryParametersMap, m_headerOptions,
-                            attributeHandler, QoS);
+                            queryParametersMap, headerOptions,
+                            validatingHandler, QoS);
 }
 
 OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
@@ -420,6 +550,55 @@ OCStackResult OCResource::post(const std::string& resourceType,
     return result_guard(post(rep, mapCpy, attributeHandler, QoS));
 }
 
+RequestFuture OCResource::getAsync(const QueryParamsMap& queryParametersMap,
+                                   QualityOfService QoS)
+{
+    RequestFuture future;
+    OCStackResult result = get(queryParametersMap, futureCallback(future), QoS);
+    return OC_STACK_OK == result ? std::move(future) : RequestFuture(failedResult(result));
+}
+
+RequestFuture OCResource::getAsync(const QueryParamsMap& queryParametersMap)
+{
+    RequestFuture future;
+    OCStackResult result = get(queryParametersMap, futureCallback(future));
+    return OC_STACK_OK == result ? std::move(future) : RequestFuture(failedResult(result));
+}
+
+RequestFuture OCResource::putAsync(const OCRepresentation& rep,
+                                   const QueryParamsMap& queryParametersMap,
+                                   QualityOfService QoS)
+{
+    RequestFuture future;
+    OCStackResult result = put(rep, queryParametersMap, futureCallback(future), QoS);
+    return OC_STACK_OK == result ? std::move(future) : RequestFuture(failedResult(result));
+}
+
+RequestFuture OCResource::putAsync(const OCRepresentation& rep,
+                                   const QueryParamsMap& queryParametersMap)
+{
+    RequestFuture future;
+    OCStackResult result = put(rep, queryParametersMap, futureCallback(future));
+    return OC_STACK_OK == result ? std::move(future) : RequestFuture(failedResult(result));
+}
+
+RequestFuture OCResource::postAsync(const OCRepresentation& rep,
+                                    const QueryParamsMap& queryParametersMap,
+                                    QualityOfService QoS)
+{
+    RequestFuture future;
+    OCStackResult result = post(rep, queryParametersMap, futureCallback(future), QoS);
+    return OC_STACK_OK == result ? std::move(future) : RequestFuture(failedResult(result));
+}
+
+RequestFuture OCResource::postAsync(const OCRepresentation& rep,
+                                    const QueryParamsMap& queryParametersMap)
+{
+    RequestFuture future;
+    OCStackResult result = post(rep, queryParametersMap, futureCallback(future));
+    return OC_STACK_OK == result ? std::move(future) : RequestFuture(failedResult(result));
+}
+
 OCStackResult OCResource::deleteResource(DeleteCallback deleteHandler, QualityOfService QoS)
 {
     return checked_guard(m_clientWrapper.lock(), &IClientWrapper::DeleteResource,
@@ -34,7 +34,7 @@ void OCResourceRequest::setPayload(OCPayload* payload)
     {
         return;
     }
-    if(payload->type != PAYLOAD_TYPE_REPRESENTATION)
+    if(payload->type != PAYLOAD_TYPE_REPRESENTATION && payload->type != PAYLOAD_TYPE_ENCODED)
     {
         throw std::logic_error("Wrong payload type");
         return;
@@ -60,3 +60,33 @@ void OCResourceRequest::setPayload(OCPayload* payload)
         oclog() << "setPayload Error: "<<OC::Exception::INVALID_REPRESENTATION<< std::flush;
     }
 }
+
+void OCResourceRequest::keepSchemaPayload()
+{
+    if (m_schemaPayload && !m_schemaPayloadCopy)
+    {
+        m_schemaPayloadCopy.reset(OCRepPayloadClone(m_schemaPayload), OCRepPayloadDestroy);
+        m_schemaPayload = m_schemaPayloadCopy.get();
+    }
+}
+
+bool OC::detail::decodeSchemaValues(const OCRepPayload* payload)
+{
+    return OCRepPayloadDecodeValues(const_cast<OCRepPayload*>(payload));
+}
+
+OCEntityHandlerResult SchemaEntityHandler::operator()(
+        std::shared_ptr<OCResourceRequest> request) const
+{
+    if (!m_handler)
+    {
+        return OC_EH_ERROR;
+    }
+    OCEntityHandlerResult result = m_handler(request);
+    // The payload belongs to the C stack and goes away when this returns.
+    if (request)
+    {
+        request->m_schemaPayload = nullptr;
+    }
+    return result;
+}
@@ -0,0 +1,191 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <CallbackExecutor.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace CallbackExecutorTest
+{
+    using namespace OC;
+
+    TEST(CallbackExecutorTest, InlineRunsOnCaller)
+    {
+        CallbackExecutor executor(CallbackExecution::Inline, 0, 0);
+        std::thread::id ran;
+        executor.post(nullptr, [&ran]{ ran = std::this_thread::get_id(); });
+        EXPECT_EQ(std::this_thread::get_id(), ran);
+    }
+
+    TEST(CallbackExecutorTest, KeepsOrderPerKey)
+    {
+        const int count = 1000;
+        std::vector<int> first;
+        std::vector<int> second;
+        {
+            CallbackExecutor executor(CallbackExecution::ThreadPool, 4, count * 2);
+            int keyA;
+            int keyB;
+            for (int i = 0; i < count; ++i)
+            {
+                executor.post(&keyA, [&first, i]{ first.push_back(i); });
+                executor.post(&keyB, [&second, i]{ second.push_back(i); });
+            }
+        }
+
+        ASSERT_EQ(static_cast<size_t>(count), first.size());
+        ASSERT_EQ(static_cast<size_t>(count), second.size());
+        for (int i = 0; i < count; ++i)
+        {
+            EXPECT_EQ(i, first[i]);
+            EXPECT_EQ(i, second[i]);
+        }
+    }
+
+    TEST(CallbackExecutorTest, BlockedKeyDoesNotHoldOthers)
+    {
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        std::promise<void> otherRan;
+        int keyA;
+        int keyB;
+        CallbackExecutor executor(CallbackExecution::ThreadPool, 2, 16);
+
+        executor.post(&keyA, [released]{ released.wait(); });
+        executor.post(&keyB, [&otherRan]{ otherRan.set_value(); });
+
+        EXPECT_EQ(std::future_status::ready,
+                otherRan.get_future().wait_for(std::chrono::seconds(5)));
+        release.set_value();
+    }
+
+    TEST(CallbackExecutorTest, ThrowingCallbackKeepsThreadRunning)
+    {
+        std::promise<void> ran;
+        int key;
+        CallbackExecutor executor(CallbackExecution::ThreadPool, 1, 16);
+
+        executor.post(&key, []{ throw 42; });
+        executor.post(&key, []{ throw std::runtime_error("callback failed"); });
+        executor.post(&key, [&ran]{ ran.set_value(); });
+
+        EXPECT_EQ(std::future_status::ready,
+                ran.get_future().wait_for(std::chrono::seconds(5)));
+    }
+
+    TEST(CallbackExecutorTest, FullQueueKeepsKeyOrder)
+    {
+        std::promise<void> started;
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        std::vector<int> seen;
+        int keyA;
+        int keyB;
+        int keyC;
+        {
+            CallbackExecutor executor(CallbackExecution::ThreadPool, 1, 1);
+
+            executor.post(&keyA, [&started, released]{ started.set_value(); released.wait(); });
+            started.get_future().wait();
+            executor.post(&keyA, [&seen]{ seen.push_back(1); });
+
+            // The queue is full: a new key runs here.
+            std::thread::id ran;
+            executor.post(&keyC, [&ran]{ ran = std::this_thread::get_id(); });
+            EXPECT_EQ(std::this_thread::get_id(), ran);
+
+            // A pending key waits past the bound rather than overtaking its callbacks.
+            executor.post(&keyA, [&seen]{ seen.push_back(2); });
+            executor.post(&keyA, [&seen]{ seen.push_back(3); });
+            EXPECT_TRUE(seen.empty());
+            EXPECT_EQ(CallbackExecutor::PostResult::KeyBusy, executor.tryPost(&keyA, []{}));
+            EXPECT_EQ(CallbackExecutor::PostResult::Full, executor.tryPost(&keyB, []{}));
+
+            release.set_value();
+        }
+        EXPECT_EQ((std::vector<int>{ 1, 2, 3 }), seen);
+    }
+
+    TEST(CallbackExecutorTest, FullQueueDropsOldestOfKey)
+    {
+        std::promise<void> started;
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        std::vector<int> seen;
+        int keyA;
+        int keyB;
+        {
+            CallbackExecutor executor(CallbackExecution::ThreadPool, 1, 2);
+
+            executor.post(&keyA, [&started, released]{ started.set_value(); released.wait(); });
+            started.get_future().wait();
+            executor.post(&keyB, []{});
+
+            // keyA has nothing waiting, so it keeps one slot past the bound.
+            executor.post(&keyA, [&seen]{ seen.push_back(1); },
+                          CallbackExecutor::Overflow::DropOldest);
+            executor.post(&keyA, [&seen]{ seen.push_back(2); },
+                          CallbackExecutor::Overflow::DropOldest);
+            executor.post(&keyA, [&seen]{ seen.push_back(3); },
+                          CallbackExecutor::Overflow::DropOldest);
+            EXPECT_TRUE(seen.empty());
+
+            release.set_value();
+        }
+        ASSERT_EQ(1u, seen.size());
+        EXPECT_EQ(3, seen[0]);
+    }
+
+    TEST(CallbackExecutorTest, TryPostLeavesFullQueueToCaller)
+    {
+        std::promise<void> started;
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        std::atomic<int> runs(0);
+        int keyA;
+        int keyB;
+        int keyC;
+        {
+            CallbackExecutor executor(CallbackExecution::ThreadPool, 1, 1);
+
+            executor.post(&keyA, [&started, released]{ started.set_value(); released.wait(); });
+            started.get_future().wait();
+            EXPECT_EQ(CallbackExecutor::PostResult::Queued,
+                      executor.tryPost(&keyB, [&runs]{ ++runs; }));
+            EXPECT_EQ(CallbackExecutor::PostResult::Full,
+                      executor.tryPost(&keyC, [&runs]{ ++runs; }));
+            EXPECT_EQ(CallbackExecutor::PostResult::KeyBusy,
+                      executor.tryPost(&keyA, [&runs]{ ++runs; }));
+
+            release.set_value();
+        }
+        EXPECT_EQ(1, runs);
+
+        CallbackExecutor inlineExecutor(CallbackExecution::Inline, 0, 0);
+        EXPECT_EQ(CallbackExecutor::PostResult::Full,
+                  inlineExecutor.tryPost(&keyA, [&runs]{ ++runs; }));
+        EXPECT_EQ(1, runs);
+    }
+}
@@ -0,0 +1,295 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Requests sent by this process to its own resources, whose entity handlers run on a
+// pool of one thread with room for one more waiting handler.
+
+#include <OCPlatform.h>
+#include <OCApi.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace EntityHandlerPoolTest
+{
+    using namespace OC;
+
+    const std::chrono::seconds TIMEOUT(5);
+
+    void Configure()
+    {
+        PlatformConfig cfg
+        { OC::ServiceType::InProc, OC::ModeType::Both, "0.0.0.0", 0,
+                OC::QualityOfService::LowQos };
+        cfg.entityHandlerExecution = CallbackExecution::ThreadPool;
+        cfg.entityHandlerThreads = 1;
+        cfg.entityHandlerQueueSize = 1;
+        OCPlatform::Configure(cfg);
+    }
+
+    OCResourceHandle RegisterResource(const std::string& uri, const std::string& type,
+                                      EntityHandler handler)
+    {
+        OCResourceHandle handle = nullptr;
+        std::string resourceUri = uri;
+        std::string resourceType = type;
+        std::string resourceInterface = DEFAULT_INTERFACE;
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::registerResource(handle, resourceUri, resourceType,
+                resourceInterface, handler, OC_DISCOVERABLE));
+        return handle;
+    }
+
+    // Finds a resource of this process through discovery.
+    OCResource::Ptr FindResource(const std::string& type)
+    {
+        auto found = std::make_shared<std::promise<OCResource::Ptr>>();
+        auto once = std::make_shared<std::once_flag>();
+        std::ostringstream query;
+        query << OC_RSRVD_WELL_KNOWN_URI << "?rt=" << type;
+        OCPlatform::findResource("", query.str(), CT_ADAPTER_IP,
+                [found, once](OCResource::Ptr resource)
+                {
+                    std::call_once(*once, [&]{ found->set_value(resource); });
+                });
+
+        auto future = found->get_future();
+        if (std::future_status::ready != future.wait_for(TIMEOUT))
+        {
+            return nullptr;
+        }
+        return future.get();
+    }
+
+    OCEntityHandlerResult Respond(std::shared_ptr<OCResourceRequest> request,
+                                  OCEntityHandlerResult result)
+    {
+        auto response = std::make_shared<OCResourceResponse>();
+        response->setRequestHandle(request->getRequestHandle());
+        response->setResourceHandle(request->getResourceHandle());
+        response->setResponseResult(result);
+        OCRepresentation rep;
+        rep.setValue("state", true);
+        response->setResourceRepresentation(rep);
+        OCPlatform::sendResponse(response);
+        return result;
+    }
+
+    // Sends a get; the future holds the result the response carried.
+    std::future<int> Get(const OCResource::Ptr& resource)
+    {
+        auto answered = std::make_shared<std::promise<int>>();
+        resource->get(QueryParamsMap(),
+                [answered](const HeaderOptions&, const OCRepresentation&, const int eCode)
+                {
+                    answered->set_value(eCode);
+                });
+        return answered->get_future();
+    }
+
+    // A resource whose handler waits until released, keeping the only pool thread busy.
+    class BlockingResource
+    {
+        public:
+            BlockingResource(const std::string& uri, const std::string& type)
+                : m_released(m_release.get_future())
+            {
+                m_handle = RegisterResource(uri, type,
+                        [this](std::shared_ptr<OCResourceRequest> request)
+                        {
+                            {
+                                std::lock_guard<std::mutex> lock(m_lock);
+                                if (m_entered)
+                                {
+                                    m_entered->set_value();
+                                    m_entered.reset();
+                                }
+                            }
+                            m_released.wait();
+                            return Respond(request, OC_EH_OK);
+                        });
+            }
+
+            ~BlockingResource()
+            {
+                OCPlatform::unregisterResource(m_handle);
+            }
+
+            // Arms the next handler call to report that it started.
+            std::future<void> expectEntered()
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_entered.reset(new std::promise<void>());
+                return m_entered->get_future();
+            }
+
+            void release()
+            {
+                m_release.set_value();
+            }
+
+        private:
+            OCResourceHandle m_handle;
+            std::mutex m_lock;
+            std::unique_ptr<std::promise<void>> m_entered;
+            std::promise<void> m_release;
+            std::shared_future<void> m_released;
+    };
+
+    TEST(EntityHandlerPoolTest, SlowHandlerLeavesStackProcessing)
+    {
+        Configure();
+
+        BlockingResource blocking("/a/pool/slow", "core.pool.slow");
+        OCResource::Ptr resource = FindResource("core.pool.slow");
+        ASSERT_TRUE(nullptr != resource);
+
+        auto entered = blocking.expectEntered();
+        auto answered = Get(resource);
+        ASSERT_EQ(std::future_status::ready, entered.wait_for(TIMEOUT));
+
+        // The stack was told to expect a slow response and goes on serving discovery.
+        EXPECT_TRUE(nullptr != FindResource("core.pool.slow"));
+        EXPECT_EQ(std::future_status::timeout,
+                  answered.wait_for(std::chrono::milliseconds(100)));
+
+        blocking.release();
+        ASSERT_EQ(std::future_status::ready, answered.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, answered.get());
+    }
+
+    TEST(EntityHandlerPoolTest, BusyResourceIsRefusedWhenPoolIsFull)
+    {
+        Configure();
+
+        BlockingResource blocking("/a/pool/busy", "core.pool.busy");
+        OCResource::Ptr resource = FindResource("core.pool.busy");
+        ASSERT_TRUE(nullptr != resource);
+
+        auto entered = blocking.expectEntered();
+        auto running = Get(resource);
+        ASSERT_EQ(std::future_status::ready, entered.wait_for(TIMEOUT));
+        auto waiting = Get(resource);
+        auto refused = Get(resource);
+
+        ASSERT_EQ(std::future_status::ready, refused.wait_for(TIMEOUT));
+        EXPECT_NE(OC_STACK_OK, refused.get());
+
+        blocking.release();
+        ASSERT_EQ(std::future_status::ready, running.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, running.get());
+        ASSERT_EQ(std::future_status::ready, waiting.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, waiting.get());
+    }
+
+    TEST(EntityHandlerPoolTest, HandlerRunsInPlaceWhenPoolIsFull)
+    {
+        Configure();
+
+        BlockingResource blocking("/a/pool/full", "core.pool.full");
+        OCResource::Ptr busy = FindResource("core.pool.full");
+        ASSERT_TRUE(nullptr != busy);
+
+        OCResourceHandle handle = RegisterResource("/a/pool/other", "core.pool.other",
+                [](std::shared_ptr<OCResourceRequest> request)
+                {
+                    return Respond(request, OC_EH_OK);
+                });
+        OCResource::Ptr other = FindResource("core.pool.other");
+        ASSERT_TRUE(nullptr != other);
+
+        auto entered = blocking.expectEntered();
+        auto running = Get(busy);
+        ASSERT_EQ(std::future_status::ready, entered.wait_for(TIMEOUT));
+        auto waiting = Get(busy);
+
+        // No handler of the other resource is pending, so it runs on the stack thread
+        // while the pool thread is still blocked.
+        auto inPlace = Get(other);
+        ASSERT_EQ(std::future_status::ready, inPlace.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, inPlace.get());
+        EXPECT_EQ(std::future_status::timeout, running.wait_for(std::chrono::seconds(0)));
+
+        blocking.release();
+        ASSERT_EQ(std::future_status::ready, running.wait_for(TIMEOUT));
+        ASSERT_EQ(std::future_status::ready, waiting.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    TEST(EntityHandlerPoolTest, FailingHandlerIsAnsweredWithError)
+    {
+        Configure();
+
+        OCResourceHandle handle = RegisterResource("/a/pool/error", "core.pool.error",
+                [](std::shared_ptr<OCResourceRequest>)
+                {
+                    return OC_EH_ERROR;
+                });
+        OCResource::Ptr resource = FindResource("core.pool.error");
+        ASSERT_TRUE(nullptr != resource);
+
+        auto answered = Get(resource);
+        ASSERT_EQ(std::future_status::ready, answered.wait_for(TIMEOUT));
+        EXPECT_NE(OC_STACK_OK, answered.get());
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    TEST(EntityHandlerPoolTest, ThrowingHandlerIsAnsweredWithError)
+    {
+        Configure();
+
+        OCResourceHandle handle = RegisterResource("/a/pool/throw", "core.pool.throw",
+                [](std::shared_ptr<OCResourceRequest>) -> OCEntityHandlerResult
+                {
+                    throw std::runtime_error("handler failed");
+                });
+        OCResource::Ptr resource = FindResource("core.pool.throw");
+        ASSERT_TRUE(nullptr != resource);
+
+        auto answered = Get(resource);
+        ASSERT_EQ(std::future_status::ready, answered.wait_for(TIMEOUT));
+        EXPECT_NE(OC_STACK_OK, answered.get());
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    TEST(EntityHandlerPoolTest, HandlerNotRespondingIsAnsweredWithItsResult)
+    {
+        Configure();
+
+        OCResourceHandle handle = RegisterResource("/a/pool/silent", "core.pool.silent",
+                [](std::shared_ptr<OCResourceRequest>)
+                {
+                    return OC_EH_OK;
+                });
+        OCResource::Ptr resource = FindResource("core.pool.silent");
+        ASSERT_TRUE(nullptr != resource);
+
+        auto answered = Get(resource);
+        ASSERT_EQ(std::future_status::ready, answered.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, answered.get());
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+}
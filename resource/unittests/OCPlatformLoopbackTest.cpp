@@ -0,0 +1,319 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Requests sent by this process to resources it serves itself. The platform keeps the
+// configuration of its first use, so these tests run in a program of their own.
+
+#include <OCPlatform.h>
+#include <OCApi.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace OCPlatformLoopbackTest
+{
+    using namespace OC;
+
+    const std::chrono::seconds TIMEOUT(5);
+
+    void Configure()
+    {
+        PlatformConfig cfg
+        { OC::ServiceType::InProc, OC::ModeType::Both, "0.0.0.0", 0,
+                OC::QualityOfService::LowQos };
+        OCPlatform::Configure(cfg);
+    }
+
+    OCResourceHandle RegisterResource(const std::string& uri, const std::string& type,
+                                      EntityHandler handler)
+    {
+        OCResourceHandle handle = nullptr;
+        std::string resourceUri = uri;
+        std::string resourceType = type;
+        std::string resourceInterface = DEFAULT_INTERFACE;
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::registerResource(handle, resourceUri, resourceType,
+                resourceInterface, handler, OC_DISCOVERABLE | OC_OBSERVABLE));
+        return handle;
+    }
+
+    // Finds a resource of this process through discovery.
+    OCResource::Ptr FindResource(const std::string& type)
+    {
+        auto found = std::make_shared<std::promise<OCResource::Ptr>>();
+        auto once = std::make_shared<std::once_flag>();
+        std::ostringstream query;
+        query << OC_RSRVD_WELL_KNOWN_URI << "?rt=" << type;
+        OCPlatform::findResource("", query.str(), CT_ADAPTER_IP,
+                [found, once](OCResource::Ptr resource)
+                {
+                    std::call_once(*once, [&]{ found->set_value(resource); });
+                });
+
+        auto future = found->get_future();
+        if (std::future_status::ready != future.wait_for(TIMEOUT))
+        {
+            return nullptr;
+        }
+        return future.get();
+    }
+
+    OCEntityHandlerResult Respond(std::shared_ptr<OCResourceRequest> request,
+                                  OCEntityHandlerResult result)
+    {
+        auto response = std::make_shared<OCResourceResponse>();
+        response->setRequestHandle(request->getRequestHandle());
+        response->setResourceHandle(request->getResourceHandle());
+        response->setResponseResult(result);
+        OCRepresentation rep;
+        rep.setValue("state", true);
+        response->setResourceRepresentation(rep);
+        OCPlatform::sendResponse(response);
+        return result;
+    }
+
+    TEST(LockOrderTest, HandlerRegistersResourceWhileAnotherThreadNotifies)
+    {
+        Configure();
+
+        std::atomic<int> registered(0);
+        std::atomic<bool> armed(false);
+        std::promise<void> entered;
+        std::promise<void> notifying;
+        std::shared_future<void> notifyStarted(notifying.get_future());
+
+        // Every call, also the ones rendering notifications, registers a resource.
+        OCResourceHandle handle = RegisterResource("/a/lockorder", "core.lockorder",
+                [&](std::shared_ptr<OCResourceRequest> request)
+                {
+                    if (armed.exchange(false))
+                    {
+                        entered.set_value();
+                        notifyStarted.wait();
+                        // Let the notifying thread reach the stack first.
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    }
+
+                    std::ostringstream uri;
+                    uri << "/a/lockorder/" << registered++;
+                    OCResourceHandle extra = RegisterResource(uri.str(), "core.extra", nullptr);
+                    OCPlatform::unregisterResource(extra);
+                    return Respond(request, OC_EH_OK);
+                });
+
+        OCResource::Ptr resource = FindResource("core.lockorder");
+        ASSERT_TRUE(nullptr != resource);
+
+        std::promise<void> observing;
+        std::once_flag observed;
+        resource->observe(ObserveType::Observe, QueryParamsMap(),
+                [&](const HeaderOptions&, const OCRepresentation&, const int, const int)
+                {
+                    std::call_once(observed, [&]{ observing.set_value(); });
+                });
+        ASSERT_EQ(std::future_status::ready, observing.get_future().wait_for(TIMEOUT));
+
+        // The stack processing thread runs the handler with the stack lock released while
+        // another thread has the stack render a notification with it.
+        armed = true;
+        std::promise<void> answered;
+        resource->get(QueryParamsMap(),
+                [&](const HeaderOptions&, const OCRepresentation&, const int)
+                {
+                    answered.set_value();
+                });
+        ASSERT_EQ(std::future_status::ready, entered.get_future().wait_for(TIMEOUT));
+
+        auto notified = std::async(std::launch::async, [&]
+                {
+                    notifying.set_value();
+                    return OCPlatform::notifyAllObservers(handle);
+                });
+
+        EXPECT_EQ(std::future_status::ready, answered.get_future().wait_for(TIMEOUT));
+        ASSERT_EQ(std::future_status::ready, notified.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, notified.get());
+
+        resource->cancelObserve();
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    OCEntityHandlerResult Answer(std::shared_ptr<OCResourceRequest> request)
+    {
+        return Respond(request, OC_EH_OK);
+    }
+
+    // Leaves the request unanswered.
+    OCEntityHandlerResult Ignore(std::shared_ptr<OCResourceRequest>)
+    {
+        return OC_EH_SLOW;
+    }
+
+    OCEntityHandlerResult Fail(std::shared_ptr<OCResourceRequest>)
+    {
+        return OC_EH_ERROR;
+    }
+
+    TEST(FutureTest, GetAsyncHoldsResponse)
+    {
+        Configure();
+
+        OCResourceHandle handle = RegisterResource("/a/future", "core.future", Answer);
+        OCResource::Ptr resource = FindResource("core.future");
+        ASSERT_TRUE(nullptr != resource);
+
+        RequestFuture future = resource->getAsync(QueryParamsMap());
+        ASSERT_EQ(std::future_status::ready, future.wait_for(TIMEOUT));
+        RequestResult result = future.get();
+        EXPECT_EQ(OC_STACK_OK, result.result);
+        EXPECT_TRUE(result.representation.getValue<bool>("state"));
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    TEST(FutureTest, WaitingInCallbackThrows)
+    {
+        Configure();
+
+        OCResourceHandle handle = RegisterResource("/a/future/callback", "core.future.callback",
+                                                   Answer);
+        OCResource::Ptr resource = FindResource("core.future.callback");
+        ASSERT_TRUE(nullptr != resource);
+
+        std::promise<int> thrown;
+        resource->get(QueryParamsMap(),
+                [&](const HeaderOptions&, const OCRepresentation&, const int)
+                {
+                    int count = 0;
+                    RequestFuture future = resource->getAsync(QueryParamsMap());
+                    try
+                    {
+                        future.get();
+                    }
+                    catch (OCException&)
+                    {
+                        ++count;
+                    }
+                    try
+                    {
+                        OCPlatform::getAll({ resource }, QueryParamsMap(), TIMEOUT);
+                    }
+                    catch (OCException&)
+                    {
+                        ++count;
+                    }
+                    thrown.set_value(count);
+                });
+
+        auto counted = thrown.get_future();
+        ASSERT_EQ(std::future_status::ready, counted.wait_for(TIMEOUT));
+        EXPECT_EQ(2, counted.get());
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    TEST(FutureTest, WaitingInEntityHandlerThrows)
+    {
+        Configure();
+
+        OCResourceHandle answering = RegisterResource("/a/future/answer", "core.future.answer",
+                                                      Answer);
+        OCResource::Ptr other = FindResource("core.future.answer");
+        ASSERT_TRUE(nullptr != other);
+
+        // Run in place, the handler is on the thread processing the stack
+        OCResourceHandle handle = RegisterResource("/a/future/handler", "core.future.handler",
+                [&](std::shared_ptr<OCResourceRequest> request)
+                {
+                    RequestFuture future = other->getAsync(QueryParamsMap());
+                    EXPECT_THROW(future.get(), OCException);
+                    EXPECT_THROW(OCPlatform::getAll({ other }, QueryParamsMap(), TIMEOUT),
+                                 OCException);
+                    return Respond(request, OC_EH_OK);
+                });
+        OCResource::Ptr resource = FindResource("core.future.handler");
+        ASSERT_TRUE(nullptr != resource);
+
+        RequestFuture future = resource->getAsync(QueryParamsMap());
+        ASSERT_EQ(std::future_status::ready, future.wait_for(TIMEOUT));
+        EXPECT_EQ(OC_STACK_OK, future.get().result);
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(answering));
+    }
+
+    TEST(GetAllTest, UnansweredRequestTimesOut)
+    {
+        Configure();
+
+        OCResourceHandle handle = RegisterResource("/a/getall/silent", "core.getall.silent",
+                                                   Ignore);
+        OCResource::Ptr resource = FindResource("core.getall.silent");
+        ASSERT_TRUE(nullptr != resource);
+
+        const std::chrono::milliseconds timeout(200);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<RequestResult> results = OCPlatform::getAll({ resource }, QueryParamsMap(),
+                                                                timeout);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        ASSERT_EQ(1u, results.size());
+        EXPECT_EQ(OC_STACK_TIMEOUT, results[0].result);
+        EXPECT_GE(elapsed, timeout);
+        EXPECT_LT(elapsed, TIMEOUT);
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+    }
+
+    TEST(GetAllTest, ResultsFollowResources)
+    {
+        Configure();
+
+        OCResourceHandle answering = RegisterResource("/a/getall/ok", "core.getall.ok", Answer);
+        OCResourceHandle silent = RegisterResource("/a/getall/none", "core.getall.none", Ignore);
+        OCResourceHandle failing = RegisterResource("/a/getall/fail", "core.getall.fail", Fail);
+        OCResource::Ptr ok = FindResource("core.getall.ok");
+        OCResource::Ptr none = FindResource("core.getall.none");
+        OCResource::Ptr fail = FindResource("core.getall.fail");
+        ASSERT_TRUE(nullptr != ok);
+        ASSERT_TRUE(nullptr != none);
+        ASSERT_TRUE(nullptr != fail);
+
+        std::vector<RequestResult> results = OCPlatform::getAll({ ok, none, fail, nullptr, ok },
+                QueryParamsMap(), std::chrono::milliseconds(500));
+
+        ASSERT_EQ(5u, results.size());
+        EXPECT_EQ(OC_STACK_OK, results[0].result);
+        EXPECT_TRUE(results[0].representation.getValue<bool>("state"));
+        EXPECT_EQ(OC_STACK_TIMEOUT, results[1].result);
+        EXPECT_NE(OC_STACK_OK, results[2].result);
+        EXPECT_NE(OC_STACK_TIMEOUT, results[2].result);
+        EXPECT_EQ(OC_STACK_INVALID_PARAM, results[3].result);
+        EXPECT_EQ(OC_STACK_OK, results[4].result);
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(answering));
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(silent));
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(failing));
+    }
+}
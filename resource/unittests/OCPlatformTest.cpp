@@ -23,6 +23,10 @@
 #include <oic_malloc.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <future>
+#include <thread>
+
 namespace OCPlatformTest
 {
     using namespace OC;
@@ -53,6 +57,10 @@ namespace OCPlatformTest
     {
     }
 
+    void foundResources(const std::vector<std::shared_ptr<OCResource>>& /*resources*/)
+    {
+    }
+
     void receivedDeviceInfo(const OCRepresentation& /*rep*/)
     {
     }
@@ -666,6 +674,57 @@ namespace OCPlatformTest
                         OC::QualityOfService::NaQos));
     }
 
+    TEST(FindResourceTest, FindResourcesNullHandlers)
+    {
+        std::ostringstream requestURI;
+        requestURI << OC_RSRVD_WELL_KNOWN_URI << "?rt=core.light";
+        OCDiscoverySession::Ptr session;
+        EXPECT_THROW(OCPlatform::findResources(session, "", requestURI.str(), CT_DEFAULT,
+                std::chrono::milliseconds(100), NULL, []{}), OC::OCException);
+        EXPECT_THROW(OCPlatform::findResources(session, "", requestURI.str(), CT_DEFAULT,
+                std::chrono::milliseconds(100), &foundResources, NULL), OC::OCException);
+        EXPECT_FALSE(session);
+    }
+
+    TEST(FindResourceTest, FindResourcesEndsAtDeadline)
+    {
+        std::ostringstream requestURI;
+        requestURI << OC_RSRVD_WELL_KNOWN_URI << "?rt=core.light";
+        OCDiscoverySession::Ptr session;
+        std::promise<void> done;
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::findResources(session, "", requestURI.str(),
+                CT_DEFAULT, std::chrono::milliseconds(100), &foundResources,
+                [&done]{ done.set_value(); }));
+        ASSERT_TRUE(session);
+        EXPECT_EQ(std::future_status::ready,
+                done.get_future().wait_for(std::chrono::seconds(5)));
+        EXPECT_TRUE(session->isDone());
+    }
+
+    TEST(FindResourceTest, FindResourcesCancel)
+    {
+        std::ostringstream requestURI;
+        requestURI << OC_RSRVD_WELL_KNOWN_URI << "?rt=core.light";
+        OCDiscoverySession::Ptr session;
+        std::atomic<int> doneCount(0);
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::findResources(session, "", requestURI.str(),
+                CT_DEFAULT, std::chrono::seconds(60), &foundResources,
+                [&doneCount]{ ++doneCount; }));
+        ASSERT_TRUE(session);
+        EXPECT_FALSE(session->isDone());
+
+        session->cancel();
+        session->cancel();
+        EXPECT_TRUE(session->isDone());
+
+        // The done callback may run on another thread
+        for (int i = 0; i < 500 && 0 == doneCount; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_EQ(1, doneCount);
+    }
+
     //GetDeviceInfo Test
     TEST(GetDeviceInfoTest, DISABLED_GetDeviceInfoWithValidParameters)
     {
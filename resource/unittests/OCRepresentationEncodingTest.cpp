@@ -21,6 +21,7 @@
 #include <gtest/gtest.h>
 #include <OCApi.h>
 #include <OCRepresentation.h>
+#include <OCResourceSchema.h>
 #include <octypes.h>
 #include <ocstack.h>
 #include <ocpayload.h>
@@ -1298,4 +1299,220 @@ namespace OCRepresentationEncodingTest
         OCRepPayloadDestroy(repPayload);
         OCPayloadDestroy(cparsed);
     }
+
+    // Schema encoding must give the same bytes as the generic path
+    TEST(SchemaEncoding, MatchesRepPayload)
+    {
+        OC::Schema::Temperature temp{21.5, "C"};
+        std::vector<uint8_t> encoded = OC::encodeSchema(temp);
+
+        OCRepPayload* repPayload = OCRepPayloadCreate();
+        OCRepPayloadAddResourceType(repPayload, "oic.r.temperature");
+        OCRepPayloadAddInterface(repPayload, "oic.if.baseline");
+        OCRepPayloadSetPropDouble(repPayload, "temperature", 21.5);
+        OCRepPayloadSetPropString(repPayload, "units", "C");
+
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK,
+                OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+        EXPECT_EQ(std::vector<uint8_t>(cborData, cborData + cborSize), encoded);
+
+        OICFree(cborData);
+        OCRepPayloadDestroy(repPayload);
+    }
+
+    TEST(SchemaEncoding, IntegersWithoutBaseline)
+    {
+        const int64_t values[] = {0, 23, 24, 255, 256, -1, -25, 70000, -5000000000LL};
+        for (int64_t value : values)
+        {
+            OC::Schema::Brightness brightness{value};
+            std::vector<uint8_t> encoded = OC::encodeSchema(brightness, OC::LINK_INTERFACE);
+
+            OCRepPayload* repPayload = OCRepPayloadCreate();
+            OCRepPayloadSetPropInt(repPayload, "brightness", value);
+
+            uint8_t* cborData;
+            size_t cborSize;
+            EXPECT_EQ(OC_STACK_OK,
+                    OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+            EXPECT_EQ(std::vector<uint8_t>(cborData, cborData + cborSize), encoded);
+
+            OICFree(cborData);
+            OCRepPayloadDestroy(repPayload);
+        }
+    }
+
+    TEST(SchemaEncoding, LargerThanStackBuffer)
+    {
+        OC::Schema::Temperature temp{-3.25, std::string(300, 'K')};
+        std::vector<uint8_t> encoded = OC::encodeSchema(temp);
+
+        OCPayload* cparsed;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    encoded.data(), encoded.size()));
+
+        OC::Schema::Temperature decoded{0, ""};
+        EXPECT_TRUE(OC::decodeSchema((OCRepPayload*)cparsed, decoded));
+        EXPECT_EQ(-3.25, decoded.temperature);
+        EXPECT_EQ(temp.units, decoded.units);
+
+        OCPayloadDestroy(cparsed);
+    }
+
+    TEST(SchemaDecoding, Normal)
+    {
+        OCRepPayload* repPayload = OCRepPayloadCreate();
+        OCRepPayloadSetPropInt(repPayload, "temperature", 20);
+        OCRepPayloadSetPropString(repPayload, "unknown", "ignored");
+
+        OC::Schema::Temperature temp{0, "F"};
+        EXPECT_TRUE(OC::decodeSchema(repPayload, temp));
+        EXPECT_EQ(20.0, temp.temperature);
+        EXPECT_EQ("F", temp.units);
+
+        OC::Schema::BinarySwitch binarySwitch{false};
+        OCRepPayloadSetPropBool(repPayload, "value", true);
+        EXPECT_TRUE(OC::decodeSchema(repPayload, binarySwitch));
+        EXPECT_TRUE(binarySwitch.value);
+
+        OCRepPayloadSetPropString(repPayload, "units", "C");
+        OCRepPayloadSetPropBool(repPayload, "temperature", true);
+        EXPECT_FALSE(OC::decodeSchema(repPayload, temp));
+
+        OCRepPayloadDestroy(repPayload);
+    }
+
+    TEST(SchemaEncoding, EncodedPayload)
+    {
+        std::vector<uint8_t> encoded = OC::encodeSchema(OC::Schema::BinarySwitch{true});
+        OCEncodedPayload* payload = OCEncodedPayloadCreate(encoded.data(), encoded.size());
+        ASSERT_NE(nullptr, payload);
+
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cborData, &cborSize));
+        EXPECT_EQ(encoded, std::vector<uint8_t>(cborData, cborData + cborSize));
+
+        OICFree(cborData);
+        OCPayloadDestroy((OCPayload*)payload);
+        EXPECT_EQ(nullptr, OCEncodedPayloadCreate(encoded.data(), 0));
+    }
+
+    static std::vector<uint8_t> encodeRepPayload(const OC::MessageContainer& mc)
+    {
+        OCRepPayload* repPayload = mc.getPayload();
+        uint8_t* cborData;
+        size_t cborSize;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+        std::vector<uint8_t> encoded(cborData, cborData + cborSize);
+        OICFree(cborData);
+        OCRepPayloadDestroy(repPayload);
+        return encoded;
+    }
+
+    static std::vector<uint8_t> encodeDirect(const OC::MessageContainer& mc)
+    {
+        OCEncodedPayload* payload = (OCEncodedPayload*)mc.getEncodedPayload();
+        EXPECT_EQ(PAYLOAD_TYPE_ENCODED, payload->base.type);
+        std::vector<uint8_t> encoded(payload->data, payload->data + payload->size);
+        OCPayloadDestroy((OCPayload*)payload);
+        return encoded;
+    }
+
+    // Direct encoding must give the same bytes as going through OCRepPayload
+    TEST(RepresentationCodec, MatchesRepPayload)
+    {
+        OC::OCRepresentation inner;
+        inner.setValue("IntAttr", 5);
+        inner.setValue("StringAttr", std::string("inner"));
+
+        OC::OCRepresentation rep;
+        rep.setUri("/a/light");
+        rep.setResourceTypes({"rt.one", "rt.two"});
+        rep.setResourceInterfaces({"oic.if.baseline"});
+        rep.setNULL("NullAttr");
+        rep.setValue("IntAttr", -77);
+        rep.setValue("DoubleAttr", 3.25);
+        rep.setValue("BoolAttr", true);
+        rep.setValue("StringAttr", std::string("String attr"));
+        rep.setValue("ObjAttr", inner);
+        rep.setValue("BinAttr", std::vector<uint8_t>{1, 2, 3});
+        rep.setValue("BoolArr", std::vector<bool>{true, false, true});
+        rep.setValue("IntArr", std::vector<std::vector<int>>{{1, 2, 3}, {4}});
+        rep.setValue("StrArr", std::vector<std::vector<std::vector<std::string>>>
+                {{{"a"}, {"b", "c"}}, {{"d", "e", "f"}}});
+        rep.setValue("ObjArr", std::vector<OC::OCRepresentation>{inner, inner});
+
+        OC::MessageContainer single;
+        single.addRepresentation(rep);
+        EXPECT_EQ(encodeRepPayload(single), encodeDirect(single));
+
+        OC::OCRepresentation child;
+        child.setUri("/a/child");
+        child.setValue("DoubleArr", std::vector<std::vector<double>>{{1.5}, {2.5, 3.5}});
+
+        OC::MessageContainer collection;
+        collection.addRepresentation(rep);
+        collection.addRepresentation(child);
+        EXPECT_EQ(encodeRepPayload(collection), encodeDirect(collection));
+    }
+
+    TEST(RepresentationCodec, RoundTrip)
+    {
+        OC::OCRepresentation inner;
+        inner.setValue("BoolAttr", false);
+
+        OC::OCRepresentation rep;
+        rep.setUri("/a/light");
+        rep.setResourceTypes({"rt.one", "rt.two"});
+        rep.setResourceInterfaces({"oic.if.baseline", "oic.if.ll"});
+        rep.setNULL("NullAttr");
+        rep.setValue("IntAttr", 77);
+        rep.setValue("DoubleAttr", 3.333);
+        rep.setValue("StringAttr", std::string(2000, 's'));
+        rep.setValue("ObjAttr", inner);
+        rep.setValue("BinAttr", std::vector<uint8_t>{0, 255});
+        rep.setValue("IntArr", std::vector<std::vector<int>>{{1, 2}, {3, 4}});
+        rep.setValue("ObjArr", std::vector<std::vector<OC::OCRepresentation>>
+                {{inner}, {inner}});
+
+        OC::OCRepresentation child;
+        child.setUri("/a/child");
+        child.setValue("StrArr", std::vector<std::string>{"x", "y"});
+
+        OC::MessageContainer mc;
+        mc.addRepresentation(rep);
+        mc.addRepresentation(child);
+
+        OCPayload* payload = mc.getEncodedPayload();
+        OC::MessageContainer decoded;
+        decoded.setPayload(payload);
+        OCPayloadDestroy(payload);
+
+        ASSERT_EQ(2u, decoded.representations().size());
+        EXPECT_EQ(rep, decoded[0]);
+        EXPECT_EQ(child, decoded[1]);
+    }
+
+    TEST(RepresentationCodec, Malformed)
+    {
+        OC::OCRepresentation rep;
+        rep.setValue("IntArr", std::vector<int>{1, 2, 3});
+        OC::MessageContainer mc;
+        mc.addRepresentation(rep);
+        std::vector<uint8_t> encoded = encodeDirect(mc);
+
+        OCEncodedPayload* truncated = OCEncodedPayloadCreate(encoded.data(), encoded.size() - 2);
+        OC::MessageContainer decoded;
+        EXPECT_THROW(decoded.setPayload((OCPayload*)truncated), OC::OCException);
+        OCPayloadDestroy((OCPayload*)truncated);
+
+        // An array mixing integers and strings
+        const uint8_t mixed[] = {0xbf, 0x61, 'a', 0x82, 0x01, 0x61, 'b', 0xff};
+        OCEncodedPayload* payload = OCEncodedPayloadCreate(mixed, sizeof(mixed));
+        EXPECT_THROW(decoded.setPayload((OCPayload*)payload), OC::OCException);
+        OCPayloadDestroy((OCPayload*)payload);
+    }
 }
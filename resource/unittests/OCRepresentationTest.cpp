@@ -1310,4 +1310,147 @@ namespace OCRepresentationTest
             }
         }
     }
+
+    TEST(OCRepresentationCopy, CopiesAreIndependent)
+    {
+        OCRepresentation child;
+        child.setUri("/child");
+        child["level"] = 1;
+
+        OCRepresentation rep;
+        rep.setUri("/parent");
+        rep.addResourceType("core.parent");
+        rep["power"] = 5;
+        rep["name"] = string("lamp");
+        rep["child"] = child;
+        rep.addChild(child);
+
+        OCRepresentation copy(rep);
+        copy["power"] = 7;
+        copy["added"] = true;
+        copy.erase("name");
+        copy.setUri("/copy");
+        copy.addResourceType("core.copy");
+        copy.addChild(child);
+        child["level"] = 2;
+
+        EXPECT_EQ(5, rep.getValue<int>("power"));
+        EXPECT_EQ("lamp", rep.getValue<string>("name"));
+        EXPECT_FALSE(rep.hasAttribute("added"));
+        EXPECT_EQ("/parent", rep.getUri());
+        EXPECT_EQ(1u, rep.getResourceTypes().size());
+        EXPECT_EQ(1u, rep.getChildren().size());
+        EXPECT_EQ(1, rep.getValue<OCRepresentation>("child").getValue<int>("level"));
+
+        EXPECT_EQ(7, copy.getValue<int>("power"));
+        EXPECT_FALSE(copy.hasAttribute("name"));
+        EXPECT_TRUE(copy.getValue<bool>("added"));
+        EXPECT_EQ("/copy", copy.getUri());
+        EXPECT_EQ(2u, copy.getResourceTypes().size());
+        EXPECT_EQ(2u, copy.getChildren().size());
+    }
+
+    TEST(OCRepresentationCopy, ReadingDoesNotAddOrReorder)
+    {
+        OCRepresentation rep;
+        rep["b"] = 2;
+        rep["c"] = 3;
+        rep["a"] = 1;
+
+        const OCRepresentation copy(rep);
+        EXPECT_EQ(0, copy.getValue<int>("missing"));
+        EXPECT_FALSE(copy.hasAttribute("missing"));
+        EXPECT_EQ(3, copy.numberOfAttributes());
+
+        vector<string> names;
+        for (const auto& item : copy)
+        {
+            names.push_back(item.attrname());
+            EXPECT_EQ(AttributeType::Integer, item.type());
+        }
+        EXPECT_EQ((vector<string>{"a", "b", "c"}), names);
+    }
+
+    TEST(OCRepresentationCopy, WritingWhileIteratingLeavesCopyAlone)
+    {
+        OCRepresentation rep;
+        rep["a"] = 1;
+        rep["b"] = 2;
+        rep["c"] = 3;
+
+        OCRepresentation copy(rep);
+        int visited = 0;
+        for (auto& item : copy)
+        {
+            item = item.getValue<int>() * 10;
+            ++visited;
+        }
+
+        EXPECT_EQ(3, visited);
+        EXPECT_EQ(10, copy.getValue<int>("a"));
+        EXPECT_EQ(30, copy.getValue<int>("c"));
+        EXPECT_EQ(1, rep.getValue<int>("a"));
+        EXPECT_EQ(3, rep.getValue<int>("c"));
+        EXPECT_EQ(3u, rep.getValues().size());
+    }
+
+    TEST(OCRepresentationCopy, MissingAttributeReadsAsNull)
+    {
+        OCRepresentation rep;
+        rep["a"] = 1;
+        const OCRepresentation copy(rep);
+
+        EXPECT_EQ(AttributeType::Null, copy["missing"].type());
+        EXPECT_EQ(AttributeType::Null, rep["missing"].type());
+        EXPECT_FALSE(rep.hasAttribute("missing"));
+        EXPECT_EQ(1, rep.numberOfAttributes());
+    }
+
+    TEST(OCRepresentationCopy, GetValuesDoesNotCopy)
+    {
+        OCRepresentation rep;
+        rep["b"] = 2;
+        rep["a"] = 1;
+
+        EXPECT_EQ(&rep.getValues(), &rep.getValues());
+        std::map<std::string, AttributeValue> values = rep.getValues();
+        EXPECT_EQ(2u, values.size());
+        EXPECT_EQ(1, boost::get<int>(values["a"]));
+    }
+
+    TEST(AttributeMapTest, SetAllSortsOnceAndKeepsLastValue)
+    {
+        AttributeMap values;
+        values.set("m", 0);
+        values.set("x", 0);
+        values.setAll({ { "z", 1 }, { "b", 2 }, { "m", 3 }, { "b", 4 } });
+
+        vector<string> names;
+        for (const auto& item : values)
+        {
+            names.push_back(item.first);
+        }
+        EXPECT_EQ((vector<string>{"b", "m", "x", "z"}), names);
+        EXPECT_EQ(4, boost::get<int>(values.find("b")->second));
+        EXPECT_EQ(3, boost::get<int>(values.find("m")->second));
+        EXPECT_EQ(0, boost::get<int>(values.find("x")->second));
+    }
+
+    TEST(AttributeMapTest, SetKeepsKeysSorted)
+    {
+        AttributeMap values;
+        values.set("c", 3);
+        values.set("a", 1);
+        values.set("d", 4);
+        values.set("b", 2);
+        values.set("d", 5);
+
+        vector<string> names;
+        for (const auto& item : values)
+        {
+            names.push_back(item.first);
+        }
+        EXPECT_EQ((vector<string>{"a", "b", "c", "d"}), names);
+        EXPECT_EQ(5, boost::get<int>(values.find("d")->second));
+    }
 }
@@ -546,5 +546,55 @@ namespace OCResourceTest
         EXPECT_NO_THROW(resource->setHeaderOptions(headerOptions));
         EXPECT_NO_THROW(resource->unsetHeaderOptions());
     }
+
+    //Future Test
+    TEST(FutureCallbackTest, FutureHoldsResponse)
+    {
+        RequestFuture future;
+        GetCallback callback = OCResource::futureCallback(future);
+        OCRepresentation rep;
+        rep.setValue("state", true);
+        callback(HeaderOptions(), rep, OC_STACK_OK);
+
+        ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+        RequestResult result = future.get();
+        EXPECT_EQ(OC_STACK_OK, result.result);
+        EXPECT_TRUE(result.representation.getValue<bool>("state"));
+    }
+
+    TEST(FutureCallbackTest, FutureKeepsFirstResponse)
+    {
+        RequestFuture future;
+        GetCallback callback = OCResource::futureCallback(future);
+        GetCallback copy = callback;
+        callback(HeaderOptions(), OCRepresentation(), OC_STACK_COMM_ERROR);
+        copy(HeaderOptions(), OCRepresentation(), OC_STACK_OK);
+
+        EXPECT_EQ(OC_STACK_COMM_ERROR, future.get().result);
+    }
+
+    TEST(FutureCallbackTest, DroppedCallbackTimesOut)
+    {
+        RequestFuture future;
+        {
+            GetCallback callback = OCResource::futureCallback(future);
+            GetCallback copy = callback;
+            EXPECT_EQ(std::future_status::timeout, future.wait_for(std::chrono::seconds(0)));
+        }
+
+        ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+        EXPECT_EQ(OC_STACK_TIMEOUT, future.get().result);
+    }
+
+    TEST(FutureCallbackTest, CalledCallbackKeepsResponseWhenDropped)
+    {
+        RequestFuture future;
+        {
+            GetCallback callback = OCResource::futureCallback(future);
+            callback(HeaderOptions(), OCRepresentation(), OC_STACK_OK);
+        }
+
+        EXPECT_EQ(OC_STACK_OK, future.get().result);
+    }
 }
 